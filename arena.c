@@ -0,0 +1,163 @@
+/**
+ * @file arena.c
+ * @brief A bump allocator for the memory of a solve.
+ *
+ * The memory a solve needs is known from the size of the system before it
+ * starts, so it is reserved in a single block. Each allocation then only
+ * moves a pointer forward, and everything is given back at once when the
+ * solve ends. The allocations fail by returning NULL when the block is
+ * exhausted, so that the solver can report it to its caller.
+ *
+ * The values that grow during the elimination, the promoted ones, are not
+ * known in advance and keep their own memory.
+ *
+ * @see arena.h
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Rounds a number of bytes up to the alignment of the allocations.
+ *
+ * @param[in] bytes The number of bytes.
+ *
+ * @return The rounded number, or SIZE_MAX if it overflows.
+ */
+static size_t
+round_up(const size_t bytes)
+{
+	if (bytes > SIZE_MAX - (ARENA_ALIGNMENT - 1)) {
+		return SIZE_MAX;
+	}
+	return (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Gives the room an allocation takes in an arena.
+ *
+ * Used to size an arena before allocating from it.
+ *
+ * @param[in] count The number of elements of the allocation.
+ * @param[in] size The size of an element.
+ *
+ * @return The number of bytes, alignment included, or SIZE_MAX if it
+ * overflows.
+ */
+size_t
+arena_size(const size_t count, const size_t size)
+{
+	if (size != 0 && count > SIZE_MAX / size) {
+		return SIZE_MAX;
+	}
+	return round_up(count * size);
+}
+
+/**
+ * @brief Allocates an arena.
+ *
+ * @param[out] a The arena to initialise.
+ * @param[in] capacity The number of bytes of the arena.
+ *
+ * @return Whether the memory could be allocated. If not, the arena is left
+ * empty.
+ */
+bool
+arena_init(arena *const a, const size_t capacity)
+{
+	a->base = NULL;
+	a->capacity = 0;
+	a->used = 0;
+	a->peak = 0;
+	return arena_reserve(a, capacity);
+}
+
+/**
+ * @brief Releases the memory of an arena.
+ *
+ * All the allocations made from it become invalid.
+ *
+ * @param[in, out] a The arena to free.
+ */
+void
+arena_free(arena *const a)
+{
+	free(a->base);
+	a->base = NULL;
+	a->capacity = 0;
+	a->used = 0;
+}
+
+/**
+ * @brief Makes sure an arena holds at least a number of bytes.
+ *
+ * The memory only grows if the arena is too small. Its contents are then
+ * lost, so the arena must hold no allocation in use.
+ *
+ * @param[in, out] a The arena, initialised or empty.
+ * @param[in] capacity The number of bytes needed.
+ *
+ * @return Whether the memory could be allocated. If not, the arena is left
+ * as it was.
+ */
+bool
+arena_reserve(arena *const a, const size_t capacity)
+{
+	if (capacity <= a->capacity) {
+		return true;
+	}
+	if (capacity == SIZE_MAX) {
+		return false;
+	}
+	void *base = NULL;
+	if (posix_memalign(&base, ARENA_ALIGNMENT, capacity) != 0) {
+		return false;
+	}
+	free(a->base);
+	a->base = base;
+	a->capacity = capacity;
+	a->used = 0;
+	return true;
+}
+
+/**
+ * @brief Allocates memory from an arena.
+ *
+ * The memory is aligned on @ref ARENA_ALIGNMENT bytes, and is not
+ * initialised.
+ *
+ * @param[in, out] a The arena to allocate from.
+ * @param[in] count The number of elements to allocate.
+ * @param[in] size The size of an element.
+ *
+ * @return The memory, or NULL if the arena is exhausted.
+ */
+void *
+arena_alloc(arena *const a, const size_t count, const size_t size)
+{
+	const size_t bytes = arena_size(count, size);
+	if (bytes > a->capacity - a->used) {
+		return NULL;
+	}
+	void *memory = a->base + a->used;
+	a->used += bytes;
+	if (a->used > a->peak) {
+		a->peak = a->used;
+	}
+	return memory;
+}
+
+/**
+ * @brief Releases all the allocations of an arena, keeping its memory.
+ *
+ * @param[in, out] a The arena to reset.
+ */
+void
+arena_reset(arena *const a)
+{
+	a->used = 0;
+}
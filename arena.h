@@ -0,0 +1,71 @@
+/**
+ * @file arena.h
+ * @brief Definitions for arena.c
+ * @see arena.c
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief The alignment of every allocation, the size of a cache line. */
+#define ARENA_ALIGNMENT 64
+
+/**
+ * @brief A block of memory handed out by bumping a pointer.
+ *
+ * The allocations are never freed one by one: the whole arena is reset, or
+ * rewound to an earlier position, at once.
+ */
+struct arena {
+	/** The memory of the arena */
+	unsigned char *base;
+	/** The number of bytes of the arena */
+	size_t capacity;
+	/** The number of bytes handed out */
+	size_t used;
+	/** The greatest number of bytes handed out at once */
+	size_t peak;
+};
+
+/**
+ * @brief Definition of a type from the arena structure.
+ * @see struct arena
+ */
+typedef struct arena arena;
+
+bool arena_init(arena *const, const size_t);
+void arena_free(arena *const);
+bool arena_reserve(arena *const, const size_t);
+void *arena_alloc(arena *const, const size_t, const size_t);
+void arena_reset(arena *const);
+size_t arena_size(const size_t, const size_t);
+
+/**
+ * @brief Gives the current position of an arena, to rewind it later.
+ *
+ * @param[in] a The arena.
+ *
+ * @return The number of bytes handed out.
+ */
+static inline size_t
+arena_position(const arena *const a)
+{
+	return a->used;
+}
+
+/**
+ * @brief Releases all the allocations made since a position.
+ *
+ * @param[in, out] a The arena.
+ * @param[in] position A position given by arena_position().
+ */
+static inline void
+arena_rewind(arena *const a, const size_t position)
+{
+	a->used = position;
+}
+
+#endif /* ARENA_H */
@@ -0,0 +1,238 @@
+/**
+ * @file bareiss.c
+ * @brief Fraction-free elimination of integer matrices.
+ *
+ * The matrix used by this engine holds the raw integer coefficients of the
+ * system instead of @ref fraction structures. Bareiss' one-step method keeps
+ * every intermediate value an integer: each row update is followed by an
+ * exact division by the previous pivot, so that the entries of the matrix are
+ * always minors of the original matrix. Their size is thus bounded by the
+ * size of the determinant, and no GCD has to be computed until the very end.
+ *
+ * The elimination is done Gauss-Jordan style (every line but the pivot's is
+ * updated), which leaves the determinant of the system on the whole diagonal.
+ * When a minor does not fit in 64 bits, the matrix is left equivalent to the
+ * system, for the fraction engine to finish the elimination.
+ *
+ * @see https://en.wikipedia.org/wiki/Bareiss_algorithm
+ */
+
+#include "bareiss.h"
+
+#include "report.h"
+
+/**
+ * @brief A signed integer type wide enough to hold the product of two
+ * `int64_t`.
+ */
+/*
+ * The cross-products of the update overflow 64 bits long before their
+ * quotient by the previous pivot does, so they are computed on 128 bits. Each
+ * product and their difference are still checked, rather than relying on
+ * their bounds.
+ */
+__extension__ typedef __int128 wide_int;
+
+/**
+ * @brief Finds a line usable as the pivot for a column.
+ *
+ * Only the lines that have not been used as pivots yet are considered.
+ *
+ * @param[in] matrix The matrix to search the pivot in.
+ * @param[in] column The index of the column of the pivot.
+ *
+ * @return The index of the first line with a non-zero value in the column, or
+ * the number of lines of the matrix if there is none.
+ */
+static size_t
+find_nonzero_in_column(const integer_matrix *const matrix,
+                       const size_t column)
+{
+	for (size_t i = column; i < matrix->n_lines; i++) {
+		if (integer_matrix_line(matrix, i)[column] != 0) {
+			return i;
+		}
+	}
+	return matrix->n_lines;
+}
+
+/**
+ * @brief Restores the elements of a line that a step of the elimination
+ * updated, before one of them overflowed.
+ *
+ * Each division by the previous pivot \f$p\f$ was exact, so the element
+ * \f$a_{ij}\f$ is \f$(p a'_{ij} + a_{ik} a_{kj}) / a_{kk}\f$. The sum is
+ * \f$a_{kk} a_{ij}\f$, a product of two 64-bit values: it fits in 128 bits.
+ *
+ * @param[in, out] line The line, whose element in the pivot's column was not
+ * updated yet.
+ * @param[in] pivot_line The line of the pivot.
+ * @param[in] column The column of the pivot.
+ * @param[in] end The column of the element that overflowed.
+ * @param[in] previous_pivot The pivot of the previous step, 1 at the first.
+ */
+static void
+restore_line(int64_t *const line, const int64_t *const pivot_line,
+             const size_t column, const size_t end,
+             const int64_t previous_pivot)
+{
+	const int64_t factor = line[column];
+	for (size_t j = 0; j < end; j++) {
+		if (j != column) {
+			const wide_int product =
+			    (wide_int)previous_pivot * line[j] +
+			    (wide_int)factor * pivot_line[j];
+			line[j] = (int64_t)(product / pivot_line[column]);
+		}
+	}
+}
+
+/**
+ * @brief Performs a fraction-free Gauss-Jordan elimination on the matrix.
+ *
+ * At the step \f$k\f$, with \f$p\f$ the previous pivot (1 at the first
+ * step), every element of every line but the pivot's is replaced by
+ * \f$(a_{kk} a_{ij} - a_{ik} a_{kj}) / p\f$. The division is always exact.
+ *
+ * The matrix is modified in place. Once done, all the diagonal elements are
+ * equal (up to the order of the lines) to the determinant of the system. If
+ * an element does not fit in 64 bits, the elimination stops with the line
+ * it belongs to as it was before the step: every line is then a multiple of
+ * a combination of the lines of the system, and solves the same system.
+ *
+ * @param[in, out] matrix The integer matrix to manipulate.
+ * @param[out] error Where to describe why the system is singular, or NULL.
+ *
+ * @return BAREISS_DONE, BAREISS_SINGULAR or BAREISS_OVERFLOW.
+ */
+enum bareiss_status
+bareiss_elimination(integer_matrix *const matrix, char *const error)
+{
+	const size_t n_lines = matrix->n_lines;
+	const size_t n_col = matrix->n_col;
+	int64_t previous_pivot = 1;
+	for (size_t k = 0; k < n_lines; k++) {
+		size_t line_pivot = find_nonzero_in_column(matrix, k);
+		if (line_pivot == n_lines) {
+			report_error(error, "the system is singular");
+			return BAREISS_SINGULAR;
+		}
+		if (line_pivot > k) {
+			integer_matrix_swap_lines(matrix, k, line_pivot);
+		}
+
+		const int64_t *pivot_line = integer_matrix_line(matrix, k);
+		const int64_t pivot = pivot_line[k];
+		for (size_t i = 0; i < n_lines; i++) {
+			if (i == k) {
+				continue;
+			}
+			int64_t *line = integer_matrix_line(matrix, i);
+			const int64_t factor = line[k];
+			for (size_t j = 0; j < n_col; j++) {
+				if (j == k) {
+					continue;
+				}
+				wide_int product;
+				wide_int subtracted;
+				wide_int update;
+				const bool overflowed =
+				    __builtin_mul_overflow(pivot, line[j],
+				                           &product) ||
+				    __builtin_mul_overflow(factor, pivot_line[j],
+				                           &subtracted) ||
+				    __builtin_sub_overflow(product, subtracted,
+				                           &update);
+				if (!overflowed) {
+					update /= previous_pivot;
+				}
+				if (overflowed || update > INT64_MAX ||
+				    update < INT64_MIN) {
+					restore_line(line, pivot_line, k, j,
+					             previous_pivot);
+					return BAREISS_OVERFLOW;
+				}
+				line[j] = (int64_t)update;
+			}
+			line[k] = 0;
+		}
+		previous_pivot = pivot;
+	}
+	return BAREISS_DONE;
+}
+
+/**
+ * @brief Stores a quotient of 64-bit integers as a fraction, promoted if its
+ * terms do not fit in 32 bits.
+ *
+ * @param[in] numerator The numerator.
+ * @param[in] denominator The denominator, which is not 0.
+ * @param[in, out] table The storage of the promoted values.
+ * @param[out] value Where to store the fraction.
+ */
+static void
+store_quotient(const int64_t numerator, const int64_t denominator,
+               wide_table *const table, fraction *const value)
+{
+	if (fraction_from_quotient(numerator, denominator, value)) {
+		return;
+	}
+	uint64_t numerator_magnitude =
+	    numerator < 0 ? -(uint64_t)numerator : (uint64_t)numerator;
+	uint64_t denominator_magnitude =
+	    denominator < 0 ? -(uint64_t)denominator : (uint64_t)denominator;
+	big_fraction big;
+	big_fraction_init(&big);
+	big_fraction_set(&big, (numerator < 0) != (denominator < 0),
+	                 numerator_magnitude, denominator_magnitude);
+	*value = (fraction){0, 0, 1};
+	tiered_set_big(table, value, &big);
+	big_fraction_free(&big);
+}
+
+/**
+ * @brief Copies an integer matrix whose elimination overflowed into a matrix
+ * of fractions, for the fraction engine to eliminate it.
+ *
+ * @param[in] integers The matrix, as left by bareiss_elimination().
+ * @param[in, out] fractions The matrix of fractions, of the same size.
+ */
+void
+bareiss_to_fractions(const integer_matrix *const integers,
+                     matrix *const fractions)
+{
+	for (size_t i = 0; i < integers->n_lines; i++) {
+		const int64_t *values = integer_matrix_line(integers, i);
+		fraction *line = matrix_line(fractions, i);
+		for (size_t j = 0; j < integers->n_col; j++) {
+			store_quotient(values[j], 1, &fractions->wide,
+			               &line[j]);
+		}
+	}
+}
+
+/**
+ * @brief Gives the value of a variable after a fraction-free elimination.
+ *
+ * The value is promoted if its terms do not fit in 32 bits.
+ *
+ * @param[in] matrix The matrix, as left by bareiss_elimination().
+ * @param[in] line The index of the variable (and of its line).
+ * @param[in, out] table The storage of the promoted values.
+ * @param[out] value Where to store the value of the variable.
+ *
+ * @return Whether the line had a pivot.
+ */
+bool
+bareiss_solution(const integer_matrix *const matrix, const size_t line,
+                 wide_table *const table, fraction *const value)
+{
+	const int64_t *values = integer_matrix_line(matrix, line);
+	const int64_t numerator = values[matrix->n_col - 1];
+	const int64_t denominator = values[line];
+	if (denominator == 0) {
+		return false;
+	}
+	store_quotient(numerator, denominator, table, value);
+	return true;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file bareiss.h
+ * @brief Function prototypes for bareiss.c
+ * @see bareiss.c
+ */
+
+#ifndef BAREISS_H
+#define BAREISS_H
+
+#include "fractions.h"
+#include "matrix.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The outcomes of a fraction-free elimination.
+ */
+enum bareiss_status {
+	/** The matrix is diagonal */
+	BAREISS_DONE,
+	/** The system is singular */
+	BAREISS_SINGULAR,
+	/** An element does not fit in 64 bits: the matrix is left equivalent
+	 * to the system */
+	BAREISS_OVERFLOW,
+};
+
+enum bareiss_status bareiss_elimination(integer_matrix *const, char *const);
+void bareiss_to_fractions(const integer_matrix *const, matrix *const);
+bool bareiss_solution(const integer_matrix *const, const size_t,
+                      wide_table *const, fraction *const);
+
+#endif /* BAREISS_H */
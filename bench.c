@@ -0,0 +1,684 @@
+/**
+ * @file bench.c
+ * @brief Measures the speed of the engines on generated systems.
+ *
+ * The systems are generated from a seed, so that every run solves the same
+ * ones: random dense systems, sparse ones, ill-conditioned ones whose lines are
+ * all close to each other, systems built from a known integer solution, and
+ * unimodular ones whose elimination stays in small integers. Each system is
+ * solved in a process of its own, whose peak memory is then its own, and the
+ * time of each phase is printed as a line of JSON: parsing the text,
+ * eliminating, reading the solution off the eliminated matrix, and printing it.
+ *
+ * The same generator writes the systems as text with `--generate`, to feed
+ * them to the program itself.
+ *
+ * @see lineqsolve.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "solver.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief The smallest number of unknowns benchmarked. */
+#define MIN_SIZE 2
+/** @brief The greatest number of unknowns benchmarked. */
+#define MAX_SIZE 2048
+/** @brief The seed of the systems when none is given. */
+#define DEFAULT_SEED 1
+
+/**
+ * @brief The kinds of systems the generator makes.
+ */
+enum system_kind {
+	/** Random coefficients of up to 1000 */
+	KIND_DENSE,
+	/** A few coefficients per line around a dominant diagonal */
+	KIND_SPARSE,
+	/** Lines that all differ from a common line by a few units */
+	KIND_ILL_CONDITIONED,
+	/** Random coefficients, with constants given by a known solution */
+	KIND_KNOWN,
+	/** The product of unit lower and upper triangular matrices of small
+	 * integers, with a known solution: eliminated in order, its values
+	 * stay small integers */
+	KIND_UNIMODULAR,
+};
+
+/** @brief The number of kinds of systems. */
+#define N_KINDS 5
+/** @brief The number of engines, counting the Gauss-Jordan elimination as
+ * one. */
+#define N_ENGINES 5
+/** @brief The index of the Gauss-Jordan elimination among the engines. */
+#define GAUSS_JORDAN 4
+
+/** @brief The names of the kinds of systems, as printed. */
+static const char *const kind_names[N_KINDS] = {"dense", "sparse", "ill",
+                                                "known", "unimodular"};
+
+/** @brief The names of the engines, as printed. */
+static const char *const engine_names[N_ENGINES] = {
+    "fraction", "bareiss", "modular", "float", "gauss-jordan"};
+
+/** @brief The engine of the solver of each engine benchmarked. */
+static const enum solver_engine solver_engines[N_ENGINES] = {
+    ENGINE_FRACTION, ENGINE_BAREISS, ENGINE_MODULAR, ENGINE_FLOAT,
+    ENGINE_FRACTION};
+
+/**
+ * @brief The greatest number of unknowns of each engine on each kind of
+ * system, by default.
+ *
+ * The exact engines slow down as the terms grow with the elimination, the
+ * bounds keep a run of the whole suite within minutes.
+ */
+static const size_t default_sizes[N_ENGINES][N_KINDS] = {
+    /* dense, sparse, ill-conditioned, known, unimodular */
+    {32, 256, 32, 32, 32},
+    {16, 16, 16, 16, 16},
+    {64, 128, 64, 128, 128},
+    {2048, 2048, 2048, 2048, 2048},
+    {32, 256, 32, 32, 32},
+};
+
+/**
+ * @brief The generator of the coefficients of a system.
+ */
+struct generator {
+	/** The state of the xorshift generator */
+	uint64_t state;
+};
+
+/**
+ * @brief Gives a pseudo-random number.
+ *
+ * @param[in, out] g The generator.
+ *
+ * @return A pseudo-random 32-bit number.
+ */
+static uint32_t
+next_random(struct generator *const g)
+{
+	g->state ^= g->state << 13;
+	g->state ^= g->state >> 7;
+	g->state ^= g->state << 17;
+	return (uint32_t)(g->state >> 32);
+}
+
+/**
+ * @brief Gives a pseudo-random integer in a range.
+ *
+ * @param[in, out] g The generator.
+ * @param[in] bound The bound of the range, at most 2^31 - 1.
+ *
+ * @return An integer between -bound and bound, both included.
+ */
+static int64_t
+random_between(struct generator *const g, const int64_t bound)
+{
+	return (int64_t)(next_random(g) % (uint32_t)(2 * bound + 1)) - bound;
+}
+
+/**
+ * @brief Generates the coefficients of a system of kind KIND_UNIMODULAR.
+ *
+ * The factors L and U, with coefficients of -1, 0 or 1 and a diagonal of
+ * ones, are drawn into the matrix, then replaced with their product line by
+ * line, from the last one: a line of the product only depends on the lines
+ * of U above it. Each coefficient is then at most n in magnitude, and so
+ * are those of the lines being eliminated.
+ *
+ * @param[in, out] g The generator.
+ * @param[in] n The number of unknowns.
+ * @param[out] coefficients The \f$n\times(n+1)\f$ coefficients, line after
+ * line.
+ * @param[in] solution The solution of the system, n values.
+ */
+static void
+generate_unimodular(struct generator *const g, const size_t n,
+                    int64_t *const coefficients, const int64_t *const solution)
+{
+	const size_t n_col = n + 1;
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) {
+			coefficients[i * n_col + j] =
+			    i == j ? 1 : random_between(g, 1);
+		}
+	}
+	/* The product line is gathered in the column of the constants */
+	int64_t *product = coefficients + n;
+	for (size_t i = n; i-- > 0;) {
+		const int64_t *l = coefficients + i * n_col;
+		for (size_t j = 0; j < n; j++) {
+			product[j * n_col] = 0;
+		}
+		for (size_t k = 0; k <= i; k++) {
+			const int64_t *u = coefficients + k * n_col;
+			const int64_t factor = k == i ? 1 : l[k];
+			if (factor == 0) {
+				continue;
+			}
+			product[k * n_col] += factor;
+			for (size_t j = k + 1; j < n; j++) {
+				product[j * n_col] += factor * u[j];
+			}
+		}
+		for (size_t j = 0; j < n; j++) {
+			coefficients[i * n_col + j] = product[j * n_col];
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		int64_t *line = coefficients + i * n_col;
+		line[n] = 0;
+		for (size_t j = 0; j < n; j++) {
+			line[n] += line[j] * solution[j];
+		}
+	}
+}
+
+/**
+ * @brief Generates the augmented matrix of a system.
+ *
+ * @param[in] kind The kind of system.
+ * @param[in] n The number of unknowns.
+ * @param[in] seed The seed of the generator.
+ * @param[out] coefficients The \f$n\times(n+1)\f$ coefficients, line after
+ * line.
+ * @param[out] solution The solution of a system of kind KIND_KNOWN or
+ * KIND_UNIMODULAR, n values, or NULL.
+ */
+static void
+generate_system(const enum system_kind kind, const size_t n,
+                const uint64_t seed, int64_t *const coefficients,
+                int64_t *const solution)
+{
+	/* The state of a xorshift generator must not be zero */
+	struct generator g = {seed * 0x9E3779B97F4A7C15u + 1};
+	const size_t n_col = n + 1;
+	int64_t *common = NULL;
+	if (kind == KIND_ILL_CONDITIONED) {
+		common = coefficients + (n - 1) * n_col;
+		for (size_t j = 0; j < n_col; j++) {
+			common[j] = random_between(&g, 100000);
+		}
+	}
+	if (kind == KIND_KNOWN || kind == KIND_UNIMODULAR) {
+		for (size_t j = 0; j < n; j++) {
+			solution[j] = random_between(&g, 9);
+		}
+	}
+	if (kind == KIND_UNIMODULAR) {
+		generate_unimodular(&g, n, coefficients, solution);
+		return;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		int64_t *line = coefficients + i * n_col;
+		switch (kind) {
+		case KIND_DENSE:
+			for (size_t j = 0; j < n_col; j++) {
+				line[j] = random_between(&g, 1000);
+			}
+			break;
+		case KIND_SPARSE:
+			/* Dominant, the diagonal keeps the system regular */
+			memset(line, 0, n_col * sizeof(int64_t));
+			for (size_t k = 0; k < 3; k++) {
+				const size_t j = next_random(&g) % n;
+				line[j] += random_between(&g, 3);
+			}
+			line[i] = 10 + next_random(&g) % 10;
+			line[n] = random_between(&g, 1000);
+			break;
+		case KIND_ILL_CONDITIONED:
+			/* The common line is the last one, written last */
+			for (size_t j = 0; j < n_col; j++) {
+				line[j] = common[j] + random_between(&g, 2);
+			}
+			break;
+		case KIND_KNOWN:
+			line[n] = 0;
+			for (size_t j = 0; j < n; j++) {
+				line[j] = random_between(&g, 100);
+				line[n] += line[j] * solution[j];
+			}
+			break;
+		case KIND_UNIMODULAR:
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Writes a system as text, in the format of the program.
+ *
+ * @param[in] output The file to write.
+ * @param[in] coefficients The augmented matrix of the system.
+ * @param[in] n The number of unknowns.
+ */
+static void
+write_system(FILE *const output, const int64_t *const coefficients,
+             const size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j <= n; j++) {
+			fprintf(output, j == 0 ? "%" PRId64 : " %" PRId64,
+			        coefficients[i * (n + 1) + j]);
+		}
+		fputc('\n', output);
+	}
+}
+
+/**
+ * @brief Gives the time elapsed since an instant, in seconds.
+ *
+ * @param[in, out] start The instant to measure from, set to the current
+ * instant.
+ *
+ * @return The number of seconds elapsed.
+ */
+static double
+lap(struct timespec *const start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	const double elapsed = (double)(end.tv_sec - start->tv_sec) +
+	                       (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+	*start = end;
+	return elapsed;
+}
+
+/**
+ * @brief Gives the largest residual of an approximate solution.
+ *
+ * @param[in] coefficients The augmented matrix of the system.
+ * @param[in] n The number of unknowns.
+ * @param[in] x The approximate solution.
+ *
+ * @return The largest difference between a constant and its line applied to
+ * the solution.
+ */
+static double
+largest_residual(const int64_t *const coefficients, const size_t n,
+                 const double *const x)
+{
+	double largest = 0;
+	for (size_t i = 0; i < n; i++) {
+		const int64_t *line = coefficients + i * (n + 1);
+		double residual = (double)line[n];
+		for (size_t j = 0; j < n; j++) {
+			residual -= (double)line[j] * x[j];
+		}
+		if (residual < 0) {
+			residual = -residual;
+		}
+		if (residual > largest) {
+			largest = residual;
+		}
+	}
+	return largest;
+}
+
+/**
+ * @brief Generates a system, solves it, and prints the measures as a line
+ * of JSON.
+ *
+ * Meant to run in a process of its own: the peak memory reported is the
+ * process'.
+ *
+ * @param[in] engine The index of the engine to solve the system with.
+ * @param[in] kind The kind of system.
+ * @param[in] n The number of unknowns.
+ * @param[in] seed The seed of the generator.
+ * @param[in] pivoting How the fraction engine chooses its pivots.
+ * @param[in] block_size The number of pivots the fraction engine eliminates
+ * together.
+ * @param[in] threads The number of threads of the solver.
+ *
+ * @return Whether the system could be generated, whether it was solved or
+ * not.
+ */
+static bool
+bench_system(const size_t engine, const enum system_kind kind,
+             const size_t n, const uint64_t seed,
+             const enum solver_pivoting pivoting, const size_t block_size,
+             const size_t threads)
+{
+	int64_t *coefficients = malloc(n * (n + 1) * sizeof(int64_t));
+	int64_t *expected = malloc(n * sizeof(int64_t));
+	char *text = NULL;
+	size_t length = 0;
+	FILE *buffer = open_memstream(&text, &length);
+	FILE *sink = fopen("/dev/null", "w");
+	solver *s = solver_create(solver_engines[engine], threads);
+	if (coefficients == NULL || expected == NULL || buffer == NULL ||
+	    sink == NULL || s == NULL) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		return false;
+	}
+	solver_set_gauss_jordan(s, engine == GAUSS_JORDAN);
+	solver_set_pivoting(s, pivoting);
+	solver_set_block_size(s, block_size);
+	generate_system(kind, n, seed, coefficients, expected);
+	write_system(buffer, coefficients, n);
+	fclose(buffer);
+
+	/* The diagnostics of the engines would drown the measures */
+	fflush(stderr);
+	if (freopen("/dev/null", "w", stderr) == NULL) {
+		return false;
+	}
+	double parse = 0;
+	double eliminate = 0;
+	double substitute = 0;
+	double print = 0;
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	enum solver_status status = solver_load_text(s, text, length);
+	parse = lap(&start);
+	/* The eliminated matrix would look sparse */
+	const bool sparse = status == SOLVER_OK && solver_uses_sparse(s);
+	if (status == SOLVER_OK) {
+		/* Only the work of the solve is counted */
+		stats_stop();
+		status = solver_eliminate(s);
+		eliminate = lap(&start);
+	}
+	if (status == SOLVER_OK) {
+		status = solver_substitute(s);
+		substitute = lap(&start);
+	}
+	if (status == SOLVER_OK) {
+		for (size_t i = 0; i < n; i++) {
+			solver_fprint_value(sink, s, i);
+			fputc('\n', sink);
+		}
+		fflush(sink);
+		print = lap(&start);
+	}
+
+	const double total = parse + eliminate + substitute + print;
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	printf("{\"engine\": \"%s\", \"kind\": \"%s\", \"n\": %zu, "
+	       "\"seed\": %" PRIu64 ", \"threads\": %zu, "
+	       "\"status\": \"%s\", ",
+	       engine_names[engine], kind_names[kind], n, seed, threads,
+	       solver_status_string(status));
+	printf("\"parse_s\": %.6f, \"eliminate_s\": %.6f, "
+	       "\"substitute_s\": %.6f, \"print_s\": %.6f, \"total_s\": %.6f, ",
+	       parse, eliminate, substitute, print, total);
+	printf("\"coefficients_per_s\": %.0f, \"peak_rss_kib\": %ld",
+	       total > 0 ? (double)(n * (n + 1)) / total : 0.0,
+	       usage.ru_maxrss);
+	if (solver_engines[engine] == ENGINE_FRACTION) {
+		const wide_table *table =
+		    sparse ? &s->sparse.wide : &s->matrix.wide;
+		printf(", \"pivot\": \"%s\", \"block\": %zu, "
+		       "\"promotions_64\": %zu, \"promotions_big\": %zu",
+		       solver_pivoting_string(pivoting), block_size,
+		       table->promotions_to_64, table->promotions_to_big);
+	}
+	if (STATS_COMPILED) {
+		printf(", \"gcd_calls\": %" PRIu64
+		       ", \"gcd_iterations\": %" PRIu64
+		       ", \"subtract_overflows\": %" PRIu64,
+		       solve_stats.gcd_calls, solve_stats.gcd_iterations,
+		       solve_stats.subtract_overflows);
+	}
+	if (status == SOLVER_OK) {
+		const double *x = solver_approximations(s);
+		printf(", \"residual\": %.3g",
+		       largest_residual(coefficients, n, x));
+		if (kind == KIND_KNOWN || kind == KIND_UNIMODULAR) {
+			double error = 0;
+			for (size_t i = 0; i < n; i++) {
+				double d = x[i] - (double)expected[i];
+				d = d < 0 ? -d : d;
+				error = d > error ? d : error;
+			}
+			printf(", \"error\": %.3g", error);
+		}
+	}
+	printf("}\n");
+
+	solver_destroy(s);
+	fclose(sink);
+	free(text);
+	free(expected);
+	free(coefficients);
+	return true;
+}
+
+/**
+ * @brief Runs bench_system() in a child process.
+ *
+ * @param[in] engine The index of the engine to solve the system with.
+ * @param[in] kind The kind of system.
+ * @param[in] n The number of unknowns.
+ * @param[in] seed The seed of the generator.
+ * @param[in] pivoting How the fraction engine chooses its pivots.
+ * @param[in] block_size The number of pivots the fraction engine eliminates
+ * together.
+ * @param[in] threads The number of threads of the solver.
+ *
+ * @return Whether the child ran to completion.
+ */
+static bool
+bench_in_child(const size_t engine, const enum system_kind kind,
+               const size_t n, const uint64_t seed,
+               const enum solver_pivoting pivoting, const size_t block_size,
+               const size_t threads)
+{
+	/* What is buffered would be printed by both processes */
+	fflush(stdout);
+	const pid_t child = fork();
+	if (child < 0) {
+		fprintf(stderr, "ERROR: the benchmark could not be started.\n");
+		return false;
+	}
+	if (child == 0) {
+		const bool ran = bench_system(engine, kind, n, seed, pivoting,
+		                              block_size, threads);
+		fflush(stdout);
+		_exit(ran ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	int status = 0;
+	if (waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+	    WEXITSTATUS(status) != EXIT_SUCCESS) {
+		fprintf(stderr, "ERROR: the benchmark of %s on a %s system of "
+		                "%zu unknowns failed.\n",
+		        engine_names[engine], kind_names[kind], n);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Finds a name in a list of names.
+ *
+ * @param[in] name The name to find.
+ * @param[in] names The list.
+ * @param[in] count The number of names of the list.
+ *
+ * @return The index of the name, or count if it is not in the list.
+ */
+static size_t
+find_name(const char *const name, const char *const *const names,
+          const size_t count)
+{
+	size_t i = 0;
+	while (i < count && strcmp(name, names[i]) != 0) {
+		i++;
+	}
+	return i;
+}
+
+/**
+ * @brief Reads a positive number given as an argument.
+ *
+ * @param[in] text The argument, or NULL if it is missing.
+ * @param[in] option The option the number belongs to.
+ *
+ * @return The number. The program exits if it is not valid.
+ */
+static unsigned long
+read_number(const char *const text, const char *const option)
+{
+	char *end = NULL;
+	const unsigned long value = text != NULL ? strtoul(text, &end, 10) : 0;
+	if (end == NULL || *end != '\0' || value == 0) {
+		fprintf(stderr, "ERROR: %s expects a positive number.\n",
+		        option);
+		exit(EXIT_FAILURE);
+	}
+	return value;
+}
+
+/**
+ * @brief Writes a generated system to the standard output.
+ *
+ * @param[in] kind The kind of system, N_KINDS if it is not valid.
+ * @param[in] n The number of unknowns.
+ * @param[in] seed The seed of the generator.
+ *
+ * @return Whether the system was written. An error is printed if not.
+ */
+static bool
+generate(const size_t kind, const size_t n, const uint64_t seed)
+{
+	int64_t *coefficients =
+	    n <= MAX_SIZE ? malloc(n * (n + 1) * sizeof(int64_t)) : NULL;
+	int64_t *solution = n <= MAX_SIZE ? malloc(n * sizeof(int64_t)) : NULL;
+	const bool valid =
+	    kind != N_KINDS && coefficients != NULL && solution != NULL;
+	if (valid) {
+		generate_system(kind, n, seed, coefficients, solution);
+		write_system(stdout, coefficients, n);
+	} else {
+		fprintf(stderr,
+		        "ERROR: --generate expects a kind and at most %d "
+		        "unknowns.\n",
+		        MAX_SIZE);
+	}
+	free(coefficients);
+	free(solution);
+	return valid;
+}
+
+/**
+ * @brief The entry point of the benchmarks.
+ *
+ * Without arguments, every engine is run on every kind of system, from 2 to
+ * its default number of unknowns, doubling each time. `--engine` and
+ * `--kind` restrict the suite to an engine or to a kind of system,
+ * `--min-size` and `--max-size` override the least and the greatest number
+ * of unknowns, `--seed` changes the systems, and `--pivot` and `--block`
+ * the pivoting and the blocks of the fraction engine, and `--threads` the
+ * number of threads of the solver, one by default. With
+ * `--generate`, followed by a kind and a number of unknowns, the system is
+ * written to the standard output instead.
+ *
+ * @param[in] argc The number of arguments supplied to the program.
+ * @param[in] argv The array containing the arguments.
+ *
+ * @return The ending status of the program.
+ */
+int
+main(const int argc, const char *const argv[])
+{
+	size_t engine_filter = N_ENGINES;
+	size_t kind_filter = N_KINDS;
+	size_t min_size = MIN_SIZE;
+	size_t max_size = 0;
+	uint64_t seed = DEFAULT_SEED;
+	enum solver_pivoting pivoting = PIVOTING_GREATEST;
+	size_t block_size = 0;
+	size_t threads = 1;
+	size_t generated_kind = N_KINDS;
+	size_t generated_size = 0;
+	for (int arg = 1; arg < argc; arg++) {
+		const char *value = arg + 1 < argc ? argv[arg + 1] : "";
+		if (strcmp(argv[arg], "--engine") == 0) {
+			engine_filter =
+			    find_name(value, engine_names, N_ENGINES);
+			if (engine_filter == N_ENGINES) {
+				fprintf(stderr, "ERROR: unknown engine %s.\n",
+				        value);
+				return EXIT_FAILURE;
+			}
+			arg++;
+		} else if (strcmp(argv[arg], "--kind") == 0) {
+			kind_filter = find_name(value, kind_names, N_KINDS);
+			if (kind_filter == N_KINDS) {
+				fprintf(stderr, "ERROR: unknown kind %s.\n",
+				        value);
+				return EXIT_FAILURE;
+			}
+			arg++;
+		} else if (strcmp(argv[arg], "--min-size") == 0) {
+			min_size = read_number(argv[++arg], "--min-size");
+		} else if (strcmp(argv[arg], "--max-size") == 0) {
+			max_size = read_number(argv[++arg], "--max-size");
+		} else if (strcmp(argv[arg], "--seed") == 0) {
+			seed = read_number(argv[++arg], "--seed");
+		} else if (strcmp(argv[arg], "--pivot") == 0) {
+			if (!solver_parse_pivoting(value, &pivoting)) {
+				fprintf(stderr, "ERROR: unknown pivoting %s.\n",
+				        value);
+				return EXIT_FAILURE;
+			}
+			arg++;
+		} else if (strcmp(argv[arg], "--block") == 0) {
+			block_size = read_number(argv[++arg], "--block");
+		} else if (strcmp(argv[arg], "--threads") == 0) {
+			threads = read_number(argv[++arg], "--threads");
+		} else if (strcmp(argv[arg], "--generate") == 0 &&
+		           arg + 2 < argc) {
+			generated_kind =
+			    find_name(argv[++arg], kind_names, N_KINDS);
+			generated_size = read_number(argv[++arg], "--generate");
+		} else {
+			fprintf(stderr, "ERROR: unknown option %s.\n",
+			        argv[arg]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (generated_size != 0) {
+		return generate(generated_kind, generated_size, seed)
+		           ? EXIT_SUCCESS
+		           : EXIT_FAILURE;
+	}
+
+	bool all_ran = true;
+	for (size_t engine = 0; engine < N_ENGINES; engine++) {
+		for (size_t kind = 0; kind < N_KINDS; kind++) {
+			if ((engine_filter != N_ENGINES &&
+			     engine != engine_filter) ||
+			    (kind_filter != N_KINDS && kind != kind_filter)) {
+				continue;
+			}
+			const size_t greatest =
+			    max_size != 0 ? max_size
+			                  : default_sizes[engine][kind];
+			for (size_t n = min_size;
+			     n <= greatest && n <= MAX_SIZE; n *= 2) {
+				all_ran &= bench_in_child(engine, kind, n, seed,
+				                          pivoting, block_size,
+				                          threads);
+			}
+		}
+	}
+	return all_ran ? EXIT_SUCCESS : EXIT_FAILURE;
+}
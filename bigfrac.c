@@ -0,0 +1,990 @@
+/**
+ * @file bigfrac.c
+ * @brief Arbitrary-precision integers and fractions.
+ *
+ * These are the last resort of the solver, used for the values that do not
+ * fit in 64-bit fractions. They are slow but never overflow: their memory is
+ * grown as needed. The functions that allocate it tell whether they could:
+ * if not, their results are left with unspecified values, that can still be
+ * overwritten or freed.
+ *
+ * The integers are unsigned, the fractions store their sign separately, like
+ * @ref fraction does. The results of the operations may alias their inputs.
+ *
+ * @see bigfrac.h
+ */
+
+#include "bigfrac.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief The base of the limbs, as a floating-point number. */
+#define LIMB_BASE 4294967296.0
+
+/* -- Helper functions -- */
+
+/**
+ * @brief Makes sure a big integer can hold a number of limbs.
+ *
+ * @param[in, out] n The integer to grow.
+ * @param[in] capacity The number of limbs needed.
+ *
+ * @return Whether the memory could be allocated. If not, the integer is left
+ * unchanged.
+ */
+static bool
+reserve(big_integer *const n, const size_t capacity)
+{
+	if (capacity <= n->capacity) {
+		return true;
+	}
+	uint32_t *limbs = realloc(n->limbs, capacity * sizeof(uint32_t));
+	if (limbs == NULL) {
+		return false;
+	}
+	n->limbs = limbs;
+	n->capacity = capacity;
+	return true;
+}
+
+/**
+ * @brief Removes the leading zero limbs of a big integer.
+ *
+ * @param[in, out] n The integer to normalise.
+ */
+static void
+trim(big_integer *const n)
+{
+	while (n->length > 0 && n->limbs[n->length - 1] == 0) {
+		n->length--;
+	}
+}
+
+/**
+ * @brief Moves a temporary result into its destination.
+ *
+ * The previous value of the destination is freed.
+ *
+ * @param[in, out] destination The integer to overwrite.
+ * @param[in] result The value to move. It must not be used afterwards.
+ */
+static void
+replace(big_integer *const destination, big_integer *const result)
+{
+	big_integer_free(destination);
+	*destination = *result;
+}
+
+/**
+ * @brief Divides a big integer by a single limb.
+ *
+ * No memory is allocated when the quotient is NULL or the dividend itself.
+ *
+ * @param[out] quotient Where to store the quotient, or NULL.
+ * @param[out] remainder Where to store the remainder of the division.
+ * @param[in] dividend The integer to divide.
+ * @param[in] divisor The (non-zero) limb to divide by.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_divide_limb(big_integer *const quotient,
+                        uint32_t *const remainder,
+                        const big_integer *const dividend,
+                        const uint32_t divisor)
+{
+	const size_t length = dividend->length;
+	if (quotient != NULL && !reserve(quotient, length)) {
+		return false;
+	}
+	uint64_t rest = 0;
+	for (size_t i = length; i-- > 0;) {
+		uint64_t current = (rest << 32) | dividend->limbs[i];
+		if (quotient != NULL) {
+			quotient->limbs[i] = (uint32_t)(current / divisor);
+		}
+		rest = current % divisor;
+	}
+	if (quotient != NULL) {
+		quotient->length = length;
+		trim(quotient);
+	}
+	*remainder = (uint32_t)rest;
+	return true;
+}
+
+/**
+ * @brief Divides a big integer by another one of at least two limbs.
+ *
+ * This is Knuth's algorithm D, as described in _Hacker's Delight_. The
+ * dividend must not be smaller than the divisor.
+ *
+ * @param[out] quotient Where to store the quotient, or NULL.
+ * @param[out] remainder Where to store the remainder, or NULL.
+ * @param[in] dividend The integer to divide.
+ * @param[in] divisor The integer to divide by.
+ *
+ * @return Whether the memory could be allocated. If not, the outputs are
+ * left unchanged.
+ */
+static bool
+divide_long(big_integer *const quotient, big_integer *const remainder,
+            const big_integer *const dividend, const big_integer *const divisor)
+{
+	const size_t m = dividend->length;
+	const size_t n = divisor->length;
+	const uint32_t *u = dividend->limbs;
+	const uint32_t *v = divisor->limbs;
+
+	uint32_t *vn = malloc(n * sizeof(uint32_t));
+	uint32_t *un = malloc((m + 1) * sizeof(uint32_t));
+	big_integer q;
+	big_integer r;
+	big_integer_init(&q);
+	big_integer_init(&r);
+	if (vn == NULL || un == NULL || !reserve(&q, m - n + 1) ||
+	    !reserve(&r, n)) {
+		free(vn);
+		free(un);
+		big_integer_free(&q);
+		big_integer_free(&r);
+		return false;
+	}
+
+	/* Normalise, so that the divisor's top bit is set */
+	const int s = __builtin_clz(v[n - 1]);
+	for (size_t i = n - 1; i > 0; i--) {
+		vn[i] = (v[i] << s) | (uint32_t)((uint64_t)v[i - 1] >> (32 - s));
+	}
+	vn[0] = v[0] << s;
+	un[m] = (uint32_t)((uint64_t)u[m - 1] >> (32 - s));
+	for (size_t i = m - 1; i > 0; i--) {
+		un[i] = (u[i] << s) | (uint32_t)((uint64_t)u[i - 1] >> (32 - s));
+	}
+	un[0] = u[0] << s;
+
+	for (size_t j = m - n + 1; j-- > 0;) {
+		/* Estimate the quotient's digit */
+		uint64_t numerator = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+		uint64_t qhat = numerator / vn[n - 1];
+		uint64_t rhat = numerator - qhat * vn[n - 1];
+		while (qhat > UINT32_MAX ||
+		       qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+			qhat--;
+			rhat += vn[n - 1];
+			if (rhat > UINT32_MAX) {
+				break;
+			}
+		}
+
+		/* Multiply and subtract */
+		int64_t k = 0;
+		int64_t t = 0;
+		for (size_t i = 0; i < n; i++) {
+			uint64_t p = qhat * vn[i];
+			t = (int64_t)un[i + j] - k - (int64_t)(p & UINT32_MAX);
+			un[i + j] = (uint32_t)t;
+			k = (int64_t)(p >> 32) - (t >> 32);
+		}
+		t = (int64_t)un[j + n] - k;
+		un[j + n] = (uint32_t)t;
+
+		q.limbs[j] = (uint32_t)qhat;
+		if (t < 0) {
+			/* The estimate was one too big, add back */
+			q.limbs[j]--;
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++) {
+				uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+				un[i + j] = (uint32_t)sum;
+				carry = sum >> 32;
+			}
+			un[j + n] += (uint32_t)carry;
+		}
+	}
+	q.length = m - n + 1;
+	trim(&q);
+
+	if (remainder != NULL) {
+		for (size_t i = 0; i < n; i++) {
+			r.limbs[i] = (un[i] >> s) |
+			             (uint32_t)((uint64_t)un[i + 1] << (32 - s));
+		}
+		r.length = n;
+		trim(&r);
+		replace(remainder, &r);
+	} else {
+		big_integer_free(&r);
+	}
+	if (quotient != NULL) {
+		replace(quotient, &q);
+	} else {
+		big_integer_free(&q);
+	}
+	free(vn);
+	free(un);
+	return true;
+}
+
+/**
+ * @brief Gives an approximation of a big integer as a mantissa and exponent.
+ *
+ * @param[in] n The integer to approximate.
+ * @param[out] exponent The power of \f$2^{32}\f$ to multiply the mantissa by.
+ *
+ * @return The mantissa.
+ */
+static double
+approximate(const big_integer *const n, long *const exponent)
+{
+	double mantissa = 0;
+	size_t used = n->length < 3 ? n->length : 3;
+	for (size_t i = 0; i < used; i++) {
+		mantissa = mantissa * LIMB_BASE + n->limbs[n->length - 1 - i];
+	}
+	*exponent = (long)(n->length - used);
+	return mantissa;
+}
+
+/* -- Integer functions -- */
+
+/**
+ * @brief Initialises a big integer to zero.
+ *
+ * @param[out] n The integer to initialise.
+ */
+void
+big_integer_init(big_integer *const n)
+{
+	n->limbs = NULL;
+	n->length = 0;
+	n->capacity = 0;
+}
+
+/**
+ * @brief Releases the memory held by a big integer.
+ *
+ * The integer is left equal to zero, and can be reused.
+ *
+ * @param[in, out] n The integer to free.
+ */
+void
+big_integer_free(big_integer *const n)
+{
+	free(n->limbs);
+	big_integer_init(n);
+}
+
+/**
+ * @brief Sets the value of a big integer.
+ *
+ * @param[out] n The integer to set.
+ * @param[in] value The value to give it.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_set_u64(big_integer *const n, uint64_t value)
+{
+	if (!reserve(n, 2)) {
+		return false;
+	}
+	n->limbs[0] = (uint32_t)value;
+	n->limbs[1] = (uint32_t)(value >> 32);
+	n->length = 2;
+	trim(n);
+	return true;
+}
+
+/**
+ * @brief Copies a big integer.
+ *
+ * @param[out] destination The integer to overwrite.
+ * @param[in] source The integer to copy.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_copy(big_integer *const destination,
+                 const big_integer *const source)
+{
+	if (destination == source) {
+		return true;
+	}
+	if (!reserve(destination, source->length)) {
+		return false;
+	}
+	if (source->length > 0) {
+		memcpy(destination->limbs, source->limbs,
+		       source->length * sizeof(uint32_t));
+	}
+	destination->length = source->length;
+	return true;
+}
+
+/**
+ * @brief Sets a big integer from its limbs.
+ *
+ * @param[out] n The integer to overwrite.
+ * @param[in] limbs The digits of the integer, in base 2^32, least
+ * significant first. Leading zero limbs are allowed.
+ * @param[in] length The number of limbs.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_set_limbs(big_integer *const n, const uint32_t *const limbs,
+                      const size_t length)
+{
+	if (!reserve(n, length)) {
+		return false;
+	}
+	if (length > 0) {
+		memcpy(n->limbs, limbs, length * sizeof(uint32_t));
+	}
+	n->length = length;
+	trim(n);
+	return true;
+}
+
+/**
+ * @brief Converts a big integer to a 64-bit integer.
+ *
+ * @param[in] n The integer to convert.
+ * @param[out] value Where to store the value.
+ *
+ * @return Whether the integer fits in 64 bits. If not, *value is not
+ * modified.
+ */
+bool
+big_integer_to_u64(const big_integer *const n, uint64_t *const value)
+{
+	if (n->length > 2) {
+		return false;
+	}
+	uint64_t result = 0;
+	for (size_t i = n->length; i-- > 0;) {
+		result = (result << 32) | n->limbs[i];
+	}
+	*value = result;
+	return true;
+}
+
+/**
+ * @brief Gives the number of bits of a big integer.
+ *
+ * @param[in] n The integer.
+ *
+ * @return The position of its most significant bit plus one, 0 for zero.
+ */
+size_t
+big_integer_bits(const big_integer *const n)
+{
+	if (n->length == 0) {
+		return 0;
+	}
+	return (n->length - 1) * 32 +
+	       (size_t)(32 - __builtin_clz(n->limbs[n->length - 1]));
+}
+
+/**
+ * @brief Compares two big integers.
+ *
+ * @see compare_fractions
+ *
+ * @param[in] a The first integer to compare.
+ * @param[in] b The second integer to compare.
+ *
+ * @return -1, 0, or 1 if `a` is respectively less, equal or greater than `b`.
+ */
+int
+big_integer_compare(const big_integer *const a, const big_integer *const b)
+{
+	if (a->length != b->length) {
+		return a->length < b->length ? -1 : 1;
+	}
+	for (size_t i = a->length; i-- > 0;) {
+		if (a->limbs[i] != b->limbs[i]) {
+			return a->limbs[i] < b->limbs[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Adds two big integers.
+ *
+ * @param[out] result Where to store the sum.
+ * @param[in] a The first term of the sum.
+ * @param[in] b The second term of the sum.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_add(big_integer *const result, const big_integer *const a,
+                const big_integer *const b)
+{
+	const big_integer *longest = a->length >= b->length ? a : b;
+	const big_integer *shortest = a->length >= b->length ? b : a;
+	big_integer sum;
+	big_integer_init(&sum);
+	if (!reserve(&sum, longest->length + 1)) {
+		return false;
+	}
+	uint64_t carry = 0;
+	for (size_t i = 0; i < longest->length; i++) {
+		carry += longest->limbs[i];
+		if (i < shortest->length) {
+			carry += shortest->limbs[i];
+		}
+		sum.limbs[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	sum.limbs[longest->length] = (uint32_t)carry;
+	sum.length = longest->length + 1;
+	trim(&sum);
+	replace(result, &sum);
+	return true;
+}
+
+/**
+ * @brief Subtracts a big integer from another.
+ *
+ * The integers being unsigned, `a` must not be smaller than `b`.
+ *
+ * @param[out] result Where to store the difference.
+ * @param[in] a The integer being subtracted from.
+ * @param[in] b The integer being subtracted.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_subtract(big_integer *const result, const big_integer *const a,
+                     const big_integer *const b)
+{
+	big_integer difference;
+	big_integer_init(&difference);
+	if (!reserve(&difference, a->length)) {
+		return false;
+	}
+	int64_t borrow = 0;
+	for (size_t i = 0; i < a->length; i++) {
+		int64_t current = (int64_t)a->limbs[i] - borrow;
+		if (i < b->length) {
+			current -= b->limbs[i];
+		}
+		borrow = current < 0;
+		difference.limbs[i] = (uint32_t)current;
+	}
+	difference.length = a->length;
+	trim(&difference);
+	replace(result, &difference);
+	return true;
+}
+
+/**
+ * @brief Multiplies two big integers.
+ *
+ * @param[out] result Where to store the product.
+ * @param[in] a The first term of the product.
+ * @param[in] b The second term of the product.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_multiply(big_integer *const result, const big_integer *const a,
+                     const big_integer *const b)
+{
+	big_integer product;
+	big_integer_init(&product);
+	if (a->length == 0 || b->length == 0) {
+		replace(result, &product);
+		return true;
+	}
+	if (!reserve(&product, a->length + b->length)) {
+		return false;
+	}
+	memset(product.limbs, 0, (a->length + b->length) * sizeof(uint32_t));
+	for (size_t i = 0; i < a->length; i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < b->length; j++) {
+			carry += (uint64_t)a->limbs[i] * b->limbs[j] +
+			         product.limbs[i + j];
+			product.limbs[i + j] = (uint32_t)carry;
+			carry >>= 32;
+		}
+		product.limbs[i + b->length] = (uint32_t)carry;
+	}
+	product.length = a->length + b->length;
+	trim(&product);
+	replace(result, &product);
+	return true;
+}
+
+/**
+ * @brief Performs the euclidian division of two big integers.
+ *
+ * @param[out] quotient Where to store the quotient, or NULL.
+ * @param[out] remainder Where to store the remainder, or NULL.
+ * @param[in] dividend The integer to divide.
+ * @param[in] divisor The integer to divide by. It must not be zero.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_divide(big_integer *const quotient, big_integer *const remainder,
+                   const big_integer *const dividend,
+                   const big_integer *const divisor)
+{
+	if (big_integer_compare(dividend, divisor) < 0) {
+		if (remainder != NULL &&
+		    !big_integer_copy(remainder, dividend)) {
+			return false;
+		}
+		if (quotient != NULL) {
+			quotient->length = 0;
+		}
+		return true;
+	}
+	if (divisor->length == 1) {
+		uint32_t rest = 0;
+		return big_integer_divide_limb(quotient, &rest, dividend,
+		                               divisor->limbs[0]) &&
+		       (remainder == NULL ||
+		        big_integer_set_u64(remainder, rest));
+	}
+	return divide_long(quotient, remainder, dividend, divisor);
+}
+
+/**
+ * @brief Gives the GCD of two big integers.
+ *
+ * Uses the Euclidian algorithm, switching to native integers as soon as the
+ * values fit in 64 bits.
+ *
+ * @param[out] result Where to store the GCD.
+ * @param[in] a One of the integers to compute the GCD of.
+ * @param[in] b One of the integers to compute the GCD of.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_gcd(big_integer *const result, const big_integer *const a,
+                const big_integer *const b)
+{
+	big_integer x;
+	big_integer y;
+	big_integer_init(&x);
+	big_integer_init(&y);
+	bool allocated = big_integer_copy(&x, a) && big_integer_copy(&y, b);
+	uint64_t small_x = 0;
+	uint64_t small_y = 0;
+	while (allocated && y.length != 0 &&
+	       !(big_integer_to_u64(&x, &small_x) &&
+	         big_integer_to_u64(&y, &small_y))) {
+		allocated = big_integer_divide(NULL, &x, &x, &y);
+		big_integer temp = x;
+		x = y;
+		y = temp;
+	}
+	if (allocated && y.length != 0) {
+		while (small_y != 0) {
+			uint64_t temp = small_y;
+			small_y = small_x % small_y;
+			small_x = temp;
+		}
+		allocated = big_integer_set_u64(&x, small_x);
+	}
+	big_integer_free(&y);
+	if (allocated) {
+		replace(result, &x);
+	} else {
+		big_integer_free(&x);
+	}
+	return allocated;
+}
+
+/**
+ * @brief Splits a big integer into chunks of 9 decimal digits.
+ *
+ * @param[in] n The integer.
+ * @param[out] chunks Where to store the chunks, the least significant first,
+ * to be released with `free()`.
+ * @param[out] n_chunks Where to store the number of chunks, at least 1.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_integer_decimal_chunks(const big_integer *const n, uint32_t **const chunks,
+                           size_t *const n_chunks)
+{
+	/* Each limb takes less than 10 decimal digits */
+	*chunks = malloc((n->length * 10 / 9 + 1) * sizeof(uint32_t));
+	if (*chunks == NULL) {
+		return false;
+	}
+	*n_chunks = 0;
+	big_integer rest;
+	big_integer_init(&rest);
+	if (!big_integer_copy(&rest, n)) {
+		free(*chunks);
+		*chunks = NULL;
+		return false;
+	}
+	/* Even zero has a chunk, and dividing in place allocates nothing */
+	do {
+		big_integer_divide_limb(&rest, &(*chunks)[(*n_chunks)++], &rest,
+		                        1000000000);
+	} while (rest.length != 0);
+	big_integer_free(&rest);
+	return true;
+}
+
+/**
+ * @brief Prints a big integer in decimal.
+ *
+ * @param[in] stream The stream to print to.
+ * @param[in] n The integer to print.
+ *
+ * @return Whether the memory could be allocated. Nothing is printed if not.
+ */
+bool
+big_integer_fprint(FILE *const stream, const big_integer *const n)
+{
+	uint32_t *chunks = NULL;
+	size_t n_chunks = 0;
+	if (!big_integer_decimal_chunks(n, &chunks, &n_chunks)) {
+		return false;
+	}
+	fprintf(stream, "%u", (unsigned)chunks[n_chunks - 1]);
+	for (size_t i = n_chunks - 1; i-- > 0;) {
+		fprintf(stream, "%09u", (unsigned)chunks[i]);
+	}
+	free(chunks);
+	return true;
+}
+
+/* -- Fraction functions -- */
+
+/**
+ * @brief Reduces a big fraction in place.
+ *
+ * @see simplify_fraction
+ *
+ * @param[in, out] f The fraction to simplify.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_simplify(big_fraction *const f)
+{
+	if (f->numerator.length == 0) {
+		f->negative = false;
+		return big_integer_set_u64(&f->denominator, 1);
+	}
+	big_integer divisor;
+	big_integer_init(&divisor);
+	bool allocated =
+	    big_integer_gcd(&divisor, &f->numerator, &f->denominator);
+	if (allocated && !(divisor.length == 1 && divisor.limbs[0] == 1)) {
+		allocated = big_integer_divide(&f->numerator, NULL,
+		                               &f->numerator, &divisor) &&
+		            big_integer_divide(&f->denominator, NULL,
+		                               &f->denominator, &divisor);
+	}
+	big_integer_free(&divisor);
+	return allocated;
+}
+
+/**
+ * @brief Initialises a big fraction, without allocating its memory.
+ *
+ * The fraction has no value yet: it must be set, or be given the result of
+ * an operation, before it is read.
+ *
+ * @param[out] f The fraction to initialise.
+ */
+void
+big_fraction_init(big_fraction *const f)
+{
+	f->negative = false;
+	big_integer_init(&f->numerator);
+	big_integer_init(&f->denominator);
+}
+
+/**
+ * @brief Releases the memory held by a big fraction.
+ *
+ * @param[in, out] f The fraction to free.
+ */
+void
+big_fraction_free(big_fraction *const f)
+{
+	big_integer_free(&f->numerator);
+	big_integer_free(&f->denominator);
+	f->negative = false;
+}
+
+/**
+ * @brief Sets the value of a big fraction.
+ *
+ * The value does not need to be reduced.
+ *
+ * @param[out] f The fraction to set.
+ * @param[in] negative Whether the fraction is negative.
+ * @param[in] numerator The numerator of the fraction.
+ * @param[in] denominator The (non-zero) denominator of the fraction.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_set(big_fraction *const f, const bool negative,
+                 const uint64_t numerator, const uint64_t denominator)
+{
+	f->negative = negative;
+	return big_integer_set_u64(&f->numerator, numerator) &&
+	       big_integer_set_u64(&f->denominator, denominator) &&
+	       big_fraction_simplify(f);
+}
+
+/**
+ * @brief Copies a big fraction.
+ *
+ * @param[out] destination The fraction to overwrite.
+ * @param[in] source The fraction to copy.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_copy(big_fraction *const destination,
+                  const big_fraction *const source)
+{
+	destination->negative = source->negative;
+	return big_integer_copy(&destination->numerator, &source->numerator) &&
+	       big_integer_copy(&destination->denominator,
+	                        &source->denominator);
+}
+
+/**
+ * @brief Gives the terms of a big fraction, if they fit in 64 bits.
+ *
+ * @param[in] f The fraction to convert.
+ * @param[out] negative Where to store the sign.
+ * @param[out] numerator Where to store the numerator.
+ * @param[out] denominator Where to store the denominator.
+ *
+ * @return Whether both terms fit in 64 bits. If not, the outputs are not
+ * modified.
+ */
+bool
+big_fraction_to_u64(const big_fraction *const f, bool *const negative,
+                    uint64_t *const numerator, uint64_t *const denominator)
+{
+	uint64_t num = 0;
+	uint64_t den = 0;
+	if (!big_integer_to_u64(&f->numerator, &num) ||
+	    !big_integer_to_u64(&f->denominator, &den)) {
+		return false;
+	}
+	*negative = f->negative;
+	*numerator = num;
+	*denominator = den;
+	return true;
+}
+
+/**
+ * @brief Multiplies two big fractions together.
+ *
+ * @param[out] result Where to store the product.
+ * @param[in] a The product's first term.
+ * @param[in] b The product's second term.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_multiply(big_fraction *const result, const big_fraction *const a,
+                      const big_fraction *const b)
+{
+	bool negative = a->negative != b->negative;
+	if (!big_integer_multiply(&result->denominator, &a->denominator,
+	                          &b->denominator) ||
+	    !big_integer_multiply(&result->numerator, &a->numerator,
+	                          &b->numerator)) {
+		return false;
+	}
+	result->negative = negative;
+	return big_fraction_simplify(result);
+}
+
+/**
+ * @brief Subtracts the product of two big fractions from a third one.
+ *
+ * @see submul_fractions
+ *
+ * @param[out] result Where to store `minuend` - `factor` \f$\times\f$ `term`.
+ * @param[in] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_submul(big_fraction *const result,
+                    const big_fraction *const minuend,
+                    const big_fraction *const factor,
+                    const big_fraction *const term)
+{
+	big_integer product_num;
+	big_integer product_den;
+	big_integer left;
+	big_integer right;
+	big_integer_init(&product_num);
+	big_integer_init(&product_den);
+	big_integer_init(&left);
+	big_integer_init(&right);
+
+	bool product_negative = factor->negative != term->negative;
+	bool minuend_negative = minuend->negative;
+
+	/* a/b - c/d = (ad - cb) / bd */
+	bool allocated =
+	    big_integer_multiply(&product_num, &factor->numerator,
+	                         &term->numerator) &&
+	    big_integer_multiply(&product_den, &factor->denominator,
+	                         &term->denominator) &&
+	    big_integer_multiply(&left, &minuend->numerator, &product_den) &&
+	    big_integer_multiply(&right, &product_num, &minuend->denominator) &&
+	    big_integer_multiply(&result->denominator, &minuend->denominator,
+	                         &product_den);
+	if (!allocated) {
+		/* Nothing more to compute */
+	} else if (minuend_negative != product_negative) {
+		/* The magnitudes add up */
+		allocated = big_integer_add(&result->numerator, &left, &right);
+		result->negative = minuend_negative;
+	} else if (big_integer_compare(&left, &right) >= 0) {
+		allocated =
+		    big_integer_subtract(&result->numerator, &left, &right);
+		result->negative = minuend_negative;
+	} else {
+		allocated =
+		    big_integer_subtract(&result->numerator, &right, &left);
+		result->negative = !minuend_negative;
+	}
+	allocated = allocated && big_fraction_simplify(result);
+
+	big_integer_free(&product_num);
+	big_integer_free(&product_den);
+	big_integer_free(&left);
+	big_integer_free(&right);
+	return allocated;
+}
+
+/**
+ * @brief Gives the invert of a big fraction.
+ *
+ * @warning If the input fraction is null, no action is performed.
+ *
+ * @param[out] result Where to store the inverted fraction.
+ * @param[in] f The fraction to invert.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+big_fraction_invert(big_fraction *const result, const big_fraction *const f)
+{
+	if (f->numerator.length == 0) {
+		return true;
+	}
+	if (result == f) {
+		big_integer temp = result->numerator;
+		result->numerator = result->denominator;
+		result->denominator = temp;
+		return true;
+	}
+	result->negative = f->negative;
+	return big_integer_copy(&result->numerator, &f->denominator) &&
+	       big_integer_copy(&result->denominator, &f->numerator);
+}
+
+/**
+ * @brief Compares two big fractions.
+ *
+ * If the memory of the cross-products cannot be allocated, the
+ * approximations of the fractions are compared instead.
+ *
+ * @see compare_fractions
+ *
+ * @param[in] a The first fraction to compare.
+ * @param[in] b The second fraction to compare.
+ *
+ * @return -1, 0, or 1 if `a` is respectively less, equal or greater than `b`.
+ */
+int
+big_fraction_compare(const big_fraction *const a, const big_fraction *const b)
+{
+	if (a->negative != b->negative) {
+		return a->negative ? -1 : 1;
+	}
+	big_integer left;
+	big_integer right;
+	big_integer_init(&left);
+	big_integer_init(&right);
+	int order = 0;
+	if (big_integer_multiply(&left, &a->numerator, &b->denominator) &&
+	    big_integer_multiply(&right, &b->numerator, &a->denominator)) {
+		order = big_integer_compare(&left, &right);
+	} else {
+		/* The magnitudes, the signs being the same */
+		double x = big_fraction_to_double(a) * (a->negative ? -1 : 1);
+		double y = big_fraction_to_double(b) * (b->negative ? -1 : 1);
+		order = (x < y) ? -1 : (x > y);
+	}
+	big_integer_free(&left);
+	big_integer_free(&right);
+	return a->negative ? -order : order;
+}
+
+/**
+ * @brief Gives an approximation of a big fraction.
+ *
+ * @param[in] f The fraction to approximate.
+ *
+ * @return The closest double, or an infinity if the value is too big.
+ */
+double
+big_fraction_to_double(const big_fraction *const f)
+{
+	long num_exponent = 0;
+	long den_exponent = 0;
+	double value = approximate(&f->numerator, &num_exponent) /
+	               approximate(&f->denominator, &den_exponent);
+	for (long i = num_exponent - den_exponent; i > 0; i--) {
+		value *= LIMB_BASE;
+	}
+	for (long i = num_exponent - den_exponent; i < 0; i++) {
+		value /= LIMB_BASE;
+	}
+	return f->negative ? -value : value;
+}
+
+/**
+ * @brief Prints a big fraction, in the same format as the fractions.
+ *
+ * @param[in] stream The stream to print to.
+ * @param[in] f The fraction to print.
+ *
+ * @return Whether the memory could be allocated. The fraction may be printed
+ * partly if not.
+ */
+bool
+big_fraction_fprint(FILE *const stream, const big_fraction *const f)
+{
+	fprintf(stream, "%c", f->negative ? '-' : '+');
+	if (!big_integer_fprint(stream, &f->numerator)) {
+		return false;
+	}
+	fprintf(stream, "/");
+	return big_integer_fprint(stream, &f->denominator);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file bigfrac.h
+ * @brief Definitions for bigfrac.c
+ * @see bigfrac.c
+ */
+
+#ifndef BIGFRAC_H
+#define BIGFRAC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief A non-negative integer of arbitrary size.
+ *
+ * The value is stored in base \f$2^{32}\f$, least significant limb first.
+ * The most significant limb is never zero: zero is represented with no limbs
+ * at all.
+ */
+struct big_integer {
+	/** The digits of the integer, in base 2^32 */
+	uint32_t *limbs;
+	/** The number of limbs in use */
+	size_t length;
+	/** The number of limbs allocated */
+	size_t capacity;
+};
+
+/**
+ * @brief Definition of a type from the big_integer structure.
+ * @see struct big_integer
+ */
+typedef struct big_integer big_integer;
+
+/**
+ * @brief A fraction of arbitrary precision.
+ *
+ * Like a @ref fraction, its sign is stored separately, and it is kept in
+ * reduced form with a positive denominator.
+ */
+struct big_fraction {
+	/** Whether the fraction is negative */
+	bool negative;
+	/** The numerator of the fraction */
+	big_integer numerator;
+	/** The denominator of the fraction */
+	big_integer denominator;
+};
+
+/**
+ * @brief Definition of a type from the big_fraction structure.
+ * @see struct big_fraction
+ */
+typedef struct big_fraction big_fraction;
+
+void big_integer_init(big_integer *const);
+void big_integer_free(big_integer *const);
+bool big_integer_set_u64(big_integer *const, uint64_t);
+bool big_integer_copy(big_integer *const, const big_integer *const);
+bool big_integer_set_limbs(big_integer *const, const uint32_t *const,
+                           const size_t);
+bool big_integer_to_u64(const big_integer *const, uint64_t *const);
+size_t big_integer_bits(const big_integer *const);
+int big_integer_compare(const big_integer *const, const big_integer *const);
+bool big_integer_add(big_integer *const, const big_integer *const,
+                     const big_integer *const);
+bool big_integer_subtract(big_integer *const, const big_integer *const,
+                          const big_integer *const);
+bool big_integer_multiply(big_integer *const, const big_integer *const,
+                          const big_integer *const);
+bool big_integer_divide(big_integer *const, big_integer *const,
+                        const big_integer *const, const big_integer *const);
+bool big_integer_divide_limb(big_integer *const, uint32_t *const,
+                             const big_integer *const, const uint32_t);
+bool big_integer_gcd(big_integer *const, const big_integer *const,
+                     const big_integer *const);
+bool big_integer_decimal_chunks(const big_integer *const, uint32_t **const,
+                                size_t *const);
+bool big_integer_fprint(FILE *const, const big_integer *const);
+
+void big_fraction_init(big_fraction *const);
+void big_fraction_free(big_fraction *const);
+bool big_fraction_set(big_fraction *const, const bool, const uint64_t,
+                      const uint64_t);
+bool big_fraction_simplify(big_fraction *const);
+bool big_fraction_copy(big_fraction *const, const big_fraction *const);
+bool big_fraction_to_u64(const big_fraction *const, bool *const,
+                         uint64_t *const, uint64_t *const);
+bool big_fraction_multiply(big_fraction *const, const big_fraction *const,
+                           const big_fraction *const);
+bool big_fraction_submul(big_fraction *const, const big_fraction *const,
+                         const big_fraction *const,
+                         const big_fraction *const);
+bool big_fraction_invert(big_fraction *const, const big_fraction *const);
+int big_fraction_compare(const big_fraction *const,
+                         const big_fraction *const);
+double big_fraction_to_double(const big_fraction *const);
+bool big_fraction_fprint(FILE *const, const big_fraction *const);
+
+#endif /* BIGFRAC_H */
@@ -0,0 +1,324 @@
+/**
+ * @file binary.c
+ * @brief Reading and writing of matrices in a binary format.
+ *
+ * Parsing text is the most expensive part of loading a big system, and the
+ * text takes several times the size of the integers it holds. In the binary
+ * format, the integers are stored as they are, so that a file can be mapped
+ * in memory and its elements converted straight into the solver's matrix.
+ *
+ * A file is made of a header of @ref BINARY_HEADER_SIZE bytes followed by the
+ * elements, line after line. All the integers are little-endian.
+ *
+ * | Offset | Size | Contents                                           |
+ * |--------|------|----------------------------------------------------|
+ * | 0      | 4    | The magic bytes `LQSB`                             |
+ * | 4      | 2    | The version of the format, @ref BINARY_VERSION     |
+ * | 6      | 1    | The size of the elements in bytes, 4 or 8          |
+ * | 7      | 1    | The flags: bit 0 is set if there is a checksum     |
+ * | 8      | 8    | The number of lines                                |
+ * | 16     | 8    | The number of columns                              |
+ * | 24     | 8    | The 64-bit FNV-1a hash of the elements, or 0       |
+ * | 32     |      | The elements, signed                               |
+ *
+ * @see https://en.wikipedia.org/wiki/Fowler–Noll–Vo_hash_function
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "binary.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @brief The bytes every binary matrix starts with. */
+#define BINARY_MAGIC "LQSB"
+
+/** @brief The flag of the files with a checksum. */
+#define BINARY_FLAG_CHECKSUM 0x01
+
+/** @brief The initial value of the FNV-1a hash. */
+#define FNV_OFFSET_BASIS 14695981039346656037u
+
+/** @brief The multiplier of the FNV-1a hash. */
+#define FNV_PRIME 1099511628211u
+
+/**
+ * @brief Extends a FNV-1a hash with bytes.
+ *
+ * @param[in] hash The hash of the previous bytes.
+ * @param[in] bytes The bytes to hash.
+ * @param[in] length The number of bytes.
+ *
+ * @return The hash of all the bytes.
+ */
+static uint64_t
+hash_bytes(uint64_t hash, const unsigned char *const bytes,
+           const size_t length)
+{
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ bytes[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * @brief Writes a little-endian integer.
+ *
+ * @param[out] bytes Where to write the integer.
+ * @param[in] value The integer.
+ * @param[in] width The number of bytes to write.
+ */
+static void
+store_le(unsigned char *const bytes, uint64_t value, const unsigned width)
+{
+	for (unsigned b = 0; b < width; b++) {
+		bytes[b] = (unsigned char)(value & 0xFF);
+		value >>= 8;
+	}
+}
+
+/**
+ * @brief Reads a matrix in the binary format from memory.
+ *
+ * The matrix refers to the memory, which must outlive it.
+ *
+ * @param[out] binary The matrix to initialise.
+ * @param[in] data The contents of a file.
+ * @param[in] size The number of bytes of the contents.
+ *
+ * @return Whether the contents are a valid matrix. The matrix's error tells
+ * why if they start like one but are not valid.
+ */
+enum binary_status
+binary_parse(binary_matrix *const binary, const void *const data,
+             const size_t size)
+{
+	const unsigned char *bytes = data;
+	binary->mapping = NULL;
+	binary->mapping_size = 0;
+	binary->error[0] = '\0';
+	if (size < 4 || memcmp(bytes, BINARY_MAGIC, 4) != 0) {
+		return BINARY_NOT_BINARY;
+	}
+	if (size < BINARY_HEADER_SIZE) {
+		report_error(binary->error, "the binary header is truncated");
+		return BINARY_INVALID;
+	}
+	const unsigned version = bytes[4] | (unsigned)bytes[5] << 8;
+	if (version != BINARY_VERSION) {
+		report_error(binary->error,
+		             "version %u of the binary format is not supported",
+		             version);
+		return BINARY_INVALID;
+	}
+	binary->element_width = bytes[6];
+	if (binary->element_width != 4 && binary->element_width != 8) {
+		report_error(binary->error,
+		             "the binary elements must have 4 or 8 bytes");
+		return BINARY_INVALID;
+	}
+	const uint64_t n_lines = binary_load_u64(bytes + 8);
+	const uint64_t n_col = binary_load_u64(bytes + 16);
+	const size_t payload_size = size - BINARY_HEADER_SIZE;
+	if (n_col != 0 &&
+	    n_lines > payload_size / binary->element_width / n_col) {
+		report_error(binary->error, "the binary matrix is truncated");
+		return BINARY_INVALID;
+	}
+	binary->n_lines = (size_t)n_lines;
+	binary->n_col = (size_t)n_col;
+	binary->payload = bytes + BINARY_HEADER_SIZE;
+	if (binary->n_lines * binary->n_col * binary->element_width !=
+	    payload_size) {
+		report_error(binary->error,
+		             "the binary matrix has trailing bytes");
+		return BINARY_INVALID;
+	}
+	if ((bytes[7] & BINARY_FLAG_CHECKSUM) &&
+	    hash_bytes(FNV_OFFSET_BASIS, binary->payload, payload_size) !=
+	        binary_load_u64(bytes + 24)) {
+		report_error(binary->error,
+		             "the checksum of the binary matrix does not match");
+		return BINARY_INVALID;
+	}
+	return BINARY_MATRIX;
+}
+
+/**
+ * @brief Opens a file as a matrix in the binary format.
+ *
+ * The file is mapped in memory, and its elements are read from there on
+ * demand.
+ *
+ * @param[out] binary The matrix to initialise. It must be closed with
+ * binary_close() if the file is a matrix.
+ * @param[in] filename The name of the file.
+ *
+ * @return Whether the file is a valid matrix. The matrix's error tells why
+ * if it starts like one but is not valid. Files that cannot be mapped are not
+ * binary matrices.
+ */
+enum binary_status
+binary_open(binary_matrix *const binary, const char *const filename)
+{
+	binary->mapping = NULL;
+	binary->mapping_size = 0;
+	binary->error[0] = '\0';
+	const int descriptor = open(filename, O_RDONLY);
+	if (descriptor < 0) {
+		return BINARY_NOT_BINARY;
+	}
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) ||
+	    status.st_size < 4) {
+		close(descriptor);
+		return BINARY_NOT_BINARY;
+	}
+	const size_t size = (size_t)status.st_size;
+	void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	/* The mapping stays valid once the file is closed */
+	close(descriptor);
+	if (mapping == MAP_FAILED) {
+		return BINARY_NOT_BINARY;
+	}
+
+	enum binary_status parsed = binary_parse(binary, mapping, size);
+	if (parsed != BINARY_MATRIX) {
+		munmap(mapping, size);
+		return parsed;
+	}
+	posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+	binary->mapping = mapping;
+	binary->mapping_size = size;
+	return BINARY_MATRIX;
+}
+
+/**
+ * @brief Releases the mapping of a binary matrix.
+ *
+ * @param[in, out] binary The matrix to close.
+ */
+void
+binary_close(binary_matrix *const binary)
+{
+	if (binary->mapping != NULL) {
+		munmap(binary->mapping, binary->mapping_size);
+	}
+	binary->mapping = NULL;
+	binary->mapping_size = 0;
+	binary->payload = NULL;
+}
+
+/**
+ * @brief Starts writing a matrix in the binary format.
+ *
+ * @param[out] writer The writer to initialise.
+ * @param[in] file The file to write to, opened for writing in binary mode.
+ * It must be seekable.
+ * @param[in] element_width The number of bytes of each element, 4 or 8.
+ * @param[in] checksum Whether to store a checksum of the elements.
+ *
+ * @return Whether the space of the header could be written. The writer's
+ * error tells why if not.
+ */
+bool
+binary_writer_start(binary_writer *const writer, FILE *const file,
+                    const unsigned element_width, const bool checksum)
+{
+	writer->file = file;
+	writer->element_width = element_width;
+	writer->checksum = checksum;
+	writer->hash = FNV_OFFSET_BASIS;
+	writer->n_lines = 0;
+	writer->n_col = 0;
+	writer->error[0] = '\0';
+	/* The header is overwritten by binary_writer_finish() */
+	const unsigned char blank[BINARY_HEADER_SIZE] = {0};
+	if (fwrite(blank, 1, BINARY_HEADER_SIZE, file) != BINARY_HEADER_SIZE) {
+		report_error(writer->error, "the file could not be written");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Writes a line of a matrix in the binary format.
+ *
+ * @param[in, out] writer The writer.
+ * @param[in] values The elements of the line.
+ * @param[in] n_col The number of elements of the line.
+ *
+ * @return Whether the line could be written. The writer's error tells why if
+ * not.
+ */
+bool
+binary_writer_line(binary_writer *const writer, const int64_t *const values,
+                   const size_t n_col)
+{
+	if (writer->n_lines == 0) {
+		writer->n_col = n_col;
+	} else if (n_col != writer->n_col) {
+		report_error(writer->error,
+		             "line %zu has %zu elements instead of %zu",
+		             writer->n_lines + 1, n_col, writer->n_col);
+		return false;
+	}
+	for (size_t j = 0; j < n_col; j++) {
+		if (writer->element_width == 4 &&
+		    (values[j] < INT32_MIN || values[j] > INT32_MAX)) {
+			report_error(writer->error,
+			             "the elements of line %zu do not fit in 32 "
+			             "bits",
+			             writer->n_lines + 1);
+			return false;
+		}
+		const unsigned width = writer->element_width;
+		unsigned char bytes[8];
+		store_le(bytes, (uint64_t)values[j], width);
+		if (writer->checksum) {
+			writer->hash = hash_bytes(writer->hash, bytes, width);
+		}
+		if (fwrite(bytes, 1, width, writer->file) != width) {
+			report_error(writer->error,
+			             "the file could not be written");
+			return false;
+		}
+	}
+	writer->n_lines++;
+	return true;
+}
+
+/**
+ * @brief Finishes writing a matrix in the binary format.
+ *
+ * Writes the header at the start of the file. The file is not closed.
+ *
+ * @param[in, out] writer The writer.
+ *
+ * @return Whether the header could be written. The writer's error tells why
+ * if not.
+ */
+bool
+binary_writer_finish(binary_writer *const writer)
+{
+	unsigned char header[BINARY_HEADER_SIZE] = {0};
+	memcpy(header, BINARY_MAGIC, 4);
+	store_le(header + 4, BINARY_VERSION, 2);
+	header[6] = (unsigned char)writer->element_width;
+	header[7] = writer->checksum ? BINARY_FLAG_CHECKSUM : 0;
+	store_le(header + 8, writer->n_lines, 8);
+	store_le(header + 16, writer->n_col, 8);
+	store_le(header + 24, writer->checksum ? writer->hash : 0, 8);
+	if (fseek(writer->file, 0, SEEK_SET) != 0 ||
+	    fwrite(header, 1, BINARY_HEADER_SIZE, writer->file) !=
+	        BINARY_HEADER_SIZE ||
+	    fflush(writer->file) != 0) {
+		report_error(writer->error, "the file could not be written");
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file binary.h
+ * @brief Definitions for binary.c
+ * @see binary.c
+ */
+
+#ifndef BINARY_H
+#define BINARY_H
+
+#include "report.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief The number of bytes of the header of a binary matrix. */
+#define BINARY_HEADER_SIZE 32
+
+/** @brief The version of the binary format written by this program. */
+#define BINARY_VERSION 1
+
+/**
+ * @brief The outcomes of opening a file as a binary matrix.
+ */
+enum binary_status {
+	/** The file is a valid binary matrix */
+	BINARY_MATRIX,
+	/** The file is not a binary matrix, it may be a text one */
+	BINARY_NOT_BINARY,
+	/** The file is a binary matrix, but it cannot be used */
+	BINARY_INVALID,
+};
+
+/**
+ * @brief A matrix of integers in the binary format.
+ *
+ * The elements are read in place, from the file's contents.
+ */
+struct binary_matrix {
+	/** The elements, line after line, in little-endian order */
+	const unsigned char *payload;
+	/** The number of lines of the matrix */
+	size_t n_lines;
+	/** The number of columns of the matrix */
+	size_t n_col;
+	/** The number of bytes of each element, 4 or 8 */
+	unsigned element_width;
+	/** The memory mapping of the file, or NULL if not mapped */
+	void *mapping;
+	/** The number of bytes of the mapping */
+	size_t mapping_size;
+	/** Why the file cannot be used, once it is found invalid */
+	char error[ERROR_SIZE];
+};
+
+/**
+ * @brief Definition of a type from the binary_matrix structure.
+ * @see struct binary_matrix
+ */
+typedef struct binary_matrix binary_matrix;
+
+/**
+ * @brief A writer of a matrix in the binary format, line by line.
+ *
+ * The header is written last, once the number of lines is known, so the
+ * file must be seekable.
+ */
+struct binary_writer {
+	/** The file to write to */
+	FILE *file;
+	/** The number of bytes of each element, 4 or 8 */
+	unsigned element_width;
+	/** Whether to store a checksum of the elements */
+	bool checksum;
+	/** The checksum of the elements written so far */
+	uint64_t hash;
+	/** The number of lines written so far */
+	size_t n_lines;
+	/** The number of columns of the lines, set by the first one */
+	size_t n_col;
+	/** Why the matrix could not be written, once it failed */
+	char error[ERROR_SIZE];
+};
+
+/**
+ * @brief Definition of a type from the binary_writer structure.
+ * @see struct binary_writer
+ */
+typedef struct binary_writer binary_writer;
+
+enum binary_status binary_parse(binary_matrix *const, const void *const,
+                                 const size_t);
+enum binary_status binary_open(binary_matrix *const, const char *const);
+void binary_close(binary_matrix *const);
+
+bool binary_writer_start(binary_writer *const, FILE *const, const unsigned,
+                         const bool);
+bool binary_writer_line(binary_writer *const, const int64_t *const,
+                        const size_t);
+bool binary_writer_finish(binary_writer *const);
+
+/**
+ * @brief Reads a little-endian 32-bit integer.
+ *
+ * Compilers turn this into a single load on little-endian processors.
+ *
+ * @param[in] bytes The bytes of the integer.
+ *
+ * @return The integer.
+ */
+static inline uint32_t
+binary_load_u32(const unsigned char *const bytes)
+{
+	return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+	       (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/**
+ * @brief Reads a little-endian 64-bit integer.
+ *
+ * @see binary_load_u32
+ */
+static inline uint64_t
+binary_load_u64(const unsigned char *const bytes)
+{
+	return (uint64_t)binary_load_u32(bytes) |
+	       (uint64_t)binary_load_u32(bytes + 4) << 32;
+}
+
+/**
+ * @brief Gives an element of a binary matrix.
+ *
+ * @param[in] m The matrix.
+ * @param[in] line The index of the element's line.
+ * @param[in] column The index of the element's column.
+ *
+ * @return The value of the element.
+ */
+static inline int64_t
+binary_element(const binary_matrix *const m, const size_t line,
+               const size_t column)
+{
+	const size_t index = line * m->n_col + column;
+	if (m->element_width == 4) {
+		return (int32_t)binary_load_u32(m->payload + index * 4);
+	}
+	return (int64_t)binary_load_u64(m->payload + index * 8);
+}
+
+#endif /* BINARY_H */
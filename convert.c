@@ -0,0 +1,159 @@
+/**
+ * @file convert.c
+ * @brief Converts matrices between the text and binary formats.
+ *
+ * The format of the input is detected: a text matrix is converted to the
+ * binary format, and a binary matrix to text. The text is read and written
+ * one line at a time, so matrices of any size can be converted.
+ *
+ * @see binary.c
+ */
+
+#include "binary.h"
+#include "reader.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Converts a text matrix to the binary format.
+ *
+ * @param[in] input The text file to read.
+ * @param[in] output The file to write, seekable.
+ * @param[in] element_width The number of bytes of each element, 4 or 8.
+ * @param[in] checksum Whether to store a checksum of the elements.
+ *
+ * @return Whether the conversion succeeded. An error is printed if not.
+ */
+static bool
+text_to_binary(FILE *const input, FILE *const output,
+               const unsigned element_width, const bool checksum)
+{
+	line_reader reader;
+	if (!reader_init(&reader, input)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		return false;
+	}
+	binary_writer writer;
+	bool converted = binary_writer_start(&writer, output, element_width,
+	                                     checksum);
+	enum read_status status = READ_LINE;
+	while (converted && (status = reader_next_line(&reader)) == READ_LINE) {
+		if (reader.n_values == 0) {
+			/* Blank lines end the matrix */
+			break;
+		}
+		converted = binary_writer_line(&writer, reader.values,
+		                               reader.n_values);
+	}
+	if (status == READ_ERROR) {
+		fprintf(stderr, "ERROR: %s.\n", reader.error);
+		converted = false;
+	} else if (!converted || !binary_writer_finish(&writer)) {
+		fprintf(stderr, "ERROR: %s.\n", writer.error);
+		converted = false;
+	}
+	reader_free(&reader);
+	return converted;
+}
+
+/**
+ * @brief Converts a binary matrix to text.
+ *
+ * @param[in] binary The matrix to convert.
+ * @param[in] output The file to write.
+ *
+ * @return Whether the conversion succeeded. An error is printed if not.
+ */
+static bool
+binary_to_text(const binary_matrix *const binary, FILE *const output)
+{
+	for (size_t i = 0; i < binary->n_lines; i++) {
+		for (size_t j = 0; j < binary->n_col; j++) {
+			fprintf(output, j == 0 ? "%" PRId64 : " %" PRId64,
+			        binary_element(binary, i, j));
+		}
+		fputc('\n', output);
+	}
+	if (fflush(output) != 0) {
+		fprintf(stderr, "ERROR: the file could not be written.\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief The entry point of the converter.
+ *
+ * Usage: `lqsconvert [--int64] [--no-checksum] input output`
+ *
+ * @param[in] argc The number of arguments supplied to the program.
+ * @param[in] argv The array containing the arguments.
+ *
+ * @return The ending status of the program.
+ */
+int
+main(const int argc, const char *const argv[])
+{
+	unsigned element_width = 4;
+	bool checksum = true;
+	const char *filenames[2] = {NULL, NULL};
+	size_t n_filenames = 0;
+	for (int arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--int64") == 0) {
+			element_width = 8;
+		} else if (strcmp(argv[arg], "--no-checksum") == 0) {
+			checksum = false;
+		} else if (argv[arg][0] == '-' || n_filenames == 2) {
+			fprintf(stderr, "ERROR: unexpected argument %s.\n",
+			        argv[arg]);
+			return EXIT_FAILURE;
+		} else {
+			filenames[n_filenames++] = argv[arg];
+		}
+	}
+	if (n_filenames != 2) {
+		fprintf(stderr, "Usage: %s [--int64] [--no-checksum] input "
+		                "output\n",
+		        argc > 0 ? argv[0] : "lqsconvert");
+		return EXIT_FAILURE;
+	}
+
+	binary_matrix binary;
+	enum binary_status format = binary_open(&binary, filenames[0]);
+	if (format == BINARY_INVALID) {
+		fprintf(stderr, "ERROR: %s.\n", binary.error);
+		return EXIT_FAILURE;
+	}
+	FILE *input = NULL;
+	if (format == BINARY_NOT_BINARY) {
+		input = fopen(filenames[0], "r");
+		if (input == NULL) {
+			fprintf(stderr, "ERROR: could not open file %s.\n",
+			        filenames[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	FILE *output = fopen(filenames[1],
+	                     format == BINARY_MATRIX ? "w" : "wb");
+	if (output == NULL) {
+		fprintf(stderr, "ERROR: could not open file %s.\n",
+		        filenames[1]);
+		return EXIT_FAILURE;
+	}
+
+	bool converted = false;
+	if (format == BINARY_MATRIX) {
+		converted = binary_to_text(&binary, output);
+		binary_close(&binary);
+	} else {
+		converted =
+		    text_to_binary(input, output, element_width, checksum);
+		fclose(input);
+	}
+	if (fclose(output) != 0) {
+		converted = false;
+	}
+	return converted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
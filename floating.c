@@ -0,0 +1,429 @@
+/**
+ * @file floating.c
+ * @brief Approximate solving of systems in double precision.
+ *
+ * This engine gives up exactness for speed: the system is converted to
+ * `double` and factorised as \f$PA = LU\f$ with partial pivoting. The
+ * factorisation is blocked and right-looking. A panel of columns is
+ * factorised, the matching lines of U are computed, and the trailing
+ * submatrix is then updated tile by tile, so that the lines of U being used
+ * stay in the cache. Each of its lines is updated with four lines of U at a
+ * time, to load and store it four times less often. The innermost loops are
+ * all contiguous multiply-subtracts, which the compiler can vectorise.
+ *
+ * The solution can then be improved by iterative refinement. The residual is
+ * computed from the exact integer coefficients, in extended precision, and
+ * the correction is solved for with the existing factors.
+ *
+ * @see https://en.wikipedia.org/wiki/LU_decomposition
+ * @see https://en.wikipedia.org/wiki/Iterative_refinement
+ */
+
+#include "floating.h"
+
+#include "report.h"
+
+#include <float.h>
+#include <stdlib.h>
+
+/** @brief The number of columns of a panel of the factorisation. */
+#define LU_BLOCK_SIZE 64
+
+/** @brief The number of columns of a tile of the trailing update. */
+#define LU_TILE_WIDTH 256
+
+/**
+ * @brief Gives the absolute value of a double.
+ *
+ * @param[in] x The value.
+ *
+ * @return The absolute value of `x`.
+ */
+static inline double
+magnitude(const double x)
+{
+	return x < 0 ? -x : x;
+}
+
+/**
+ * @brief Subtracts a multiple of a line from another.
+ *
+ * This is the kernel of the panel factorisation.
+ *
+ * @param[in, out] line The line to update.
+ * @param[in] pivot_line The line to subtract a multiple of.
+ * @param[in] factor The multiple.
+ * @param[in] length The number of elements to update.
+ */
+static void
+update_line(double *restrict line, const double *restrict pivot_line,
+            const double factor, const size_t length)
+{
+	for (size_t j = 0; j < length; j++) {
+		line[j] -= factor * pivot_line[j];
+	}
+}
+
+/**
+ * @brief Subtracts multiples of four consecutive lines from another.
+ *
+ * Equivalent to four calls to update_line(), but the line being updated is
+ * only loaded and stored once.
+ *
+ * @param[in, out] line The line to update.
+ * @param[in] pivot_line The first of the four lines to subtract multiples
+ * of.
+ * @param[in] stride The number of elements between two consecutive lines.
+ * @param[in] factors The four multiples.
+ * @param[in] length The number of elements to update.
+ */
+static void
+update_line_by_four(double *restrict line, const double *restrict pivot_line,
+                    const size_t stride, const double *const factors,
+                    const size_t length)
+{
+	const double *restrict p0 = pivot_line;
+	const double *restrict p1 = pivot_line + stride;
+	const double *restrict p2 = pivot_line + 2 * stride;
+	const double *restrict p3 = pivot_line + 3 * stride;
+	const double f0 = factors[0];
+	const double f1 = factors[1];
+	const double f2 = factors[2];
+	const double f3 = factors[3];
+	for (size_t j = 0; j < length; j++) {
+		line[j] -= f0 * p0[j] + f1 * p1[j] + f2 * p2[j] + f3 * p3[j];
+	}
+}
+
+/**
+ * @brief Swaps two lines of a square matrix of doubles.
+ *
+ * @param[in, out] data The elements of the matrix.
+ * @param[in] size The number of columns of the matrix.
+ * @param[in] line1 The index of one of the lines to swap.
+ * @param[in] line2 The index of the other line to swap.
+ */
+static void
+swap_lines(double *const data, const size_t size, const size_t line1,
+           const size_t line2)
+{
+	double *a = data + line1 * size;
+	double *b = data + line2 * size;
+	for (size_t j = 0; j < size; j++) {
+		double temp = a[j];
+		a[j] = b[j];
+		b[j] = temp;
+	}
+}
+
+/**
+ * @brief Factorises a panel of columns.
+ *
+ * The columns of the panel are eliminated one after the other, only within
+ * the panel. Pivoting swaps whole lines.
+ *
+ * @param[in, out] lu The factorisation being computed.
+ * @param[in] first The index of the first column of the panel.
+ * @param[in] width The number of columns of the panel.
+ *
+ * @return Whether a non-zero pivot was found for every column.
+ */
+static bool
+factorise_panel(lu_factorization *const lu, const size_t first,
+                const size_t width)
+{
+	const size_t n = lu->size;
+	double *a = lu->data;
+	for (size_t k = first; k < first + width; k++) {
+		size_t pivot = k;
+		double largest = magnitude(a[k * n + k]);
+		for (size_t i = k + 1; i < n; i++) {
+			if (magnitude(a[i * n + k]) > largest) {
+				largest = magnitude(a[i * n + k]);
+				pivot = i;
+			}
+		}
+		if (largest == 0) {
+			return false;
+		}
+		if (pivot != k) {
+			swap_lines(a, n, k, pivot);
+			size_t temp = lu->permutation[k];
+			lu->permutation[k] = lu->permutation[pivot];
+			lu->permutation[pivot] = temp;
+		}
+
+		const double *pivot_line = a + k * n;
+		const double inverse = 1 / pivot_line[k];
+		for (size_t i = k + 1; i < n; i++) {
+			double *line = a + i * n;
+			line[k] *= inverse;
+			if (line[k] != 0) {
+				update_line(line + k + 1, pivot_line + k + 1,
+				            line[k], first + width - k - 1);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Computes the largest residual of an approximate solution.
+ *
+ * The residual is computed from the integer coefficients, and accumulated in
+ * extended precision.
+ *
+ * @param[in] system The system, as an augmented integer matrix.
+ * @param[in] solution The approximate value of each unknown.
+ * @param[out] residual Where to store the residual of each equation.
+ *
+ * @return The largest residual, in absolute value.
+ */
+static double
+compute_residual(const integer_matrix *const system,
+                 const double *const solution, double *const residual)
+{
+	const size_t n = system->n_lines;
+	double largest = 0;
+	for (size_t i = 0; i < n; i++) {
+		const int64_t *line = integer_matrix_line(system, i);
+		long double sum = (long double)line[n];
+		for (size_t j = 0; j < n; j++) {
+			sum -= (long double)line[j] * solution[j];
+		}
+		residual[i] = (double)sum;
+		if (magnitude(residual[i]) > largest) {
+			largest = magnitude(residual[i]);
+		}
+	}
+	return largest;
+}
+
+/**
+ * @brief Allocates an LU factorisation.
+ *
+ * @param[out] lu The factorisation to initialise.
+ * @param[in] size The number of lines and columns of the matrix.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+lu_init(lu_factorization *const lu, const size_t size)
+{
+	lu->size = size;
+	lu->data = NULL;
+	lu->permutation = NULL;
+	if (size != 0 && size > SIZE_MAX / size / sizeof(double)) {
+		return false;
+	}
+	lu->data = malloc(size * size * sizeof(double));
+	lu->permutation = malloc(size * sizeof(size_t));
+	if (lu->data == NULL || lu->permutation == NULL) {
+		lu_free(lu);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Releases the memory held by an LU factorisation.
+ *
+ * @param[in, out] lu The factorisation to free.
+ */
+void
+lu_free(lu_factorization *const lu)
+{
+	free(lu->data);
+	free(lu->permutation);
+	lu->data = NULL;
+	lu->permutation = NULL;
+}
+
+/**
+ * @brief Factorises the matrix of a system.
+ *
+ * @param[in, out] lu The factorisation to compute, of the size of the system.
+ * @param[in] system The system, as an augmented integer matrix. Its last
+ * column is ignored.
+ *
+ * @return Whether the matrix is regular.
+ */
+bool
+lu_factorise(lu_factorization *const lu, const integer_matrix *const system)
+{
+	const size_t n = lu->size;
+	double *a = lu->data;
+	for (size_t i = 0; i < n; i++) {
+		const int64_t *line = integer_matrix_line(system, i);
+		for (size_t j = 0; j < n; j++) {
+			a[i * n + j] = (double)line[j];
+		}
+		lu->permutation[i] = i;
+	}
+
+	for (size_t first = 0; first < n; first += LU_BLOCK_SIZE) {
+		const size_t width =
+		    n - first < LU_BLOCK_SIZE ? n - first : LU_BLOCK_SIZE;
+		const size_t end = first + width;
+		if (!factorise_panel(lu, first, width)) {
+			return false;
+		}
+
+		/* The lines of U right of the panel */
+		for (size_t i = first + 1; i < end; i++) {
+			for (size_t p = first; p < i; p++) {
+				update_line(a + i * n + end, a + p * n + end,
+				            a[i * n + p], n - end);
+			}
+		}
+
+		/* The trailing submatrix, one tile of columns at a time */
+		for (size_t column = end; column < n; column += LU_TILE_WIDTH) {
+			const size_t tile = n - column < LU_TILE_WIDTH
+			                        ? n - column
+			                        : LU_TILE_WIDTH;
+			for (size_t i = end; i < n; i++) {
+				double *line = a + i * n;
+				size_t p = first;
+				for (; p + 4 <= end; p += 4) {
+					update_line_by_four(
+					    line + column, a + p * n + column,
+					    n, line + p, tile);
+				}
+				for (; p < end; p++) {
+					update_line(line + column,
+					            a + p * n + column, line[p],
+					            tile);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Solves a system with its LU factorisation.
+ *
+ * @param[in] lu The factorisation of the system's matrix.
+ * @param[in] constants The constants of the equations.
+ * @param[out] solution Where to store the value of each unknown. It must not
+ * overlap the constants.
+ */
+void
+lu_solve(const lu_factorization *const lu, const double *const constants,
+         double *const solution)
+{
+	const size_t n = lu->size;
+	const double *a = lu->data;
+	for (size_t i = 0; i < n; i++) {
+		double value = constants[lu->permutation[i]];
+		for (size_t p = 0; p < i; p++) {
+			value -= a[i * n + p] * solution[p];
+		}
+		solution[i] = value;
+	}
+	for (size_t i = n; i-- > 0;) {
+		double value = solution[i];
+		for (size_t p = i + 1; p < n; p++) {
+			value -= a[i * n + p] * solution[p];
+		}
+		solution[i] = value / a[i * n + i];
+	}
+}
+
+/**
+ * @brief Gives the room float_solve() needs in an arena.
+ *
+ * @param[in] n The number of unknowns of the system.
+ *
+ * @return The number of bytes, or SIZE_MAX if it overflows.
+ */
+size_t
+float_solve_arena_size(const size_t n)
+{
+	if (n != 0 && n > SIZE_MAX / n / sizeof(double)) {
+		return SIZE_MAX;
+	}
+	return arena_size(n * n, sizeof(double)) +
+	       arena_size(n, sizeof(size_t)) +
+	       arena_size(2 * n, sizeof(double));
+}
+
+/**
+ * @brief Solves a system approximately, in double precision.
+ *
+ * The refinement stops early once the corrections are negligible. The
+ * factors and the residual are allocated from an arena, and released from
+ * it on return.
+ *
+ * @param[in] system The system to solve, as a square augmented matrix.
+ * @param[in] refinement_steps The maximum number of refinement steps.
+ * @param[in, out] scratch The arena to allocate from, with the room given by
+ * float_solve_arena_size().
+ * @param[out] solution Where to store the value of each unknown.
+ * @param[out] largest_residual Where to store the largest residual of the
+ * solution, once the system is solved.
+ * @param[out] error Where to describe why the system could not be solved,
+ * or NULL.
+ *
+ * @return Whether the system could be solved.
+ */
+bool
+float_solve(const integer_matrix *const system, const size_t refinement_steps,
+            arena *const scratch, double *const solution,
+            double *const largest_residual, char *const error)
+{
+	const size_t n = system->n_lines;
+	const size_t position = arena_position(scratch);
+	lu_factorization lu;
+	lu.size = n;
+	lu.data = NULL;
+	lu.permutation = NULL;
+	if (n == 0 || n <= SIZE_MAX / n) {
+		lu.data = arena_alloc(scratch, n * n, sizeof(double));
+		lu.permutation = arena_alloc(scratch, n, sizeof(size_t));
+	}
+	double *residual = arena_alloc(scratch, 2 * n, sizeof(double));
+	if (lu.data == NULL || lu.permutation == NULL || residual == NULL) {
+		report_error(error, "the memory was not allocated");
+		arena_rewind(scratch, position);
+		return false;
+	}
+	double *correction = residual + n;
+
+	bool solved = lu_factorise(&lu, system);
+	if (!solved) {
+		report_error(error, "the system is singular");
+	} else {
+		for (size_t i = 0; i < n; i++) {
+			residual[i] = (double)integer_matrix_line(system, i)[n];
+		}
+		lu_solve(&lu, residual, solution);
+
+		for (size_t step = 0; step < refinement_steps; step++) {
+			compute_residual(system, solution, residual);
+			lu_solve(&lu, residual, correction);
+			double largest_correction = 0;
+			double largest_value = 0;
+			for (size_t i = 0; i < n; i++) {
+				solution[i] += correction[i];
+				if (magnitude(correction[i]) >
+				    largest_correction) {
+					largest_correction =
+					    magnitude(correction[i]);
+				}
+				if (magnitude(solution[i]) > largest_value) {
+					largest_value = magnitude(solution[i]);
+				}
+			}
+			if (largest_correction <= DBL_EPSILON * largest_value) {
+				break;
+			}
+		}
+		*largest_residual =
+		    compute_residual(system, solution, residual);
+	}
+
+	arena_rewind(scratch, position);
+	return solved;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file floating.h
+ * @brief Definitions for floating.c
+ * @see floating.c
+ */
+
+#ifndef FLOATING_H
+#define FLOATING_H
+
+#include "arena.h"
+#include "matrix.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief An LU factorisation with partial pivoting, in double precision.
+ *
+ * Both factors share a single row-major buffer: L is below the diagonal, with
+ * an implicit unit diagonal, and U is on and above it.
+ */
+struct lu_factorization {
+	/** The factors, stored line after line */
+	double *data;
+	/** The number of lines and columns of the factorised matrix */
+	size_t size;
+	/** The line of the original matrix at each line of the factors */
+	size_t *permutation;
+};
+
+/**
+ * @brief Definition of a type from the lu_factorization structure.
+ * @see struct lu_factorization
+ */
+typedef struct lu_factorization lu_factorization;
+
+bool lu_init(lu_factorization *const, const size_t);
+void lu_free(lu_factorization *const);
+bool lu_factorise(lu_factorization *const, const integer_matrix *const);
+void lu_solve(const lu_factorization *const, const double *const,
+              double *const);
+size_t float_solve_arena_size(const size_t);
+bool float_solve(const integer_matrix *const, const size_t, arena *const,
+                 double *const, double *const, char *const);
+
+#endif /* FLOATING_H */
@@ -8,7 +8,8 @@
  */
 #include "fractions.h"
 
-#include <assert.h>
+#include "stats.h"
+
 #include <limits.h>
 #include <stdlib.h>
 
@@ -18,22 +19,149 @@
  * @brief Gives the GCD of two _positive_ integers.
  *
  * Computes the greatest commom divisor (GCD) of the two integers using the
- * Euclidian algorithm.
+ * binary (Stein's) algorithm.
  *
  * @param[in] a One of the integers to compute the GCD of.
  * @param[in] b One of the integers to compute the GCD of.
  *
  * @return The GCD of its inputs.
  */
+/*
+ * Counting the trailing zeros removes all the factors of two at once, and the
+ * loop is only made of subtractions and shifts: it avoids the integer
+ * divisions of Euclid's algorithm, which are several times slower. A single
+ * division is still done first when the inputs have very different
+ * magnitudes, since subtracting a small number from a much bigger one would
+ * take many iterations.
+ */
 static uint32_t
 gcd(uint32_t a, uint32_t b)
 {
-	while (b != 0) {
-		uint32_t t = b;
-		b = a % b;
-		a = t;
+	STATS_ADD(gcd_calls, 1);
+	if (a < b) {
+		uint32_t t = a;
+		a = b;
+		b = t;
+	}
+	if (b == 0) {
+		return a;
+	}
+	if ((a >> 6) > b) {
+		a %= b;
+		if (a == 0) {
+			return b;
+		}
+	}
+	/* The common factors of two */
+	int shift = __builtin_ctz(a | b);
+	a >>= __builtin_ctz(a);
+	b >>= __builtin_ctz(b);
+	/* Both are now odd: their difference is even */
+	uint64_t iterations = 0;
+	while (a != b) {
+		uint32_t difference = a > b ? a - b : b - a;
+		b = a < b ? a : b;
+		a = difference >> __builtin_ctz(difference);
+		iterations++;
+	}
+	STATS_ADD(gcd_iterations, iterations);
+	return a << shift;
+}
+
+/**
+ * @brief Gives the GCD of two _positive_ 64-bit integers.
+ *
+ * @see gcd
+ *
+ * @param[in] a One of the integers to compute the GCD of.
+ * @param[in] b One of the integers to compute the GCD of.
+ *
+ * @return The GCD of its inputs.
+ */
+uint64_t
+gcd_u64(uint64_t a, uint64_t b)
+{
+	STATS_ADD(gcd_calls, 1);
+	if (a < b) {
+		uint64_t t = a;
+		a = b;
+		b = t;
+	}
+	if (b == 0) {
+		return a;
+	}
+	if ((a >> 6) > b) {
+		a %= b;
+		if (a == 0) {
+			return b;
+		}
+	}
+	int shift = __builtin_ctzll(a | b);
+	a >>= __builtin_ctzll(a);
+	b >>= __builtin_ctzll(b);
+	uint64_t iterations = 0;
+	while (a != b) {
+		uint64_t difference = a > b ? a - b : b - a;
+		b = a < b ? a : b;
+		a = difference >> __builtin_ctzll(difference);
+		iterations++;
+	}
+	STATS_ADD(gcd_iterations, iterations);
+	return a << shift;
+}
+
+/**
+ * @brief Gives the absolute value of a 64-bit integer, as an unsigned integer.
+ *
+ * Contrary to `llabs`, this is defined for `INT64_MIN`.
+ *
+ * @param[in] input The integer to get the magnitude of.
+ *
+ * @return The magnitude of `input`.
+ */
+static uint64_t
+magnitude_u64(int64_t input)
+{
+	/* Same trick as in fraction_from_int() */
+	return input < 0 ? (uint64_t)(-(input + 1)) + 1 : (uint64_t)input;
+}
+
+/**
+ * @brief Stores a fraction given by 64-bit terms, if it fits.
+ *
+ * The terms are reduced on 64 bits only if they do not already fit in a
+ * @ref fraction, the common case being reduced with 32-bit operations.
+ *
+ * @param[in] negative Whether the fraction is negative.
+ * @param[in] numerator The magnitude of the numerator.
+ * @param[in] denominator The (non-zero) denominator.
+ * @param[out] result Where to store the reduced fraction.
+ *
+ * @return Whether the fraction could be represented. If not, *result is not
+ * modified.
+ */
+static bool
+store_reduced(const bool negative, uint64_t numerator, uint64_t denominator,
+              fraction *const result)
+{
+	bool reduced = false;
+	if (numerator > UINT32_MAX || denominator > UINT32_MAX) {
+		/* Reducing may bring the terms back to 32 bits */
+		uint64_t divisor = gcd_u64(numerator, denominator);
+		numerator /= divisor;
+		denominator /= divisor;
+		if (numerator > UINT32_MAX || denominator > UINT32_MAX) {
+			return false;
+		}
+		reduced = true;
 	}
-	return a;
+	result->negative = negative && numerator != 0;
+	result->numerator = (uint32_t)numerator;
+	result->denominator = (uint32_t)denominator;
+	if (!reduced) {
+		simplify_fraction(result);
+	}
+	return true;
 }
 
 /* -- Arithmetic functions -- */
@@ -46,16 +174,27 @@ gcd(uint32_t a, uint32_t b)
  * @param[in] fraction_in1 The product's first term.
  * @param[in] fraction_in2 The product's second term.
  * @param[out] result Where to store the product's result.
+ *
+ * @return Whether the product could be represented. If not, *result is not
+ * modified.
  */
-void
+bool
 multiply_fractions(const fraction *const fraction_in1,
                    const fraction *const fraction_in2, fraction *const result)
 {
-	result->negative = fraction_in1->negative != fraction_in2->negative;
-	result->numerator = fraction_in1->numerator * fraction_in2->numerator;
-	result->denominator =
-	    fraction_in1->denominator * fraction_in2->denominator;
-	simplify_fraction(result);
+	bool negative = fraction_in1->negative != fraction_in2->negative;
+	uint64_t numerator =
+	    (uint64_t)fraction_in1->numerator * fraction_in2->numerator;
+	uint64_t denominator =
+	    (uint64_t)fraction_in1->denominator * fraction_in2->denominator;
+	/* The product of two whole numbers is already reduced */
+	if (denominator == 1 && numerator <= UINT32_MAX) {
+		result->negative = negative && numerator != 0;
+		result->numerator = (uint32_t)numerator;
+		result->denominator = 1;
+		return true;
+	}
+	return store_reduced(negative, numerator, denominator, result);
 }
 
 /**
@@ -70,12 +209,15 @@ multiply_fractions(const fraction *const fraction_in1,
  * @param[in] fraction2 The subtraction's second term (the fraction being
  * subtracted).
  * @param[out] result Where to store the subtraction's result.
+ *
+ * @return Whether the difference could be represented. If not, *result is
+ * not modified.
  */
 /*
- * Using 64-bit integers and downcasting seemed a quite good option to me, no
- * overflow to care about.
+ * The computation is done on 64-bit integers, with every step that could
+ * overflow them checked.
  */
-void
+bool
 subtract_fractions(const fraction *const fraction1,
                    const fraction *const fraction2, fraction *const result)
 {
@@ -84,9 +226,29 @@ subtract_fractions(const fraction *const fraction1,
 	int64_t wide_num2 =
 	    (int64_t)fraction2->numerator * (fraction2->negative ? -1 : 1);
 	int64_t wide_result = 0;
+	uint64_t denominator = 0;
 	if (fraction1->denominator == fraction2->denominator) {
 		wide_result = wide_num1 - wide_num2;
-		result->denominator = fraction1->denominator;
+		denominator = fraction1->denominator;
+	} else if (fraction1->denominator == 1) {
+		/* The LCM is the other denominator, no GCD needed */
+		if (__builtin_mul_overflow(wide_num1, fraction2->denominator,
+		                           &wide_num1) ||
+		    __builtin_sub_overflow(wide_num1, wide_num2,
+		                           &wide_result)) {
+			STATS_ADD(subtract_overflows, 1);
+			return false;
+		}
+		denominator = fraction2->denominator;
+	} else if (fraction2->denominator == 1) {
+		if (__builtin_mul_overflow(wide_num2, fraction1->denominator,
+		                           &wide_num2) ||
+		    __builtin_sub_overflow(wide_num1, wide_num2,
+		                           &wide_result)) {
+			STATS_ADD(subtract_overflows, 1);
+			return false;
+		}
+		denominator = fraction1->denominator;
 	} else {
 		/*
 		 * Divide by the LCM (least common multiple) to reduce the
@@ -95,21 +257,137 @@ subtract_fractions(const fraction *const fraction1,
 		 * because the dividend is always a multiple of the divisor,
 		 * by construction.
 		 */
-		int64_t lcm =
-		    (int64_t)fraction1->denominator /
+		uint64_t lcm =
+		    (uint64_t)fraction1->denominator /
 		    gcd(fraction1->denominator, fraction2->denominator) *
 		    fraction2->denominator;
-		wide_result = wide_num1 * (lcm / fraction1->denominator) -
-		              wide_num2 * (lcm / fraction2->denominator);
-		result->denominator = (uint32_t)lcm;
-	}
-	result->negative = (wide_result < 0);
-	/* This should always be true, but the compiler needs convincing */
-	assert(wide_result < (int64_t)UINT_MAX ||
-	       wide_result > (int64_t)UINT_MAX * -1);
-	result->numerator =
-	    (uint32_t)(wide_result < 0 ? -wide_result : wide_result);
-	simplify_fraction(result);
+		if (__builtin_mul_overflow(wide_num1,
+		                           lcm / fraction1->denominator,
+		                           &wide_num1) ||
+		    __builtin_mul_overflow(wide_num2,
+		                           lcm / fraction2->denominator,
+		                           &wide_num2) ||
+		    __builtin_sub_overflow(wide_num1, wide_num2,
+		                           &wide_result)) {
+			STATS_ADD(subtract_overflows, 1);
+			return false;
+		}
+		denominator = lcm;
+	}
+	const uint64_t magnitude = magnitude_u64(wide_result);
+	if (magnitude > UINT32_MAX || denominator > UINT32_MAX) {
+		STATS_ADD(subtract_near_overflows, 1);
+	}
+	if (!store_reduced(wide_result < 0, magnitude, denominator, result)) {
+		STATS_ADD(subtract_overflows, 1);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Computes `minuend` - `factor` \f$\times\f$ `term` on 64 bits.
+ *
+ * @see submul_fractions
+ *
+ * @param[in] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ * @param[out] result Where to store the result. It may alias `minuend`.
+ *
+ * @return Whether the result could be computed without overflowing. If not,
+ * *result is not modified.
+ */
+static bool
+submul_fractions_wide(const fraction *const minuend,
+                      const fraction *const factor, const fraction *const term,
+                      fraction *const result)
+{
+	/* The product, not reduced: it has at most 64 bits */
+	uint64_t product_num = (uint64_t)factor->numerator * term->numerator;
+	uint64_t product_den =
+	    (uint64_t)factor->denominator * term->denominator;
+
+	int64_t left = 0;
+	int64_t right = 0;
+	uint64_t denominator = 0;
+	if (__builtin_mul_overflow(minuend->numerator, product_den, &left) ||
+	    __builtin_mul_overflow(product_num, minuend->denominator,
+	                           &right) ||
+	    __builtin_mul_overflow(minuend->denominator, product_den,
+	                           &denominator)) {
+		return false;
+	}
+	if (minuend->negative) {
+		left = -left;
+	}
+	if (factor->negative != term->negative) {
+		right = -right;
+	}
+	int64_t difference = 0;
+	if (__builtin_sub_overflow(left, right, &difference)) {
+		return false;
+	}
+
+	/* The only normalisation */
+	uint64_t magnitude = magnitude_u64(difference);
+	if (magnitude == 0) {
+		denominator = 1;
+	} else if (denominator != 1) {
+		uint64_t divisor = gcd_u64(magnitude, denominator);
+		magnitude /= divisor;
+		denominator /= divisor;
+	}
+	if (magnitude > UINT32_MAX || denominator > UINT32_MAX) {
+		return false;
+	}
+	result->negative = difference < 0;
+	result->numerator = (uint32_t)magnitude;
+	result->denominator = (uint32_t)denominator;
+	return true;
+}
+
+/**
+ * @brief Subtracts the product of two fractions from a third one.
+ *
+ * Performs `minuend` - `factor` \f$\times\f$ `term` in a single step: the
+ * whole expression is computed on 64 bits and reduced once, instead of
+ * reducing the product and then the difference. The result is stored in
+ * simplified form.
+ *
+ * If an intermediate value does not fit on 64 bits, the product and the
+ * difference are computed separately with multiply_fractions() and
+ * subtract_fractions().
+ *
+ * @param[in] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ * @param[out] result Where to store the result. It may alias `minuend`.
+ *
+ * @return Whether the result could be represented. If not, *result is not
+ * modified.
+ */
+bool
+submul_fractions(const fraction *const minuend, const fraction *const factor,
+                 const fraction *const term, fraction *const result)
+{
+	if (term->numerator == 0 || factor->numerator == 0) {
+		*result = *minuend;
+		return true;
+	}
+	if (submul_fractions_wide(minuend, factor, term, result)) {
+		return true;
+	}
+	/* The single step overflowed 64 bits, or its result 32 bits */
+	STATS_ADD(subtract_near_overflows, 1);
+	fraction product = {0};
+	fraction difference = {0};
+	if (!multiply_fractions(factor, term, &product) ||
+	    !subtract_fractions(minuend, &product, &difference)) {
+		return false;
+	}
+	*result = difference;
+	return true;
 }
 
 /**
@@ -156,6 +434,7 @@ compare_fractions(const fraction *const f_a, const fraction *const f_b)
 bool
 simplify_fraction(fraction *const f)
 {
+	STATS_ADD(simplify_calls, 1);
 	/* If the fraction is equal to zero, we chose to force the
 	 * denominator to 1, make it positive and consider it reduced */
 	if (f->numerator == 0) {
@@ -163,10 +442,15 @@ simplify_fraction(fraction *const f)
 		f->denominator = 1;
 		return true;
 	}
+	/* Whole numbers and unit fractions cannot be reduced */
+	if (f->denominator == 1 || f->numerator == 1) {
+		return false;
+	}
 	uint32_t divisor = gcd(f->numerator, f->denominator);
 	if (divisor == 1) {
 		return false;
 	} else {
+		STATS_ADD(simplify_hits, 1);
 		f->numerator /= divisor;
 		f->denominator /= divisor;
 		return true;
@@ -237,3 +521,30 @@ fraction_from_int(int32_t input, fraction *const output)
 		output->numerator = input;
 	}
 }
+
+/**
+ * @brief Convert the quotient of two integers to an equivalent fraction.
+ *
+ * The quotient is reduced before being stored, so that values whose terms do
+ * not fit in 32 bits are still converted if their reduced form does.
+ *
+ * @warning If the denominator is 0 or if the reduced fraction does not fit
+ * in a @ref fraction, the value of *output is not modified.
+ *
+ * @param[in] numerator The dividend of the quotient.
+ * @param[in] denominator The divisor of the quotient.
+ * @param[out] output The fraction to initialise.
+ *
+ * @return Whether the quotient could be represented.
+ */
+bool
+fraction_from_quotient(int64_t numerator, int64_t denominator,
+                       fraction *const output)
+{
+	if (denominator == 0) {
+		return false;
+	}
+	return store_reduced((numerator < 0) != (denominator < 0),
+	                     magnitude_u64(numerator),
+	                     magnitude_u64(denominator), output);
+}
@@ -40,14 +40,18 @@ struct fraction {
  */
 typedef struct fraction fraction;
 
-void multiply_fractions(const fraction *const, const fraction *const,
+uint64_t gcd_u64(uint64_t, uint64_t);
+bool multiply_fractions(const fraction *const, const fraction *const,
                         fraction *const);
-void subtract_fractions(const fraction *const, const fraction *const,
+bool subtract_fractions(const fraction *const, const fraction *const,
                         fraction *const);
+bool submul_fractions(const fraction *const, const fraction *const,
+                      const fraction *const, fraction *const);
 int compare_fractions(const fraction *const, const fraction *const);
 bool simplify_fraction(fraction *const);
 void invert_fraction(const fraction *const, fraction *const);
 char fraction_sign_as_character(const fraction *const);
 void fraction_from_int(int32_t, fraction *const);
+bool fraction_from_quotient(int64_t, int64_t, fraction *const);
 
 #endif /* FRACTIONS_H */
@@ -0,0 +1,464 @@
+/**
+ * @file kernels.c
+ * @brief Vectorised operations on lines of fractions.
+ *
+ * The operations on a @ref fraction are too irregular to be vectorised in
+ * general: each one ends with a GCD whose length depends on the values. The
+ * kernels of this file instead vectorise the common cases on whole lines
+ * stored as @ref fraction_row structures, and hand the other elements over to
+ * the scalar functions of fractions.c, which remain the reference.
+ *
+ * The multiply-subtract of the elimination is vectorised when the factor and
+ * the elements are whole numbers, which needs no GCD at all. The lines of
+ * the matrix are copied into @ref fraction_row structures for it, as long as
+ * none of their values is promoted.
+ *
+ * Each kernel exists in portable C, SSE4.2 and AVX2. The best version the
+ * processor supports is chosen the first time a kernel is called.
+ */
+
+#include "kernels.h"
+
+#include "tiered.h"
+
+#include <immintrin.h>
+#include <pthread.h>
+
+/** @brief The type of the implementations of row_submul(). */
+typedef size_t submul_kernel(fraction_row *const, const fraction *const,
+                             const fraction_row *const, const size_t,
+                             const size_t);
+
+/* -- Portable kernels -- */
+
+/**
+ * @brief Subtracts a multiple of a line from another, one element at a time.
+ *
+ * @see row_submul
+ */
+static size_t
+submul_scalar(fraction_row *const row, const fraction *const factor,
+              const fraction_row *const pivot, const size_t first,
+              const size_t end)
+{
+	for (size_t j = first; j < end; j++) {
+		fraction minuend = {0};
+		fraction term = {0};
+		fraction_row_get(row, j, &minuend);
+		fraction_row_get(pivot, j, &term);
+		if (!submul_fractions(&minuend, factor, &term, &minuend)) {
+			return j;
+		}
+		fraction_row_set(row, j, &minuend);
+	}
+	return end;
+}
+
+/* -- SSE4.2 kernels -- */
+
+/**
+ * @brief Loads two 32-bit terms into 64-bit lanes.
+ *
+ * @param[in] terms The terms to load.
+ *
+ * @return The zero-extended terms.
+ */
+__attribute__((target("sse4.2"))) static inline __m128i
+load2(const uint32_t *const terms)
+{
+	return _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i *)terms));
+}
+
+/**
+ * @brief Loads two signs into 64-bit masks.
+ *
+ * @param[in] negatives The signs to load, as 0 or 1.
+ *
+ * @return All ones in the lanes of the negative signs, zero in the others.
+ */
+__attribute__((target("sse4.2"))) static inline __m128i
+load_signs2(const uint32_t *const negatives)
+{
+	return _mm_sub_epi64(_mm_setzero_si128(), load2(negatives));
+}
+
+/**
+ * @brief Stores the low halves of two 64-bit lanes.
+ *
+ * @param[out] terms Where to store the terms.
+ * @param[in] lanes The lanes to store.
+ */
+__attribute__((target("sse4.2"))) static inline void
+store2(uint32_t *const terms, const __m128i lanes)
+{
+	_mm_storel_epi64((__m128i *)terms, _mm_shuffle_epi32(lanes, 0x08));
+}
+
+/**
+ * @brief Negates the lanes of a vector selected by a mask.
+ *
+ * @param[in] x The lanes to negate.
+ * @param[in] mask All ones in the lanes to negate, zero in the others.
+ *
+ * @return The lanes, negated where the mask is set.
+ */
+__attribute__((target("sse4.2"))) static inline __m128i
+negate_where2(const __m128i x, const __m128i mask)
+{
+	return _mm_sub_epi64(_mm_xor_si128(x, mask), mask);
+}
+
+/**
+ * @brief Subtracts a multiple of a line from another, two elements at a time.
+ *
+ * @see row_submul
+ */
+__attribute__((target("sse4.2"))) static size_t
+submul_sse4(fraction_row *const row, const fraction *const factor,
+            const fraction_row *const pivot, const size_t first,
+            const size_t end)
+{
+	if (factor->denominator != 1) {
+		return submul_scalar(row, factor, pivot, first, end);
+	}
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi64x(1);
+	const __m128i limit = _mm_set1_epi64x(UINT32_MAX);
+	const __m128i f = _mm_set1_epi64x(factor->numerator);
+	const __m128i f_negative = _mm_set1_epi64x(-(int64_t)factor->negative);
+	size_t j = first;
+	for (; j + 2 <= end; j += 2) {
+		/* Zero where both denominators are 1 */
+		__m128i fractional = _mm_or_si128(
+		    _mm_xor_si128(load2(row->denominators + j), ones),
+		    _mm_xor_si128(load2(pivot->denominators + j), ones));
+		__m128i m_negative = load_signs2(row->negatives + j);
+		__m128i p_negative = load_signs2(pivot->negatives + j);
+
+		/* Beyond 2^33, the product cannot be compensated */
+		__m128i product =
+		    _mm_mul_epu32(f, load2(pivot->numerators + j));
+		__m128i too_big = _mm_srli_epi64(product, 33);
+		product = negate_where2(product,
+		                        _mm_xor_si128(f_negative, p_negative));
+		__m128i minuend =
+		    negate_where2(load2(row->numerators + j), m_negative);
+		__m128i result = _mm_sub_epi64(minuend, product);
+		__m128i negative = _mm_cmpgt_epi64(zero, result);
+		result = negate_where2(result, negative);
+
+		__m128i fails = _mm_or_si128(
+		    _mm_or_si128(too_big, _mm_cmpgt_epi64(result, limit)),
+		    fractional);
+		if (!_mm_testz_si128(fails, fails)) {
+			size_t stop =
+			    submul_scalar(row, factor, pivot, j, j + 2);
+			if (stop != j + 2) {
+				return stop;
+			}
+			continue;
+		}
+		store2(row->numerators + j, result);
+		store2(row->negatives + j, _mm_and_si128(negative, ones));
+	}
+	return submul_scalar(row, factor, pivot, j, end);
+}
+
+/* -- AVX2 kernels -- */
+
+/**
+ * @brief Loads four 32-bit terms into 64-bit lanes.
+ *
+ * @param[in] terms The terms to load.
+ *
+ * @return The zero-extended terms.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+load4(const uint32_t *const terms)
+{
+	return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)terms));
+}
+
+/**
+ * @brief Loads four signs into 64-bit masks.
+ *
+ * @see load_signs2
+ */
+__attribute__((target("avx2"))) static inline __m256i
+load_signs4(const uint32_t *const negatives)
+{
+	return _mm256_sub_epi64(_mm256_setzero_si256(), load4(negatives));
+}
+
+/**
+ * @brief Stores the low halves of four 64-bit lanes.
+ *
+ * @param[out] terms Where to store the terms.
+ * @param[in] lanes The lanes to store.
+ */
+__attribute__((target("avx2"))) static inline void
+store4(uint32_t *const terms, const __m256i lanes)
+{
+	const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+	_mm_storeu_si128((__m128i *)terms,
+	                 _mm256_castsi256_si128(
+	                     _mm256_permutevar8x32_epi32(lanes, low_halves)));
+}
+
+/**
+ * @brief Negates the lanes of a vector selected by a mask.
+ *
+ * @param[in] x The lanes to negate.
+ * @param[in] mask All ones in the lanes to negate, zero in the others.
+ *
+ * @return The lanes, negated where the mask is set.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+negate_where4(const __m256i x, const __m256i mask)
+{
+	return _mm256_sub_epi64(_mm256_xor_si256(x, mask), mask);
+}
+
+/**
+ * @brief Subtracts a multiple of a line from another, four elements at a
+ * time.
+ *
+ * @see row_submul
+ */
+__attribute__((target("avx2"))) static size_t
+submul_avx2(fraction_row *const row, const fraction *const factor,
+            const fraction_row *const pivot, const size_t first,
+            const size_t end)
+{
+	if (factor->denominator != 1) {
+		return submul_scalar(row, factor, pivot, first, end);
+	}
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi64x(1);
+	const __m256i limit = _mm256_set1_epi64x(UINT32_MAX);
+	const __m256i f = _mm256_set1_epi64x(factor->numerator);
+	const __m256i f_negative =
+	    _mm256_set1_epi64x(-(int64_t)factor->negative);
+	size_t j = first;
+	for (; j + 4 <= end; j += 4) {
+		/* Zero where both denominators are 1 */
+		__m256i fractional = _mm256_or_si256(
+		    _mm256_xor_si256(load4(row->denominators + j), ones),
+		    _mm256_xor_si256(load4(pivot->denominators + j), ones));
+		__m256i m_negative = load_signs4(row->negatives + j);
+		__m256i p_negative = load_signs4(pivot->negatives + j);
+
+		/* Beyond 2^33, the product cannot be compensated */
+		__m256i product =
+		    _mm256_mul_epu32(f, load4(pivot->numerators + j));
+		__m256i too_big = _mm256_srli_epi64(product, 33);
+		product = negate_where4(
+		    product, _mm256_xor_si256(f_negative, p_negative));
+		__m256i result = _mm256_sub_epi64(
+		    negate_where4(load4(row->numerators + j), m_negative),
+		    product);
+		__m256i negative = _mm256_cmpgt_epi64(zero, result);
+		result = negate_where4(result, negative);
+
+		__m256i fails = _mm256_or_si256(
+		    _mm256_or_si256(too_big, _mm256_cmpgt_epi64(result, limit)),
+		    fractional);
+		if (!_mm256_testz_si256(fails, fails)) {
+			size_t stop =
+			    submul_scalar(row, factor, pivot, j, j + 4);
+			if (stop != j + 4) {
+				return stop;
+			}
+			continue;
+		}
+		store4(row->numerators + j, result);
+		store4(row->negatives + j, _mm256_and_si256(negative, ones));
+	}
+	return submul_scalar(row, factor, pivot, j, end);
+}
+
+/* -- Dispatch -- */
+
+/** @brief The implementation of row_submul() in use. */
+static submul_kernel *selected_submul = NULL;
+
+/** @brief Makes sure the kernels are selected only once. */
+static pthread_once_t selection_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Sets the implementation of the kernels.
+ *
+ * @param[in] isa The instruction set to use.
+ */
+static void
+use_kernels(const enum kernel_isa isa)
+{
+	switch (isa) {
+	case KERNEL_SCALAR:
+		selected_submul = submul_scalar;
+		break;
+	case KERNEL_SSE4:
+		selected_submul = submul_sse4;
+		break;
+	case KERNEL_AVX2:
+		selected_submul = submul_avx2;
+		break;
+	}
+}
+
+/**
+ * @brief Selects the best kernels the processor supports.
+ */
+static void
+select_best(void)
+{
+	use_kernels(kernel_best_isa());
+}
+
+/**
+ * @brief Gives the best instruction set the processor supports.
+ *
+ * @return The fastest usable implementation of the kernels.
+ */
+enum kernel_isa
+kernel_best_isa(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return KERNEL_AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		return KERNEL_SSE4;
+	}
+	return KERNEL_SCALAR;
+}
+
+/**
+ * @brief Chooses the implementation of the kernels.
+ *
+ * The best one is chosen automatically, this is only needed to compare them.
+ * It must not be called while a kernel is running.
+ *
+ * @param[in] isa The instruction set to use.
+ *
+ * @return Whether the processor supports the instruction set. The kernels
+ * are left unchanged if not.
+ */
+bool
+kernel_select(const enum kernel_isa isa)
+{
+	if (isa > kernel_best_isa()) {
+		return false;
+	}
+	/* The automatic selection must not override this one later */
+	pthread_once(&selection_once, select_best);
+	use_kernels(isa);
+	return true;
+}
+
+/* -- Public functions -- */
+
+/**
+ * @brief Gives the room a line of fractions needs in an arena.
+ *
+ * @param[in] length The number of elements of the line.
+ *
+ * @return The number of bytes, or SIZE_MAX if it overflows.
+ */
+size_t
+fraction_row_arena_size(const size_t length)
+{
+	const size_t size = arena_size(length, sizeof(uint32_t));
+	return size > SIZE_MAX / 3 ? SIZE_MAX : 3 * size;
+}
+
+/**
+ * @brief Allocates a line of fractions from an arena.
+ *
+ * The elements are not initialised. The arrays are aligned on the arena's
+ * cache lines.
+ *
+ * @param[out] row The line to initialise.
+ * @param[in, out] a The arena to allocate from, with the room given by
+ * fraction_row_arena_size().
+ * @param[in] length The number of elements of the line.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+fraction_row_alloc(fraction_row *const row, arena *const a,
+                   const size_t length)
+{
+	row->numerators = arena_alloc(a, length, sizeof(uint32_t));
+	row->denominators = arena_alloc(a, length, sizeof(uint32_t));
+	row->negatives = arena_alloc(a, length, sizeof(uint32_t));
+	row->length = length;
+	return row->numerators != NULL && row->denominators != NULL &&
+	       row->negatives != NULL;
+}
+
+/**
+ * @brief Copies part of a line of a matrix into a line of fractions.
+ *
+ * @param[out] row The line to fill, at the same indices as `line`.
+ * @param[in] line The elements to copy.
+ * @param[in] first The index of the first element to copy.
+ * @param[in] end The index of the element after the last one to copy.
+ *
+ * @return Whether the elements were copied. A promoted element cannot be,
+ * and the line of fractions is then left partly filled.
+ */
+bool
+fraction_row_load(fraction_row *const row, const fraction *const line,
+                  const size_t first, const size_t end)
+{
+	for (size_t j = first; j < end; j++) {
+		if (fraction_is_wide(&line[j])) {
+			return false;
+		}
+		fraction_row_set(row, j, &line[j]);
+	}
+	return true;
+}
+
+/**
+ * @brief Copies part of a line of fractions back into a line of a matrix.
+ *
+ * @param[in] row The line to copy.
+ * @param[out] line Where to copy the elements, at the same indices.
+ * @param[in] first The index of the first element to copy.
+ * @param[in] end The index of the element after the last one to copy.
+ */
+void
+fraction_row_store(const fraction_row *const row, fraction *const line,
+                   const size_t first, const size_t end)
+{
+	for (size_t j = first; j < end; j++) {
+		fraction_row_get(row, j, &line[j]);
+	}
+}
+
+/**
+ * @brief Subtracts a multiple of a line from another, in place.
+ *
+ * Performs `row` -= `factor` \f$\times\f$ `pivot` on the elements from
+ * `first` to `end` excluded, with the same results as submul_fractions().
+ * Like it, it stops at the first element whose result overflows.
+ *
+ * @param[in, out] row The line being subtracted from.
+ * @param[in] factor The fraction to multiply `pivot` by.
+ * @param[in] pivot The line being subtracted.
+ * @param[in] first The index of the first element to update.
+ * @param[in] end The index of the element after the last one to update.
+ *
+ * @return The index of the element that overflowed, which is left
+ * unmodified along with the following ones, or `end` if none did.
+ */
+size_t
+row_submul(fraction_row *const row, const fraction *const factor,
+           const fraction_row *const pivot, const size_t first,
+           const size_t end)
+{
+	pthread_once(&selection_once, select_best);
+	return selected_submul(row, factor, pivot, first, end);
+}
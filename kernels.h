@@ -0,0 +1,97 @@
+/**
+ * @file kernels.h
+ * @brief Definitions for kernels.c
+ * @see kernels.c
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "arena.h"
+#include "fractions.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The instruction sets the kernels are implemented with.
+ */
+enum kernel_isa {
+	/** Portable C, one element at a time */
+	KERNEL_SCALAR,
+	/** SSE4.2, two elements at a time */
+	KERNEL_SSE4,
+	/** AVX2, four elements at a time */
+	KERNEL_AVX2,
+};
+
+/**
+ * @brief A line of fractions, stored as a structure of arrays.
+ *
+ * Each term of the fractions has its own array, so that several elements can
+ * be processed by a single instruction. The signs
+ * take 32 bits, like the other terms, to stay in the same lanes.
+ */
+struct fraction_row {
+	/** The numerators of the fractions */
+	uint32_t *numerators;
+	/** The denominators of the fractions */
+	uint32_t *denominators;
+	/** Whether each fraction is negative, as 0 or 1 */
+	uint32_t *negatives;
+	/** The number of fractions */
+	size_t length;
+};
+
+/**
+ * @brief Definition of a type from the fraction_row structure.
+ * @see struct fraction_row
+ */
+typedef struct fraction_row fraction_row;
+
+size_t fraction_row_arena_size(const size_t);
+bool fraction_row_alloc(fraction_row *const, arena *const, const size_t);
+bool fraction_row_load(fraction_row *const, const fraction *const,
+                       const size_t, const size_t);
+void fraction_row_store(const fraction_row *const, fraction *const,
+                        const size_t, const size_t);
+
+enum kernel_isa kernel_best_isa(void);
+bool kernel_select(const enum kernel_isa);
+size_t row_submul(fraction_row *const, const fraction *const,
+                  const fraction_row *const, const size_t, const size_t);
+
+/**
+ * @brief Gives an element of a line of fractions.
+ *
+ * @param[in] row The line to read.
+ * @param[in] index The index of the element.
+ * @param[out] f Where to store the element.
+ */
+static inline void
+fraction_row_get(const fraction_row *const row, const size_t index,
+                 fraction *const f)
+{
+	f->negative = row->negatives[index] != 0;
+	f->numerator = row->numerators[index];
+	f->denominator = row->denominators[index];
+}
+
+/**
+ * @brief Sets an element of a line of fractions.
+ *
+ * @param[in, out] row The line to modify.
+ * @param[in] index The index of the element.
+ * @param[in] f The value to give it.
+ */
+static inline void
+fraction_row_set(fraction_row *const row, const size_t index,
+                 const fraction *const f)
+{
+	row->negatives[index] = f->negative;
+	row->numerators[index] = f->numerator;
+	row->denominators[index] = f->denominator;
+}
+
+#endif /* KERNELS_H */
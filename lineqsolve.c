@@ -0,0 +1,1706 @@
+/**
+ * @file lineqsolve.c
+ * @brief The public interface of the solver library.
+ *
+ * A @ref solver keeps the memory of the last system loaded in an arena, so
+ * that loading the next one only allocates when it is bigger. The engines
+ * themselves are in their own files, and the elimination on fractions in
+ * solver.c.
+ *
+ * @see lineqsolve.h
+ * @see solver.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "solver.h"
+
+#include "bareiss.h"
+#include "floating.h"
+#include "modular.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Creates a solver.
+ *
+ * @param[in] engine The engine that solves the systems.
+ * @param[in] n_threads The number of threads of the fraction engine, 0
+ * standing for 1.
+ *
+ * @return The solver, to be given to solver_destroy(), or NULL if the memory
+ * could not be allocated.
+ */
+solver *
+solver_create(const enum solver_engine engine, const size_t n_threads)
+{
+	solver *s = calloc(1, sizeof(solver));
+	if (s == NULL) {
+		return NULL;
+	}
+	s->engine = engine;
+	s->n_threads = n_threads == 0 ? 1 : n_threads;
+	s->n_rhs = 1;
+	wide_table_init(&s->table);
+	return s;
+}
+
+/**
+ * @brief Releases the copy of the system of a solver and the memory of its
+ * updates.
+ *
+ * @param[in, out] s The solver.
+ */
+static void
+free_updates(solver *const s)
+{
+	free(s->system);
+	free(s->updates.columns);
+	free(s->updates.rows);
+	free(s->updates.pivots);
+	s->system = NULL;
+	s->updates.count = 0;
+	s->updates.columns = NULL;
+	s->updates.rows = NULL;
+	s->updates.pivots = NULL;
+}
+
+/**
+ * @brief Releases a solver and all its memory.
+ *
+ * @param[in] s The solver, or NULL.
+ */
+void
+solver_destroy(solver *const s)
+{
+	if (s == NULL) {
+		return;
+	}
+	matrix_free(&s->matrix);
+	integer_matrix_free(&s->integer_matrix);
+	sparse_free(&s->sparse);
+	wide_table_free(&s->table);
+	arena_free(&s->arena);
+	free(s->inverse);
+	free_updates(s);
+	free(s);
+}
+
+/**
+ * @brief Sets the maximum number of refinement steps of the floating-point
+ * engine, 0 by default.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] steps The maximum number of steps.
+ */
+void
+solver_set_refinement(solver *const s, const size_t steps)
+{
+	s->refinement_steps = steps;
+}
+
+/**
+ * @brief Sets whether the fraction engine always solves the systems as
+ * sparse ones.
+ *
+ * Otherwise, only the systems with few non-zero coefficients are.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] sparse Whether the sparse elimination is always used.
+ */
+void
+solver_set_sparse(solver *const s, const bool sparse)
+{
+	s->force_sparse = sparse;
+}
+
+/**
+ * @brief Sets whether the fraction engine eliminates the dense systems with
+ * the Gauss-Jordan method.
+ *
+ * By default, the system is brought to a row-echelon form, and the
+ * constants are then back-substituted. The Gauss-Jordan method eliminates
+ * the lines above each pivot as well, for about half as many operations
+ * again: it is kept to compare both.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] jordan Whether the Gauss-Jordan method is used.
+ */
+void
+solver_set_gauss_jordan(solver *const s, const bool jordan)
+{
+	s->gauss_jordan = jordan;
+}
+
+/**
+ * @brief Sets the number of pivots the fraction engine eliminates together
+ * in the dense systems.
+ *
+ * By default, or with 0 or 1, each pivot is applied to the whole of the
+ * lines below it in turn. With blocks, the columns of a block are
+ * eliminated first, then its pivots are applied together to the rest of
+ * the lines, a cache-sized tile at a time. The solution is the same. The
+ * Gauss-Jordan method and the factorisation eliminate one pivot at a time.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] block_size The number of pivots of a block.
+ */
+void
+solver_set_block_size(solver *const s, const size_t block_size)
+{
+	s->block_size = block_size;
+}
+
+/**
+ * @brief Sets how the fraction engine chooses the pivots of the dense
+ * systems, PIVOTING_GREATEST by default.
+ *
+ * The sparse elimination keeps its own criterion, which limits the
+ * fill-in.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] pivoting The strategy.
+ */
+void
+solver_set_pivoting(solver *const s, const enum solver_pivoting pivoting)
+{
+	s->pivoting = pivoting;
+}
+
+/**
+ * @brief Sets the number of right-hand sides of the systems loaded next, 1
+ * by default.
+ *
+ * The constants of each side follow the coefficients of the unknowns, in as
+ * many columns, and the solutions of all the sides are given one after the
+ * other. Only the fraction engine solves several sides at once.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] n_rhs The number of right-hand sides, 0 standing for 1.
+ */
+void
+solver_set_rhs(solver *const s, const size_t n_rhs)
+{
+	s->n_rhs = n_rhs == 0 ? 1 : n_rhs;
+}
+
+/**
+ * @brief Sets whether the fraction engine keeps the LU factorisation of the
+ * systems it solves.
+ *
+ * The systems are then eliminated by an LU factorisation instead of
+ * Gauss-Jordan elimination, and other right-hand sides can be solved by
+ * solver_solve_rhs() without factorising the system again. The
+ * factorisation can also be saved by solver_save_factors(), and gives the
+ * inverse of the system by solver_invert().
+ *
+ * @param[in, out] s The solver.
+ * @param[in] keep Whether the factorisation is kept.
+ */
+void
+solver_set_factors(solver *const s, const bool keep)
+{
+	s->keep_factors = keep;
+}
+
+/**
+ * @brief Sets how many times the fraction engine updates the factorisation
+ * of a system before it factorises it again, 0 by default.
+ *
+ * The factorisation must be kept, by solver_set_factors(). The system is
+ * then kept too, and solver_update_coefficient(), solver_update_line() and
+ * solver_update_column() change it and solve it again in \f$O(n^2)\f$
+ * operations, instead of \f$O(n^3)\f$ for a new factorisation. Each update
+ * makes the next solves slower, and its values grow: after the limit, the
+ * changed system is factorised from scratch.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] limit The number of updates, 0 for none.
+ */
+void
+solver_set_updates(solver *const s, const size_t limit)
+{
+	s->updates.limit = limit;
+}
+
+/**
+ * @brief Drops the system of a solver, and prepares its memory for a new
+ * one.
+ *
+ * The matrix the engine uses, the permutation of its factorisation, the
+ * solution and its approximation all come from the arena of the solver. The
+ * lines of the system are then given by solver_store_line().
+ *
+ * @param[in, out] s The solver.
+ * @param[in] n The number of unknowns of the new system.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_INPUT if the system has no unknowns or
+ * several right-hand sides the engine cannot solve, or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_prepare(solver *const s, const size_t n)
+{
+	/* The memory of the previous system is given back at once */
+	matrix_free(&s->matrix);
+	integer_matrix_free(&s->integer_matrix);
+	sparse_free(&s->sparse);
+	wide_table_clear(&s->table);
+	arena_reset(&s->arena);
+	free(s->inverse);
+	free_updates(s);
+	s->n = 0;
+	s->solved = false;
+	s->factored = false;
+	s->eliminated = false;
+	s->echelon = (struct echelon){0, false};
+	s->determinant_known = false;
+	s->inverse = NULL;
+	s->permutation = NULL;
+	s->solution = NULL;
+	s->solution_table = NULL;
+	s->approximations = NULL;
+	s->n_primes = 0;
+	s->residual = 0;
+	s->error[0] = '\0';
+	if (n == 0 || (s->n_rhs > 1 && s->engine != ENGINE_FRACTION)) {
+		return SOLVER_ERROR_INPUT;
+	}
+
+	const size_t n_col = n + s->n_rhs;
+	const size_t n_values = n * s->n_rhs;
+	bool allocated = arena_reserve(
+	    &s->arena, solve_arena_size(s->engine, n, s->n_rhs, s->n_threads));
+	if (allocated && s->engine == ENGINE_FRACTION) {
+		allocated = matrix_init_in(&s->matrix, &s->arena, n, n_col);
+	} else if (allocated) {
+		allocated = integer_matrix_init_in(&s->integer_matrix,
+		                                   &s->arena, n, n_col);
+	}
+	s->permutation =
+	    allocated ? arena_alloc(&s->arena, n, sizeof(size_t)) : NULL;
+	s->solution = allocated ? arena_alloc(&s->arena, n_values,
+	                                      sizeof(fraction))
+	                        : NULL;
+	s->approximations =
+	    allocated ? arena_alloc(&s->arena, n_values, sizeof(double))
+	              : NULL;
+	if (s->permutation == NULL || s->solution == NULL ||
+	    s->approximations == NULL) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	for (size_t i = 0; i < n_values; i++) {
+		fraction_from_int(0, &s->solution[i]);
+		s->approximations[i] = 0;
+	}
+	s->n = n;
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Stores a line of the system of a solver, in the matrix its engine
+ * uses.
+ *
+ * @param[in, out] s The solver, prepared by solver_prepare().
+ * @param[in] line The index of the line.
+ * @param[in] values The coefficients of the line, which fit in 32 bits.
+ */
+void
+solver_store_line(solver *const s, const size_t line,
+                  const int64_t *const values)
+{
+	if (s->engine == ENGINE_FRACTION) {
+		store_line(&s->matrix, line, values);
+	} else {
+		store_integer_line(&s->integer_matrix, line, values);
+	}
+}
+
+/**
+ * @brief Tells whether the memory of a value of a solver could not be
+ * allocated.
+ *
+ * The tables of the promoted values are marked when it happens, and the
+ * computation that used them must be abandoned.
+ *
+ * @param[in] s The solver.
+ *
+ * @return Whether a table of the solver is marked as failed.
+ */
+static bool
+out_of_memory(const solver *const s)
+{
+	return s->matrix.wide.failed || s->sparse.wide.failed ||
+	       s->table.failed;
+}
+
+/**
+ * @brief Reads the solution off the matrix of the fraction engine, once it
+ * is diagonal.
+ *
+ * @param[in, out] s The solver, whose system was eliminated.
+ *
+ * @return SOLVER_OK, or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_read_diagonal(solver *const s)
+{
+	matrix *matrix = &s->matrix;
+	const size_t n = matrix->n_lines;
+	for (size_t i = 0; i < n; i++) {
+		const fraction *line = matrix_line(matrix, i);
+		fraction inverse = {0, 0, 1};
+		tiered_invert(&matrix->wide, &line[i], &inverse);
+		for (size_t r = 0; n + r < matrix->n_col; r++) {
+			tiered_multiply(&matrix->wide, &line[n + r], &inverse,
+			                &s->solution[r * n + i]);
+		}
+		tiered_release(&matrix->wide, &inverse);
+	}
+	s->solution_table = &matrix->wide;
+	s->solved = true;
+	s->status = out_of_memory(s) ? SOLVER_ERROR_MEMORY : SOLVER_OK;
+	return s->status;
+}
+
+/**
+ * @brief Tells whether the fraction engine solves the system of a solver as
+ * a sparse one.
+ *
+ * @param[in] s The solver, with a system loaded.
+ *
+ * @return Whether the sparse elimination is used.
+ */
+bool
+solver_uses_sparse(const solver *const s)
+{
+	/* The sparse elimination only solves a single right-hand side */
+	return s->engine == ENGINE_FRACTION && s->n_rhs == 1 &&
+	       !s->keep_factors && (s->force_sparse || is_sparse(&s->matrix));
+}
+
+/**
+ * @brief Loads a system into a solver.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] n The number of unknowns of the system.
+ * @param[in] coefficients The augmented matrix of the system, line after
+ * line: \f$n\times(n+k)\f$ coefficients for \f$k\f$ right-hand sides,
+ * which must fit in 32 bits.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_INPUT if the system is empty or a
+ * coefficient is too large, or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_load(solver *const s, const size_t n,
+            const int64_t *const coefficients)
+{
+	enum solver_status status = solver_prepare(s, n);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	const size_t n_col = n + s->n_rhs;
+	for (size_t i = 0; i < n * n_col; i++) {
+		if (coefficients[i] < INT32_MIN ||
+		    coefficients[i] > INT32_MAX) {
+			report_error(s->error, "the coefficients of line %zu "
+			             "do not fit in 32 bits", i / n_col + 1);
+			s->n = 0;
+			return SOLVER_ERROR_INPUT;
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		solver_store_line(s, i, coefficients + i * n_col);
+	}
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Loads a system written as text into a solver.
+ *
+ * The text is in the format of the files read by the program: one line of
+ * coefficients per equation, the constants of each right-hand side last.
+ * The triplet format is not accepted.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] text The text of the system, which needs not end with a null
+ * character.
+ * @param[in] length The number of characters of the text.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_INPUT if the text is not a valid system,
+ * or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_load_text(solver *const s, const char *const text,
+                 const size_t length)
+{
+	s->n = 0;
+	s->error[0] = '\0';
+	if (length == 0) {
+		report_error(s->error, "the text is empty");
+		return SOLVER_ERROR_INPUT;
+	}
+	/* The stream is only read from, the text is left untouched */
+	FILE *input = fmemopen((void *)text, length, "r");
+	if (input == NULL) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	line_reader reader;
+	if (!reader_init(&reader, input)) {
+		fclose(input);
+		return SOLVER_ERROR_MEMORY;
+	}
+
+	enum solver_status status = SOLVER_ERROR_INPUT;
+	if (reader_next_line(&reader) == READ_LINE &&
+	    reader.n_values > s->n_rhs &&
+	    check_system_line(&reader, reader.n_values)) {
+		const size_t n = reader.n_values - s->n_rhs;
+		status = solver_prepare(s, n);
+		for (size_t i = 0; status == SOLVER_OK && i < n; i++) {
+			if (i > 0 && !read_system_line(&reader, n + s->n_rhs)) {
+				s->n = 0;
+				status = SOLVER_ERROR_INPUT;
+				break;
+			}
+			solver_store_line(s, i, reader.values);
+		}
+	}
+	if (status == SOLVER_ERROR_INPUT && reader.error[0] != '\0') {
+		report_error(s->error, "%s", reader.error);
+	}
+
+	reader_free(&reader);
+	fclose(input);
+	return status;
+}
+
+/**
+ * @brief Loads a system in the binary format into a solver.
+ *
+ * @param[in, out] s The solver.
+ * @param[in] data The bytes of the binary matrix, header included.
+ * @param[in] size The number of bytes.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_INPUT if the bytes are not the augmented
+ * matrix of a system with coefficients that fit in 32 bits, or
+ * SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_load_binary(solver *const s, const void *const data, const size_t size)
+{
+	s->n = 0;
+	s->error[0] = '\0';
+	binary_matrix binary;
+	const enum binary_status format = binary_parse(&binary, data, size);
+	if (format != BINARY_MATRIX) {
+		report_error(s->error, "%s",
+		             format == BINARY_INVALID ? binary.error
+		                                      : "the data is not a "
+		                                        "binary matrix");
+		return SOLVER_ERROR_INPUT;
+	}
+	if (binary.n_col != binary.n_lines + s->n_rhs) {
+		report_error(s->error,
+		             "the binary matrix has %zu columns instead of %zu",
+		             binary.n_col, binary.n_lines + s->n_rhs);
+		return SOLVER_ERROR_INPUT;
+	}
+	enum solver_status status = solver_prepare(s, binary.n_lines);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	bool loaded =
+	    s->engine == ENGINE_FRACTION
+	        ? load_binary_system(&s->matrix, &binary, s->error)
+	        : load_binary_integer_system(&s->integer_matrix, &binary,
+	                                     s->error);
+	if (!loaded) {
+		s->n = 0;
+		return SOLVER_ERROR_INPUT;
+	}
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Solves the fraction engine's system as a sparse one.
+ *
+ * @param[in, out] s The solver.
+ *
+ * @return The outcome of the solve.
+ */
+static enum solver_status
+solve_sparse(solver *const s)
+{
+	if (!sparse_from_matrix(&s->sparse, &s->matrix)) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	if (!sparse_solve(&s->sparse, s->solution, s->error)) {
+		return SOLVER_ERROR_UNSOLVED;
+	}
+	s->solution_table = &s->sparse.wide;
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Keeps a copy of the system of a solver before it is factorised, if
+ * it is to be updated.
+ *
+ * The copy is made once: the updates change it, and it is factorised again
+ * from it.
+ *
+ * @param[in, out] s The solver, with a system loaded.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+keep_system(solver *const s)
+{
+	const size_t n = s->n;
+	const size_t limit = s->updates.limit;
+	if (limit == 0 || s->system != NULL) {
+		return true;
+	}
+	s->system = malloc(n * s->matrix.n_col * sizeof(int64_t));
+	s->updates.columns = malloc(limit * n * sizeof(fraction));
+	s->updates.rows = malloc(limit * n * sizeof(fraction));
+	s->updates.pivots = malloc(limit * sizeof(fraction));
+	if (s->system == NULL || s->updates.columns == NULL ||
+	    s->updates.rows == NULL || s->updates.pivots == NULL) {
+		free_updates(s);
+		return false;
+	}
+	for (size_t i = 0; i < n; i++) {
+		const fraction *line = matrix_line(&s->matrix, i);
+		int64_t *values = s->system + i * s->matrix.n_col;
+		/* The system was just stored: its values are integers */
+		for (size_t j = 0; j < s->matrix.n_col; j++) {
+			const int64_t value = line[j].numerator;
+			values[j] = line[j].negative ? -value : value;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Finishes with fractions the elimination of a system whose
+ * fraction-free elimination overflowed.
+ *
+ * The integer matrix, equivalent to the system, is copied to the matrix of
+ * the fraction engine, which eliminates it as it eliminates its own systems
+ * and gives the solution. The fraction-free elimination is usually the
+ * faster one, so it is tried first.
+ *
+ * @param[in, out] s The solver, of the Bareiss engine.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_UNSOLVED if the system is singular, or
+ * SOLVER_ERROR_MEMORY.
+ */
+static enum solver_status
+eliminate_with_fractions(solver *const s)
+{
+	const size_t n_col = s->integer_matrix.n_col;
+	if (!matrix_init_in(&s->matrix, &s->arena, s->n, n_col)) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	bareiss_to_fractions(&s->integer_matrix, &s->matrix);
+	struct echelon echelon = {0, false};
+	if (!gaussian_elimination(&s->matrix, s->pivoting, s->block_size,
+	                          s->n_threads, &s->arena, &echelon)) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	if (echelon.rank < s->n) {
+		report_error(s->error, "the system is singular");
+		return SOLVER_ERROR_UNSOLVED;
+	}
+	return out_of_memory(s) ? SOLVER_ERROR_MEMORY : solver_read_diagonal(s);
+}
+
+/**
+ * @brief Eliminates the system of a solver, the first phase of
+ * solver_solve().
+ *
+ * The modular and floating-point engines, the sparse elimination, and the
+ * fraction elimination the Bareiss engine falls back to when its values
+ * overflow, solve the system entirely in this phase.
+ *
+ * @param[in, out] s The solver, with a system loaded and not yet solved.
+ *
+ * The dense elimination of the fraction engine records the rank of the
+ * system and the parity of its line swaps as it goes. A singular system is
+ * reported as soon as it is eliminated, and is not back-substituted: its
+ * rank and determinant are still available.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_UNSOLVED or SOLVER_ERROR_MEMORY. The
+ * solve ends here if it fails.
+ */
+enum solver_status
+solver_eliminate(solver *const s)
+{
+	enum solver_status status = SOLVER_OK;
+	s->error[0] = '\0';
+	switch (s->engine) {
+	case ENGINE_FRACTION:
+		if (solver_uses_sparse(s)) {
+			status = solve_sparse(s);
+			break;
+		}
+		if (s->keep_factors && !keep_system(s)) {
+			status = SOLVER_ERROR_MEMORY;
+			break;
+		}
+		if (s->keep_factors) {
+			s->factored = factorise(&s->matrix, s->pivoting,
+			                        s->permutation, &s->echelon);
+			s->eliminated = true;
+		} else if (s->gauss_jordan) {
+			s->eliminated =
+			    gauss_jordan(&s->matrix, s->pivoting, s->n_threads,
+			                 &s->arena, &s->echelon);
+		} else {
+			s->eliminated = gaussian_elimination(
+			    &s->matrix, s->pivoting, s->block_size,
+			    s->n_threads, &s->arena, &s->echelon);
+		}
+		if (!s->eliminated) {
+			status = SOLVER_ERROR_MEMORY;
+		} else if (s->echelon.rank < s->n) {
+			report_error(s->error, "the system is singular, of "
+			             "rank %zu for %zu unknowns",
+			             s->echelon.rank, s->n);
+			status = SOLVER_ERROR_UNSOLVED;
+		}
+		break;
+	case ENGINE_BAREISS:
+		switch (bareiss_elimination(&s->integer_matrix, s->error)) {
+		case BAREISS_DONE:
+			break;
+		case BAREISS_SINGULAR:
+			status = SOLVER_ERROR_UNSOLVED;
+			break;
+		case BAREISS_OVERFLOW:
+			status = eliminate_with_fractions(s);
+			break;
+		}
+		break;
+	case ENGINE_MODULAR:
+		if (modular_solve(&s->integer_matrix, &s->table, s->solution,
+		                  &s->n_primes, s->error)) {
+			s->solution_table = &s->table;
+		} else {
+			status = SOLVER_ERROR_UNSOLVED;
+		}
+		break;
+	case ENGINE_FLOAT:
+		if (!float_solve(&s->integer_matrix, s->refinement_steps,
+		                 &s->arena, s->approximations, &s->residual,
+		                 s->error)) {
+			status = SOLVER_ERROR_UNSOLVED;
+		}
+		break;
+	}
+	if (out_of_memory(s)) {
+		status = SOLVER_ERROR_MEMORY;
+	}
+	if (status != SOLVER_OK) {
+		s->solved = true;
+		s->status = status;
+	}
+	return status;
+}
+
+/**
+ * @brief Reads the solution off the eliminated system of a solver, the
+ * second phase of solver_solve().
+ *
+ * @param[in, out] s The solver, whose system was eliminated by
+ * solver_eliminate().
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_UNSOLVED if a variable has no pivot, or
+ * SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_substitute(solver *const s)
+{
+	enum solver_status status = SOLVER_OK;
+	if (s->factored) {
+		back_substitute(&s->matrix, s->solution);
+		for (size_t r = 0; r < s->n_rhs; r++) {
+			apply_rank_updates(&s->matrix.wide, &s->updates,
+			                   s->updates.count, s->n,
+			                   s->solution + r * s->n);
+		}
+		s->solution_table = &s->matrix.wide;
+	} else if (s->engine == ENGINE_FRACTION && s->solution_table == NULL) {
+		solver_read_diagonal(s);
+	} else if (s->engine == ENGINE_BAREISS && s->solution_table == NULL) {
+		for (size_t i = 0; status == SOLVER_OK && i < s->n; i++) {
+			if (!bareiss_solution(&s->integer_matrix, i, &s->table,
+			                      &s->solution[i])) {
+				status = SOLVER_ERROR_UNSOLVED;
+			}
+		}
+		s->solution_table = &s->table;
+	}
+	if (status == SOLVER_OK && out_of_memory(s)) {
+		status = SOLVER_ERROR_MEMORY;
+	}
+	if (status == SOLVER_OK && s->engine != ENGINE_FLOAT) {
+		for (size_t i = 0; i < s->n * s->n_rhs; i++) {
+			s->approximations[i] = tiered_to_double(
+			    s->solution_table, &s->solution[i]);
+		}
+	}
+	s->solved = true;
+	s->status = status;
+	return status;
+}
+
+/**
+ * @brief Solves the system of a solver with its engine.
+ *
+ * The matrix of the system is reduced in place: solving it again only gives
+ * back the outcome of the first solve.
+ *
+ * @param[in, out] s The solver, with a system loaded.
+ *
+ * @return SOLVER_OK if the solution is available, SOLVER_ERROR_NO_SYSTEM,
+ * SOLVER_ERROR_UNSOLVED if the engine could not solve the system, or
+ * SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_solve(solver *const s)
+{
+	if (s->n == 0) {
+		return SOLVER_ERROR_NO_SYSTEM;
+	}
+	if (s->solved) {
+		return s->status;
+	}
+	double start = STATS_NOW();
+	enum solver_status status = solver_eliminate(s);
+	STATS_TIME(PHASE_ELIMINATE, start);
+	if (status == SOLVER_OK) {
+		start = STATS_NOW();
+		status = solver_substitute(s);
+		STATS_TIME(PHASE_SUBSTITUTE, start);
+	}
+	return status;
+}
+
+/**
+ * @brief Puts new constants in the factorisation of the system of a solver.
+ *
+ * @param[in, out] s The solver, whose system is factorised.
+ * @param[in] constants The constants of the first line of the system, each
+ * line of constants following the previous one.
+ * @param[in] stride The distance between the constants of two lines.
+ */
+static void
+set_constants(solver *const s, const int64_t *const constants,
+              const size_t stride)
+{
+	const size_t n = s->n;
+	/* The constants are put in the order of the lines of the factors */
+	for (size_t i = 0; i < n; i++) {
+		fraction *line = matrix_line(&s->matrix, i);
+		const int64_t *values = constants + s->permutation[i] * stride;
+		for (size_t r = 0; r < s->n_rhs; r++) {
+			tiered_release(&s->matrix.wide, &line[n + r]);
+			fraction_from_int((int32_t)values[r], &line[n + r]);
+		}
+	}
+}
+
+/**
+ * @brief Solves the factorised system of a solver for other right-hand
+ * sides.
+ *
+ * The factorisation is reused, so that each side only costs
+ * \f$O(n^2)\f$ operations. The solution replaces the previous one.
+ *
+ * @param[in, out] s The solver, whose system was factorised by
+ * solver_solve() after solver_set_factors(), or loaded by
+ * solver_load_factors().
+ * @param[in] constants The constants of the right-hand sides, line after
+ * line: \f$n\times k\f$ values for \f$k\f$ sides, which must fit in 32
+ * bits.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_NO_SYSTEM if there is no factorisation,
+ * SOLVER_ERROR_INPUT if a constant is too large.
+ */
+enum solver_status
+solver_solve_rhs(solver *const s, const int64_t *const constants)
+{
+	if (!s->factored) {
+		return SOLVER_ERROR_NO_SYSTEM;
+	}
+	const size_t n = s->n;
+	const size_t n_rhs = s->n_rhs;
+	for (size_t i = 0; i < n * n_rhs; i++) {
+		if (constants[i] < INT32_MIN || constants[i] > INT32_MAX) {
+			return SOLVER_ERROR_INPUT;
+		}
+	}
+	set_constants(s, constants, n_rhs);
+	if (s->system != NULL) {
+		/* The system is factorised again with these constants */
+		for (size_t i = 0; i < n; i++) {
+			int64_t *line = s->system + i * (n + n_rhs);
+			for (size_t r = 0; r < n_rhs; r++) {
+				line[n + r] = constants[i * n_rhs + r];
+			}
+		}
+	}
+	const double start = STATS_NOW();
+	forward_substitute(&s->matrix);
+	const enum solver_status status = solver_substitute(s);
+	STATS_TIME(PHASE_SUBSTITUTE, start);
+	return status;
+}
+
+/**
+ * @brief Computes the difference of two coefficients, which may not fit in
+ * 32 bits.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in] value The new coefficient, which fits in 32 bits.
+ * @param[in] previous The previous coefficient, which fits in 32 bits.
+ * @param[in, out] difference Where to store the difference. The previous
+ * value is released.
+ */
+static void
+difference(wide_table *const table, const int64_t value,
+           const int64_t previous, fraction *const difference)
+{
+	const fraction one = {0, 1, 1};
+	fraction term;
+	fraction_from_int((int32_t)previous, &term);
+	tiered_release(table, difference);
+	fraction_from_int((int32_t)value, difference);
+	tiered_submul(table, difference, &term, &one);
+}
+
+/**
+ * @brief Releases the values of a vector of the system of a solver.
+ *
+ * @param[in, out] s The solver.
+ * @param[in, out] values The values.
+ * @param[in] count The number of values.
+ */
+static void
+release_vector(solver *const s, fraction *const values, const size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		tiered_release(&s->matrix.wide, &values[i]);
+	}
+}
+
+/**
+ * @brief Factorises the changed system of a solver from scratch, and solves
+ * it.
+ *
+ * @param[in, out] s The solver, whose system is kept.
+ *
+ * @return The outcome of the solve.
+ */
+static enum solver_status
+refactorise(solver *const s)
+{
+	matrix *matrix = &s->matrix;
+	/* Every value of the previous factorisation is dropped at once */
+	wide_table_clear(&matrix->wide);
+	for (size_t i = 0; i < s->n; i++) {
+		store_line(matrix, i, s->system + i * matrix->n_col);
+	}
+	for (size_t i = 0; i < s->n * s->n_rhs; i++) {
+		fraction_from_int(0, &s->solution[i]);
+	}
+	free(s->inverse);
+	s->inverse = NULL;
+	s->updates.count = 0;
+	s->determinant_known = false;
+	s->solved = false;
+	s->factored = false;
+	s->eliminated = false;
+	return solver_solve(s);
+}
+
+/**
+ * @brief Solves the system of a solver again after a change.
+ *
+ * A rank-one change \f$uv^T\f$ of the coefficients is recorded as an update
+ * of the factorisation, then the system is solved with its constants, in
+ * \f$O(n^2)\f$ operations. It is factorised from scratch instead if it was
+ * singular, if the change makes it singular or if the limit of updates is
+ * reached.
+ *
+ * @param[in, out] s The solver, whose system is kept, with the change.
+ * @param[in, out] vectors The column \f$u\f$ of the change followed by its
+ * line \f$v\f$, \f$n\f$ values each, or NULL if only the constants
+ * changed. They are released.
+ *
+ * @return The outcome of the solve.
+ */
+static enum solver_status
+update(solver *const s, fraction *const vectors)
+{
+	const size_t n = s->n;
+	wide_table *table = &s->matrix.wide;
+	bool updated = false;
+	if (vectors != NULL && s->factored &&
+	    s->updates.count < s->updates.limit) {
+		/* det(A + uv^T) = det(A) (1 + v^T A^-1 u) */
+		solver_compute_determinant(s);
+		fraction ratio = {0, 0, 1};
+		updated = add_rank_update(&s->matrix, s->permutation,
+		                          &s->updates, vectors, vectors + n,
+		                          &ratio);
+		tiered_multiply(table, &s->determinant, &ratio,
+		                &s->determinant);
+		tiered_release(table, &ratio);
+	}
+	if (vectors != NULL) {
+		/* Before a new factorisation drops the table */
+		release_vector(s, vectors, 2 * n);
+	}
+	if (!s->factored || (vectors != NULL && !updated)) {
+		return refactorise(s);
+	}
+	if (updated) {
+		free(s->inverse);
+		s->inverse = NULL;
+	}
+	const double start = STATS_NOW();
+	set_constants(s, s->system + n, s->matrix.n_col);
+	forward_substitute(&s->matrix);
+	const enum solver_status status = solver_substitute(s);
+	STATS_TIME(PHASE_SUBSTITUTE, start);
+	return status;
+}
+
+/**
+ * @brief Checks that the system of a solver can be updated.
+ *
+ * @param[in] s The solver.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_NO_SYSTEM, or SOLVER_ERROR_UNSUPPORTED if
+ * the system is not kept for its updates.
+ */
+static enum solver_status
+check_updatable(const solver *const s)
+{
+	if (s->n == 0) {
+		return SOLVER_ERROR_NO_SYSTEM;
+	}
+	return s->system != NULL ? SOLVER_OK : SOLVER_ERROR_UNSUPPORTED;
+}
+
+/**
+ * @brief Changes a coefficient of the system of a solver, and solves it
+ * again.
+ *
+ * The change is a rank-one update of the factorisation: the solve takes
+ * \f$O(n^2)\f$ operations.
+ *
+ * @see solver_set_updates()
+ *
+ * @param[in, out] s The solver, whose system was solved with its
+ * factorisation kept for updates.
+ * @param[in] line The line of the coefficient, starting from 0.
+ * @param[in] column The column of the coefficient, starting from 0, a
+ * column after the unknowns being the constant of a right-hand side.
+ * @param[in] value The new coefficient, which must fit in 32 bits.
+ *
+ * @return The outcome of the solve, SOLVER_ERROR_INPUT if the coefficient
+ * does not exist or does not fit, or an error as for check_updatable().
+ */
+enum solver_status
+solver_update_coefficient(solver *const s, const size_t line,
+                          const size_t column, const int64_t value)
+{
+	const enum solver_status status = check_updatable(s);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	const size_t n = s->n;
+	if (line >= n || column >= s->matrix.n_col || value < INT32_MIN ||
+	    value > INT32_MAX) {
+		return SOLVER_ERROR_INPUT;
+	}
+	int64_t *coefficient = s->system + line * s->matrix.n_col + column;
+	const int64_t previous = *coefficient;
+	*coefficient = value;
+	if (column >= n || value == previous) {
+		return update(s, NULL);
+	}
+	fraction *vectors = malloc(2 * n * sizeof(fraction));
+	if (vectors == NULL) {
+		*coefficient = previous;
+		return SOLVER_ERROR_MEMORY;
+	}
+	fraction *u = vectors;
+	fraction *v = vectors + n;
+	for (size_t i = 0; i < 2 * n; i++) {
+		fraction_from_int(0, &vectors[i]);
+	}
+	difference(&s->matrix.wide, value, previous, &u[line]);
+	fraction_from_int(1, &v[column]);
+	const enum solver_status solved = update(s, vectors);
+	free(vectors);
+	return solved;
+}
+
+/**
+ * @brief Replaces a line of the system of a solver, and solves it again.
+ *
+ * @see solver_update_coefficient()
+ *
+ * @param[in, out] s The solver, whose system was solved with its
+ * factorisation kept for updates.
+ * @param[in] line The index of the line, starting from 0.
+ * @param[in] values The new coefficients of the line, followed by its
+ * constant for each right-hand side, which must fit in 32 bits.
+ *
+ * @return The outcome, as for solver_update_coefficient().
+ */
+enum solver_status
+solver_update_line(solver *const s, const size_t line,
+                   const int64_t *const values)
+{
+	const enum solver_status status = check_updatable(s);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	const size_t n = s->n;
+	const size_t n_col = s->matrix.n_col;
+	if (line >= n) {
+		return SOLVER_ERROR_INPUT;
+	}
+	for (size_t j = 0; j < n_col; j++) {
+		if (values[j] < INT32_MIN || values[j] > INT32_MAX) {
+			return SOLVER_ERROR_INPUT;
+		}
+	}
+	fraction *vectors = malloc(2 * n * sizeof(fraction));
+	if (vectors == NULL) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	fraction *u = vectors;
+	fraction *v = vectors + n;
+	int64_t *previous = s->system + line * n_col;
+	bool changed = false;
+	for (size_t j = 0; j < n; j++) {
+		fraction_from_int(0, &u[j]);
+		fraction_from_int(0, &v[j]);
+		difference(&s->matrix.wide, values[j], previous[j], &v[j]);
+		changed = changed || values[j] != previous[j];
+	}
+	fraction_from_int(1, &u[line]);
+	for (size_t j = 0; j < n_col; j++) {
+		previous[j] = values[j];
+	}
+	if (!changed) {
+		/* Only the constants changed */
+		free(vectors);
+		return update(s, NULL);
+	}
+	const enum solver_status solved = update(s, vectors);
+	free(vectors);
+	return solved;
+}
+
+/**
+ * @brief Replaces the column of an unknown in the system of a solver, and
+ * solves it again.
+ *
+ * @see solver_update_coefficient()
+ *
+ * @param[in, out] s The solver, whose system was solved with its
+ * factorisation kept for updates.
+ * @param[in] column The index of the unknown, starting from 0.
+ * @param[in] values The new coefficients of the unknown, one per line,
+ * which must fit in 32 bits.
+ *
+ * @return The outcome, as for solver_update_coefficient().
+ */
+enum solver_status
+solver_update_column(solver *const s, const size_t column,
+                     const int64_t *const values)
+{
+	const enum solver_status status = check_updatable(s);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	const size_t n = s->n;
+	const size_t n_col = s->matrix.n_col;
+	if (column >= n) {
+		return SOLVER_ERROR_INPUT;
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (values[i] < INT32_MIN || values[i] > INT32_MAX) {
+			return SOLVER_ERROR_INPUT;
+		}
+	}
+	fraction *vectors = malloc(2 * n * sizeof(fraction));
+	if (vectors == NULL) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	fraction *u = vectors;
+	fraction *v = vectors + n;
+	bool changed = false;
+	for (size_t i = 0; i < n; i++) {
+		int64_t *previous = s->system + i * n_col + column;
+		fraction_from_int(0, &u[i]);
+		fraction_from_int(0, &v[i]);
+		difference(&s->matrix.wide, values[i], *previous, &u[i]);
+		changed = changed || values[i] != *previous;
+		*previous = values[i];
+	}
+	fraction_from_int(1, &v[column]);
+	if (!changed) {
+		free(vectors);
+		return update(s, NULL);
+	}
+	const enum solver_status solved = update(s, vectors);
+	free(vectors);
+	return solved;
+}
+
+/**
+ * @brief Gives the number of updates made to the factorisation of the
+ * system of a solver since it was last factorised.
+ *
+ * @param[in] s The solver.
+ *
+ * @return The number of updates.
+ */
+size_t
+solver_update_count(const solver *const s)
+{
+	return s->updates.count;
+}
+
+/**
+ * @brief Saves the factorisation of the system of a solver to a file.
+ *
+ * @param[in, out] s The solver, whose system was factorised.
+ * @param[in] stream The file to write to, opened in binary mode.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_NO_SYSTEM if there is no factorisation,
+ * SOLVER_ERROR_UNSUPPORTED if it was updated since, or SOLVER_ERROR_IO.
+ */
+enum solver_status
+solver_save_factors(solver *const s, FILE *const stream)
+{
+	s->error[0] = '\0';
+	if (!s->factored) {
+		return SOLVER_ERROR_NO_SYSTEM;
+	}
+	if (s->updates.count > 0) {
+		/* The factors are no longer those of the system */
+		return SOLVER_ERROR_UNSUPPORTED;
+	}
+	if (!write_factors(stream, &s->matrix, s->permutation)) {
+		report_error(s->error, "the factors could not be written");
+		return SOLVER_ERROR_IO;
+	}
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Loads a factorisation saved by solver_save_factors() into a
+ * solver.
+ *
+ * The factorisation replaces the system of the solver, which has no
+ * solution until solver_solve_rhs() gives it constants, with the number of
+ * right-hand sides set by solver_set_rhs().
+ *
+ * @param[in, out] s The solver, of the fraction engine.
+ * @param[in] stream The file to read from, opened in binary mode.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_INPUT if the engine is not the fraction
+ * one or the file does not hold valid factors, or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_load_factors(solver *const s, FILE *const stream)
+{
+	s->n = 0;
+	s->error[0] = '\0';
+	size_t n = 0;
+	if (s->engine != ENGINE_FRACTION ||
+	    !read_factors_header(stream, &n, s->error)) {
+		return SOLVER_ERROR_INPUT;
+	}
+	const enum solver_status status = solver_prepare(s, n);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	if (!read_factors(stream, &s->matrix, s->permutation, s->error)) {
+		s->n = 0;
+		return SOLVER_ERROR_INPUT;
+	}
+	s->factored = true;
+	s->solved = true;
+	s->status = SOLVER_ERROR_NO_SYSTEM;
+	/* Only regular systems are saved. The parity of the line swaps is
+	 * that of the number of inversions of the permutation */
+	s->eliminated = true;
+	s->echelon.rank = n;
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = i + 1; j < n; j++) {
+			if (s->permutation[j] < s->permutation[i]) {
+				s->echelon.odd_swaps = !s->echelon.odd_swaps;
+			}
+		}
+	}
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Gives the number of unknowns of the system of a solver.
+ *
+ * @param[in] s The solver.
+ *
+ * @return The number of unknowns, or 0 if no system is loaded.
+ */
+size_t
+solver_size(const solver *const s)
+{
+	return s->n;
+}
+
+/**
+ * @brief Gives the approximate solution of the system of a solver.
+ *
+ * @param[in] s The solver, whose system was solved.
+ *
+ * @return The value of each unknown for each right-hand side, one side after
+ * the other, valid until the next system is loaded, or NULL if the system
+ * was not solved.
+ */
+const double *
+solver_approximations(const solver *const s)
+{
+	return s->solved && s->status == SOLVER_OK ? s->approximations : NULL;
+}
+
+/**
+ * @brief Gives a fraction, whatever its tier, as 64-bit integers.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] value The fraction.
+ * @param[out] numerator Where to store the numerator, with its sign.
+ * @param[out] denominator Where to store the denominator.
+ *
+ * @return Whether the terms of the fraction fit in 64 bits.
+ */
+static bool
+exact_value(const wide_table *const table, const fraction *const value,
+            int64_t *const numerator, int64_t *const denominator)
+{
+	wide_fraction wide = {value->negative, value->numerator,
+	                      value->denominator};
+	if (fraction_is_wide(value)) {
+		const struct wide_entry *entry =
+		    &table->entries[value->numerator];
+		if (entry->tier != TIER_64) {
+			return false;
+		}
+		wide = entry->wide;
+	}
+	if (wide.numerator > INT64_MAX || wide.denominator > INT64_MAX) {
+		return false;
+	}
+	*numerator = wide.negative ? -(int64_t)wide.numerator
+	                           : (int64_t)wide.numerator;
+	*denominator = (int64_t)wide.denominator;
+	return true;
+}
+
+/**
+ * @brief Gives the exact value of an unknown of the system of a solver.
+ *
+ * @param[in] s The solver, whose system was solved by an exact engine.
+ * @param[in] index The index of the unknown, starting from 0, plus
+ * \f$r\times n\f$ for the right-hand side \f$r\f$.
+ * @param[out] numerator Where to store the numerator of the value, with its
+ * sign.
+ * @param[out] denominator Where to store the denominator of the value.
+ *
+ * @return Whether the exact value is known and fits in 64-bit terms.
+ */
+bool
+solver_exact_value(const solver *const s, const size_t index,
+                   int64_t *const numerator, int64_t *const denominator)
+{
+	if (solver_approximations(s) == NULL || s->engine == ENGINE_FLOAT ||
+	    index >= s->n * s->n_rhs) {
+		return false;
+	}
+	return exact_value(s->solution_table, &s->solution[index], numerator,
+	                   denominator);
+}
+
+/**
+ * @brief Prints the value of an unknown of the system of a solver.
+ *
+ * The exact engines print a fraction, as in `-3/4`, and the floating-point
+ * one an approximation.
+ *
+ * @param[in] stream The stream to print to.
+ * @param[in] s The solver, whose system was solved.
+ * @param[in] index The index of the unknown, as for solver_exact_value().
+ *
+ * @return Whether the memory of the conversion to decimal could be
+ * allocated.
+ */
+bool
+solver_fprint_value(FILE *const stream, const solver *const s,
+                    const size_t index)
+{
+	if (s->engine == ENGINE_FLOAT) {
+		fprintf(stream, "%g", s->approximations[index]);
+		return true;
+	}
+	return tiered_fprint(stream, s->solution_table, &s->solution[index]);
+}
+
+/**
+ * @brief Makes sure the system of a solver was eliminated by the dense
+ * fraction engine, solving it if it was not yet.
+ *
+ * @param[in, out] s The solver.
+ *
+ * @return SOLVER_OK if the system was eliminated, whether it is regular or
+ * not, SOLVER_ERROR_NO_SYSTEM, SOLVER_ERROR_UNSUPPORTED if another engine
+ * or the sparse elimination solved it, or SOLVER_ERROR_MEMORY.
+ */
+static enum solver_status
+check_eliminated(solver *const s)
+{
+	if (s->n == 0) {
+		return SOLVER_ERROR_NO_SYSTEM;
+	}
+	if (!s->solved) {
+		solver_solve(s);
+	}
+	if (s->eliminated) {
+		return SOLVER_OK;
+	}
+	return s->status == SOLVER_ERROR_MEMORY ? SOLVER_ERROR_MEMORY
+	                                        : SOLVER_ERROR_UNSUPPORTED;
+}
+
+/**
+ * @brief Gives the rank of the matrix of the unknowns of a solver's system.
+ *
+ * The rank is the number of pivots found by the elimination: it is below
+ * the number of unknowns if the system is singular. The system is solved
+ * first if it was not yet.
+ *
+ * @param[in, out] s The solver, of the fraction engine.
+ * @param[out] rank Where to store the rank.
+ *
+ * @return SOLVER_OK, even for a singular system, SOLVER_ERROR_NO_SYSTEM,
+ * SOLVER_ERROR_UNSUPPORTED if the system was solved by another engine or as
+ * a sparse one, or SOLVER_ERROR_MEMORY.
+ */
+enum solver_status
+solver_rank(solver *const s, size_t *const rank)
+{
+	const enum solver_status status = check_eliminated(s);
+	if (status == SOLVER_OK) {
+		*rank = s->echelon.rank;
+	}
+	return status;
+}
+
+/**
+ * @brief Computes the determinant of the matrix of the unknowns of a
+ * solver's system, from its elimination.
+ *
+ * The lines of the row-echelon form only differ from those of the system
+ * by multiples of other lines, which leave the determinant as it is, and by
+ * swaps, which flip its sign: it is the product of the pivots, with the
+ * sign of the swaps. The diagonal forms and the factorisation keep the
+ * pivots on their diagonal. The determinant is computed once, in the table
+ * of the matrix.
+ *
+ * @param[in, out] s The solver, of the fraction engine.
+ *
+ * @return The outcome, as for solver_rank().
+ */
+enum solver_status
+solver_compute_determinant(solver *const s)
+{
+	const enum solver_status status = check_eliminated(s);
+	if (status != SOLVER_OK || s->determinant_known) {
+		return status;
+	}
+	wide_table *table = &s->matrix.wide;
+	if (s->echelon.rank < s->n) {
+		fraction_from_int(0, &s->determinant);
+	} else {
+		fraction_from_int(s->echelon.odd_swaps ? -1 : 1,
+		                  &s->determinant);
+		fraction product = {0, 0, 1};
+		for (size_t i = 0; i < s->n; i++) {
+			const fraction *line = matrix_line(&s->matrix, i);
+			tiered_multiply(table, &s->determinant, &line[i],
+			                &product);
+			tiered_release(table, &s->determinant);
+			s->determinant = product;
+			product = (fraction){0, 0, 1};
+		}
+	}
+	if (out_of_memory(s)) {
+		return SOLVER_ERROR_MEMORY;
+	}
+	s->determinant_known = true;
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Gives the determinant of the matrix of the unknowns of a solver's
+ * system.
+ *
+ * It comes from the elimination that solves the system, without another
+ * one. The system is solved first if it was not yet.
+ *
+ * @see solver_compute_determinant()
+ *
+ * @param[in, out] s The solver, of the fraction engine.
+ * @param[out] numerator Where to store the numerator of the determinant,
+ * with its sign.
+ * @param[out] denominator Where to store its denominator.
+ *
+ * @return SOLVER_OK, 0 being the determinant of a singular system,
+ * SOLVER_ERROR_OVERFLOW if it does not fit in 64-bit terms, or an error as
+ * for solver_rank().
+ */
+enum solver_status
+solver_determinant(solver *const s, int64_t *const numerator,
+                   int64_t *const denominator)
+{
+	const enum solver_status status = solver_compute_determinant(s);
+	if (status != SOLVER_OK) {
+		return status;
+	}
+	return exact_value(&s->matrix.wide, &s->determinant, numerator,
+	                   denominator)
+	           ? SOLVER_OK
+	           : SOLVER_ERROR_OVERFLOW;
+}
+
+/**
+ * @brief Computes the inverse of the matrix of the unknowns of a solver's
+ * system, from its LU factorisation.
+ *
+ * Each column of the inverse solves the system for a column of the
+ * identity, as a right-hand side: the factorisation is reused as by
+ * solver_solve_rhs(), as many columns at a time as the system has
+ * right-hand sides, in \f$O(n^2)\f$ operations per column. The constants
+ * of the matrix are replaced, but not the solution of the system.
+ *
+ * @param[in, out] s The solver, whose system was factorised by
+ * solver_solve() after solver_set_factors(), or loaded by
+ * solver_load_factors(). The system is solved first if it was not yet.
+ *
+ * @return SOLVER_OK, SOLVER_ERROR_UNSOLVED if the system is singular,
+ * SOLVER_ERROR_UNSUPPORTED if it was solved without keeping its
+ * factorisation, or an error as for solver_rank().
+ */
+enum solver_status
+solver_invert(solver *const s)
+{
+	const enum solver_status status = check_eliminated(s);
+	if (status != SOLVER_OK || s->inverse != NULL) {
+		return status;
+	}
+	if (s->echelon.rank < s->n) {
+		return SOLVER_ERROR_UNSOLVED;
+	}
+	if (!s->factored) {
+		return SOLVER_ERROR_UNSUPPORTED;
+	}
+	const size_t n = s->n;
+	const size_t n_rhs = s->n_rhs;
+	matrix *matrix = &s->matrix;
+	s->inverse = malloc(n * n * sizeof(fraction));
+	fraction *columns = malloc(n * n_rhs * sizeof(fraction));
+	if (s->inverse == NULL || columns == NULL) {
+		free(s->inverse);
+		free(columns);
+		s->inverse = NULL;
+		return SOLVER_ERROR_MEMORY;
+	}
+	for (size_t i = 0; i < n * n_rhs; i++) {
+		fraction_from_int(0, &columns[i]);
+	}
+	const double start = STATS_NOW();
+	for (size_t first = 0; first < n; first += n_rhs) {
+		/* The columns of the identity, in the order of the lines of
+		 * the factors */
+		for (size_t i = 0; i < n; i++) {
+			fraction *line = matrix_line(matrix, i);
+			for (size_t r = 0; r < n_rhs; r++) {
+				tiered_release(&matrix->wide, &line[n + r]);
+				fraction_from_int(s->permutation[i] == first + r,
+				                  &line[n + r]);
+			}
+		}
+		forward_substitute(matrix);
+		back_substitute(matrix, columns);
+		for (size_t r = 0; r < n_rhs; r++) {
+			apply_rank_updates(&matrix->wide, &s->updates,
+			                   s->updates.count, n,
+			                   columns + r * n);
+		}
+		/* The values are moved, line after line */
+		for (size_t r = 0; r < n_rhs && first + r < n; r++) {
+			for (size_t i = 0; i < n; i++) {
+				s->inverse[i * n + first + r] =
+				    columns[r * n + i];
+				columns[r * n + i] = (fraction){0, 0, 1};
+			}
+		}
+	}
+	STATS_TIME(PHASE_SUBSTITUTE, start);
+	for (size_t i = 0; i < n * n_rhs; i++) {
+		tiered_release(&matrix->wide, &columns[i]);
+	}
+	free(columns);
+	if (out_of_memory(s)) {
+		free(s->inverse);
+		s->inverse = NULL;
+		return SOLVER_ERROR_MEMORY;
+	}
+	return SOLVER_OK;
+}
+
+/**
+ * @brief Gives a value of the inverse computed by solver_invert().
+ *
+ * @param[in] s The solver.
+ * @param[in] line The line of the value, starting from 0.
+ * @param[in] column The column of the value, starting from 0.
+ * @param[out] numerator Where to store the numerator of the value, with its
+ * sign.
+ * @param[out] denominator Where to store the denominator of the value.
+ *
+ * @return Whether the inverse is known and the value fits in 64-bit terms.
+ */
+bool
+solver_inverse_value(const solver *const s, const size_t line,
+                     const size_t column, int64_t *const numerator,
+                     int64_t *const denominator)
+{
+	if (s->inverse == NULL || line >= s->n || column >= s->n) {
+		return false;
+	}
+	return exact_value(&s->matrix.wide, &s->inverse[line * s->n + column],
+	                   numerator, denominator);
+}
+
+/**
+ * @brief Describes the outcome of a function of the library.
+ *
+ * @param[in] status The outcome.
+ *
+ * @return The description, as a string.
+ */
+const char *
+solver_status_string(const enum solver_status status)
+{
+	switch (status) {
+	case SOLVER_OK:
+		return "success";
+	case SOLVER_ERROR_MEMORY:
+		return "the memory was not allocated";
+	case SOLVER_ERROR_INPUT:
+		return "the input is not a valid system";
+	case SOLVER_ERROR_NO_SYSTEM:
+		return "no system was loaded";
+	case SOLVER_ERROR_UNSOLVED:
+		return "the system could not be solved";
+	case SOLVER_ERROR_OVERFLOW:
+		return "the value does not fit in 64-bit terms";
+	case SOLVER_ERROR_IO:
+		return "the file could not be read or written";
+	case SOLVER_ERROR_UNSUPPORTED:
+		return "the way the system was solved does not give this";
+	}
+	return "unknown status";
+}
+
+/**
+ * @brief Tells why the system of a solver could not be loaded, solved or
+ * saved, in more detail than the status of the function that failed.
+ *
+ * The description is that of the last failure, and is cleared when another
+ * system is loaded or solved. Some failures, such as those of memory, have
+ * none besides their status.
+ *
+ * @param[in] s The solver.
+ *
+ * @return The description, as a string in the style of
+ * solver_status_string(), empty if there is none.
+ */
+const char *
+solver_last_error(const solver *const s)
+{
+	return s->error;
+}
+
+/**
+ * @brief Gives the name of a pivoting strategy, as given on the command
+ * line.
+ *
+ * @param[in] pivoting The strategy.
+ *
+ * @return The name, as a string.
+ */
+const char *
+solver_pivoting_string(const enum solver_pivoting pivoting)
+{
+	switch (pivoting) {
+	case PIVOTING_GREATEST:
+		return "greatest";
+	case PIVOTING_SMALLEST:
+		return "smallest";
+	case PIVOTING_SPARSEST:
+		return "sparsest";
+	case PIVOTING_FIRST:
+		return "first";
+	}
+	return "unknown";
+}
+
+/**
+ * @brief Finds a pivoting strategy from its name.
+ *
+ * @see solver_pivoting_string()
+ *
+ * @param[in] name The name of the strategy.
+ * @param[out] pivoting Where to store the strategy.
+ *
+ * @return Whether the name is that of a strategy.
+ */
+bool
+solver_parse_pivoting(const char *const name,
+                      enum solver_pivoting *const pivoting)
+{
+	const enum solver_pivoting strategies[] = {
+	    PIVOTING_GREATEST, PIVOTING_SMALLEST, PIVOTING_SPARSEST,
+	    PIVOTING_FIRST};
+	for (size_t i = 0; i < sizeof(strategies) / sizeof(*strategies); i++) {
+		if (strcmp(name, solver_pivoting_string(strategies[i])) == 0) {
+			*pivoting = strategies[i];
+			return true;
+		}
+	}
+	return false;
+}
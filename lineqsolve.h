@@ -0,0 +1,140 @@
+/**
+ * @file lineqsolve.h
+ * @brief The public interface of the solver library.
+ *
+ * A program links with `liblineqsolve.a` or `liblineqsolve.so` and only
+ * includes this header. A @ref solver holds the chosen engine and the memory
+ * of the systems it solves, reused from one system to the next:
+ *
+ * @code
+ * solver *s = solver_create(ENGINE_MODULAR, 1);
+ * const int64_t system[] = {1, 2, 3,
+ *                           4, 5, 6};
+ * if (s != NULL && solver_load(s, 2, system) == SOLVER_OK &&
+ *     solver_solve(s) == SOLVER_OK) {
+ *         const double *x = solver_approximations(s);
+ * }
+ * solver_destroy(s);
+ * @endcode
+ *
+ * The library prints nothing: when a function fails, solver_last_error()
+ * tells why in more detail than its status.
+ *
+ * @see lineqsolve.c
+ */
+
+#ifndef LINEQSOLVE_H
+#define LINEQSOLVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The elimination methods that can be used to solve a system.
+ */
+enum solver_engine {
+	/** Gaussian elimination and back-substitution on fractions */
+	ENGINE_FRACTION,
+	/** Fraction-free Gauss-Jordan elimination on integers */
+	ENGINE_BAREISS,
+	/** Elimination modulo several primes, then reconstruction */
+	ENGINE_MODULAR,
+	/** LU factorisation in double precision, approximate */
+	ENGINE_FLOAT,
+};
+
+/**
+ * @brief How the fraction engine chooses the pivot of each column, out of the
+ * lines not yet eliminated.
+ *
+ * With exact fractions, the size of the terms matters more than their
+ * magnitude: every operation pays for the bits of its operands.
+ */
+enum solver_pivoting {
+	/** The value of greatest magnitude, as with floating-point numbers */
+	PIVOTING_GREATEST,
+	/** The value whose numerator and denominator have the fewest bits */
+	PIVOTING_SMALLEST,
+	/** The value of the line with the fewest non-zero coefficients */
+	PIVOTING_SPARSEST,
+	/** The first non-zero value, without swapping the lines otherwise */
+	PIVOTING_FIRST,
+};
+
+/**
+ * @brief The outcomes of the functions of the library.
+ */
+enum solver_status {
+	/** The operation succeeded */
+	SOLVER_OK,
+	/** The memory could not be allocated */
+	SOLVER_ERROR_MEMORY,
+	/** The input is not a valid system */
+	SOLVER_ERROR_INPUT,
+	/** No system was loaded */
+	SOLVER_ERROR_NO_SYSTEM,
+	/** The engine could not solve the system, singular or too large */
+	SOLVER_ERROR_UNSOLVED,
+	/** A value asked for does not fit in 64-bit terms: only
+	 * solver_determinant() gives it */
+	SOLVER_ERROR_OVERFLOW,
+	/** A file could not be read or written */
+	SOLVER_ERROR_IO,
+	/** The engine, or the way it solved the system, does not give the
+	 * result asked for */
+	SOLVER_ERROR_UNSUPPORTED,
+};
+
+/**
+ * @brief A solver, with its engine and the memory of its systems.
+ *
+ * Its contents are private.
+ */
+typedef struct solver solver;
+
+solver *solver_create(const enum solver_engine, const size_t);
+void solver_destroy(solver *const);
+void solver_set_refinement(solver *const, const size_t);
+void solver_set_sparse(solver *const, const bool);
+void solver_set_gauss_jordan(solver *const, const bool);
+void solver_set_block_size(solver *const, const size_t);
+void solver_set_pivoting(solver *const, const enum solver_pivoting);
+void solver_set_rhs(solver *const, const size_t);
+void solver_set_factors(solver *const, const bool);
+void solver_set_updates(solver *const, const size_t);
+enum solver_status solver_load(solver *const, const size_t,
+                               const int64_t *const);
+enum solver_status solver_load_text(solver *const, const char *const,
+                                    const size_t);
+enum solver_status solver_load_binary(solver *const, const void *const,
+                                      const size_t);
+enum solver_status solver_solve(solver *const);
+enum solver_status solver_solve_rhs(solver *const, const int64_t *const);
+enum solver_status solver_update_coefficient(solver *const, const size_t,
+                                             const size_t, const int64_t);
+enum solver_status solver_update_line(solver *const, const size_t,
+                                      const int64_t *const);
+enum solver_status solver_update_column(solver *const, const size_t,
+                                        const int64_t *const);
+size_t solver_update_count(const solver *const);
+enum solver_status solver_save_factors(solver *const, FILE *const);
+enum solver_status solver_load_factors(solver *const, FILE *const);
+size_t solver_size(const solver *const);
+const double *solver_approximations(const solver *const);
+bool solver_exact_value(const solver *const, const size_t, int64_t *const,
+                        int64_t *const);
+bool solver_fprint_value(FILE *const, const solver *const, const size_t);
+enum solver_status solver_rank(solver *const, size_t *const);
+enum solver_status solver_determinant(solver *const, int64_t *const,
+                                      int64_t *const);
+enum solver_status solver_invert(solver *const);
+bool solver_inverse_value(const solver *const, const size_t, const size_t,
+                          int64_t *const, int64_t *const);
+const char *solver_status_string(const enum solver_status);
+const char *solver_last_error(const solver *const);
+const char *solver_pivoting_string(const enum solver_pivoting);
+bool solver_parse_pivoting(const char *const, enum solver_pivoting *const);
+
+#endif /* LINEQSOLVE_H */
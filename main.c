@@ -1,18 +1,19 @@
 /**
  * @file main.c
- * @brief The main logic file.
+ * @brief The command-line interface of the solver.
  *
- * The matrix used in this program is modeled as a 2D array of fractions, with
- * \f$n_{\mathrm{lines}}\times n_{\mathrm{col}}\f$ elements.
+ * The systems are read from a file, in text or binary, and solved through
+ * the library. Only the pipelined elimination and the triplet input, which
+ * read the file while solving, use its internals.
  *
- * The matrix is referenced in a line-column fashion (row-major). *I.e.* the
- * value at `matrix[0][1]` is the element at the intersection of the first line
- * and the second colum.
+ * @see lineqsolve.c
  */
 
 #include "main.h"
+#include "server.h"
 
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -24,261 +25,372 @@
 #define DEFAULT_FILENAME_IN "matrix.txt"
 
 /**
- * @brief Counts the occurences of a character in a string.
+ * @brief The maximum number of refinement steps of the floating-point engine,
+ * when refinement is asked for.
+ */
+#define FLOAT_REFINEMENT_STEPS 3
+
+/**
+ * @brief Writes the buffered results to the standard output.
  *
- * @param[in] to_search The character to look for.
- * @param[in] string The string to search in.
+ * @param[in, out] out The output.
  *
- * @return The number of matches.
+ * @return Whether all the results were written. An error is printed if not.
  */
-size_t
-count_char_in_string(const char to_search, const char *string)
+static bool
+finish_output(output *const out)
 {
-	size_t count = 0;
-	while (*string != '\0') {
-		if (*string == to_search) {
-			count++;
-		}
-		string++;
-		if (count == SIZE_MAX) {
-			/* The end of the string has been overshot, something
-			 * went wrong */
-			return 0;
-		}
+	const bool written = writer_flush(&out->writer);
+	if (!written) {
+		fprintf(stderr, "ERROR: the results could not be written.\n");
 	}
-	return count;
+	writer_free(&out->writer);
+	return written;
 }
 
 /**
- * @brief Pretty-prints a matrix.
+ * @brief Tells why a function of the library failed on a solver.
  *
- * Prints a 2D array of fractions on the standard output, formatted as a
- * matrix.
+ * @param[in] s The solver.
+ * @param[in] status The status the function returned.
  *
- * @param[in] matrix The matrix to print.
- * @param[in] n_lines The number of lines of the matrix.
- * @param[in] n_col The number of columns of the matrix.
+ * @return The error of the solver, or the description of the status if it
+ * has none.
  */
-void
-pp_matrix(fraction **const matrix, const size_t n_lines, const size_t n_col)
+static const char *
+failure_reason(const solver *const s, const enum solver_status status)
 {
-	/*
-	 * The matrix is pretty-printed with brackets represented either
-	 * with parenthesises for single-line matrix or with a combination of
-	 * slashes and vertical bars for multi-line matrixes.
-	 */
-	printf("\n");
-	for (size_t i = 0; i < n_lines; i++) {
-		if (i == 0) {
-			printf("⎛");
-		} else if (i == n_lines - 1) {
-			printf("⎝");
-		} else {
-			printf("⎜");
-		}
-
-		for (size_t j = 0; j < n_col; j++) {
-			printf("%c%u/%u",
-			       fraction_sign_as_character(&matrix[i][j]),
-			       matrix[i][j].numerator,
-			       matrix[i][j].denominator);
-			if (j != n_col - 1) {
-				printf(" ");
-			}
-		}
-
-		if (i == 0) {
-			printf("⎞");
-		} else if (i == n_lines - 1) {
-			printf("⎠");
-		} else {
-			printf("⎟");
-		}
-		printf("\n");
-	}
+	const char *error = solver_last_error(s);
+	return error[0] != '\0' ? error : solver_status_string(status);
 }
 
 /**
- * @brief Finds the greatest fraction in matrix's column.
- *
- * @param[in] matrix The matrix to search the values in.
- * @param[in] column The index of the column to search in.
- * @param[in] n_lines The number of lines in the matrix.
+ * @brief Prints why a function of the library failed on a solver.
  *
- * @return The line number of the column's greatest item.
+ * @param[in] s The solver.
+ * @param[in] status The status the function returned.
  */
-size_t
-find_greatest_value_in_column(fraction **const matrix, const size_t column,
-                              const size_t n_lines)
+static void
+print_failure(const solver *const s, const enum solver_status status)
 {
-	/* Start with the smallest possible value */
-	fraction current_max_val = {true, UINT32_MAX, 1};
-	size_t current_max_index = 0;
-	for (size_t i = 0; i < n_lines; i++) {
-		if (compare_fractions(&matrix[i][column], &current_max_val) ==
-		    1) {
-			current_max_val = matrix[i][column];
-			current_max_index = i;
-		}
-	}
-	return current_max_index;
+	fprintf(stderr, "ERROR: %s.\n", failure_reason(s, status));
 }
 
 /**
- * @brief Subtract two matrix lines in places
- *
- * Piece-wise removes the value in line2 from line1, and stores the result in
- * line1.
+ * @brief Prints what the engine of a solver tells of its last solve,
+ * besides the solution.
  *
- * @param[in, out] line1 Pointer to the first item of the line being subtracted
- * from.
- * @param[in] line2 Pointer to the line being subtracted.
- * @param[in] n_col The number of columns in the matrix.
+ * @param[in] s The solver.
  */
-void
-subtract_lines_in_place(fraction *const line1, fraction *const line2,
-                        const size_t n_col)
+static void
+print_engine_report(const solver *const s)
 {
-	for (size_t i = 0; i < n_col; i++) {
-		subtract_fractions(line1 + i, line2 + i, &line1[i]);
+	if (s->n_primes > 0) {
+		fprintf(stderr, "The system was solved modulo %zu primes.\n",
+		        s->n_primes);
+	}
+	if (s->engine == ENGINE_FLOAT && s->solved && s->status == SOLVER_OK) {
+		fprintf(stderr, "The largest residual is %g.\n", s->residual);
 	}
 }
 
 /**
- * @brief Multiplies the values in the line by a fraction.
+ * @brief Reads the first line of the next system of a batch.
+ *
+ * Blank lines before the system are skipped. A line holding a single integer
+ * is a header giving the number of unknowns of the system, which is then
+ * followed by its first line. Otherwise, the line is the system's first
+ * line, and its length gives the number of unknowns.
  *
- * The fractions in the line are multiplied in place by the indicated fraction.
+ * @param[in, out] reader The reader of the batch.
+ * @param[out] number_variables Where to store the number of unknowns.
  *
- * @param[in, out] line Pointer to the first item of the line being multiplied.
- * @param[in] factor The fraction to multiply the line by.
- * @param[in] n_col The number of columns in the line.
+ * @return Whether the first line of a system was read, its coefficients
+ * being in the reader, or the end of the batch was reached. The reader's
+ * error tells why the input is not valid.
  */
-void
-multiply_line_in_place(fraction *const line, const fraction factor,
-                       const size_t n_col)
+enum read_status
+read_batch_header(line_reader *const reader, size_t *const number_variables)
 {
-	for (size_t i = 0; i < n_col; i++) {
-		multiply_fractions(line + i, &factor, &line[i]);
+	enum read_status status = READ_LINE;
+	do {
+		status = reader_next_line(reader);
+	} while (status == READ_LINE && reader->n_values == 0);
+	if (status != READ_LINE) {
+		return status;
+	}
+	if (reader->n_values == 1) {
+		if (reader->values[0] < 1 || reader->values[0] > INT32_MAX) {
+			report_error(reader->error,
+			             "line %zu does not give a valid number of "
+			             "unknowns",
+			             reader->line_number);
+			return READ_ERROR;
+		}
+		*number_variables = (size_t)reader->values[0];
+		return read_system_line(reader, *number_variables + 1)
+		           ? READ_LINE
+		           : READ_ERROR;
 	}
+	*number_variables = reader->n_values - 1;
+	return check_system_line(reader, *number_variables + 1) ? READ_LINE
+	                                                        : READ_ERROR;
 }
 
 /**
- * @brief Computes a row-echelon form of the matrix.
+ * @brief What is printed of the matrix of a system, besides its solution.
+ */
+struct properties {
+	/** Whether its rank is printed */
+	bool rank;
+	/** Whether its determinant is printed */
+	bool determinant;
+	/** Whether its inverse is printed */
+	bool inverse;
+};
+
+/**
+ * @brief Prints the rank, the determinant and the inverse of the matrix of
+ * a solver's system, as asked, in text.
+ *
+ * They all come from the elimination that solved the system. The rank and
+ * the determinant of a singular system are printed too, but it has no
+ * inverse.
  *
- * Uses Gauss' method (row operations) to find a row-echelon form of the matrix.
- * The matrix is modified in place.
+ * @param[in, out] out The output.
+ * @param[in, out] s The solver, whose system was eliminated by the dense
+ * fraction engine.
+ * @param[in] properties What to print.
  *
- * @param[in, out] matrix The matrix to manipulate.
- * @param[in] n_lines The number of lines in the matrix.
- * @param[in] n_col The number of columns in the matrix.
+ * @return SOLVER_OK, SOLVER_ERROR_UNSOLVED if the inverse was asked for a
+ * singular system, or the error of the library.
  */
-void
-triangularise(fraction **const matrix, const size_t n_lines, const size_t n_col)
+static enum solver_status
+print_properties(output *const out, solver *const s,
+                 const struct properties *const properties)
 {
-	/* For each step, the pivot is in position (i, i) */
-	for (size_t i = 0; i < n_lines; i++) {
-		/* Make the line with the biggest value of the
-		 * column the pivot line */
-		size_t line_pivot =
-		    find_greatest_value_in_column(matrix, i, n_lines);
-		if (line_pivot > i) {
-			/* Make the greatest value the pivot, for greater
-			 * stability */
-			fraction *temp_line = matrix[i];
-			matrix[i] = matrix[line_pivot];
-			matrix[line_pivot] = temp_line;
-		}
-
-		fraction inverse_of_pivot = {0};
-		invert_fraction(&matrix[i][i], &inverse_of_pivot);
-
-		fraction *subtracted_line = calloc(n_col, sizeof(fraction));
-		if (subtracted_line == NULL) {
-			exit(EXIT_FAILURE);
-		}
-		for (size_t j = 0; j < n_lines; j++) {
-			if (j == i) {
-				/* This is the pivot */
-				continue;
+	writer *w = &out->writer;
+	size_t rank = 0;
+	enum solver_status status = SOLVER_OK;
+	if (properties->rank || properties->determinant ||
+	    properties->inverse) {
+		status = solver_rank(s, &rank);
+	}
+	if (status == SOLVER_OK && properties->rank) {
+		writer_string(w, "The rank of the system is: ");
+		writer_unsigned(w, rank);
+		writer_string(w, ".\n");
+	}
+	if (status == SOLVER_OK && properties->determinant) {
+		status = solver_compute_determinant(s);
+	}
+	if (status == SOLVER_OK && properties->determinant) {
+		const wide_table *table = &s->matrix.wide;
+		writer_string(w, "The determinant of the system is: ");
+		/* Determinants easily outgrow a float */
+		writer_double(w, "%g",
+		              tiered_to_double(table, &s->determinant));
+		writer_string(w, " (");
+		writer_fraction(w, table, &s->determinant);
+		writer_string(w, ").\n");
+	}
+	if (status == SOLVER_OK && properties->inverse) {
+		status = solver_invert(s);
+	}
+	if (status == SOLVER_OK && properties->inverse) {
+		writer_string(w, "Inverse matrix:\n");
+		for (size_t i = 0; i < s->n; i++) {
+			writer_string(w, opening_bracket(i, s->n));
+			for (size_t j = 0; j < s->n; j++) {
+				if (j > 0) {
+					writer_char(w, ' ');
+				}
+				writer_fraction(w, &s->matrix.wide,
+				                &s->inverse[i * s->n + j]);
 			}
-			/* Determine the factor */
-			fraction simplification_factor = {0};
-			multiply_fractions(&matrix[j][i], &inverse_of_pivot,
-			                   &simplification_factor);
-			/* Pre-multiply (a copy of!) the pivot's line */
-			subtracted_line = memcpy(subtracted_line, matrix[i],
-			                         n_col * sizeof(fraction));
-			multiply_line_in_place(subtracted_line,
-			                       simplification_factor, n_col);
-			/* Subtract the lines */
-			subtract_lines_in_place(matrix[j], subtracted_line,
-			                        n_col);
-		}
-		free(subtracted_line);
+			writer_string(w, closing_bracket(i, s->n));
+			writer_char(w, '\n');
+		}
 	}
+	return status;
 }
 
 /**
- * @brief Reduces a matrix in upper-echelon form.
+ * @brief Solves right-hand sides with a saved factorisation, and prints
+ * their solutions.
  *
- * Uses back-substitution to transform a matrix in row-echelon form to its
- * reduced-row-echelon form.
+ * The input holds one line per equation, with the constant of each
+ * right-hand side. The number of sides is given by the first line, unless
+ * the solver already expects more than one.
  *
- * This function is currently unsued.
+ * @param[in] input The file holding the constants.
+ * @param[in] factors_filename The file holding the factorisation.
+ * @param[in, out] s The solver, of the fraction engine.
+ * @param[in, out] out The output of the solutions.
+ * @param[in] properties What to print of the matrix of the system, after
+ * the solutions.
  *
- * @param[in,out] matrix The matrix to reduce.
- * @param[in] n_lines The number of lines in the matrix.
- * @param[in] n_col The number of columns in the matrix.
+ * @return Whether the sides could be solved. An error is printed if not.
  */
-void
-diagonalise(fraction **const matrix, const size_t n_lines, const size_t n_col)
+static bool
+solve_with_factors(FILE *const input, const char *const factors_filename,
+                   solver *const s, output *const out,
+                   const struct properties *const properties)
 {
+	line_reader reader;
+	if (!reader_init(&reader, input)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		return false;
+	}
+	if (reader_next_line(&reader) != READ_LINE || reader.n_values == 0) {
+		fprintf(stderr, "ERROR: the constants could not be read.\n");
+		reader_free(&reader);
+		return false;
+	}
+	if (s->n_rhs == 1) {
+		solver_set_rhs(s, reader.n_values);
+	}
+	FILE *factors = fopen(factors_filename, "rb");
+	if (factors == NULL) {
+		fprintf(stderr, "ERROR: could not open file %s.\n",
+		        factors_filename);
+		reader_free(&reader);
+		return false;
+	}
+	enum solver_status status = solver_load_factors(s, factors);
+	fclose(factors);
+	const size_t n = s->n;
+	const size_t n_rhs = s->n_rhs;
+	int64_t *constants = NULL;
+	if (status == SOLVER_OK) {
+		constants = malloc(n * n_rhs * sizeof(int64_t));
+		if (constants == NULL) {
+			status = SOLVER_ERROR_MEMORY;
+		}
+	}
+	for (size_t i = 0; status == SOLVER_OK && i < n; i++) {
+		if (i == 0 ? !check_system_line(&reader, n_rhs)
+		           : !read_system_line(&reader, n_rhs)) {
+			report_error(s->error, "%s", reader.error);
+			status = SOLVER_ERROR_INPUT;
+			break;
+		}
+		for (size_t r = 0; r < n_rhs; r++) {
+			constants[i * n_rhs + r] = reader.values[r];
+		}
+	}
+	if (status == SOLVER_OK) {
+		fprintf(stderr,
+		        "Solving %zu right-hand sides of a system with %zu "
+		        "variables.\n",
+		        n_rhs, n);
+		status = solver_solve_rhs(s, constants);
+	}
+	if (status == SOLVER_OK) {
+		print_solution(out, s);
+		status = print_properties(out, s, properties);
+	}
+	if (status != SOLVER_OK) {
+		print_failure(s, status);
+	}
+	free(constants);
+	reader_free(&reader);
+	return status == SOLVER_OK;
 }
 
 /**
- * @brief Performs the gaussian elimination method on the matrix.
- *
- * Uses the gaussian elimitation method on an augmented matrix to find the
- * solution of its corresponding system of linear equations. The matrix is
- * modified in place.
- *
- * @param[in, out] matrix The matrix system to resolve.
- * @param[in] n_lines The number of lines in the matrix.
- * @param[in] n_col The number of columns in the matrix.
+ * @brief Prints the statistics of the solves on the standard error, when the
+ * program ends.
  */
-void
-gaussian_elimination(fraction **const matrix, const size_t n_lines,
-                     const size_t n_col)
+static void
+print_stats(void)
 {
-	triangularise(matrix, n_lines, n_col);
-	diagonalise(matrix, n_lines, n_col);
+	stats_fprint_json(stderr);
+	stats_stop();
 }
 
 /**
- * @brief Prints the solution to the linear equation system after gaussian
- * elimination.
+ * @brief Solves all the systems of a batch, printing only their solutions.
+ *
+ * The systems follow each other in the input, each one possibly preceded by
+ * blank lines or by a header giving its number of unknowns. The solution of
+ * each system is printed on a line of its own, or `failed` if it could not
+ * be solved: the number of the system, from 1, and the reason are then
+ * printed on the standard error. The solver reuses the memory of each system
+ * for the next one.
+ *
+ * @param[in] input The file holding the systems.
+ * @param[in, out] s The solver.
+ * @param[in, out] out The output of the solutions.
  *
- * @param[in] matrix The matrix to print.
- * @param[in] n_lines The number of lines in the matrix.
- * @param[in] n_col The number of columns in the matrix.
+ * @return Whether the whole batch could be read and every system solved.
  */
-void
-print_results(fraction **const matrix, const size_t n_lines, const size_t n_col)
+bool
+solve_batch(FILE *const input, solver *const s, output *const out)
 {
-	for (size_t i = 0; i < n_lines; i++) {
-		fraction inverted_pivot = {0};
-		invert_fraction(&matrix[i][i], &inverted_pivot);
-		fraction var_i_val = {0};
-		multiply_fractions(&matrix[i][n_col - 1], &inverted_pivot,
-		                   &var_i_val);
-		float var_i_approx = var_i_val.numerator *
-		                     (var_i_val.negative ? -1.0 : 1.0) /
-		                     var_i_val.denominator;
-		printf("The value of the variable %zu is: %g (%c%u/%u).\n",
-		       i + 1, var_i_approx,
-		       fraction_sign_as_character(&var_i_val),
-		       var_i_val.numerator, var_i_val.denominator);
+	line_reader reader;
+	if (!reader_init(&reader, input)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		return false;
+	}
+
+	bool all_solved = true;
+	size_t n = 0;
+	size_t index = 0;
+	enum read_status status = READ_LINE;
+	double start = STATS_NOW();
+	while ((status = read_batch_header(&reader, &n)) == READ_LINE) {
+		if (solver_prepare(s, n) != SOLVER_OK) {
+			fprintf(stderr,
+			        "ERROR: the memory was not allocated.\n");
+			status = READ_ERROR;
+			break;
+		}
+		for (size_t i = 0; i < n; i++) {
+			if (i > 0 && !read_system_line(&reader, n + 1)) {
+				status = READ_ERROR;
+				break;
+			}
+			solver_store_line(s, i, reader.values);
+		}
+		if (status == READ_ERROR) {
+			break;
+		}
+		STATS_TIME(PHASE_READ, start);
+		index++;
+		writer *w = &out->writer;
+		const enum solver_status solved = solver_solve(s);
+		print_engine_report(s);
+		if (solved != SOLVER_OK) {
+			fprintf(stderr, "ERROR: the system %zu failed: %s.\n",
+			        index, failure_reason(s, solved));
+			writer_string(w, "failed\n");
+			all_solved = false;
+			start = STATS_NOW();
+			continue;
+		}
+		start = STATS_NOW();
+		for (size_t i = 0; i < n; i++) {
+			if (i > 0) {
+				writer_char(w, ' ');
+			}
+			if (s->engine == ENGINE_FLOAT) {
+				writer_double(w, "%g", s->approximations[i]);
+			} else {
+				writer_fraction(w, s->solution_table,
+				                &s->solution[i]);
+			}
+		}
+		writer_char(w, '\n');
+		STATS_TIME(PHASE_PRINT, start);
+		start = STATS_NOW();
+	}
+	if (status == READ_ERROR && reader.error[0] != '\0') {
+		fprintf(stderr, "ERROR: %s.\n", reader.error);
 	}
+
+	reader_free(&reader);
+	return all_solved && status == READ_END;
 }
 
 /**
@@ -295,36 +407,364 @@ int
 main(const int argc, const char *const argv[])
 {
 	size_t number_variables = 0;
-	fraction **values_matrix = {0};
-	const char *input_filename = "";
+	const char *input_filename = NULL;
+	enum solver_engine engine = ENGINE_FRACTION;
+	size_t refinement_steps = 0;
+	size_t n_threads = 1;
+	bool pipelined = false;
+	bool batch = false;
+	bool sparse = false;
+	bool jordan = false;
+	enum solver_pivoting pivoting = PIVOTING_GREATEST;
+	bool pivoting_given = false;
+	size_t block_size = 0;
+	bool stats = false;
+	bool quiet = false;
+	enum output_format output_format = FORMAT_TEXT;
+	size_t n_rhs = 1;
+	const char *save_factors = NULL;
+	const char *load_factors = NULL;
+	const char *serve = NULL;
+	size_t max_request = SERVER_DEFAULT_MAX_PAYLOAD;
+	bool max_request_given = false;
+	struct properties properties = {false, false, false};
 
 	if (argc == 0) {
 		fprintf(stderr,
 		        "ERROR: number of arguments should not be 0.\n");
 		exit(EXIT_FAILURE);
-	} else if (argc == 1) {
+	}
+	for (int arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--bareiss") == 0) {
+			engine = ENGINE_BAREISS;
+		} else if (strcmp(argv[arg], "--modular") == 0) {
+			engine = ENGINE_MODULAR;
+		} else if (strcmp(argv[arg], "--float") == 0) {
+			engine = ENGINE_FLOAT;
+		} else if (strcmp(argv[arg], "--refine") == 0) {
+			refinement_steps = FLOAT_REFINEMENT_STEPS;
+		} else if (strcmp(argv[arg], "--pipeline") == 0) {
+			pipelined = true;
+		} else if (strcmp(argv[arg], "--batch") == 0) {
+			batch = true;
+		} else if (strcmp(argv[arg], "--sparse") == 0) {
+			sparse = true;
+		} else if (strcmp(argv[arg], "--gauss-jordan") == 0) {
+			jordan = true;
+		} else if (strcmp(argv[arg], "--pivot") == 0) {
+			if (arg + 1 == argc ||
+			    !solver_parse_pivoting(argv[++arg], &pivoting)) {
+				fprintf(stderr,
+				        "ERROR: --pivot expects greatest, "
+				        "smallest, sparsest or first.\n");
+				exit(EXIT_FAILURE);
+			}
+			pivoting_given = true;
+		} else if (strcmp(argv[arg], "--block") == 0) {
+			char *end = NULL;
+			unsigned long value =
+			    arg + 1 < argc ? strtoul(argv[++arg], &end, 10) : 0;
+			if (end == NULL || *end != '\0' || value == 0) {
+				fprintf(stderr, "ERROR: --block expects a "
+				                "positive number of pivots.\n");
+				exit(EXIT_FAILURE);
+			}
+			block_size = value;
+		} else if (strcmp(argv[arg], "--stats") == 0) {
+			stats = true;
+		} else if (strcmp(argv[arg], "--quiet") == 0) {
+			quiet = true;
+		} else if (strcmp(argv[arg], "--rank") == 0) {
+			properties.rank = true;
+		} else if (strcmp(argv[arg], "--determinant") == 0) {
+			properties.determinant = true;
+		} else if (strcmp(argv[arg], "--inverse") == 0) {
+			properties.inverse = true;
+		} else if (strcmp(argv[arg], "--format") == 0) {
+			if (arg + 1 == argc ||
+			    !parse_output_format(argv[++arg], &output_format)) {
+				fprintf(stderr,
+				        "ERROR: --format expects text, csv, "
+				        "jsonl or binary.\n");
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(argv[arg], "--rhs") == 0) {
+			char *end = NULL;
+			unsigned long value =
+			    arg + 1 < argc ? strtoul(argv[++arg], &end, 10) : 0;
+			if (end == NULL || *end != '\0' || value == 0 ||
+			    value > INT32_MAX) {
+				fprintf(stderr,
+				        "ERROR: --rhs expects a positive "
+				        "number of right-hand sides.\n");
+				exit(EXIT_FAILURE);
+			}
+			n_rhs = value;
+		} else if (strcmp(argv[arg], "--save-factors") == 0 ||
+		           strcmp(argv[arg], "--load-factors") == 0) {
+			if (arg + 1 == argc) {
+				fprintf(stderr, "ERROR: %s expects a file.\n",
+				        argv[arg]);
+				exit(EXIT_FAILURE);
+			}
+			if (argv[arg][2] == 's') {
+				save_factors = argv[++arg];
+			} else {
+				load_factors = argv[++arg];
+			}
+		} else if (strcmp(argv[arg], "--serve") == 0) {
+			if (arg + 1 == argc) {
+				fprintf(stderr,
+				        "ERROR: --serve expects a socket path, "
+				        "or - for the standard input and "
+				        "output.\n");
+				exit(EXIT_FAILURE);
+			}
+			serve = argv[++arg];
+		} else if (strcmp(argv[arg], "--max-request") == 0) {
+			char *end = NULL;
+			unsigned long value =
+			    arg + 1 < argc ? strtoul(argv[++arg], &end, 10) : 0;
+			if (end == NULL || *end != '\0' || value == 0 ||
+			    value > SIZE_MAX >> 20) {
+				fprintf(stderr,
+				        "ERROR: --max-request expects a "
+				        "positive number of MiB.\n");
+				exit(EXIT_FAILURE);
+			}
+			max_request = (size_t)value << 20;
+			max_request_given = true;
+		} else if (strcmp(argv[arg], "-j") == 0) {
+			char *end = NULL;
+			unsigned long value =
+			    arg + 1 < argc ? strtoul(argv[++arg], &end, 10) : 0;
+			if (end == NULL || *end != '\0' || value == 0) {
+				fprintf(stderr, "ERROR: -j expects a positive "
+				                "number of threads.\n");
+				exit(EXIT_FAILURE);
+			}
+			n_threads = value;
+		} else if (argv[arg][0] == '-' && argv[arg][1] != '\0') {
+			fprintf(stderr, "ERROR: unknown option %s.\n",
+			        argv[arg]);
+			exit(EXIT_FAILURE);
+		} else if (input_filename == NULL) {
+			input_filename = argv[arg];
+		} else {
+			fprintf(stderr,
+			        "ERROR: only one input file expected.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (serve == NULL && max_request_given) {
+		fprintf(stderr, "ERROR: --max-request only applies to "
+		                "--serve.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (serve != NULL && input_filename != NULL) {
+		fprintf(stderr, "ERROR: --serve reads the systems from its "
+		                "clients.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (input_filename == NULL) {
 		input_filename = DEFAULT_FILENAME_IN;
-	} else if (argc == 2) {
-		input_filename = argv[1];
-	} else {
-		fprintf(stderr, "ERROR: only 1 or 2 arguments expected.\n");
+	}
+	/* The properties of the matrix come from its factorisation */
+	const bool with_properties = properties.rank ||
+	                             properties.determinant ||
+	                             properties.inverse;
+	const bool keep_factors = save_factors != NULL || with_properties;
+	if (pipelined && (engine != ENGINE_FRACTION || batch)) {
+		fprintf(stderr, "ERROR: --pipeline only works with the "
+		                "fraction engine, on a single system.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (sparse && (engine != ENGINE_FRACTION || batch || pipelined)) {
+		fprintf(stderr, "ERROR: --sparse only works with the fraction "
+		                "engine, on a single system.\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((n_rhs > 1 || keep_factors || load_factors != NULL) &&
+	    (engine != ENGINE_FRACTION || batch || sparse)) {
+		fprintf(stderr, "ERROR: --rhs and the factors only work with "
+		                "the fraction engine, on a single dense "
+		                "system.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (jordan && (engine != ENGINE_FRACTION || sparse || keep_factors ||
+	               load_factors != NULL)) {
+		fprintf(stderr, "ERROR: --gauss-jordan only works with the "
+		                "dense elimination of the fraction engine.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (pivoting_given && (engine != ENGINE_FRACTION || sparse ||
+	                       pipelined || load_factors != NULL)) {
+		fprintf(stderr, "ERROR: --pivot only works with the dense "
+		                "elimination of the fraction engine.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (block_size != 0 &&
+	    (engine != ENGINE_FRACTION || sparse || pipelined || jordan ||
+	     keep_factors || load_factors != NULL)) {
+		fprintf(stderr, "ERROR: --block only works with the row-echelon "
+		                "elimination of the fraction engine.\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((keep_factors || load_factors != NULL) && pipelined) {
+		fprintf(stderr, "ERROR: --pipeline does not factorise the "
+		                "system.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (output_format != FORMAT_TEXT && batch) {
+		fprintf(stderr, "ERROR: --batch prints a line per system, in "
+		                "text.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (with_properties && output_format != FORMAT_TEXT) {
+		fprintf(stderr, "ERROR: the rank, the determinant and the "
+		                "inverse are only printed in text.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (serve != NULL && (batch || pipelined || keep_factors ||
+	                      load_factors != NULL)) {
+		fprintf(stderr, "ERROR: --serve only solves the systems, "
+		                "without --batch, --pipeline, the factors or "
+		                "the properties.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (stats) {
+		if (!stats_start()) {
+			fprintf(stderr, "ERROR: --stats needs a build with "
+			                "LINEQSOLVE_STATS defined, like "
+			                "lineqsolve-stats.\n");
+			exit(EXIT_FAILURE);
+		}
+		/* The statistics are printed however the program ends */
+		atexit(print_stats);
+	}
+	/* "-" stands for the standard input */
+	const bool from_stdin = strcmp(input_filename, "-") == 0;
+	output out;
+	if (!writer_init(&out.writer, stdout)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
 		exit(EXIT_FAILURE);
 	}
+	out.format = output_format;
+	/* Only the text format has room for the matrices */
+	out.matrices = !quiet && output_format == FORMAT_TEXT;
 
-	FILE *input = fopen(input_filename, "r");
-	if (input == NULL) {
-		fprintf(stderr, "ERROR: could not open file %s.\n",
-		        input_filename);
+	solver *s = solver_create(engine, n_threads);
+	if (s == NULL) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
 		exit(EXIT_FAILURE);
 	}
-	fprintf(stderr, "Reading the file\n");
+	solver_set_refinement(s, refinement_steps);
+	solver_set_sparse(s, sparse);
+	solver_set_gauss_jordan(s, jordan);
+	solver_set_block_size(s, block_size);
+	solver_set_pivoting(s, pivoting);
+	solver_set_rhs(s, n_rhs);
+	solver_set_factors(s, keep_factors);
+
+	if (serve != NULL) {
+		/* The workers solve the systems side by side, a thread each */
+		const bool served =
+		    server_run(serve, s, n_threads, output_format, max_request);
+		writer_free(&out.writer);
+		solver_destroy(s);
+		return served ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (load_factors != NULL) {
+		FILE *input = from_stdin ? stdin : fopen(input_filename, "r");
+		if (input == NULL) {
+			fprintf(stderr, "ERROR: could not open file %s.\n",
+			        input_filename);
+			exit(EXIT_FAILURE);
+		}
+		bool solved =
+		    solve_with_factors(input, load_factors, s, &out,
+		                       &properties);
+		if (!from_stdin) {
+			fclose(input);
+		}
+		solved = finish_output(&out) && solved;
+		solver_destroy(s);
+		return solved ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
-	char string[256];
-	/* Read until a newline is reached */
-	fgets(string, 256, input);
-	rewind(input);
+	if (batch) {
+		FILE *input = from_stdin ? stdin : fopen(input_filename, "r");
+		if (input == NULL) {
+			fprintf(stderr, "ERROR: could not open file %s.\n",
+			        input_filename);
+			exit(EXIT_FAILURE);
+		}
+		bool solved = solve_batch(input, s, &out);
+		if (!from_stdin) {
+			fclose(input);
+		}
+		solved = finish_output(&out) && solved;
+		solver_destroy(s);
+		return solved ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
-	number_variables = count_char_in_string(' ', string);
+	const double read_start = STATS_NOW();
+	binary_matrix binary;
+	const enum binary_status format =
+	    from_stdin ? BINARY_NOT_BINARY
+	               : binary_open(&binary, input_filename);
+	if (format == BINARY_INVALID) {
+		fprintf(stderr, "ERROR: %s.\n", binary.error);
+		exit(EXIT_FAILURE);
+	}
+	FILE *input = NULL;
+	line_reader reader;
+	bool triplets = false;
+	if (format == BINARY_MATRIX) {
+		fprintf(stderr, "Mapping the binary file\n");
+		/* The whole matrix is available at once */
+		pipelined = false;
+		if (binary.n_col != binary.n_lines + n_rhs) {
+			fprintf(stderr,
+			        "ERROR: the binary matrix has %zu columns "
+			        "instead of %zu.\n",
+			        binary.n_col, binary.n_lines + n_rhs);
+			exit(EXIT_FAILURE);
+		}
+		number_variables = binary.n_lines;
+	} else {
+		input = from_stdin ? stdin : fopen(input_filename, "r");
+		if (input == NULL) {
+			fprintf(stderr, "ERROR: could not open file %s.\n",
+			        input_filename);
+			exit(EXIT_FAILURE);
+		}
+		fprintf(stderr, "Reading the file\n");
+
+		if (!reader_init(&reader, input)) {
+			fprintf(stderr,
+			        "ERROR: the memory was not allocated.\n");
+			exit(EXIT_FAILURE);
+		}
+		/* The first line gives the size of the system */
+		enum read_status first_line = reader_next_line(&reader);
+		if (first_line == READ_ERROR) {
+			fprintf(stderr, "ERROR: %s.\n", reader.error);
+			exit(EXIT_FAILURE);
+		}
+		if (first_line == READ_LINE && reader.n_values > n_rhs &&
+		    reader.n_values > 1) {
+			number_variables = reader.n_values - n_rhs;
+		} else if (first_line == READ_LINE && reader.n_values == 1 &&
+		           reader.values[0] > 0 &&
+		           reader.values[0] <= INT32_MAX) {
+			/* A lone number of unknowns announces triplets */
+			triplets = true;
+			pipelined = false;
+			number_variables = (size_t)reader.values[0];
+		}
+	}
 	if (number_variables == 0) {
 		fprintf(stderr,
 		        "ERROR: the number of variables could not be read.\n");
@@ -335,48 +775,189 @@ main(const int argc, const char *const argv[])
 		exit(EXIT_SUCCESS);
 	}
 	fprintf(stderr, "This system has %zu variables.\n", number_variables);
-
-	values_matrix = calloc(number_variables, sizeof(fraction *));
-	if (values_matrix == NULL) {
-		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+	if (format != BINARY_MATRIX && !triplets &&
+	    !check_system_line(&reader, number_variables + n_rhs)) {
+		fprintf(stderr, "ERROR: %s.\n", reader.error);
+		exit(EXIT_FAILURE);
+	}
+	if (triplets && (n_rhs > 1 || keep_factors)) {
+		fprintf(stderr, "ERROR: the triplets only give a single "
+		                "right-hand side, and are not factorised.\n");
 		exit(EXIT_FAILURE);
 	}
-	for (size_t i = 0; i < number_variables; i++) {
-		/* n variables + result */
-		values_matrix[i] =
-		    calloc(number_variables + 1, sizeof(fraction));
-		if (values_matrix[i] == NULL) {
+
+	if (triplets && engine == ENGINE_FRACTION) {
+		/* The system is never stored densely */
+		sparse_matrix system;
+		if (!sparse_init(&system, number_variables,
+		                 number_variables + 1)) {
 			fprintf(stderr,
 			        "ERROR: the memory was not allocated.\n");
 			exit(EXIT_FAILURE);
 		}
-	}
-
-	for (size_t i = 0; i < number_variables; i++) {
-		for (size_t j = 0; j < (number_variables + 1); j++) {
-			int32_t input_coefficient = 0;
-			fscanf(input, "%d", &input_coefficient);
-			fraction_from_int(input_coefficient,
-			                  &values_matrix[i][j]);
+		bool solved =
+		    read_triplets(&reader, number_variables, &system, NULL);
+		if (!solved) {
+			fprintf(stderr, "ERROR: %s.\n", reader.error);
+		}
+		reader_free(&reader);
+		fclose(input);
+		fprintf(stderr, "File closed\n");
+		if (solved &&
+		    !print_sparse_results(&out, &system, s->error)) {
+			print_failure(s, SOLVER_ERROR_UNSOLVED);
+			solved = false;
 		}
+		solved = finish_output(&out) && solved;
+		sparse_free(&system);
+		solver_destroy(s);
+		return solved ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 
-	fclose(input);
-	fprintf(stderr, "File closed\n");
-
-	printf("Initial matrix:");
-	pp_matrix(values_matrix, number_variables, number_variables + 1);
-	gaussian_elimination(values_matrix, number_variables,
-	                     number_variables + 1);
-	printf("\nFinal matrix:");
-	pp_matrix(values_matrix, number_variables, number_variables + 1);
+	/* All the memory of the solve is reserved at once */
+	if (solver_prepare(s, number_variables) != SOLVER_OK) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		exit(EXIT_FAILURE);
+	}
 
-	print_results(values_matrix, number_variables, number_variables + 1);
+	if (format == BINARY_MATRIX) {
+		bool loaded = engine != ENGINE_FRACTION
+		                  ? load_binary_integer_system(
+		                        &s->integer_matrix, &binary, s->error)
+		                  : load_binary_system(&s->matrix, &binary,
+		                                       s->error);
+		binary_close(&binary);
+		if (!loaded) {
+			print_failure(s, SOLVER_ERROR_INPUT);
+			exit(EXIT_FAILURE);
+		}
+		fprintf(stderr, "File closed\n");
+	} else if (triplets) {
+		bool loaded = read_triplets(&reader, number_variables, NULL,
+		                            &s->integer_matrix);
+		if (!loaded) {
+			fprintf(stderr, "ERROR: %s.\n", reader.error);
+			exit(EXIT_FAILURE);
+		}
+		reader_free(&reader);
+		fclose(input);
+		fprintf(stderr, "File closed\n");
+	} else {
+		/* In a pipeline, the other lines are read during the
+		 * elimination */
+		const size_t n_read_now = pipelined ? 1 : number_variables;
+		for (size_t i = 0; i < n_read_now; i++) {
+			if (i > 0 && !read_system_line(&reader,
+			                               number_variables +
+			                                   n_rhs)) {
+				fprintf(stderr, "ERROR: %s.\n", reader.error);
+				exit(EXIT_FAILURE);
+			}
+			solver_store_line(s, i, reader.values);
+		}
+		if (!pipelined) {
+			reader_free(&reader);
+			fclose(input);
+			fprintf(stderr, "File closed\n");
+		}
+	}
 
-	for (size_t i = 0; i < number_variables; i++) {
-		free(values_matrix[i]);
+	STATS_TIME(PHASE_READ, read_start);
+	enum solver_status status = SOLVER_OK;
+	double start = STATS_NOW();
+	if (engine != ENGINE_FRACTION) {
+		pp_integer_matrix(&out, "Initial matrix:", &s->integer_matrix);
+		status = solver_solve(s);
+		print_engine_report(s);
+		if (engine != ENGINE_BAREISS) {
+			pp_blank_line(&out);
+		} else if (status != SOLVER_ERROR_UNSOLVED) {
+			pp_integer_matrix(&out, "\nFinal matrix:",
+			                  &s->integer_matrix);
+		}
+		if (engine == ENGINE_MODULAR && status == SOLVER_OK) {
+			fprintf(stderr, "The solution was verified.\n");
+		}
+		if (status == SOLVER_OK) {
+			start = STATS_NOW();
+			print_solution(&out, s);
+			STATS_TIME(PHASE_PRINT, start);
+		}
+	} else if (!pipelined && solver_uses_sparse(s)) {
+		sparse_matrix system;
+		if (!sparse_from_matrix(&system, &s->matrix)) {
+			fprintf(stderr,
+			        "ERROR: the memory was not allocated.\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!print_sparse_results(&out, &system, s->error)) {
+			status = SOLVER_ERROR_UNSOLVED;
+		}
+		sparse_free(&system);
+	} else {
+		if (pipelined) {
+			if (pipelined_elimination(&s->matrix, &reader,
+			                          &s->arena, s->error)) {
+				status = solver_read_diagonal(s);
+			} else {
+				status = SOLVER_ERROR_UNSOLVED;
+			}
+			reader_free(&reader);
+			fclose(input);
+			fprintf(stderr, "File closed\n");
+			STATS_TIME(PHASE_ELIMINATE, start);
+		} else {
+			pp_matrix(&out, "Initial matrix:", &s->matrix);
+			status = solver_solve(s);
+			pp_blank_line(&out);
+		}
+		if (status == SOLVER_OK) {
+			start = STATS_NOW();
+			pp_matrix(&out, "Final matrix:", &s->matrix);
+			print_solution(&out, s);
+			STATS_TIME(PHASE_PRINT, start);
+		}
+		/* A singular system still has a rank and a determinant */
+		if ((status == SOLVER_OK || status == SOLVER_ERROR_UNSOLVED) &&
+		    with_properties && s->eliminated) {
+			const enum solver_status printed =
+			    print_properties(&out, s, &properties);
+			if (status == SOLVER_OK) {
+				status = printed;
+			}
+		}
+		if (status == SOLVER_OK && save_factors != NULL) {
+			FILE *factors = fopen(save_factors, "wb");
+			if (factors == NULL) {
+				fprintf(stderr,
+				        "ERROR: could not open file %s.\n",
+				        save_factors);
+				status = SOLVER_ERROR_IO;
+			} else {
+				status = solver_save_factors(s, factors);
+				fclose(factors);
+				if (status == SOLVER_ERROR_IO) {
+					print_failure(s, status);
+				}
+			}
+		}
+		fprintf(stderr,
+		        "%zu values were promoted to 64 bits, %zu to arbitrary "
+		        "precision.\n",
+		        s->matrix.wide.promotions_to_64,
+		        s->matrix.wide.promotions_to_big);
+	}
+	if (!finish_output(&out) && status == SOLVER_OK) {
+		status = SOLVER_ERROR_IO;
+	}
+	/* The output and the files explain their own failures */
+	if (status != SOLVER_OK && status != SOLVER_ERROR_IO) {
+		print_failure(s, status);
 	}
-	free(values_matrix);
+	fprintf(stderr,
+	        "The solve used %zu of the %zu bytes reserved for it.\n",
+	        s->arena.peak, s->arena.capacity);
+	solver_destroy(s);
 
-	return EXIT_SUCCESS;
+	return status == SOLVER_OK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,372 @@
+/**
+ * @file matrix.c
+ * @brief Storage of the matrices.
+ *
+ * A matrix is allocated as one contiguous block of elements, plus the index
+ * of its lines. Scanning a column thus stays in a single allocation, and the
+ * lines can be reordered without moving any element.
+ *
+ * @see matrix.h
+ */
+
+#include "matrix.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Allocates the line index of a matrix.
+ *
+ * The index initially maps every line to its own position in the buffer.
+ *
+ * @param[in] n_lines The number of lines of the matrix.
+ *
+ * @return The index, or NULL if it could not be allocated.
+ */
+static size_t *
+allocate_line_index(const size_t n_lines)
+{
+	size_t *lines = malloc(n_lines * sizeof(size_t));
+	if (lines == NULL) {
+		return NULL;
+	}
+	for (size_t i = 0; i < n_lines; i++) {
+		lines[i] = i;
+	}
+	return lines;
+}
+
+/**
+ * @brief Makes sure a buffer can hold a number of elements.
+ *
+ * @param[in, out] buffer The buffer, reallocated if it is too small.
+ * @param[in, out] capacity The number of elements the buffer can hold.
+ * @param[in] count The number of elements needed.
+ * @param[in] element_size The size of an element.
+ *
+ * @return Whether the memory could be allocated. If not, the buffer is left
+ * unchanged.
+ */
+static bool
+reserve(void **const buffer, size_t *const capacity, const size_t count,
+        const size_t element_size)
+{
+	if (count <= *capacity) {
+		return true;
+	}
+	if (count > SIZE_MAX / element_size) {
+		return false;
+	}
+	void *grown = realloc(*buffer, count * element_size);
+	if (grown == NULL) {
+		return false;
+	}
+	*buffer = grown;
+	*capacity = count;
+	return true;
+}
+
+/**
+ * @brief Allocates a matrix, with all its elements set to zero.
+ *
+ * @param[out] m The matrix to initialise.
+ * @param[in] n_lines The number of lines of the matrix.
+ * @param[in] n_col The number of columns of the matrix.
+ *
+ * @return Whether the memory could be allocated. If not, the matrix is left
+ * empty.
+ */
+bool
+matrix_init(matrix *const m, const size_t n_lines, const size_t n_col)
+{
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	m->data = NULL;
+	m->lines = NULL;
+	m->capacity = 0;
+	m->line_capacity = 0;
+	m->borrowed = false;
+	wide_table_init(&m->wide);
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	m->data = calloc(n_lines * m->stride, sizeof(fraction));
+	m->lines = allocate_line_index(n_lines);
+	if (m->data == NULL || m->lines == NULL) {
+		matrix_free(m);
+		return false;
+	}
+	m->capacity = n_lines * m->stride;
+	m->line_capacity = n_lines;
+	/* A zero fraction has a denominator of 1 */
+	for (size_t i = 0; i < n_lines * m->stride; i++) {
+		m->data[i].denominator = 1;
+	}
+	return true;
+}
+
+/**
+ * @brief Allocates a matrix from an arena, with all its elements set to
+ * zero.
+ *
+ * The buffers are released with the arena, matrix_free() only releases the
+ * promoted values. The matrix cannot be reshaped beyond its initial size.
+ *
+ * @see matrix_init
+ *
+ * @param[out] m The matrix to initialise.
+ * @param[in, out] a The arena to allocate from.
+ * @param[in] n_lines The number of lines of the matrix.
+ * @param[in] n_col The number of columns of the matrix.
+ *
+ * @return Whether the arena had enough room. If not, the matrix is left
+ * empty.
+ */
+bool
+matrix_init_in(matrix *const m, arena *const a, const size_t n_lines,
+               const size_t n_col)
+{
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	m->capacity = 0;
+	m->line_capacity = 0;
+	m->borrowed = true;
+	wide_table_init(&m->wide);
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	m->data = arena_alloc(a, n_lines * m->stride, sizeof(fraction));
+	m->lines = arena_alloc(a, n_lines, sizeof(size_t));
+	if (m->data == NULL || m->lines == NULL) {
+		matrix_free(m);
+		return false;
+	}
+	m->capacity = n_lines * m->stride;
+	m->line_capacity = n_lines;
+	for (size_t i = 0; i < n_lines; i++) {
+		m->lines[i] = i;
+	}
+	for (size_t i = 0; i < n_lines * m->stride; i++) {
+		m->data[i] = (fraction){0, 0, 1};
+	}
+	return true;
+}
+
+/**
+ * @brief Releases the memory held by a matrix.
+ *
+ * @param[in, out] m The matrix to free.
+ */
+void
+matrix_free(matrix *const m)
+{
+	if (!m->borrowed) {
+		free(m->data);
+		free(m->lines);
+	}
+	wide_table_free(&m->wide);
+	m->data = NULL;
+	m->lines = NULL;
+	m->n_lines = 0;
+	m->n_col = 0;
+	m->stride = 0;
+	m->capacity = 0;
+	m->line_capacity = 0;
+}
+
+/**
+ * @brief Changes the size of a matrix, reusing its memory.
+ *
+ * The memory only grows if the new size does not fit in it. As after
+ * matrix_init(), all the elements are set to zero and the lines are in
+ * order. The promoted values are dropped, but the table keeps its memory.
+ * A matrix allocated from an arena cannot grow.
+ *
+ * @param[in, out] m The matrix to reshape, initialised or empty.
+ * @param[in] n_lines The new number of lines.
+ * @param[in] n_col The new number of columns.
+ *
+ * @return Whether the memory could be allocated. If not, the matrix is left
+ * as it was.
+ */
+bool
+matrix_reshape(matrix *const m, const size_t n_lines, const size_t n_col)
+{
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	if (m->borrowed && (n_lines * n_col > m->capacity ||
+	                    n_lines > m->line_capacity)) {
+		/* The arena's memory cannot be reallocated */
+		return false;
+	}
+	void *data = m->data;
+	void *lines = m->lines;
+	bool reserved =
+	    reserve(&data, &m->capacity, n_lines * n_col, sizeof(fraction)) &&
+	    reserve(&lines, &m->line_capacity, n_lines, sizeof(size_t));
+	m->data = data;
+	m->lines = lines;
+	if (!reserved) {
+		return false;
+	}
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	for (size_t i = 0; i < n_lines; i++) {
+		m->lines[i] = i;
+	}
+	for (size_t i = 0; i < n_lines * n_col; i++) {
+		m->data[i] = (fraction){0, 0, 1};
+	}
+	wide_table_clear(&m->wide);
+	return true;
+}
+
+/**
+ * @brief Allocates an integer matrix, with all its elements set to zero.
+ *
+ * @see matrix_init
+ *
+ * @param[out] m The matrix to initialise.
+ * @param[in] n_lines The number of lines of the matrix.
+ * @param[in] n_col The number of columns of the matrix.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+integer_matrix_init(integer_matrix *const m, const size_t n_lines,
+                    const size_t n_col)
+{
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	m->data = NULL;
+	m->lines = NULL;
+	m->capacity = 0;
+	m->line_capacity = 0;
+	m->borrowed = false;
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	m->data = calloc(n_lines * m->stride, sizeof(int64_t));
+	m->lines = allocate_line_index(n_lines);
+	if (m->data == NULL || m->lines == NULL) {
+		integer_matrix_free(m);
+		return false;
+	}
+	m->capacity = n_lines * m->stride;
+	m->line_capacity = n_lines;
+	return true;
+}
+
+/**
+ * @brief Allocates an integer matrix from an arena, with all its elements
+ * set to zero.
+ *
+ * @see matrix_init_in
+ *
+ * @param[out] m The matrix to initialise.
+ * @param[in, out] a The arena to allocate from.
+ * @param[in] n_lines The number of lines of the matrix.
+ * @param[in] n_col The number of columns of the matrix.
+ *
+ * @return Whether the arena had enough room.
+ */
+bool
+integer_matrix_init_in(integer_matrix *const m, arena *const a,
+                       const size_t n_lines, const size_t n_col)
+{
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	m->capacity = 0;
+	m->line_capacity = 0;
+	m->borrowed = true;
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	m->data = arena_alloc(a, n_lines * m->stride, sizeof(int64_t));
+	m->lines = arena_alloc(a, n_lines, sizeof(size_t));
+	if (m->data == NULL || m->lines == NULL) {
+		integer_matrix_free(m);
+		return false;
+	}
+	m->capacity = n_lines * m->stride;
+	m->line_capacity = n_lines;
+	for (size_t i = 0; i < n_lines; i++) {
+		m->lines[i] = i;
+	}
+	for (size_t i = 0; i < n_lines * m->stride; i++) {
+		m->data[i] = 0;
+	}
+	return true;
+}
+
+/**
+ * @brief Releases the memory held by an integer matrix.
+ *
+ * @param[in, out] m The matrix to free.
+ */
+void
+integer_matrix_free(integer_matrix *const m)
+{
+	if (!m->borrowed) {
+		free(m->data);
+		free(m->lines);
+	}
+	m->data = NULL;
+	m->lines = NULL;
+	m->n_lines = 0;
+	m->n_col = 0;
+	m->stride = 0;
+	m->capacity = 0;
+	m->line_capacity = 0;
+}
+
+/**
+ * @brief Changes the size of an integer matrix, reusing its memory.
+ *
+ * @see matrix_reshape
+ *
+ * @param[in, out] m The matrix to reshape, initialised or empty.
+ * @param[in] n_lines The new number of lines.
+ * @param[in] n_col The new number of columns.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+integer_matrix_reshape(integer_matrix *const m, const size_t n_lines,
+                       const size_t n_col)
+{
+	if (n_col != 0 && n_lines > SIZE_MAX / n_col) {
+		return false;
+	}
+	if (m->borrowed && (n_lines * n_col > m->capacity ||
+	                    n_lines > m->line_capacity)) {
+		/* The arena's memory cannot be reallocated */
+		return false;
+	}
+	void *data = m->data;
+	void *lines = m->lines;
+	bool reserved =
+	    reserve(&data, &m->capacity, n_lines * n_col, sizeof(int64_t)) &&
+	    reserve(&lines, &m->line_capacity, n_lines, sizeof(size_t));
+	m->data = data;
+	m->lines = lines;
+	if (!reserved) {
+		return false;
+	}
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->stride = n_col;
+	for (size_t i = 0; i < n_lines; i++) {
+		m->lines[i] = i;
+	}
+	for (size_t i = 0; i < n_lines * n_col; i++) {
+		m->data[i] = 0;
+	}
+	return true;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file matrix.h
+ * @brief Definitions for matrix.c
+ * @see matrix.c
+ */
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "arena.h"
+#include "fractions.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A matrix of fractions.
+ *
+ * All the elements are stored in a single row-major buffer. The lines are
+ * accessed through a permutation index, so that swapping two lines only
+ * swaps two indices.
+ *
+ * The elements may be promoted: their values are then in the matrix's
+ * @ref wide_table, and they must be handled with the functions of tiered.h.
+ */
+struct matrix {
+	/** The elements of the matrix, stored line after line */
+	fraction *data;
+	/** The number of lines of the matrix */
+	size_t n_lines;
+	/** The number of columns of the matrix */
+	size_t n_col;
+	/** The number of elements between the starts of two stored lines */
+	size_t stride;
+	/** The index in the buffer of each line of the matrix, in order */
+	size_t *lines;
+	/** The number of elements the buffer can hold */
+	size_t capacity;
+	/** The number of lines the line index can hold */
+	size_t line_capacity;
+	/** Whether the buffers belong to an arena, rather than to the matrix */
+	bool borrowed;
+	/** The values of the elements that do not fit in a fraction */
+	wide_table wide;
+};
+
+/**
+ * @brief Definition of a type from the matrix structure.
+ * @see struct matrix
+ */
+typedef struct matrix matrix;
+
+/**
+ * @brief A matrix of integers.
+ *
+ * It is laid out the same way as a @ref matrix.
+ */
+struct integer_matrix {
+	/** The elements of the matrix, stored line after line */
+	int64_t *data;
+	/** The number of lines of the matrix */
+	size_t n_lines;
+	/** The number of columns of the matrix */
+	size_t n_col;
+	/** The number of elements between the starts of two stored lines */
+	size_t stride;
+	/** The index in the buffer of each line of the matrix, in order */
+	size_t *lines;
+	/** The number of elements the buffer can hold */
+	size_t capacity;
+	/** The number of lines the line index can hold */
+	size_t line_capacity;
+	/** Whether the buffers belong to an arena, rather than to the matrix */
+	bool borrowed;
+};
+
+/**
+ * @brief Definition of a type from the integer_matrix structure.
+ * @see struct integer_matrix
+ */
+typedef struct integer_matrix integer_matrix;
+
+bool matrix_init(matrix *const, const size_t, const size_t);
+bool matrix_init_in(matrix *const, arena *const, const size_t, const size_t);
+void matrix_free(matrix *const);
+bool matrix_reshape(matrix *const, const size_t, const size_t);
+bool integer_matrix_init(integer_matrix *const, const size_t, const size_t);
+bool integer_matrix_init_in(integer_matrix *const, arena *const, const size_t,
+                            const size_t);
+void integer_matrix_free(integer_matrix *const);
+bool integer_matrix_reshape(integer_matrix *const, const size_t,
+                            const size_t);
+
+/**
+ * @brief Gives a line of a matrix.
+ *
+ * @param[in] m The matrix to get the line of.
+ * @param[in] line The index of the line.
+ *
+ * @return A pointer to the first element of the line.
+ */
+static inline fraction *
+matrix_line(const matrix *const m, const size_t line)
+{
+	return m->data + m->lines[line] * m->stride;
+}
+
+/**
+ * @brief Swaps two lines of a matrix.
+ *
+ * The elements themselves are not moved.
+ *
+ * @param[in, out] m The matrix to modify.
+ * @param[in] line1 The index of one of the lines to swap.
+ * @param[in] line2 The index of the other line to swap.
+ */
+static inline void
+matrix_swap_lines(matrix *const m, const size_t line1, const size_t line2)
+{
+	size_t temp = m->lines[line1];
+	m->lines[line1] = m->lines[line2];
+	m->lines[line2] = temp;
+}
+
+/**
+ * @brief Gives a line of an integer matrix.
+ *
+ * @see matrix_line
+ *
+ * @param[in] m The matrix to get the line of.
+ * @param[in] line The index of the line.
+ *
+ * @return A pointer to the first element of the line.
+ */
+static inline int64_t *
+integer_matrix_line(const integer_matrix *const m, const size_t line)
+{
+	return m->data + m->lines[line] * m->stride;
+}
+
+/**
+ * @brief Swaps two lines of an integer matrix.
+ *
+ * @see matrix_swap_lines
+ *
+ * @param[in, out] m The matrix to modify.
+ * @param[in] line1 The index of one of the lines to swap.
+ * @param[in] line2 The index of the other line to swap.
+ */
+static inline void
+integer_matrix_swap_lines(integer_matrix *const m, const size_t line1,
+                          const size_t line2)
+{
+	size_t temp = m->lines[line1];
+	m->lines[line1] = m->lines[line2];
+	m->lines[line2] = temp;
+}
+
+#endif /* MATRIX_H */
@@ -0,0 +1,257 @@
+/**
+ * @file microbench.c
+ * @brief Measures the speed of the fraction operations.
+ *
+ * Each operation is timed over a pool of pre-generated operands, for several
+ * operand distributions resembling what the solver handles: whole numbers
+ * (the input matrix), small fractions (the first elimination steps) and
+ * fractions with large terms (the later steps). The results are printed in
+ * nanoseconds per operation.
+ *
+ * The line kernel of kernels.c is then compared with the same operation
+ * done one fraction at a time, with every instruction set the processor
+ * supports.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "fractions.h"
+#include "kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief The number of operands generated for each distribution. */
+#define POOL_SIZE 4096
+/** @brief The number of times each operation is performed. */
+#define ITERATIONS 20000000
+/** @brief The number of elements of the lines of the line benchmarks. */
+#define ROW_LENGTH 1024
+/** @brief The number of times each line operation is performed. */
+#define ROW_ITERATIONS 20000
+
+/**
+ * @brief A distribution of operands.
+ */
+struct distribution {
+	/** The name of the distribution, as printed */
+	const char *name;
+	/** The upper bound (excluded) of the numerators */
+	uint32_t max_numerator;
+	/** The upper bound (excluded) of the denominators */
+	uint32_t max_denominator;
+};
+
+/** @brief The state of the pseudo-random number generator. */
+static uint64_t rng_state = 0x9E3779B97F4A7C15u;
+
+/**
+ * @brief Gives a pseudo-random number.
+ *
+ * Uses a xorshift generator, so that the operands are the same on every run.
+ *
+ * @return A pseudo-random 32-bit number.
+ */
+static uint32_t
+next_random(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return (uint32_t)(rng_state >> 32);
+}
+
+/**
+ * @brief Fills a pool of operands from a distribution.
+ *
+ * The operands are stored in reduced form, as the solver would keep them.
+ *
+ * @param[out] pool The operands to generate.
+ * @param[in] dist The distribution to draw the operands from.
+ */
+static void
+fill_pool(fraction *const pool, const struct distribution *const dist)
+{
+	for (size_t i = 0; i < POOL_SIZE; i++) {
+		pool[i].negative = next_random() & 1;
+		pool[i].numerator = next_random() % dist->max_numerator + 1;
+		pool[i].denominator = next_random() % dist->max_denominator + 1;
+		simplify_fraction(&pool[i]);
+	}
+}
+
+/**
+ * @brief Gives the time elapsed since an instant, in nanoseconds.
+ *
+ * @param[in] start The instant to measure from.
+ *
+ * @return The number of nanoseconds elapsed.
+ */
+static double
+elapsed_ns(const struct timespec *const start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+	       (end.tv_nsec - start->tv_nsec);
+}
+
+/**
+ * @brief Times every fraction operation on a distribution of operands.
+ *
+ * @param[in] dist The distribution to draw the operands from.
+ */
+static void
+bench_distribution(const struct distribution *const dist)
+{
+	static fraction pool[POOL_SIZE];
+	fill_pool(pool, dist);
+	/* Keeps the compiler from discarding the results */
+	volatile uint32_t sink = 0;
+	struct timespec start;
+	fraction result = {0};
+	const size_t mask = POOL_SIZE - 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		multiply_fractions(&pool[i & mask], &pool[(i + 1) & mask],
+		                   &result);
+		sink += result.numerator;
+	}
+	printf("%-12s multiply  %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		subtract_fractions(&pool[i & mask], &pool[(i + 1) & mask],
+		                   &result);
+		sink += result.numerator;
+	}
+	printf("%-12s subtract  %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		submul_fractions(&pool[i & mask], &pool[(i + 1) & mask],
+		                 &pool[(i + 2) & mask], &result);
+		sink += result.numerator;
+	}
+	printf("%-12s submul    %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		sink += compare_fractions(&pool[i & mask],
+		                          &pool[(i + 1) & mask]);
+	}
+	printf("%-12s compare   %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		/* Un-reduce the operand so that there is work to do */
+		result.negative = false;
+		result.numerator = pool[i & mask].numerator * 6;
+		result.denominator = pool[i & mask].denominator * 6;
+		sink += simplify_fraction(&result);
+	}
+	printf("%-12s simplify  %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		invert_fraction(&pool[i & mask], &result);
+		sink += result.numerator;
+	}
+	printf("%-12s invert    %8.2f ns/op\n", dist->name,
+	       elapsed_ns(&start) / ITERATIONS);
+}
+
+/**
+ * @brief Times the line kernel against the fraction operations.
+ *
+ * The lines hold small whole numbers, like the input matrix. The line being
+ * updated is reset before each operation, so that nothing overflows.
+ *
+ * @param[in] dist The distribution to draw the operands from.
+ */
+static void
+bench_rows(const struct distribution *const dist)
+{
+	/* Only the first ROW_LENGTH operands are used */
+	static fraction pool[POOL_SIZE];
+	static fraction line[ROW_LENGTH];
+	arena rows;
+	fraction_row pivot;
+	fraction_row row;
+	if (!arena_init(&rows, 2 * fraction_row_arena_size(ROW_LENGTH)) ||
+	    !fraction_row_alloc(&pivot, &rows, ROW_LENGTH) ||
+	    !fraction_row_alloc(&row, &rows, ROW_LENGTH)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		exit(EXIT_FAILURE);
+	}
+	fill_pool(pool, dist);
+	for (size_t j = 0; j < ROW_LENGTH; j++) {
+		fraction_row_set(&pivot, j, &pool[j]);
+	}
+	const fraction factor = {true, 7, 1};
+	volatile uint32_t sink = 0;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ROW_ITERATIONS; i++) {
+		for (size_t j = 0; j < ROW_LENGTH; j++) {
+			line[j] = pool[(j + 1) % ROW_LENGTH];
+			submul_fractions(&line[j], &factor, &pool[j], &line[j]);
+		}
+		sink += line[i % ROW_LENGTH].numerator;
+	}
+	printf("%-12s submul    %8.2f ns/element\n", "fractions",
+	       elapsed_ns(&start) / ROW_ITERATIONS / ROW_LENGTH);
+
+	const char *const names[] = {"scalar", "sse4", "avx2"};
+	for (enum kernel_isa isa = KERNEL_SCALAR; isa <= KERNEL_AVX2; isa++) {
+		if (!kernel_select(isa)) {
+			continue;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (size_t i = 0; i < ROW_ITERATIONS; i++) {
+			for (size_t j = 0; j < ROW_LENGTH; j++) {
+				fraction_row_set(&row, j,
+				                 &pool[(j + 1) % ROW_LENGTH]);
+			}
+			sink += row_submul(&row, &factor, &pivot, 0,
+			                   ROW_LENGTH);
+		}
+		printf("%-12s submul    %8.2f ns/element\n", names[isa],
+		       elapsed_ns(&start) / ROW_ITERATIONS / ROW_LENGTH);
+	}
+	arena_free(&rows);
+}
+
+/**
+ * @brief The entry point of the microbenchmark.
+ *
+ * @return The ending status of the program.
+ */
+int
+main(void)
+{
+	/*
+	 * The bounds are chosen so that no operation overflows: the products
+	 * of two terms stay below 2^32.
+	 */
+	const struct distribution distributions[] = {
+	    {"whole", 1000, 1},
+	    {"small", 100, 100},
+	    {"large", 60000, 60000},
+	};
+	for (size_t i = 0; i < sizeof(distributions) / sizeof(*distributions);
+	     i++) {
+		bench_distribution(&distributions[i]);
+	}
+	bench_rows(&distributions[0]);
+	return EXIT_SUCCESS;
+}
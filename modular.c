@@ -0,0 +1,747 @@
+/**
+ * @file modular.c
+ * @brief Exact solving of integer systems through modular arithmetic.
+ *
+ * Instead of eliminating over the rationals, where the sizes of the values
+ * grow with every step, the system is solved modulo several primes that fit
+ * in a machine word. Each of these eliminations only ever handles integers
+ * smaller than the prime, and they are independent of each other, so they
+ * run on separate threads.
+ *
+ * The residues of each unknown are then combined with the Chinese remainder
+ * theorem, and the fraction they stand for is recovered by rational
+ * reconstruction. Enough primes are used for the product of the moduli to
+ * exceed twice the square of Hadamard's bound on the determinant, which
+ * makes the reconstruction unique. The solution is finally checked against
+ * the original system, with fractions.
+ *
+ * @see https://en.wikipedia.org/wiki/Chinese_remainder_theorem
+ * @see https://en.wikipedia.org/wiki/Rational_reconstruction_(mathematics)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "modular.h"
+
+#include "report.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/** @brief The number of bits each prime is guaranteed to contribute. */
+#define PRIME_BITS 30
+
+/** @brief The largest prime that can be used, \f$2^{31} - 1\f$. */
+#define LARGEST_PRIME 2147483647u
+
+/**
+ * @brief The eliminations of a system modulo a batch of primes, shared by
+ * the threads that perform them.
+ */
+struct modular_batch {
+	/** The system to solve */
+	const integer_matrix *system;
+	/** The primes to solve it modulo */
+	const uint32_t *primes;
+	/** The number of primes */
+	size_t n_primes;
+	/** The solution modulo each prime, one after the other */
+	uint32_t *residues;
+	/** Whether the system is singular modulo each prime */
+	bool *singular;
+	/** The index of the next prime to handle */
+	size_t next;
+	/** Whether a thread could not allocate its workspace */
+	bool failed;
+	/** The lock protecting `next` and `failed` */
+	pthread_mutex_t lock;
+};
+
+/* -- Arithmetic modulo a prime -- */
+
+/**
+ * @brief Raises an integer to a power, modulo another.
+ *
+ * @param[in] base The integer to raise.
+ * @param[in] exponent The power to raise it to.
+ * @param[in] modulus The modulus, smaller than \f$2^{32}\f$.
+ *
+ * @return The power, modulo `modulus`.
+ */
+static uint64_t
+power_mod(uint64_t base, uint64_t exponent, const uint64_t modulus)
+{
+	uint64_t result = 1;
+	base %= modulus;
+	while (exponent > 0) {
+		if (exponent & 1) {
+			result = result * base % modulus;
+		}
+		base = base * base % modulus;
+		exponent >>= 1;
+	}
+	return result;
+}
+
+/**
+ * @brief Tells whether a 32-bit integer is prime.
+ *
+ * Uses the Miller-Rabin test with the bases 2, 7 and 61, which is
+ * deterministic below \f$2^{32}\f$.
+ *
+ * @param[in] n The integer to test.
+ *
+ * @return Whether the integer is prime.
+ */
+bool
+is_word_prime(const uint32_t n)
+{
+	static const uint32_t bases[] = {2, 7, 61};
+	if (n < 2) {
+		return false;
+	}
+	for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+		if (n == bases[i]) {
+			return true;
+		}
+		if (n % bases[i] == 0) {
+			return false;
+		}
+	}
+	const int shift = __builtin_ctz(n - 1);
+	const uint32_t odd = (n - 1) >> shift;
+	for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+		uint64_t x = power_mod(bases[i], odd, n);
+		if (x == 1 || x == n - 1) {
+			continue;
+		}
+		int squarings = 1;
+		for (; squarings < shift; squarings++) {
+			x = x * x % n;
+			if (x == n - 1) {
+				break;
+			}
+		}
+		if (squarings == shift) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Gives the inverse of an integer modulo another.
+ *
+ * @param[in] a The integer to invert. It must be coprime with `modulus`.
+ * @param[in] modulus The modulus.
+ *
+ * @return The integer \f$x < modulus\f$ such that
+ * \f$ax \equiv 1 \pmod{modulus}\f$.
+ */
+uint32_t
+inverse_mod(const uint32_t a, const uint32_t modulus)
+{
+	int64_t old_r = a % modulus;
+	int64_t r = modulus;
+	int64_t old_s = 1;
+	int64_t s = 0;
+	while (r != 0) {
+		int64_t q = old_r / r;
+		int64_t temp = old_r - q * r;
+		old_r = r;
+		r = temp;
+		temp = old_s - q * s;
+		old_s = s;
+		s = temp;
+	}
+	return (uint32_t)(old_s < 0 ? old_s + modulus : old_s);
+}
+
+/**
+ * @brief Solves a system modulo a prime.
+ *
+ * The elimination is done Gauss-Jordan style, normalising each pivot line so
+ * that the last column holds the solution at the end.
+ *
+ * @param[in] system The system to solve.
+ * @param[in] prime The prime to solve it modulo.
+ * @param[out] work A workspace as large as the system.
+ * @param[out] solution Where to store the value of each unknown.
+ *
+ * @return Whether the system is regular modulo the prime.
+ */
+static bool
+solve_modulo(const integer_matrix *const system, const uint32_t prime,
+             uint32_t *const work, uint32_t *const solution)
+{
+	const size_t n = system->n_lines;
+	const size_t n_col = system->n_col;
+	const int64_t p = prime;
+
+	for (size_t i = 0; i < n; i++) {
+		const int64_t *line = integer_matrix_line(system, i);
+		for (size_t j = 0; j < n_col; j++) {
+			int64_t value = line[j] % p;
+			work[i * n_col + j] = (uint32_t)(value < 0 ? value + p
+			                                           : value);
+		}
+	}
+
+	for (size_t k = 0; k < n; k++) {
+		size_t pivot = k;
+		while (pivot < n && work[pivot * n_col + k] == 0) {
+			pivot++;
+		}
+		if (pivot == n) {
+			return false;
+		}
+		uint32_t *pivot_line = work + k * n_col;
+		if (pivot != k) {
+			uint32_t *other = work + pivot * n_col;
+			for (size_t j = k; j < n_col; j++) {
+				uint32_t temp = pivot_line[j];
+				pivot_line[j] = other[j];
+				other[j] = temp;
+			}
+		}
+
+		const uint64_t inverse = inverse_mod(pivot_line[k], prime);
+		for (size_t j = k; j < n_col; j++) {
+			pivot_line[j] =
+			    (uint32_t)(pivot_line[j] * inverse % prime);
+		}
+		for (size_t i = 0; i < n; i++) {
+			uint32_t *line = work + i * n_col;
+			if (i == k || line[k] == 0) {
+				continue;
+			}
+			/* Subtracting is adding the opposite of the factor */
+			const uint64_t factor = prime - line[k];
+			for (size_t j = k; j < n_col; j++) {
+				line[j] = (uint32_t)((line[j] +
+				                      factor * pivot_line[j]) %
+				                     prime);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		solution[i] = work[i * n_col + n_col - 1];
+	}
+	return true;
+}
+
+/**
+ * @brief Solves a system modulo the primes of a batch, until none are left.
+ *
+ * This is the body of the threads of modular_solve(), which can also be
+ * called directly.
+ *
+ * @param[in, out] argument The @ref modular_batch to work on.
+ *
+ * @return NULL.
+ */
+static void *
+modular_worker(void *const argument)
+{
+	struct modular_batch *batch = argument;
+	const integer_matrix *system = batch->system;
+	uint32_t *work = malloc(system->n_lines * system->n_col *
+	                        sizeof(uint32_t));
+	if (work == NULL) {
+		pthread_mutex_lock(&batch->lock);
+		batch->failed = true;
+		pthread_mutex_unlock(&batch->lock);
+		return NULL;
+	}
+	for (;;) {
+		pthread_mutex_lock(&batch->lock);
+		size_t i = batch->next++;
+		pthread_mutex_unlock(&batch->lock);
+		if (i >= batch->n_primes) {
+			break;
+		}
+		batch->singular[i] =
+		    !solve_modulo(system, batch->primes[i], work,
+		                  batch->residues + i * system->n_lines);
+	}
+	free(work);
+	return NULL;
+}
+
+/**
+ * @brief Solves a system modulo a batch of primes, in parallel.
+ *
+ * One thread is started per online processor, the calling thread being one
+ * of them, and they take the primes one at a time.
+ *
+ * @param[in, out] batch The batch to solve.
+ *
+ * @return Whether all the eliminations could be done.
+ */
+static bool
+run_batch(struct modular_batch *const batch)
+{
+	long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n_threads < 1) {
+		n_threads = 1;
+	}
+	if ((size_t)n_threads > batch->n_primes) {
+		n_threads = (long)batch->n_primes;
+	}
+
+	batch->next = 0;
+	batch->failed = false;
+	pthread_t *threads = malloc((size_t)n_threads * sizeof(pthread_t));
+	long started = 0;
+	if (threads != NULL) {
+		while (started < n_threads - 1 &&
+		       pthread_create(&threads[started], NULL, modular_worker,
+		                      batch) == 0) {
+			started++;
+		}
+	}
+	modular_worker(batch);
+	for (long i = 0; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	/* A thread that failed to allocate left its primes to the others */
+	return batch->next > batch->n_primes || !batch->failed;
+}
+
+/* -- Reconstruction of the solution -- */
+
+/**
+ * @brief Gives an upper bound on the size of the minors of a system.
+ *
+ * This is Hadamard's bound: the product of the norms of the lines of the
+ * augmented matrix bounds the determinant of the system and those of the
+ * matrices of Cramer's rule.
+ *
+ * @param[in] system The system to bound the minors of.
+ *
+ * @return The number of bits of the bound.
+ */
+static size_t
+hadamard_bits(const integer_matrix *const system)
+{
+	size_t bits = 0;
+	for (size_t i = 0; i < system->n_lines; i++) {
+		const int64_t *line = integer_matrix_line(system, i);
+		double squared_norm = 0;
+		for (size_t j = 0; j < system->n_col; j++) {
+			squared_norm += (double)line[j] * (double)line[j];
+		}
+		size_t line_bits = 0;
+		while (squared_norm >= 1) {
+			squared_norm /= 2;
+			line_bits++;
+		}
+		bits += (line_bits + 1) / 2;
+	}
+	return bits;
+}
+
+/**
+ * @brief Tells whether an integer is small enough to be a term of a
+ * reconstructed fraction.
+ *
+ * @param[in] n The integer to check.
+ * @param[in] modulus The modulus of the reconstruction.
+ * @param[out] below Where to store whether \f$2n^2 < modulus\f$.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+below_bound(const big_integer *const n, const big_integer *const modulus,
+            bool *const below)
+{
+	big_integer twice_square;
+	big_integer_init(&twice_square);
+	bool allocated =
+	    big_integer_multiply(&twice_square, n, n) &&
+	    big_integer_add(&twice_square, &twice_square, &twice_square);
+	*below = allocated && big_integer_compare(&twice_square, modulus) < 0;
+	big_integer_free(&twice_square);
+	return allocated;
+}
+
+/**
+ * @brief Subtracts a signed big integer from another.
+ *
+ * @param[in, out] a_negative The sign of the integer being subtracted from,
+ * replaced by that of the difference.
+ * @param[in, out] a The magnitude of the integer being subtracted from,
+ * replaced by that of the difference.
+ * @param[in] b_negative The sign of the integer being subtracted.
+ * @param[in] b The magnitude of the integer being subtracted.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+signed_subtract(bool *const a_negative, big_integer *const a,
+                const bool b_negative, const big_integer *const b)
+{
+	if (*a_negative != b_negative) {
+		return big_integer_add(a, a, b);
+	}
+	if (big_integer_compare(a, b) >= 0) {
+		return big_integer_subtract(a, a, b);
+	}
+	*a_negative = !*a_negative;
+	return big_integer_subtract(a, b, a);
+}
+
+/**
+ * @brief Finds the fraction congruent to an integer modulo another.
+ *
+ * The extended Euclidian algorithm is run on the modulus and the residue,
+ * and stopped at the first remainder \f$r\f$ with \f$2r^2 < modulus\f$. The
+ * fraction is then \f$r / t\f$, where \f$t\f$ is the matching Bézout
+ * coefficient of the residue. It is unique when both of its terms are below
+ * \f$\sqrt{modulus / 2}\f$.
+ *
+ * @param[out] result Where to store the fraction. It must be initialised.
+ * @param[in] residue The residue to reconstruct, smaller than the modulus.
+ * @param[in] modulus The modulus.
+ * @param[out] found Where to store whether a small enough fraction exists.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+rational_reconstruction(big_fraction *const result,
+                        const big_integer *const residue,
+                        const big_integer *const modulus, bool *const found)
+{
+	big_integer r0, r1, t0, t1, quotient, remainder, product;
+	big_integer_init(&r0);
+	big_integer_init(&r1);
+	big_integer_init(&t0);
+	big_integer_init(&t1);
+	big_integer_init(&quotient);
+	big_integer_init(&remainder);
+	big_integer_init(&product);
+	bool t0_negative = false;
+	bool t1_negative = false;
+	bool below = false;
+	bool allocated = big_integer_copy(&r0, modulus) &&
+	                 big_integer_copy(&r1, residue) &&
+	                 big_integer_set_u64(&t1, 1);
+
+	while (allocated) {
+		allocated = below_bound(&r1, modulus, &below);
+		if (!allocated || below) {
+			break;
+		}
+		/* t0 - quotient * t1 becomes the new t1 */
+		allocated =
+		    big_integer_divide(&quotient, &remainder, &r0, &r1) &&
+		    big_integer_copy(&r0, &r1) &&
+		    big_integer_copy(&r1, &remainder) &&
+		    big_integer_multiply(&product, &quotient, &t1) &&
+		    signed_subtract(&t0_negative, &t0, t1_negative, &product);
+		big_integer temp = t0;
+		t0 = t1;
+		t1 = temp;
+		bool temp_negative = t0_negative;
+		t0_negative = t1_negative;
+		t1_negative = temp_negative;
+	}
+
+	allocated = allocated && big_integer_gcd(&remainder, &r1, &t1) &&
+	            below_bound(&t1, modulus, &below);
+	*found = allocated && below && remainder.length == 1 &&
+	         remainder.limbs[0] == 1;
+	if (*found) {
+		result->negative = t1_negative && r1.length > 0;
+		allocated =
+		    big_integer_copy(&result->numerator, &r1) &&
+		    big_integer_copy(&result->denominator, &t1);
+	}
+
+	big_integer_free(&r0);
+	big_integer_free(&r1);
+	big_integer_free(&t0);
+	big_integer_free(&t1);
+	big_integer_free(&quotient);
+	big_integer_free(&remainder);
+	big_integer_free(&product);
+	return allocated;
+}
+
+/**
+ * @brief Rebuilds the solution of a system from its residues.
+ *
+ * Garner's algorithm combines the residues of each unknown, then the
+ * fraction is recovered by rational reconstruction.
+ *
+ * @param[in] primes The primes the system was solved modulo.
+ * @param[in] n_primes The number of primes.
+ * @param[in] residues The solution modulo each prime, one after the other.
+ * @param[in] n The number of unknowns.
+ * @param[in, out] table The storage of the promoted values.
+ * @param[out] solution Where to store the value of each unknown.
+ *
+ * @return Whether every unknown could be reconstructed. The table is marked
+ * as failed if the memory could not be allocated.
+ */
+static bool
+reconstruct(const uint32_t *const primes, const size_t n_primes,
+            const uint32_t *const residues, const size_t n,
+            wide_table *const table, fraction *const solution)
+{
+	/* The product of the previous primes, and its inverse modulo each */
+	big_integer *moduli = malloc((n_primes + 1) * sizeof(big_integer));
+	uint32_t *inverses = malloc(n_primes * sizeof(uint32_t));
+	if (moduli == NULL || inverses == NULL) {
+		free(moduli);
+		free(inverses);
+		table->failed = true;
+		return false;
+	}
+	big_integer prime;
+	big_integer_init(&prime);
+	for (size_t t = 0; t <= n_primes; t++) {
+		big_integer_init(&moduli[t]);
+	}
+	bool allocated = big_integer_set_u64(&moduli[0], 1);
+	for (size_t t = 0; allocated && t < n_primes; t++) {
+		/* Without a quotient, the division allocates nothing */
+		uint32_t residue = 0;
+		big_integer_divide_limb(NULL, &residue, &moduli[t], primes[t]);
+		inverses[t] = inverse_mod(residue, primes[t]);
+		allocated = big_integer_set_u64(&prime, primes[t]) &&
+		            big_integer_multiply(&moduli[t + 1], &moduli[t],
+		                                 &prime);
+	}
+
+	bool reconstructed = true;
+	big_integer value, step;
+	big_integer_init(&value);
+	big_integer_init(&step);
+	big_fraction result;
+	big_fraction_init(&result);
+	for (size_t i = 0; i < n && allocated && reconstructed; i++) {
+		value.length = 0;
+		for (size_t t = 0; allocated && t < n_primes; t++) {
+			const uint64_t p = primes[t];
+			uint32_t current = 0;
+			big_integer_divide_limb(NULL, &current, &value,
+			                        primes[t]);
+			uint64_t digit = (residues[t * n + i] + p - current) %
+			                 p * inverses[t] % p;
+			allocated =
+			    big_integer_set_u64(&prime, digit) &&
+			    big_integer_multiply(&step, &moduli[t], &prime) &&
+			    big_integer_add(&value, &value, &step);
+		}
+		allocated = allocated &&
+		            rational_reconstruction(&result, &value,
+		                                    &moduli[n_primes],
+		                                    &reconstructed);
+		if (allocated && reconstructed) {
+			allocated = tiered_set_big(table, &solution[i], &result);
+		}
+	}
+	if (!allocated) {
+		table->failed = true;
+	}
+
+	big_fraction_free(&result);
+	big_integer_free(&value);
+	big_integer_free(&step);
+	big_integer_free(&prime);
+	for (size_t t = 0; t <= n_primes; t++) {
+		big_integer_free(&moduli[t]);
+	}
+	free(moduli);
+	free(inverses);
+	return allocated && reconstructed;
+}
+
+/**
+ * @brief Sets a fraction to an integer, whatever its size.
+ *
+ * The table is marked as failed if the memory could not be allocated.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in] value The integer.
+ * @param[out] result Where to store the fraction.
+ */
+static void
+tiered_from_integer(wide_table *const table, const int64_t value,
+                    fraction *const result)
+{
+	if (fraction_from_quotient(value, 1, result)) {
+		return;
+	}
+	big_fraction big;
+	big_fraction_init(&big);
+	uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+	result->negative = false;
+	result->numerator = 0;
+	result->denominator = 1;
+	if (big_fraction_set(&big, value < 0, magnitude, 1)) {
+		tiered_set_big(table, result, &big);
+	} else {
+		table->failed = true;
+	}
+	big_fraction_free(&big);
+}
+
+/* -- Public functions -- */
+
+/**
+ * @brief Checks that values are the solution of a system.
+ *
+ * Every equation is evaluated exactly, with fractions.
+ *
+ * @param[in] system The system, as an augmented integer matrix.
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in] solution The value of each unknown.
+ *
+ * @return Whether the values satisfy every equation.
+ */
+bool
+verify_solution(const integer_matrix *const system, wide_table *const table,
+                const fraction *const solution)
+{
+	const size_t n_unknowns = system->n_col - 1;
+	bool satisfied = true;
+	for (size_t i = 0; i < system->n_lines && satisfied; i++) {
+		const int64_t *line = integer_matrix_line(system, i);
+		fraction remainder = {0, 0, 1};
+		tiered_from_integer(table, line[n_unknowns], &remainder);
+		for (size_t j = 0; j < n_unknowns; j++) {
+			if (line[j] == 0) {
+				continue;
+			}
+			fraction coefficient = {0, 0, 1};
+			tiered_from_integer(table, line[j], &coefficient);
+			tiered_submul(table, &remainder, &coefficient,
+			              &solution[j]);
+			tiered_release(table, &coefficient);
+		}
+		satisfied = tiered_is_zero(&remainder);
+		tiered_release(table, &remainder);
+	}
+	return satisfied;
+}
+
+/**
+ * @brief Solves a system exactly, with modular arithmetic.
+ *
+ * The primes are taken downwards from \f$2^{31} - 1\f$. Those modulo which
+ * the system is singular are skipped, unless there are so many of them that
+ * the determinant must be zero.
+ *
+ * @param[in] system The system to solve, as a square augmented matrix.
+ * @param[in, out] table The storage of the promoted values.
+ * @param[out] solution Where to store the value of each unknown. The
+ * fractions must be initialised.
+ * @param[out] n_primes Where to store the number of primes the system was
+ * solved modulo, once it is solved modulo enough of them.
+ * @param[out] error Where to describe why the system could not be solved,
+ * or NULL.
+ *
+ * @return Whether the system could be solved. If the memory could not be
+ * allocated, the table is marked as failed and the error is left as it is.
+ */
+bool
+modular_solve(const integer_matrix *const system, wide_table *const table,
+              fraction *const solution, size_t *const n_primes,
+              char *const error)
+{
+	const size_t n = system->n_lines;
+	const size_t bound_bits = hadamard_bits(system);
+	/* The modulus must exceed twice the square of the bound */
+	const size_t n_needed = (2 * bound_bits + 1) / PRIME_BITS + 1;
+
+	uint32_t *primes = malloc(n_needed * sizeof(uint32_t));
+	uint32_t *residues = malloc(n_needed * n * sizeof(uint32_t));
+	uint32_t *batch_primes = malloc(n_needed * sizeof(uint32_t));
+	uint32_t *batch_residues = malloc(n_needed * n * sizeof(uint32_t));
+	bool *singular = malloc(n_needed * sizeof(bool));
+	if (primes == NULL || residues == NULL || batch_primes == NULL ||
+	    batch_residues == NULL || singular == NULL) {
+		free(primes);
+		free(residues);
+		free(batch_primes);
+		free(batch_residues);
+		free(singular);
+		table->failed = true;
+		return false;
+	}
+
+	struct modular_batch batch = {0};
+	batch.system = system;
+	batch.primes = batch_primes;
+	batch.residues = batch_residues;
+	batch.singular = singular;
+	pthread_mutex_init(&batch.lock, NULL);
+
+	bool solved = true;
+	size_t n_good = 0;
+	size_t n_singular = 0;
+	uint32_t candidate = LARGEST_PRIME;
+	while (solved && n_good < n_needed) {
+		batch.n_primes = n_needed - n_good;
+		for (size_t t = 0; t < batch.n_primes; t++) {
+			while (!is_word_prime(candidate)) {
+				candidate -= 2;
+			}
+			batch_primes[t] = candidate;
+			candidate -= 2;
+		}
+		if (!run_batch(&batch)) {
+			table->failed = true;
+			solved = false;
+			break;
+		}
+		for (size_t t = 0; t < batch.n_primes; t++) {
+			if (singular[t]) {
+				n_singular++;
+				continue;
+			}
+			primes[n_good] = batch_primes[t];
+			memcpy(residues + n_good * n, batch_residues + t * n,
+			       n * sizeof(uint32_t));
+			n_good++;
+		}
+		/* The determinant cannot be a multiple of all these primes */
+		if (n_singular * PRIME_BITS > bound_bits) {
+			report_error(error, "the system is singular");
+			solved = false;
+		}
+	}
+	pthread_mutex_destroy(&batch.lock);
+	if (solved) {
+		*n_primes = n_good + n_singular;
+	}
+
+	if (solved &&
+	    !reconstruct(primes, n_good, residues, n, table, solution)) {
+		if (!table->failed) {
+			report_error(error,
+			             "the solution could not be reconstructed");
+		}
+		solved = false;
+	}
+	if (solved && !verify_solution(system, table, solution)) {
+		if (!table->failed) {
+			report_error(error,
+			             "the solution does not satisfy the system");
+		}
+		solved = false;
+	}
+
+	free(primes);
+	free(residues);
+	free(batch_primes);
+	free(batch_residues);
+	free(singular);
+	return solved && !table->failed;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file modular.h
+ * @brief Function prototypes for modular.c
+ * @see modular.c
+ */
+
+#ifndef MODULAR_H
+#define MODULAR_H
+
+#include "bigfrac.h"
+#include "fractions.h"
+#include "matrix.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+bool is_word_prime(const uint32_t);
+uint32_t inverse_mod(const uint32_t, const uint32_t);
+bool rational_reconstruction(big_fraction *const, const big_integer *const,
+                             const big_integer *const, bool *const);
+bool modular_solve(const integer_matrix *const, wide_table *const,
+                   fraction *const, size_t *const, char *const);
+bool verify_solution(const integer_matrix *const, wide_table *const,
+                     const fraction *const);
+
+#endif /* MODULAR_H */
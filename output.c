@@ -0,0 +1,374 @@
+/**
+ * @file output.c
+ * @brief The printing of the matrices and of the solutions.
+ *
+ * The results are written to the buffer of an @ref output, in the format it
+ * was given: the program flushes it to the standard output, the server sends
+ * it in its responses.
+ *
+ * @see main.c
+ * @see server.c
+ */
+
+#include "output.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Gives the glyph opening a line of a pretty-printed matrix.
+ *
+ * The matrix is pretty-printed with brackets represented either with
+ * parenthesises for single-line matrix or with a combination of slashes and
+ * vertical bars for multi-line matrixes.
+ *
+ * @param[in] line The index of the line being printed.
+ * @param[in] n_lines The number of lines of the matrix.
+ *
+ * @return The glyph, as a string.
+ */
+const char *
+opening_bracket(const size_t line, const size_t n_lines)
+{
+	if (line == 0) {
+		return "⎛";
+	} else if (line == n_lines - 1) {
+		return "⎝";
+	} else {
+		return "⎜";
+	}
+}
+
+/**
+ * @brief Gives the glyph closing a line of a pretty-printed matrix.
+ *
+ * @see opening_bracket
+ *
+ * @param[in] line The index of the line being printed.
+ * @param[in] n_lines The number of lines of the matrix.
+ *
+ * @return The glyph, as a string.
+ */
+const char *
+closing_bracket(const size_t line, const size_t n_lines)
+{
+	if (line == 0) {
+		return "⎞";
+	} else if (line == n_lines - 1) {
+		return "⎠";
+	} else {
+		return "⎟";
+	}
+}
+
+/**
+ * @brief Pretty-prints a matrix.
+ *
+ * Prints a matrix of fractions, formatted as a matrix, after a title. Nothing
+ * is printed if the output only holds the results.
+ *
+ * @param[in, out] out The output.
+ * @param[in] title The title of the matrix.
+ * @param[in] matrix The matrix to print.
+ */
+void
+pp_matrix(output *const out, const char *const title,
+          const matrix *const matrix)
+{
+	if (!out->matrices) {
+		return;
+	}
+	writer *w = &out->writer;
+	writer_string(w, title);
+	writer_char(w, '\n');
+	for (size_t i = 0; i < matrix->n_lines; i++) {
+		const fraction *line = matrix_line(matrix, i);
+		writer_string(w, opening_bracket(i, matrix->n_lines));
+		for (size_t j = 0; j < matrix->n_col; j++) {
+			writer_fraction(w, &matrix->wide, &line[j]);
+			if (j != matrix->n_col - 1) {
+				writer_char(w, ' ');
+			}
+		}
+		writer_string(w, closing_bracket(i, matrix->n_lines));
+		writer_char(w, '\n');
+	}
+}
+
+/**
+ * @brief Pretty-prints an integer matrix.
+ *
+ * @see pp_matrix
+ *
+ * @param[in, out] out The output.
+ * @param[in] title The title of the matrix.
+ * @param[in] matrix The matrix to print.
+ */
+void
+pp_integer_matrix(output *const out, const char *const title,
+                  const integer_matrix *const matrix)
+{
+	if (!out->matrices) {
+		return;
+	}
+	writer *w = &out->writer;
+	writer_string(w, title);
+	writer_char(w, '\n');
+	for (size_t i = 0; i < matrix->n_lines; i++) {
+		const int64_t *line = integer_matrix_line(matrix, i);
+		writer_string(w, opening_bracket(i, matrix->n_lines));
+		for (size_t j = 0; j < matrix->n_col; j++) {
+			writer_signed(w, line[j]);
+			if (j != matrix->n_col - 1) {
+				writer_char(w, ' ');
+			}
+		}
+		writer_string(w, closing_bracket(i, matrix->n_lines));
+		writer_char(w, '\n');
+	}
+}
+
+/**
+ * @brief Prints the blank line separating the matrices, if they are printed.
+ *
+ * @param[in, out] out The output.
+ */
+void
+pp_blank_line(output *const out)
+{
+	if (out->matrices) {
+		writer_char(&out->writer, '\n');
+	}
+}
+
+/**
+ * @brief Prints what comes before the values of the solution.
+ *
+ * That is the header line of the CSV format, and the header of the binary
+ * one: the magic bytes `LQSR`, the version of the format, whether the values
+ * are exact, two zero bytes, then the number of unknowns and of right-hand
+ * sides as little-endian 64-bit integers.
+ *
+ * @param[in, out] out The output.
+ * @param[in] n The number of unknowns.
+ * @param[in] n_rhs The number of right-hand sides.
+ * @param[in] exact Whether the values are exact fractions, rather than
+ * approximations.
+ */
+void
+print_results_header(output *const out, const size_t n, const size_t n_rhs,
+                     const bool exact)
+{
+	writer *w = &out->writer;
+	if (out->format == FORMAT_CSV) {
+		writer_string(w, "rhs,variable,numerator,denominator,"
+		                 "approximation\n");
+	} else if (out->format == FORMAT_BINARY) {
+		const unsigned char header[8] = {
+		    'L', 'Q', 'S', 'R', RESULTS_VERSION, exact, 0, 0};
+		writer_bytes(w, header, sizeof(header));
+		writer_le(w, n, 8);
+		writer_le(w, n_rhs, 8);
+	}
+}
+
+/**
+ * @brief Prints the value of one of the system's variables.
+ *
+ * The exact value is given as a fraction, with its approximation. In the
+ * binary format, only the fraction is written, as by tiered_write().
+ *
+ * @param[in, out] out The output.
+ * @param[in] rhs The index of the right-hand side, starting from 0.
+ * @param[in] index The index of the variable, starting from 0.
+ * @param[in] table The storage of the value, if it is promoted.
+ * @param[in] value The value of the variable.
+ */
+void
+print_variable(output *const out, const size_t rhs, const size_t index,
+               const wide_table *const table, const fraction *const value)
+{
+	writer *w = &out->writer;
+	const double approx = tiered_to_double(table, value);
+	switch (out->format) {
+	case FORMAT_TEXT:
+		writer_string(w, "The value of the variable ");
+		writer_unsigned(w, index + 1);
+		writer_string(w, " is: ");
+		/* The approximation has always been that of a float */
+		writer_double(w, "%g", (float)approx);
+		writer_string(w, " (");
+		writer_fraction(w, table, value);
+		writer_string(w, ").\n");
+		break;
+	case FORMAT_CSV:
+		writer_unsigned(w, rhs + 1);
+		writer_char(w, ',');
+		writer_unsigned(w, index + 1);
+		writer_char(w, ',');
+		writer_numerator(w, table, value);
+		writer_char(w, ',');
+		writer_denominator(w, table, value);
+		writer_double(w, ",%.17g\n", approx);
+		break;
+	case FORMAT_JSONL:
+		writer_string(w, "{\"rhs\": ");
+		writer_unsigned(w, rhs + 1);
+		writer_string(w, ", \"variable\": ");
+		writer_unsigned(w, index + 1);
+		writer_string(w, ", \"numerator\": \"");
+		writer_numerator(w, table, value);
+		writer_string(w, "\", \"denominator\": \"");
+		writer_denominator(w, table, value);
+		writer_double(w, "\", \"approximation\": %.17g}\n", approx);
+		break;
+	case FORMAT_BINARY:
+		writer_binary_fraction(w, table, value);
+		break;
+	}
+}
+
+/**
+ * @brief Prints the approximate value of one of the system's variables.
+ *
+ * @see print_variable
+ *
+ * @param[in, out] out The output.
+ * @param[in] rhs The index of the right-hand side, starting from 0.
+ * @param[in] index The index of the variable, starting from 0.
+ * @param[in] value The value of the variable.
+ */
+void
+print_approximation(output *const out, const size_t rhs, const size_t index,
+                    const double value)
+{
+	writer *w = &out->writer;
+	switch (out->format) {
+	case FORMAT_TEXT:
+		writer_string(w, "The value of the variable ");
+		writer_unsigned(w, index + 1);
+		writer_double(w, " is: %g.\n", value);
+		break;
+	case FORMAT_CSV:
+		writer_unsigned(w, rhs + 1);
+		writer_char(w, ',');
+		writer_unsigned(w, index + 1);
+		writer_double(w, ",,,%.17g\n", value);
+		break;
+	case FORMAT_JSONL:
+		writer_string(w, "{\"rhs\": ");
+		writer_unsigned(w, rhs + 1);
+		writer_string(w, ", \"variable\": ");
+		writer_unsigned(w, index + 1);
+		writer_double(w, ", \"approximation\": %.17g}\n", value);
+		break;
+	case FORMAT_BINARY: {
+		uint64_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		writer_le(w, bits, 8);
+		break;
+	}
+	}
+}
+
+/**
+ * @brief Gives the format of the results from its name.
+ *
+ * @param[in] name The name of the format: text, csv, jsonl or binary.
+ * @param[out] format Where to store the format.
+ *
+ * @return Whether the name is the one of a format.
+ */
+bool
+parse_output_format(const char *const name, enum output_format *const format)
+{
+	static const char *const names[] = {"text", "csv", "jsonl", "binary"};
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (strcmp(name, names[i]) == 0) {
+			*format = (enum output_format)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Prints the solution of a solver's system, one unknown per line.
+ *
+ * With several right-hand sides, the solution of each one is preceded by
+ * its number in the text format.
+ *
+ * @param[in, out] out The output.
+ * @param[in] s The solver, whose system was solved.
+ */
+void
+print_solution(output *const out, const solver *const s)
+{
+	const bool exact = s->engine != ENGINE_FLOAT;
+	print_results_header(out, s->n, s->n_rhs, exact);
+	for (size_t r = 0; r < s->n_rhs; r++) {
+		if (s->n_rhs > 1 && out->format == FORMAT_TEXT) {
+			writer_string(&out->writer, "Right-hand side ");
+			writer_unsigned(&out->writer, r + 1);
+			writer_string(&out->writer, ":\n");
+		}
+		for (size_t i = 0; i < s->n; i++) {
+			const size_t index = r * s->n + i;
+			if (exact) {
+				print_variable(out, r, i, s->solution_table,
+				               &s->solution[index]);
+			} else {
+				print_approximation(out, r, i,
+				                    s->approximations[index]);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Solves a sparse system, and prints its solution.
+ *
+ * @param[in, out] out The output.
+ * @param[in, out] system The augmented sparse matrix of the system, reduced
+ * in place.
+ * @param[out] error Where to describe why the system could not be solved.
+ *
+ * @return Whether the system could be solved.
+ */
+bool
+print_sparse_results(output *const out, sparse_matrix *const system,
+                     char *const error)
+{
+	const size_t n = system->n_lines;
+	fprintf(stderr,
+	        "Solving as a sparse system, %zu of the %zu elements are not "
+	        "zero.\n",
+	        sparse_count(system), n * system->n_col);
+	fraction *solution = malloc(n * sizeof(fraction));
+	if (solution == NULL) {
+		report_error(error, "the memory was not allocated");
+		return false;
+	}
+	bool solved = sparse_solve(system, solution, error);
+	if (!solved && system->wide.failed) {
+		report_error(error, "the memory was not allocated");
+	}
+	if (solved) {
+		print_results_header(out, n, 1, true);
+		for (size_t i = 0; i < n; i++) {
+			print_variable(out, 0, i, &system->wide, &solution[i]);
+		}
+		for (size_t i = 0; i < n; i++) {
+			tiered_release(&system->wide, &solution[i]);
+		}
+	}
+	fprintf(stderr,
+	        "The elimination created %zu non-zero elements. %zu values "
+	        "were promoted to 64 bits, %zu to arbitrary precision.\n",
+	        system->fill_in, system->wide.promotions_to_64,
+	        system->wide.promotions_to_big);
+	free(solution);
+	return solved;
+}
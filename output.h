@@ -0,0 +1,67 @@
+/**
+ * @file output.h
+ * @brief Definitions for output.c
+ * @see output.c
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "solver.h"
+#include "writer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief The version of the binary format of the results. */
+#define RESULTS_VERSION 1
+
+/**
+ * @brief The formats in which the results are printed.
+ */
+enum output_format {
+	/** Sentences for a human reader, after the matrices */
+	FORMAT_TEXT,
+	/** A line of comma-separated values per unknown, after a header */
+	FORMAT_CSV,
+	/** A JSON object per unknown, one per line */
+	FORMAT_JSONL,
+	/** The exact values in binary, after a header */
+	FORMAT_BINARY
+};
+
+/**
+ * @brief Where and how the results are printed.
+ */
+struct output {
+	/** The buffer of the results */
+	writer writer;
+	/** The format of the solutions */
+	enum output_format format;
+	/** Whether the initial and final matrices are printed */
+	bool matrices;
+};
+
+/**
+ * @brief Definition of a type from the output structure.
+ * @see struct output
+ */
+typedef struct output output;
+
+const char *opening_bracket(const size_t, const size_t);
+const char *closing_bracket(const size_t, const size_t);
+void pp_matrix(output *const, const char *const, const matrix *const);
+void pp_integer_matrix(output *const, const char *const,
+                       const integer_matrix *const);
+void pp_blank_line(output *const);
+void print_results_header(output *const, const size_t, const size_t,
+                          const bool);
+void print_variable(output *const, const size_t, const size_t,
+                    const wide_table *const, const fraction *const);
+void print_approximation(output *const, const size_t, const size_t,
+                         const double);
+void print_solution(output *const, const solver *const);
+bool print_sparse_results(output *const, sparse_matrix *const, char *const);
+bool parse_output_format(const char *const, enum output_format *const);
+
+#endif /* OUTPUT_H */
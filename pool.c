@@ -0,0 +1,165 @@
+/**
+ * @file pool.c
+ * @brief A pool of persistent worker threads.
+ *
+ * Starting threads costs far more than a step of an elimination, so the
+ * threads are started once per solve, and woken up for each task with a
+ * condition variable.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "pool.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief The body of the threads of a pool.
+ *
+ * Waits for tasks and runs them, until the pool is stopped.
+ *
+ * @param[in] argument The @ref pool_worker of the thread.
+ *
+ * @return NULL.
+ */
+static void *
+pool_thread(void *const argument)
+{
+	struct pool_worker *worker = argument;
+	worker_pool *pool = worker->pool;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->stopping && pool->generation == seen) {
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		}
+		if (pool->stopping) {
+			break;
+		}
+		seen = pool->generation;
+		pool_task *task = pool->task;
+		void *task_argument = pool->argument;
+		pthread_mutex_unlock(&pool->lock);
+
+		task(task_argument, worker->index, pool->n_threads);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->n_busy == 0) {
+			pthread_cond_signal(&pool->finished);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+/**
+ * @brief Gives the number of processors available.
+ *
+ * @return The number of online processors, at least 1.
+ */
+size_t
+pool_online_processors(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n < 1 ? 1 : (size_t)n;
+}
+
+/**
+ * @brief Starts the threads of a pool.
+ *
+ * If some threads cannot be started, the pool works with fewer.
+ *
+ * @param[out] pool The pool to initialise.
+ * @param[in] n_threads The number of threads wanted, including the caller.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+pool_init(worker_pool *const pool, const size_t n_threads)
+{
+	pool->n_threads = 1;
+	pool->workers = NULL;
+	pool->task = NULL;
+	pool->argument = NULL;
+	pool->generation = 0;
+	pool->n_busy = 0;
+	pool->stopping = false;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	pthread_cond_init(&pool->finished, NULL);
+	if (n_threads <= 1) {
+		return true;
+	}
+
+	pool->workers = malloc((n_threads - 1) * sizeof(struct pool_worker));
+	if (pool->workers == NULL) {
+		pool_free(pool);
+		return false;
+	}
+	for (size_t i = 0; i < n_threads - 1; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].index = i + 1;
+		if (pthread_create(&pool->workers[i].thread, NULL, pool_thread,
+		                   &pool->workers[i]) != 0) {
+			break;
+		}
+		pool->n_threads++;
+	}
+	return true;
+}
+
+/**
+ * @brief Runs a task on all the threads of a pool, and waits for its end.
+ *
+ * @param[in, out] pool The pool to run the task on.
+ * @param[in] task The task to run.
+ * @param[in, out] argument The argument to give to the task.
+ */
+void
+pool_run(worker_pool *const pool, pool_task *const task, void *const argument)
+{
+	if (pool->n_threads > 1) {
+		pthread_mutex_lock(&pool->lock);
+		pool->task = task;
+		pool->argument = argument;
+		pool->n_busy = pool->n_threads - 1;
+		pool->generation++;
+		pthread_cond_broadcast(&pool->wake);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	task(argument, 0, pool->n_threads);
+
+	if (pool->n_threads > 1) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->n_busy > 0) {
+			pthread_cond_wait(&pool->finished, &pool->lock);
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+/**
+ * @brief Stops the threads of a pool, and releases its resources.
+ *
+ * @param[in, out] pool The pool to free.
+ */
+void
+pool_free(worker_pool *const pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (size_t i = 0; i + 1 < pool->n_threads; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+	free(pool->workers);
+	pool->workers = NULL;
+	pool->n_threads = 1;
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->wake);
+	pthread_cond_destroy(&pool->finished);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file pool.h
+ * @brief Definitions for pool.c
+ * @see pool.c
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A task run by every thread of a @ref worker_pool.
+ *
+ * It is given the argument of the task, the index of the thread running it,
+ * and the number of threads, so that it can take its share of the work.
+ */
+typedef void pool_task(void *const, const size_t, const size_t);
+
+/**
+ * @brief The state of a thread of a @ref worker_pool.
+ */
+struct pool_worker {
+	/** The pool the thread belongs to */
+	struct worker_pool *pool;
+	/** The index of the thread, from 1: the caller of pool_run() is 0 */
+	size_t index;
+	/** The thread itself */
+	pthread_t thread;
+};
+
+/**
+ * @brief A set of threads that run tasks together.
+ *
+ * The threads are started once, and wait between two tasks. The thread that
+ * runs a task takes part in it, so a pool of one thread starts none.
+ */
+struct worker_pool {
+	/** The number of threads, including the caller of pool_run() */
+	size_t n_threads;
+	/** The threads started by the pool */
+	struct pool_worker *workers;
+	/** The lock protecting the fields below */
+	pthread_mutex_t lock;
+	/** Signaled when a task is started or the pool stopped */
+	pthread_cond_t wake;
+	/** Signaled when the last thread finishes a task */
+	pthread_cond_t finished;
+	/** The task being run */
+	pool_task *task;
+	/** The argument of the task being run */
+	void *argument;
+	/** The number of tasks started, for the threads to notice a new one */
+	unsigned long generation;
+	/** The number of started threads still running the task */
+	size_t n_busy;
+	/** Whether the threads must exit */
+	bool stopping;
+};
+
+/**
+ * @brief Definition of a type from the worker_pool structure.
+ * @see struct worker_pool
+ */
+typedef struct worker_pool worker_pool;
+
+size_t pool_online_processors(void);
+bool pool_init(worker_pool *const, const size_t);
+void pool_run(worker_pool *const, pool_task *const, void *const);
+void pool_free(worker_pool *const);
+
+#endif /* POOL_H */
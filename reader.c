@@ -0,0 +1,246 @@
+/**
+ * @file reader.c
+ * @brief Reading of lines of integers from a text file.
+ *
+ * The file is read in large blocks, and scanned by hand: the integers are
+ * accumulated digit by digit, without `scanf()`'s parsing of a format on
+ * each call. Nothing limits the length of a line, an integer being possibly
+ * split across two blocks.
+ */
+
+#include "reader.h"
+
+#include <stdlib.h>
+
+/** @brief The number of bytes read from the file at once. */
+#define READ_BUFFER_SIZE 65536
+
+/** @brief The number of integers a line can hold before growing it. */
+#define INITIAL_LINE_CAPACITY 64
+
+/**
+ * @brief Reads the next block of the file into the buffer.
+ *
+ * @param[in, out] reader The reader whose buffer is empty.
+ *
+ * @return Whether any byte could be read.
+ */
+static bool
+refill(line_reader *const reader)
+{
+	reader->position = 0;
+	reader->length = fread(reader->buffer, 1, READ_BUFFER_SIZE,
+	                       reader->file);
+	if (reader->length == 0 && ferror(reader->file)) {
+		reader->failed = true;
+	}
+	return reader->length != 0;
+}
+
+/**
+ * @brief Gives the next byte to scan, without consuming it.
+ *
+ * @param[in, out] reader The reader to scan.
+ *
+ * @return The byte, or `EOF` at the end of the file.
+ */
+static inline int
+peek(line_reader *const reader)
+{
+	if (reader->position == reader->length && !refill(reader)) {
+		return EOF;
+	}
+	return (unsigned char)reader->buffer[reader->position];
+}
+
+/**
+ * @brief Tells whether a byte is a decimal digit.
+ *
+ * @param[in] c The byte.
+ *
+ * @return Whether it is a digit.
+ */
+static inline bool
+is_digit(const int c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Scans an integer.
+ *
+ * @param[in, out] reader The reader, on the first byte of the integer.
+ * @param[out] value Where to store the integer.
+ *
+ * @return Whether a whole integer could be scanned. The reader's error tells
+ * why if not.
+ */
+static bool
+scan_integer(line_reader *const reader, int64_t *const value)
+{
+	int c = peek(reader);
+	const bool negative = c == '-';
+	if (c == '-' || c == '+') {
+		reader->position++;
+		c = peek(reader);
+	}
+	if (!is_digit(c)) {
+		report_error(reader->error, "line %zu is not a line of integers",
+		             reader->line_number + 1);
+		return false;
+	}
+
+	/* The magnitude of INT64_MIN does not fit in an int64_t */
+	const uint64_t limit = (uint64_t)INT64_MAX + negative;
+	uint64_t magnitude = 0;
+	do {
+		const unsigned digit = (unsigned)(c - '0');
+		if (magnitude > (limit - digit) / 10) {
+			report_error(reader->error,
+			             "line %zu holds an integer too large",
+			             reader->line_number + 1);
+			return false;
+		}
+		magnitude = magnitude * 10 + digit;
+		reader->position++;
+		c = peek(reader);
+	} while (is_digit(c));
+
+	if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != EOF) {
+		report_error(reader->error, "line %zu is not a line of integers",
+		             reader->line_number + 1);
+		return false;
+	}
+	*value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+	return true;
+}
+
+/**
+ * @brief Appends an integer to the values of the current line.
+ *
+ * @param[in, out] reader The reader whose line to extend.
+ * @param[in] value The integer to append.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+append_value(line_reader *const reader, const int64_t value)
+{
+	if (reader->n_values == reader->capacity) {
+		if (reader->capacity > SIZE_MAX / 2 / sizeof(int64_t)) {
+			return false;
+		}
+		const size_t capacity = reader->capacity * 2;
+		int64_t *values =
+		    realloc(reader->values, capacity * sizeof(int64_t));
+		if (values == NULL) {
+			return false;
+		}
+		reader->values = values;
+		reader->capacity = capacity;
+	}
+	reader->values[reader->n_values++] = value;
+	return true;
+}
+
+/**
+ * @brief Prepares a reader of a file.
+ *
+ * @param[out] reader The reader to initialise.
+ * @param[in] file The file to read, opened for reading.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+reader_init(line_reader *const reader, FILE *const file)
+{
+	reader->file = file;
+	reader->position = 0;
+	reader->length = 0;
+	reader->line_number = 0;
+	reader->failed = false;
+	reader->error[0] = '\0';
+	reader->n_values = 0;
+	reader->capacity = INITIAL_LINE_CAPACITY;
+	reader->buffer = malloc(READ_BUFFER_SIZE);
+	reader->values = malloc(reader->capacity * sizeof(int64_t));
+	if (reader->buffer == NULL || reader->values == NULL) {
+		reader_free(reader);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Releases the memory held by a reader.
+ *
+ * The file is not closed.
+ *
+ * @param[in, out] reader The reader to free.
+ */
+void
+reader_free(line_reader *const reader)
+{
+	free(reader->buffer);
+	free(reader->values);
+	reader->buffer = NULL;
+	reader->values = NULL;
+	reader->n_values = 0;
+	reader->capacity = 0;
+}
+
+/**
+ * @brief Reads the next line of integers.
+ *
+ * The integers are separated by spaces or tabs, and the line ends with a
+ * newline or the end of the file. A carriage return before the newline is
+ * ignored.
+ *
+ * @param[in, out] reader The reader to read from. On success, its `values`
+ * hold the integers of the line.
+ *
+ * @return Whether a line was read. The reader's error tells why the input is
+ * not valid.
+ */
+enum read_status
+reader_next_line(line_reader *const reader)
+{
+	reader->n_values = 0;
+	int c = peek(reader);
+	if (c == EOF) {
+		if (reader->failed) {
+			report_error(reader->error,
+			             "the file could not be read");
+			return READ_ERROR;
+		}
+		return READ_END;
+	}
+
+	for (;;) {
+		c = peek(reader);
+		if (c == ' ' || c == '\t' || c == '\r') {
+			reader->position++;
+		} else if (c == '\n') {
+			reader->position++;
+			break;
+		} else if (c == EOF) {
+			break;
+		} else {
+			int64_t value = 0;
+			if (!scan_integer(reader, &value)) {
+				return READ_ERROR;
+			}
+			if (!append_value(reader, value)) {
+				report_error(reader->error,
+				             "the memory was not allocated");
+				return READ_ERROR;
+			}
+		}
+	}
+	if (reader->failed) {
+		report_error(reader->error, "the file could not be read");
+		return READ_ERROR;
+	}
+	reader->line_number++;
+	return READ_LINE;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file reader.h
+ * @brief Definitions for reader.c
+ * @see reader.c
+ */
+
+#ifndef READER_H
+#define READER_H
+
+#include "report.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The outcomes of reading a line.
+ */
+enum read_status {
+	/** A line was read, possibly empty */
+	READ_LINE,
+	/** The end of the input was reached before any line */
+	READ_END,
+	/** The input could not be read, or is not a line of integers */
+	READ_ERROR,
+};
+
+/**
+ * @brief A buffered reader of lines of integers.
+ *
+ * The integers of the last line read are kept in a buffer of the reader,
+ * which grows with the longest line.
+ */
+struct line_reader {
+	/** The file to read from */
+	FILE *file;
+	/** The bytes read from the file but not yet scanned */
+	char *buffer;
+	/** The index of the next byte to scan in the buffer */
+	size_t position;
+	/** The number of bytes in the buffer */
+	size_t length;
+	/** The number of lines read so far, to locate errors */
+	size_t line_number;
+	/** Whether reading from the file failed */
+	bool failed;
+	/** The integers of the last line read */
+	int64_t *values;
+	/** The number of integers of the last line read */
+	size_t n_values;
+	/** The number of integers that fit in `values` */
+	size_t capacity;
+	/** Why the last line could not be read, once it failed */
+	char error[ERROR_SIZE];
+};
+
+/**
+ * @brief Definition of a type from the line_reader structure.
+ * @see struct line_reader
+ */
+typedef struct line_reader line_reader;
+
+bool reader_init(line_reader *const, FILE *const);
+void reader_free(line_reader *const);
+enum read_status reader_next_line(line_reader *const);
+
+#endif /* READER_H */
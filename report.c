@@ -0,0 +1,35 @@
+/**
+ * @file report.c
+ * @brief The error messages of the library.
+ *
+ * The library prints nothing: a function that fails describes the failure in
+ * a buffer of its caller, which decides whether and where to print it. The
+ * messages start in lower case and have no final period, like the
+ * descriptions of solver_status_string().
+ */
+
+#include "report.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+/**
+ * @brief Describes a failure.
+ *
+ * A longer message is truncated.
+ *
+ * @param[out] error The buffer of @ref ERROR_SIZE bytes to write the message
+ * in, or NULL if the caller does not need it.
+ * @param[in] format The format of the message, as with printf().
+ */
+void
+report_error(char *const error, const char *const format, ...)
+{
+	if (error == NULL) {
+		return;
+	}
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(error, ERROR_SIZE, format, arguments);
+	va_end(arguments);
+}
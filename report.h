@@ -0,0 +1,15 @@
+/**
+ * @file report.h
+ * @brief Definitions for report.c
+ * @see report.c
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+/** @brief The number of bytes of an error message, with its null byte. */
+#define ERROR_SIZE 128
+
+void report_error(char *const, const char *const, ...);
+
+#endif /* REPORT_H */
@@ -0,0 +1,845 @@
+/**
+ * @file server.c
+ * @brief A long-running server of solves, over a local socket or the
+ * standard input and output.
+ *
+ * Starting the program for each system costs more than solving a small one:
+ * the process, the sanitizers, the files and the parsing of the printed
+ * results. The server is started once, keeps a solver per worker thread with
+ * its memory, and answers the requests of its clients as they come. A client
+ * may send many requests before reading the responses, which come back in
+ * the same order.
+ *
+ * Each request and each response is a frame: a header of
+ * @ref FRAME_HEADER_SIZE bytes followed by a payload. All the integers are
+ * little-endian.
+ *
+ * | Offset | Size | Contents                                             |
+ * |--------|------|------------------------------------------------------|
+ * | 0      | 4    | `LQSQ` for a request, `LQSA` for a response          |
+ * | 4      | 2    | The version of the frames, @ref SERVER_VERSION       |
+ * | 6      | 1    | The @ref frame_kind of a request, or the             |
+ * |        |      | @ref solver_status of a response                     |
+ * | 7      | 1    | 0                                                    |
+ * | 8      | 8    | The number of bytes of the payload                   |
+ * | 16     |      | The payload                                          |
+ *
+ * The payload of a request is a system, in text or in binary. The payload of
+ * a response is its solution, in the format the program prints, or the
+ * description of the error followed by a new line: that of its status, then
+ * the details given by solver_last_error(), if any, after a colon.
+ *
+ * A request that cannot be read is answered too, in its turn, with the
+ * status SOLVER_ERROR_INPUT (or SOLVER_ERROR_MEMORY) and details that give
+ * its number, counting from 1. A payload larger than the server accepts is
+ * skipped, and the next requests are served. After a header that is not
+ * valid, or a truncated payload, the frames cannot be told apart any more:
+ * the server answers the requests read so far and stops reading.
+ *
+ * @see server.h
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "server.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/** @brief The number of requests waiting or being solved, per worker. */
+#define SERVER_QUEUE_PER_WORKER 4
+
+/** @brief The number of bytes read from a client at once. */
+#define READ_BUFFER_SIZE 65536
+
+/** @brief The number of clients waiting to connect. */
+#define SERVER_BACKLOG 16
+
+/**
+ * @brief The outcomes of reading a request.
+ */
+enum frame_status {
+	/** A request was read */
+	FRAME_READ,
+	/** The client sends no more requests */
+	FRAME_END,
+	/** The request is not a valid frame */
+	FRAME_INVALID,
+};
+
+/** @brief Whether the server was asked to stop, by a signal. */
+static volatile sig_atomic_t interrupted = 0;
+
+/**
+ * @brief Asks the server to stop, on a signal.
+ *
+ * @param[in] signal The signal.
+ */
+static void
+on_signal(const int signal)
+{
+	(void)signal;
+	interrupted = 1;
+}
+
+/**
+ * @brief Blocks the signals that stop the server in the calling thread, so
+ * that the threads it starts leave them to the main thread.
+ *
+ * @param[out] previous Where to store the previous mask of the thread.
+ */
+static void
+block_signals(sigset_t *const previous)
+{
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, previous);
+}
+
+/**
+ * @brief Reads a little-endian integer.
+ *
+ * @param[in] bytes The bytes of the integer.
+ * @param[in] size The number of bytes, at most 8.
+ *
+ * @return The integer.
+ */
+static uint64_t
+read_le(const unsigned char *const bytes, const size_t size)
+{
+	uint64_t n = 0;
+	for (size_t b = size; b-- > 0;) {
+		n = n << 8 | bytes[b];
+	}
+	return n;
+}
+
+/**
+ * @brief Fills the header of a response, once its payload is written.
+ *
+ * @param[in, out] response The response, starting with room for its
+ * header.
+ * @param[in] status The outcome of the solve.
+ */
+static void
+finish_response(writer *const response, const enum solver_status status)
+{
+	unsigned char *header = (unsigned char *)response->buffer;
+	const uint64_t length = response->length - FRAME_HEADER_SIZE;
+	memcpy(header, "LQSA", 4);
+	header[4] = SERVER_VERSION & 0xff;
+	header[5] = SERVER_VERSION >> 8;
+	header[6] = (unsigned char)status;
+	header[7] = 0;
+	for (size_t b = 0; b < 8; b++) {
+		header[8 + b] = (unsigned char)(length >> (8 * b));
+	}
+}
+
+/**
+ * @brief Solves a request, and writes its response.
+ *
+ * A request rejected when it was read is answered with its error, without
+ * being solved.
+ *
+ * @param[in, out] s The solver of the worker.
+ * @param[in, out] request The request.
+ */
+static void
+solve_request(solver *const s, struct server_request *const request)
+{
+	enum solver_status status = request->status;
+	const char *error = request->error;
+	if (status == SOLVER_OK) {
+		status = request->kind == FRAME_TEXT
+		             ? solver_load_text(s,
+		                                (const char *)request->payload,
+		                                request->length)
+		             : solver_load_binary(s, request->payload,
+		                                  request->length);
+		if (status == SOLVER_OK) {
+			status = solver_solve(s);
+		}
+		error = solver_last_error(s);
+	}
+	const unsigned char header[FRAME_HEADER_SIZE] = {0};
+	writer *w = &request->response.writer;
+	writer_clear(w);
+	writer_bytes(w, header, sizeof(header));
+	if (status == SOLVER_OK) {
+		print_solution(&request->response, s);
+	}
+	if (w->failed) {
+		/* The buffer is large enough for the error */
+		status = SOLVER_ERROR_MEMORY;
+		error = "";
+		writer_clear(w);
+		writer_bytes(w, header, sizeof(header));
+	}
+	if (status != SOLVER_OK) {
+		writer_string(w, solver_status_string(status));
+		if (error[0] != '\0') {
+			writer_string(w, ": ");
+			writer_string(w, error);
+		}
+		writer_char(w, '\n');
+	}
+	finish_response(w, status);
+}
+
+/**
+ * @brief The body of the worker threads.
+ *
+ * Takes the requests in the order they were read and solves them, until the
+ * server is stopped.
+ *
+ * @param[in] argument The @ref server_worker of the thread.
+ *
+ * @return NULL.
+ */
+static void *
+worker_thread(void *const argument)
+{
+	struct server_worker *worker = argument;
+	server *srv = worker->server;
+
+	pthread_mutex_lock(&srv->lock);
+	for (;;) {
+		while (!srv->stopping && srv->n_taken == srv->n_read) {
+			pthread_cond_wait(&srv->work, &srv->lock);
+		}
+		if (srv->stopping) {
+			break;
+		}
+		struct server_request *request =
+		    &srv->requests[srv->n_taken++ % srv->depth];
+		pthread_mutex_unlock(&srv->lock);
+
+		solve_request(worker->solver, request);
+
+		pthread_mutex_lock(&srv->lock);
+		request->solved = true;
+		pthread_cond_signal(&srv->solved);
+	}
+	pthread_mutex_unlock(&srv->lock);
+	return NULL;
+}
+
+/**
+ * @brief Writes bytes to a file descriptor, however many calls it takes.
+ *
+ * @param[in] fd The file descriptor.
+ * @param[in] bytes The bytes.
+ * @param[in] count The number of bytes.
+ *
+ * @return Whether all the bytes were written.
+ */
+static bool
+write_all(const int fd, const char *bytes, size_t count)
+{
+	while (count > 0) {
+		const ssize_t written = write(fd, bytes, count);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return false;
+		}
+		bytes += written;
+		count -= (size_t)written;
+	}
+	return true;
+}
+
+/**
+ * @brief The body of the thread sending the responses.
+ *
+ * Sends the responses in the order of the requests, each one as soon as it
+ * is solved, until the client sends no more requests and every one is
+ * answered. Sending a response frees the slot of its request.
+ *
+ * @param[in] argument The server.
+ *
+ * @return NULL.
+ */
+static void *
+sender_thread(void *const argument)
+{
+	server *srv = argument;
+
+	pthread_mutex_lock(&srv->lock);
+	for (;;) {
+		while (srv->n_sent < srv->n_read
+		           ? !srv->requests[srv->n_sent % srv->depth].solved
+		           : !srv->end_of_input) {
+			pthread_cond_wait(&srv->solved, &srv->lock);
+		}
+		if (srv->n_sent == srv->n_read) {
+			break;
+		}
+		struct server_request *request =
+		    &srv->requests[srv->n_sent % srv->depth];
+		pthread_mutex_unlock(&srv->lock);
+
+		const writer *w = &request->response.writer;
+		if (!srv->broken &&
+		    !write_all(srv->output, w->buffer, w->length)) {
+			fprintf(stderr,
+			        "ERROR: the responses could not be written.\n");
+			srv->broken = true;
+		}
+
+		pthread_mutex_lock(&srv->lock);
+		request->solved = false;
+		srv->n_sent++;
+		pthread_cond_signal(&srv->room);
+	}
+	pthread_mutex_unlock(&srv->lock);
+	return NULL;
+}
+
+/**
+ * @brief Makes room for the payload of a request in its slot.
+ *
+ * @param[in, out] request The request.
+ * @param[in] length The number of bytes of the payload.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+reserve_payload(struct server_request *const request, const size_t length)
+{
+	unsigned char *payload = realloc(request->payload, length);
+	if (payload == NULL) {
+		return false;
+	}
+	request->payload = payload;
+	request->capacity = length;
+	return true;
+}
+
+/**
+ * @brief Reads the next block of the client into the buffer of a server,
+ * once the previous one is used.
+ *
+ * @param[in, out] srv The server.
+ *
+ * @return Whether bytes were read, or false at the end of the input or if
+ * the server was stopped.
+ */
+static bool
+fill_buffer(server *const srv)
+{
+	for (;;) {
+		const ssize_t n =
+		    read(srv->input, srv->buffer, READ_BUFFER_SIZE);
+		if (n < 0 && errno == EINTR && !interrupted) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		srv->buffered = (size_t)n;
+		srv->consumed = 0;
+		return true;
+	}
+}
+
+/**
+ * @brief Reads bytes from the client.
+ *
+ * The input is read in large blocks, so that the small requests of a
+ * pipelining client take few calls to `read()`. A large payload is read in
+ * place, without a copy.
+ *
+ * @param[in, out] srv The server.
+ * @param[out] bytes Where to store the bytes.
+ * @param[in] count The number of bytes.
+ *
+ * @return The number of bytes read, fewer than asked at the end of the input
+ * or if the server was stopped.
+ */
+static size_t
+read_bytes(server *const srv, unsigned char *const bytes, const size_t count)
+{
+	size_t done = 0;
+	while (done < count) {
+		if (srv->consumed == srv->buffered &&
+		    count - done >= READ_BUFFER_SIZE) {
+			const ssize_t n =
+			    read(srv->input, bytes + done, count - done);
+			if (n < 0 && errno == EINTR && !interrupted) {
+				continue;
+			}
+			if (n <= 0) {
+				break;
+			}
+			done += (size_t)n;
+			continue;
+		}
+		if (srv->consumed == srv->buffered && !fill_buffer(srv)) {
+			break;
+		}
+		size_t taken = srv->buffered - srv->consumed;
+		if (taken > count - done) {
+			taken = count - done;
+		}
+		memcpy(bytes + done, srv->buffer + srv->consumed, taken);
+		srv->consumed += taken;
+		done += taken;
+	}
+	return done;
+}
+
+/**
+ * @brief Reads bytes from the client, and drops them.
+ *
+ * @param[in, out] srv The server.
+ * @param[in] count The number of bytes.
+ *
+ * @return Whether all the bytes were read.
+ */
+static bool
+skip_bytes(server *const srv, uint64_t count)
+{
+	while (count > 0) {
+		if (srv->consumed == srv->buffered && !fill_buffer(srv)) {
+			return false;
+		}
+		size_t taken = srv->buffered - srv->consumed;
+		if (taken > count) {
+			taken = (size_t)count;
+		}
+		srv->consumed += taken;
+		count -= taken;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads the next request of the client into a free slot, and hands
+ * it to the workers.
+ *
+ * Waits for a slot to be freed when they are all taken: the client is not
+ * read from meanwhile. A request that cannot be read takes a slot all the
+ * same, so that its error is answered in its turn.
+ *
+ * @param[in, out] srv The server.
+ *
+ * @return Whether a request was handed to the workers, or the input ended
+ * or became unreadable. An error is printed if the request is rejected.
+ */
+static enum frame_status
+read_request(server *const srv)
+{
+	unsigned char header[FRAME_HEADER_SIZE];
+	const size_t got = read_bytes(srv, header, sizeof(header));
+	if (got == 0) {
+		return FRAME_END;
+	}
+
+	pthread_mutex_lock(&srv->lock);
+	while (srv->n_read - srv->n_sent == srv->depth) {
+		pthread_cond_wait(&srv->room, &srv->lock);
+	}
+	const size_t number = srv->n_read + 1;
+	struct server_request *request =
+	    &srv->requests[srv->n_read % srv->depth];
+	pthread_mutex_unlock(&srv->lock);
+
+	/* The slot is free: the workers and the sender are behind */
+	enum frame_status status = FRAME_READ;
+	const uint64_t length = read_le(header + 8, 8);
+	request->status = SOLVER_ERROR_INPUT;
+	request->length = 0;
+	if (got < sizeof(header) || memcmp(header, "LQSQ", 4) != 0 ||
+	    read_le(header + 4, 2) != SERVER_VERSION ||
+	    header[6] > FRAME_BINARY || header[7] != 0) {
+		report_error(request->error,
+		             "the request %zu is not a valid frame", number);
+		status = FRAME_INVALID;
+	} else if (length > srv->max_payload) {
+		report_error(request->error,
+		             "the request %zu has %" PRIu64 " bytes, more "
+		             "than the %zu accepted",
+		             number, length, srv->max_payload);
+		if (!skip_bytes(srv, length)) {
+			status = FRAME_INVALID;
+		}
+	} else if (length > request->capacity &&
+	           !reserve_payload(request, (size_t)length)) {
+		request->status = SOLVER_ERROR_MEMORY;
+		report_error(request->error,
+		             "the memory of the request %zu was not "
+		             "allocated",
+		             number);
+		if (!skip_bytes(srv, length)) {
+			status = FRAME_INVALID;
+		}
+	} else if (read_bytes(srv, request->payload, (size_t)length) <
+	           length) {
+		report_error(request->error, "the request %zu is truncated",
+		             number);
+		status = FRAME_INVALID;
+	} else {
+		request->status = SOLVER_OK;
+		request->error[0] = '\0';
+		request->kind = (enum frame_kind)header[6];
+		request->length = (size_t)length;
+	}
+	if (request->status != SOLVER_OK) {
+		fprintf(stderr, "ERROR: %s.\n", request->error);
+	}
+
+	pthread_mutex_lock(&srv->lock);
+	srv->n_read++;
+	pthread_cond_signal(&srv->work);
+	pthread_mutex_unlock(&srv->lock);
+	return status;
+}
+
+/**
+ * @brief Gives a worker a solver set up as another one.
+ *
+ * The factorisation is not kept: the systems of the requests are only
+ * solved.
+ *
+ * @param[out] s The solver of the worker.
+ * @param[in] model The solver whose settings are copied.
+ */
+static void
+copy_settings(solver *const s, const solver *const model)
+{
+	solver_set_refinement(s, model->refinement_steps);
+	solver_set_sparse(s, model->force_sparse);
+	solver_set_gauss_jordan(s, model->gauss_jordan);
+	solver_set_block_size(s, model->block_size);
+	solver_set_pivoting(s, model->pivoting);
+	solver_set_rhs(s, model->n_rhs);
+}
+
+/**
+ * @brief Releases the memory of the requests of a server.
+ *
+ * @param[in, out] srv The server.
+ */
+static void
+free_requests(server *const srv)
+{
+	for (size_t r = 0; r < srv->depth; r++) {
+		free(srv->requests[r].payload);
+		writer_free(&srv->requests[r].response.writer);
+	}
+	free(srv->requests);
+	free(srv->buffer);
+}
+
+/**
+ * @brief Starts the workers of a server.
+ *
+ * Each worker has a solver with the engine and the settings of a model, and
+ * a single thread: the requests are solved side by side instead. If some
+ * threads cannot be started, the server works with fewer.
+ *
+ * @param[out] srv The server to initialise.
+ * @param[in] model The solver whose engine and settings are used.
+ * @param[in] n_workers The number of workers.
+ * @param[in] format The format of the solutions.
+ * @param[in] max_payload The largest payload of a request, in bytes. The
+ * memory of the requests is bounded by @ref SERVER_QUEUE_PER_WORKER times
+ * the number of workers times this.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+server_init(server *const srv, const solver *const model,
+            const size_t n_workers, const enum output_format format,
+            const size_t max_payload)
+{
+	srv->n_workers = 0;
+	srv->depth = SERVER_QUEUE_PER_WORKER * n_workers;
+	srv->format = format;
+	srv->max_payload = max_payload;
+	srv->workers = calloc(n_workers, sizeof(struct server_worker));
+	srv->requests = calloc(srv->depth, sizeof(struct server_request));
+	srv->buffer = malloc(READ_BUFFER_SIZE);
+	bool allocated = srv->workers != NULL && srv->requests != NULL &&
+	                 srv->buffer != NULL;
+	for (size_t r = 0; allocated && r < srv->depth; r++) {
+		output *response = &srv->requests[r].response;
+		allocated = writer_init_memory(&response->writer);
+		response->format = format;
+		response->matrices = false;
+	}
+	for (size_t w = 0; allocated && w < n_workers; w++) {
+		srv->workers[w].server = srv;
+		srv->workers[w].solver = solver_create(model->engine, 1);
+		allocated = srv->workers[w].solver != NULL;
+		if (allocated) {
+			copy_settings(srv->workers[w].solver, model);
+		}
+	}
+	if (!allocated) {
+		for (size_t w = 0; srv->workers != NULL && w < n_workers; w++) {
+			solver_destroy(srv->workers[w].solver);
+		}
+		free(srv->workers);
+		if (srv->requests != NULL) {
+			free_requests(srv);
+		} else {
+			free(srv->buffer);
+		}
+		return false;
+	}
+
+	pthread_mutex_init(&srv->lock, NULL);
+	pthread_cond_init(&srv->work, NULL);
+	pthread_cond_init(&srv->solved, NULL);
+	pthread_cond_init(&srv->room, NULL);
+	srv->n_read = 0;
+	srv->n_taken = 0;
+	srv->n_sent = 0;
+	srv->end_of_input = false;
+	srv->stopping = false;
+
+	sigset_t previous;
+	block_signals(&previous);
+	for (size_t w = 0; w < n_workers; w++) {
+		struct server_worker *worker = &srv->workers[srv->n_workers];
+		worker->solver = srv->workers[w].solver;
+		worker->server = srv;
+		if (pthread_create(&worker->thread, NULL, worker_thread,
+		                   worker) == 0) {
+			srv->n_workers++;
+		} else {
+			solver_destroy(worker->solver);
+		}
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if (srv->n_workers == 0) {
+		server_free(srv);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Answers the requests of a client, until it sends no more.
+ *
+ * The requests are read by the caller, solved by the workers and answered by
+ * a thread of their own, all at the same time.
+ *
+ * @param[in, out] srv The server, whose workers wait for requests.
+ * @param[in] input The file descriptor the requests are read from.
+ * @param[in] output The file descriptor the responses are written to.
+ *
+ * @return Whether the input ended after a whole frame, and every response
+ * was sent. An error is printed if not. The requests that were rejected are
+ * answered, and do not make it fail by themselves.
+ */
+bool
+server_serve(server *const srv, const int input, const int output)
+{
+	srv->input = input;
+	srv->output = output;
+	srv->buffered = 0;
+	srv->consumed = 0;
+	srv->broken = false;
+	pthread_mutex_lock(&srv->lock);
+	srv->n_read = 0;
+	srv->n_taken = 0;
+	srv->n_sent = 0;
+	srv->end_of_input = false;
+	pthread_mutex_unlock(&srv->lock);
+
+	sigset_t previous;
+	block_signals(&previous);
+	pthread_t sender;
+	const bool started =
+	    pthread_create(&sender, NULL, sender_thread, srv) == 0;
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if (!started) {
+		fprintf(stderr, "ERROR: the thread could not be started.\n");
+		return false;
+	}
+
+	enum frame_status status = FRAME_READ;
+	while ((status = read_request(srv)) == FRAME_READ) {
+	}
+	/* The requests read are still answered */
+	pthread_mutex_lock(&srv->lock);
+	srv->end_of_input = true;
+	pthread_cond_signal(&srv->solved);
+	pthread_mutex_unlock(&srv->lock);
+	pthread_join(sender, NULL);
+	return status == FRAME_END && !srv->broken;
+}
+
+/**
+ * @brief Stops the workers of a server, and releases its memory.
+ *
+ * @param[in, out] srv The server, which is not serving a client.
+ */
+void
+server_free(server *const srv)
+{
+	pthread_mutex_lock(&srv->lock);
+	srv->stopping = true;
+	pthread_cond_broadcast(&srv->work);
+	pthread_mutex_unlock(&srv->lock);
+	for (size_t w = 0; w < srv->n_workers; w++) {
+		pthread_join(srv->workers[w].thread, NULL);
+		solver_destroy(srv->workers[w].solver);
+	}
+	free(srv->workers);
+	free_requests(srv);
+	pthread_mutex_destroy(&srv->lock);
+	pthread_cond_destroy(&srv->work);
+	pthread_cond_destroy(&srv->solved);
+	pthread_cond_destroy(&srv->room);
+}
+
+/**
+ * @brief Tells whether a server listens on a socket.
+ *
+ * @param[in] address The address of the socket.
+ *
+ * @return Whether a connection to the socket succeeds.
+ */
+static bool
+socket_in_use(const struct sockaddr_un *const address)
+{
+	const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (probe < 0) {
+		return false;
+	}
+	const bool in_use = connect(probe, (const struct sockaddr *)address,
+	                            sizeof(*address)) == 0;
+	close(probe);
+	return in_use;
+}
+
+/**
+ * @brief Answers the clients of a Unix domain socket, one after the other,
+ * until the server is stopped.
+ *
+ * The clients are not served concurrently: the next one waits, in the
+ * backlog of the socket, until the current one closes its connection, even
+ * if it is idle. The clients are expected to keep a single connection open
+ * and pipeline their requests on it.
+ *
+ * A socket left by a server that was killed is replaced, but not one that
+ * another server listens on. The socket is removed when the server stops.
+ *
+ * @param[in, out] srv The server.
+ * @param[in] path The path of the socket.
+ *
+ * @return Whether the socket could be listened on. An error is printed if
+ * not.
+ */
+static bool
+listen_and_serve(server *const srv, const char *const path)
+{
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "ERROR: the socket path %s is too long.\n",
+		        path);
+		return false;
+	}
+	memcpy(address.sun_path, path, strlen(path));
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		fprintf(stderr, "ERROR: the socket could not be created.\n");
+		return false;
+	}
+	struct stat file;
+	if (stat(path, &file) == 0 && S_ISSOCK(file.st_mode) &&
+	    !socket_in_use(&address)) {
+		unlink(path);
+	}
+	if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+	    listen(listener, SERVER_BACKLOG) != 0) {
+		fprintf(stderr, "ERROR: could not listen on %s.\n", path);
+		close(listener);
+		return false;
+	}
+	fprintf(stderr, "Listening on %s, one client at a time\n", path);
+
+	bool listening = true;
+	while (!interrupted) {
+		const int client = accept(listener, NULL, NULL);
+		if (client < 0 && errno == EINTR) {
+			continue;
+		}
+		if (client < 0) {
+			fprintf(stderr,
+			        "ERROR: a client could not be accepted.\n");
+			listening = false;
+			break;
+		}
+		/* A client that fails does not stop the server */
+		server_serve(srv, client, client);
+		close(client);
+	}
+	close(listener);
+	unlink(path);
+	return listening;
+}
+
+/**
+ * @brief Serves solves until the server is stopped by a signal, or until
+ * the end of the standard input.
+ *
+ * @param[in] path The path of the Unix domain socket to listen on, or `-`
+ * for the standard input and output.
+ * @param[in] model The solver whose engine and settings are used.
+ * @param[in] n_workers The number of requests solved at the same time.
+ * @param[in] format The format of the solutions.
+ * @param[in] max_payload The largest payload of a request, in bytes.
+ *
+ * @return Whether the server could run, and the standard input was valid.
+ * An error is printed if not.
+ */
+bool
+server_run(const char *const path, const solver *const model,
+           const size_t n_workers, const enum output_format format,
+           const size_t max_payload)
+{
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	sigemptyset(&action.sa_mask);
+	/* Without SA_RESTART, the blocking calls return on these signals */
+	action.sa_handler = on_signal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	/* A client that is gone is seen as a failed write */
+	action.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &action, NULL);
+
+	server srv;
+	if (!server_init(&srv, model, n_workers, format, max_payload)) {
+		fprintf(stderr, "ERROR: the memory was not allocated.\n");
+		return false;
+	}
+	fprintf(stderr, "Serving with %zu worker%s\n", srv.n_workers,
+	        srv.n_workers == 1 ? "" : "s");
+	const bool served =
+	    strcmp(path, "-") == 0
+	        ? server_serve(&srv, STDIN_FILENO, STDOUT_FILENO)
+	        : listen_and_serve(&srv, path);
+	server_free(&srv);
+	return served;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file server.h
+ * @brief Definitions for server.c
+ * @see server.c
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "output.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief The version of the frames of the requests and of the responses. */
+#define SERVER_VERSION 1
+
+/** @brief The number of bytes of the header of a frame. */
+#define FRAME_HEADER_SIZE 16
+
+/**
+ * @brief The largest payload of a request accepted by default, in bytes.
+ *
+ * A system of 2048 unknowns takes 32 MiB in the binary format with 64-bit
+ * coefficients, and about as much in text with 7-digit ones.
+ */
+#define SERVER_DEFAULT_MAX_PAYLOAD ((size_t)64 << 20)
+
+/**
+ * @brief The formats of the system sent in a request.
+ */
+enum frame_kind {
+	/** The text format of the input files */
+	FRAME_TEXT,
+	/** The binary format of the matrices, as written by `lqsconvert` */
+	FRAME_BINARY,
+};
+
+/**
+ * @brief A request of a client, from its arrival to its response.
+ *
+ * The memory of a request is kept for the next ones.
+ */
+struct server_request {
+	/** The format of the system */
+	enum frame_kind kind;
+	/** The system, as sent by the client */
+	unsigned char *payload;
+	/** The number of bytes of the system */
+	size_t length;
+	/** The number of bytes the payload can hold */
+	size_t capacity;
+	/** SOLVER_OK, or why the request was rejected before being solved */
+	enum solver_status status;
+	/** The details of the rejection, with the number of the request */
+	char error[ERROR_SIZE];
+	/** The response, with its header: the solution, or the error */
+	output response;
+	/** Whether the request was solved, and its response can be sent */
+	bool solved;
+};
+
+/**
+ * @brief The state of a worker thread of a @ref server.
+ */
+struct server_worker {
+	/** The server the thread belongs to */
+	struct server *server;
+	/** The solver of the thread, whose memory is kept from one request
+	 * to the next */
+	solver *solver;
+	/** The thread itself */
+	pthread_t thread;
+};
+
+/**
+ * @brief A server of solves, to the clients of a socket or of the standard
+ * input and output.
+ *
+ * The requests of a client are read into a ring of slots, solved by the
+ * workers as they arrive, and answered in the order they were sent. When
+ * every slot is taken, the server stops reading until the oldest response is
+ * sent: a client that sends requests faster than it reads the responses is
+ * held back by its socket.
+ */
+struct server {
+	/** The workers */
+	struct server_worker *workers;
+	/** The number of workers */
+	size_t n_workers;
+	/** The slots of the requests */
+	struct server_request *requests;
+	/** The number of slots */
+	size_t depth;
+	/** The format of the solutions */
+	enum output_format format;
+	/** The largest payload of a request, in bytes: the slots never hold
+	 * more */
+	size_t max_payload;
+	/** The file descriptor the requests are read from */
+	int input;
+	/** The file descriptor the responses are written to */
+	int output;
+	/** The bytes read from the input and not yet used */
+	unsigned char *buffer;
+	/** The number of bytes read into the buffer */
+	size_t buffered;
+	/** The number of bytes of the buffer already used */
+	size_t consumed;
+	/** Whether a response could not be written. The next ones are dropped
+	 * until the client is gone */
+	bool broken;
+	/** The lock protecting the fields below */
+	pthread_mutex_t lock;
+	/** Signaled when a request is read or the server stopped */
+	pthread_cond_t work;
+	/** Signaled when a request is solved or the input ended */
+	pthread_cond_t solved;
+	/** Signaled when a response is sent, freeing its slot */
+	pthread_cond_t room;
+	/** The number of requests read from the client */
+	size_t n_read;
+	/** The number of requests taken by the workers */
+	size_t n_taken;
+	/** The number of responses sent */
+	size_t n_sent;
+	/** Whether the client sends no more requests */
+	bool end_of_input;
+	/** Whether the workers must exit */
+	bool stopping;
+};
+
+/**
+ * @brief Definition of a type from the server structure.
+ * @see struct server
+ */
+typedef struct server server;
+
+bool server_init(server *const, const solver *const, const size_t,
+                 const enum output_format, const size_t);
+bool server_serve(server *const, const int, const int);
+void server_free(server *const);
+bool server_run(const char *const, const solver *const, const size_t,
+                const enum output_format, const size_t);
+
+#endif /* SERVER_H */
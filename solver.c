@@ -0,0 +1,1811 @@
+/**
+ * @file solver.c
+ * @brief The elimination on fractions, and the loading of the systems.
+ *
+ * The matrix used by the fraction engine is modeled as a @ref matrix of
+ * fractions, with \f$n_{\mathrm{lines}}\times n_{\mathrm{col}}\f$ elements.
+ *
+ * The matrix is referenced in a line-column fashion (row-major). *I.e.* the
+ * value at `matrix_line(matrix, 0)[1]` is the element at the intersection of
+ * the first line and the second colum.
+ *
+ * @see lineqsolve.c
+ */
+
+#include "solver.h"
+
+#include "floating.h"
+#include "kernels.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The greatest share of non-zero coefficients, in percent, for which
+ * a dense system is solved as a sparse one.
+ */
+#define SPARSE_DENSITY_PERCENT 10
+
+/** @brief The number of bytes of the header of a file of factors. */
+#define FACTORS_HEADER_SIZE 16
+
+/** @brief The version of the format of the files of factors. */
+#define FACTORS_VERSION 1
+
+/**
+ * @brief The number of bytes of the pivot lines' share of a tile, in an
+ * elimination by blocks, sized for the first-level cache.
+ */
+#define TILE_BYTES 16384
+
+/**
+ * @brief The state of a step of triangularise() and gauss_jordan(), shared
+ * by the threads of their pool.
+ */
+struct elimination_step {
+	/** The matrix being eliminated */
+	matrix *matrix;
+	/** Whether the lines above the pivot are eliminated too */
+	bool reduce;
+	/** How the pivots are chosen */
+	enum solver_pivoting pivoting;
+	/** The index of the pivot's line */
+	size_t line;
+	/** The index of the pivot's column */
+	size_t pivot;
+	/** The index of the line of the first pivot of the block being
+	 * eliminated, in an elimination by blocks */
+	size_t block_line;
+	/** The index of the column of the first pivot of the block */
+	size_t block_start;
+	/** The number of pivots of the block, in consecutive lines and
+	 * columns */
+	size_t block_pivots;
+	/** The index of the column after the block being eliminated, or 0 if
+	 * the pivots are eliminated one at a time */
+	size_t block_end;
+	/** The number of columns of a tile of the lines below the block */
+	size_t tile_width;
+	/** The inverse of the pivot */
+	const fraction *inverse_of_pivot;
+	/** The factor of the line being eliminated, one per thread */
+	fraction *factors;
+	/** The pivot's line, from the pivot's column on, for row_submul() */
+	fraction_row pivot_row;
+	/** Whether the pivot's line was copied to `pivot_row`: none of its
+	 * values is promoted */
+	bool narrow_pivot;
+	/** The line being eliminated, one per thread, for row_submul() */
+	fraction_row *rows;
+	/** The best pivot found by each thread in the pivot's column */
+	size_t *candidates;
+};
+
+/**
+ * @brief The state of pipelined_elimination(), shared with the thread
+ * reading the lines.
+ */
+struct pipeline {
+	/** The matrix being read and eliminated */
+	matrix *matrix;
+	/** The reader of the file, used only by the reading thread */
+	line_reader *reader;
+	/** Protects the following fields */
+	pthread_mutex_t lock;
+	/** Signals that a line was read, or that reading stopped */
+	pthread_cond_t line_read;
+	/** The number of lines of the matrix read so far */
+	size_t n_read;
+	/** Whether reading failed */
+	bool failed;
+	/** Whether the elimination failed, and reading can stop */
+	bool stopping;
+};
+
+/**
+ * @brief Checks the line of a system just read.
+ *
+ * @param[in] reader The reader of the file.
+ * @param[in] n_col The number of coefficients the line must have.
+ *
+ * @return Whether the line has the right number of coefficients, which fit
+ * in 32 bits. The reader's error tells why if not.
+ */
+bool
+check_system_line(line_reader *const reader, const size_t n_col)
+{
+	if (reader->n_values != n_col) {
+		report_error(reader->error,
+		             "line %zu has %zu coefficients instead of %zu",
+		             reader->line_number, reader->n_values, n_col);
+		return false;
+	}
+	for (size_t j = 0; j < n_col; j++) {
+		if (reader->values[j] < INT32_MIN ||
+		    reader->values[j] > INT32_MAX) {
+			report_error(reader->error, "the coefficients of line "
+			             "%zu do not fit in 32 bits",
+			             reader->line_number);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Reads a line of a system.
+ *
+ * @param[in, out] reader The reader of the file.
+ * @param[in] n_col The number of coefficients the line must have.
+ *
+ * @return Whether a valid line was read, its coefficients being in the
+ * reader. The reader's error tells why if not.
+ */
+bool
+read_system_line(line_reader *const reader, const size_t n_col)
+{
+	enum read_status status = reader_next_line(reader);
+	if (status == READ_END) {
+		report_error(reader->error, "the file ends before line %zu",
+		             reader->line_number + 1);
+	}
+	return status == READ_LINE && check_system_line(reader, n_col);
+}
+
+/**
+ * @brief Reads the coefficients of a system given as triplets.
+ *
+ * Each line holds the line and the column of a coefficient, counted from 1,
+ * and its value. Column \f$n + 1\f$ holds the constants. The coefficients
+ * not given are zero, and those given several times are summed. The
+ * triplets end with the file or with a blank line.
+ *
+ * @param[in, out] reader The reader of the file, positioned after the line
+ * giving the number of unknowns.
+ * @param[in] n The number of unknowns of the system.
+ * @param[in, out] sparse The sparse matrix to fill, or NULL.
+ * @param[in, out] dense The integer matrix to fill, zeroed, if `sparse` is
+ * NULL.
+ *
+ * @return Whether the triplets could be read. The reader's error tells why if
+ * not.
+ */
+bool
+read_triplets(line_reader *const reader, const size_t n,
+              sparse_matrix *const sparse, integer_matrix *const dense)
+{
+	enum read_status status = READ_LINE;
+	while ((status = reader_next_line(reader)) == READ_LINE &&
+	       reader->n_values != 0) {
+		const int64_t *values = reader->values;
+		if (reader->n_values != 3) {
+			report_error(reader->error,
+			             "line %zu is not a triplet of a line, a "
+			             "column and a coefficient",
+			             reader->line_number);
+			return false;
+		}
+		if (values[0] < 1 || (uint64_t)values[0] > n || values[1] < 1 ||
+		    (uint64_t)values[1] > n + 1) {
+			report_error(reader->error,
+			             "line %zu gives a coefficient outside the "
+			             "system",
+			             reader->line_number);
+			return false;
+		}
+		const size_t line = (size_t)values[0] - 1;
+		const size_t column = (size_t)values[1] - 1;
+		int64_t value = values[2];
+		if (sparse == NULL) {
+			value += integer_matrix_line(dense, line)[column];
+		}
+		if (value < INT32_MIN || value > INT32_MAX) {
+			report_error(reader->error,
+			             "the coefficient of line %zu does not fit "
+			             "in 32 bits",
+			             reader->line_number);
+			return false;
+		}
+		if (sparse == NULL) {
+			integer_matrix_line(dense, line)[column] = value;
+		} else if (!sparse_append(sparse, line, column,
+		                          (int32_t)value)) {
+			report_error(reader->error,
+			             "the memory was not allocated");
+			return false;
+		}
+	}
+	if (sparse != NULL) {
+		sparse_finish(sparse);
+	}
+	return status != READ_ERROR;
+}
+
+/**
+ * @brief Sets a line of a matrix from the coefficients read.
+ *
+ * @param[in, out] matrix The matrix to fill.
+ * @param[in] line The index of the line to set.
+ * @param[in] values The coefficients of the line, which fit in 32 bits.
+ */
+void
+store_line(matrix *const matrix, const size_t line,
+           const int64_t *const values)
+{
+	fraction *elements = matrix_line(matrix, line);
+	for (size_t j = 0; j < matrix->n_col; j++) {
+		fraction_from_int((int32_t)values[j], &elements[j]);
+	}
+}
+
+/**
+ * @brief Sets a line of an integer matrix from the coefficients read.
+ *
+ * @see store_line
+ */
+void
+store_integer_line(integer_matrix *const matrix, const size_t line,
+                   const int64_t *const values)
+{
+	int64_t *elements = integer_matrix_line(matrix, line);
+	for (size_t j = 0; j < matrix->n_col; j++) {
+		elements[j] = values[j];
+	}
+}
+
+/**
+ * @brief Fills a matrix from a binary matrix of the same size.
+ *
+ * The elements are converted straight from the mapped file.
+ *
+ * @param[out] matrix The matrix to fill.
+ * @param[in] binary The binary matrix to read.
+ * @param[out] error Where to describe the line that does not fit, or NULL.
+ *
+ * @return Whether all the elements fit in 32 bits.
+ */
+bool
+load_binary_system(matrix *const matrix, const binary_matrix *const binary,
+                   char *const error)
+{
+	for (size_t i = 0; i < matrix->n_lines; i++) {
+		fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; j < matrix->n_col; j++) {
+			const int64_t value = binary_element(binary, i, j);
+			if (value < INT32_MIN || value > INT32_MAX) {
+				report_error(error,
+				             "the coefficients of line %zu do "
+				             "not fit in 32 bits",
+				             i + 1);
+				return false;
+			}
+			fraction_from_int((int32_t)value, &line[j]);
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Fills an integer matrix from a binary matrix of the same size.
+ *
+ * @see load_binary_system
+ */
+bool
+load_binary_integer_system(integer_matrix *const matrix,
+                           const binary_matrix *const binary,
+                           char *const error)
+{
+	for (size_t i = 0; i < matrix->n_lines; i++) {
+		int64_t *line = integer_matrix_line(matrix, i);
+		for (size_t j = 0; j < matrix->n_col; j++) {
+			const int64_t value = binary_element(binary, i, j);
+			if (value < INT32_MIN || value > INT32_MAX) {
+				report_error(error,
+				             "the coefficients of line %zu do "
+				             "not fit in 32 bits",
+				             i + 1);
+				return false;
+			}
+			line[j] = value;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Gives the cost of a pivot, for the strategies that minimise one.
+ *
+ * @param[in] matrix The matrix the pivot belongs to.
+ * @param[in] pivoting The strategy, PIVOTING_SMALLEST or PIVOTING_SPARSEST.
+ * @param[in] line The index of the pivot's line.
+ * @param[in] column The index of the pivot's column.
+ *
+ * @return The number of bits of the pivot's terms, or the number of
+ * non-zero coefficients of its line from its column on.
+ */
+static size_t
+pivot_cost(const matrix *const matrix, const enum solver_pivoting pivoting,
+           const size_t line, const size_t column)
+{
+	const fraction *values = matrix_line(matrix, line);
+	if (pivoting == PIVOTING_SMALLEST) {
+		size_t numerator_bits = 0;
+		size_t denominator_bits = 0;
+		tiered_bits(&matrix->wide, &values[column], &numerator_bits,
+		            &denominator_bits);
+		return numerator_bits + denominator_bits;
+	}
+	size_t count = 0;
+	for (size_t j = column; j < matrix->n_lines; j++) {
+		count += !tiered_is_zero(&values[j]);
+	}
+	return count;
+}
+
+/**
+ * @brief Tells whether a value of a column makes a better pivot than
+ * another.
+ *
+ * Ties are left to the value found first, so that the lines only move when
+ * a pivot is strictly better.
+ *
+ * @param[in] matrix The matrix the values belong to.
+ * @param[in] pivoting The strategy.
+ * @param[in] column The index of the column.
+ * @param[in] line The index of the line of the value, which is not zero.
+ * @param[in] best The index of the line of the best pivot so far.
+ *
+ * @return Whether the value is strictly better.
+ */
+static bool
+is_better_pivot(const matrix *const matrix,
+                const enum solver_pivoting pivoting, const size_t column,
+                const size_t line, const size_t best)
+{
+	switch (pivoting) {
+	case PIVOTING_GREATEST:
+		return tiered_compare_magnitude(
+		           &matrix->wide, matrix_line(matrix, line) + column,
+		           matrix_line(matrix, best) + column) == 1;
+	case PIVOTING_SMALLEST:
+	case PIVOTING_SPARSEST:
+		return pivot_cost(matrix, pivoting, line, column) <
+		       pivot_cost(matrix, pivoting, best, column);
+	case PIVOTING_FIRST:
+		break;
+	}
+	return false;
+}
+
+/**
+ * @brief Finds the best pivot in part of a matrix's column.
+ *
+ * @param[in] matrix The matrix to search the values in.
+ * @param[in] pivoting The strategy that ranks the values.
+ * @param[in] column The index of the column to search in.
+ * @param[in] first The index of the first line to search.
+ * @param[in] end The index of the line after the last one to search.
+ *
+ * @return The line number of the best non-zero value of the lines, or `end`
+ * if they are all zero.
+ */
+size_t
+find_pivot_in_lines(const matrix *const matrix,
+                    const enum solver_pivoting pivoting, const size_t column,
+                    const size_t first, const size_t end)
+{
+	size_t best = end;
+	for (size_t i = first; i < end; i++) {
+		if (tiered_is_zero(matrix_line(matrix, i) + column)) {
+			continue;
+		}
+		if (best == end) {
+			best = i;
+			if (pivoting == PIVOTING_FIRST) {
+				break;
+			}
+		} else if (is_better_pivot(matrix, pivoting, column, i, best)) {
+			best = i;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Subtracts a multiple of a line from another, in place.
+ *
+ * Performs `line` -= `factor` \f$\times\f$ `pivot_line`, element by
+ * element, with one tiered_submul() each. The columns before `first_col`
+ * are left untouched: they are expected to be zero in `pivot_line`.
+ *
+ * @param[in, out] table The storage of the promoted values of the lines.
+ * @param[in, out] line Pointer to the first item of the line being modified.
+ * @param[in] pivot_line Pointer to the first item of the line being
+ * subtracted.
+ * @param[in] factor The fraction to multiply `pivot_line` by.
+ * @param[in] first_col The index of the first column to update.
+ * @param[in] n_col The number of columns in the lines.
+ */
+void
+eliminate_line(wide_table *const table, fraction *const line,
+               const fraction *const pivot_line, const fraction *const factor,
+               const size_t first_col, const size_t n_col)
+{
+	for (size_t i = first_col; i < n_col; i++) {
+		tiered_submul(table, &line[i], factor, &pivot_line[i]);
+	}
+}
+
+/**
+ * @brief Subtracts a multiple of the pivot's line from another, with the
+ * line kernels when they apply.
+ *
+ * The kernels only handle fractions: the line is copied to a @ref
+ * fraction_row if none of its values, nor the factor, is promoted. From the
+ * first element that overflows on, and for the other lines, the elements go
+ * through eliminate_line().
+ *
+ * @param[in, out] step The @ref elimination_step being done.
+ * @param[in, out] row The line of fractions of the thread.
+ * @param[in, out] line The line being eliminated.
+ * @param[in] factor The fraction to multiply the pivot's line by.
+ */
+static void
+eliminate_narrow_line(struct elimination_step *const step,
+                      fraction_row *const row, fraction *const line,
+                      const fraction *const factor)
+{
+	matrix *matrix = step->matrix;
+	const size_t column = step->pivot;
+	const size_t n_col = matrix->n_col;
+	size_t first = column;
+	if (step->narrow_pivot && !fraction_is_wide(factor) &&
+	    fraction_row_load(row, line, column, n_col)) {
+		first = row_submul(row, factor, &step->pivot_row, column,
+		                   n_col);
+		fraction_row_store(row, line, column, first);
+	}
+	eliminate_line(&matrix->wide, line, matrix_line(matrix, step->line),
+	               factor, first, n_col);
+}
+
+/**
+ * @brief Records the growth of the coefficients after a step of an
+ * elimination.
+ *
+ * @param[in] matrix The matrix being eliminated.
+ * @param[in] n_lines The number of lines of the matrix already filled.
+ * @param[in] step The index of the step.
+ */
+static void
+record_growth(const matrix *const matrix, const size_t n_lines,
+              const size_t step)
+{
+	size_t greatest_numerator = 0;
+	size_t greatest_denominator = 0;
+	for (size_t i = 0; i < n_lines; i++) {
+		const fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; j < matrix->n_col; j++) {
+			size_t numerator_bits = 0;
+			size_t denominator_bits = 0;
+			tiered_bits(&matrix->wide, &line[j], &numerator_bits,
+			            &denominator_bits);
+			if (numerator_bits > greatest_numerator) {
+				greatest_numerator = numerator_bits;
+			}
+			if (denominator_bits > greatest_denominator) {
+				greatest_denominator = denominator_bits;
+			}
+		}
+	}
+	stats_record_step(step, (uint32_t)greatest_numerator,
+	                  (uint32_t)greatest_denominator);
+}
+
+/**
+ * @brief Searches a share of the lines for the best pivot of the pivot's
+ * column.
+ *
+ * Only the lines from the pivot's on are searched: those above it hold the
+ * previous pivots. They are split in contiguous blocks, one per thread, so
+ * that the results can be combined in order.
+ *
+ * @see pool_task
+ *
+ * @param[in, out] argument The @ref elimination_step being done.
+ * @param[in] thread The index of the thread.
+ * @param[in] n_threads The number of threads.
+ */
+static void
+search_pivot_task(void *const argument, const size_t thread,
+                  const size_t n_threads)
+{
+	struct elimination_step *step = argument;
+	const size_t first = step->line;
+	const size_t count = step->matrix->n_lines - first;
+	step->candidates[thread] = find_pivot_in_lines(
+	    step->matrix, step->pivoting, step->pivot,
+	    first + count * thread / n_threads,
+	    first + count * (thread + 1) / n_threads);
+}
+
+/**
+ * @brief Combines the results of search_pivot_task().
+ *
+ * The blocks are combined in order, so that the line found is the same as
+ * with a single thread.
+ *
+ * @param[in] step The step whose pivot was searched for.
+ * @param[in] n_threads The number of threads that searched.
+ *
+ * @return The line number of the best pivot of the column, or the number of
+ * lines of the matrix if the column is zero from the pivot's line on.
+ */
+static size_t
+best_candidate(const struct elimination_step *const step,
+               const size_t n_threads)
+{
+	const matrix *matrix = step->matrix;
+	const size_t n_lines = matrix->n_lines;
+	const size_t column = step->pivot;
+	const size_t first = step->line;
+	const size_t count = n_lines - first;
+	size_t best = n_lines;
+	for (size_t t = 0; t < n_threads; t++) {
+		const size_t candidate = step->candidates[t];
+		if (candidate == first + count * (t + 1) / n_threads) {
+			/* This block had no candidate */
+			continue;
+		}
+		if (best == n_lines) {
+			best = candidate;
+		} else if (is_better_pivot(matrix, step->pivoting, column,
+		                           candidate, best)) {
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Eliminates the pivot's column from a share of the lines.
+ *
+ * Every line below the pivot, and above it for the Gauss-Jordan
+ * elimination, is independent of the others. They are dealt out to the
+ * threads in turn, each with its own factor.
+ *
+ * @see pool_task
+ *
+ * @param[in, out] argument The @ref elimination_step being done.
+ * @param[in] thread The index of the thread.
+ * @param[in] n_threads The number of threads.
+ */
+static void
+eliminate_task(void *const argument, const size_t thread,
+               const size_t n_threads)
+{
+	struct elimination_step *step = argument;
+	matrix *matrix = step->matrix;
+	const size_t i = step->line;
+	const size_t column = step->pivot;
+	fraction *simplification_factor = &step->factors[thread];
+	const size_t first = step->reduce ? 0 : i + 1;
+	for (size_t j = first + thread; j < matrix->n_lines; j += n_threads) {
+		if (j == i) {
+			/* This is the pivot */
+			continue;
+		}
+		fraction *line = matrix_line(matrix, j);
+		if (tiered_is_zero(&line[column])) {
+			/* Nothing to eliminate */
+			continue;
+		}
+		/* Determine the factor */
+		tiered_multiply(&matrix->wide, &line[column],
+		                step->inverse_of_pivot, simplification_factor);
+		/* The pivot's line is zero left of the pivot */
+		eliminate_narrow_line(step, &step->rows[thread], line,
+		                      simplification_factor);
+	}
+}
+
+/**
+ * @brief Eliminates the pivot's column from a share of the lines, within
+ * the pivot's block only.
+ *
+ * Each line below the pivot keeps its factor in the pivot's column, instead
+ * of the zero it would end with, and only the columns of the block are
+ * updated: the rest of the line is left to update_block_task().
+ *
+ * @see eliminate_task
+ *
+ * @param[in, out] argument The @ref elimination_step being done.
+ * @param[in] thread The index of the thread.
+ * @param[in] n_threads The number of threads.
+ */
+static void
+factor_block_task(void *const argument, const size_t thread,
+                  const size_t n_threads)
+{
+	struct elimination_step *step = argument;
+	matrix *matrix = step->matrix;
+	const size_t i = step->line;
+	const size_t column = step->pivot;
+	const fraction *pivot_line = matrix_line(matrix, i);
+	fraction *factor = &step->factors[thread];
+	for (size_t j = i + 1 + thread; j < matrix->n_lines; j += n_threads) {
+		fraction *line = matrix_line(matrix, j);
+		if (tiered_is_zero(&line[column])) {
+			/* Nothing to eliminate */
+			continue;
+		}
+		tiered_multiply(&matrix->wide, &line[column],
+		                step->inverse_of_pivot, factor);
+		/* The factor takes the place of the value it comes from */
+		tiered_release(&matrix->wide, &line[column]);
+		line[column] = *factor;
+		*factor = (fraction){0, 0, 1};
+		eliminate_line(&matrix->wide, line, pivot_line, &line[column],
+		               column + 1, step->block_end);
+	}
+}
+
+/**
+ * @brief Applies the pivots of a block to the rest of a line.
+ *
+ * The columns right of the block are updated one tile at a time: the tile
+ * of the line stays in cache while the tiles of all the pivots of the block
+ * are subtracted from it, instead of the whole line being read again for
+ * each pivot. The factors are then replaced with the zeros they stand for.
+ *
+ * @param[in, out] step The @ref elimination_step being done.
+ * @param[in] j The index of the line, below the first pivot of the block.
+ */
+static void
+update_block_line(struct elimination_step *const step, const size_t j)
+{
+	matrix *matrix = step->matrix;
+	fraction *line = matrix_line(matrix, j);
+	/* The lines of the block only depend on the pivots above them */
+	const size_t above = j - step->block_line;
+	const size_t count =
+	    above < step->block_pivots ? above : step->block_pivots;
+	const size_t start = step->block_start;
+	for (size_t first = step->block_end; first < matrix->n_col;
+	     first += step->tile_width) {
+		const size_t last = first + step->tile_width < matrix->n_col
+		                        ? first + step->tile_width
+		                        : matrix->n_col;
+		for (size_t p = 0; p < count; p++) {
+			if (!tiered_is_zero(&line[start + p])) {
+				eliminate_line(
+				    &matrix->wide, line,
+				    matrix_line(matrix, step->block_line + p),
+				    &line[start + p], first, last);
+			}
+		}
+	}
+	for (size_t p = 0; p < count; p++) {
+		tiered_release(&matrix->wide, &line[start + p]);
+		line[start + p] = (fraction){0, 0, 1};
+	}
+}
+
+/**
+ * @brief Applies the pivots of a block to a share of the lines below it.
+ *
+ * The lines of the block are updated beforehand, since they are the pivot
+ * lines of the others.
+ *
+ * @see update_block_line
+ * @see pool_task
+ *
+ * @param[in, out] argument The @ref elimination_step being done.
+ * @param[in] thread The index of the thread.
+ * @param[in] n_threads The number of threads.
+ */
+static void
+update_block_task(void *const argument, const size_t thread,
+                  const size_t n_threads)
+{
+	struct elimination_step *step = argument;
+	const size_t first = step->block_line + step->block_pivots;
+	for (size_t j = first + thread; j < step->matrix->n_lines;
+	     j += n_threads) {
+		update_block_line(step, j);
+	}
+}
+
+/**
+ * @brief Eliminates the columns of the unknowns, one pivot after the other.
+ *
+ * The pivot search and the updates of the lines are shared between the
+ * threads of a pool, started once for the whole elimination. The promoted
+ * values are then protected by the lock of the matrix's table.
+ *
+ * One pivot at a time, the lines whose values all fit in fractions are
+ * updated by the vectorised kernel row_submul().
+ *
+ * A column that is zero from the next pivot's line down has no pivot: it is
+ * skipped, and the next pivot is searched for in the next column, from the
+ * same line. The matrix then ends in a row-echelon form whose number of
+ * pivots is its rank, and no zero is ever inverted.
+ *
+ * With blocks of more than one pivot, each block of columns is eliminated
+ * first, the factors of the lines being kept in place, then the pivots of
+ * the block are applied together to the rest of the lines by
+ * update_block_task(). The matrix is then read once per block instead of
+ * once per pivot. A column without a pivot ends its block early. The values
+ * are the same either way, but the sparsest pivots are chosen from the lines
+ * as they were at the start of the block.
+ *
+ * @param[in, out] matrix The matrix to manipulate.
+ * @param[in] pivoting How the pivots are chosen.
+ * @param[in] block_size The number of pivots eliminated together, 0 or 1
+ * for one at a time. It is ignored when `reduce` is set.
+ * @param[in] n_threads The number of threads to use.
+ * @param[in, out] scratch The arena to allocate the state of the threads
+ * from, with the room given by triangularise_arena_size(). It is released
+ * on return.
+ * @param[in] reduce Whether the lines above the pivots are eliminated too.
+ * @param[out] echelon Where to store the rank and the parity of the
+ * elimination.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+eliminate_columns(matrix *const matrix, const enum solver_pivoting pivoting,
+                  const size_t block_size, const size_t n_threads,
+                  arena *const scratch, const bool reduce,
+                  struct echelon *const echelon)
+{
+	const size_t n_lines = matrix->n_lines;
+	const size_t position = arena_position(scratch);
+	struct elimination_step step = {0};
+	step.matrix = matrix;
+	step.reduce = reduce;
+	step.pivoting = pivoting;
+	step.factors = arena_alloc(scratch, n_threads, sizeof(fraction));
+	step.candidates = arena_alloc(scratch, n_threads, sizeof(size_t));
+	step.rows = arena_alloc(scratch, n_threads, sizeof(fraction_row));
+	bool allocated = step.factors != NULL && step.candidates != NULL &&
+	                 step.rows != NULL &&
+	                 fraction_row_alloc(&step.pivot_row, scratch,
+	                                    matrix->n_col);
+	for (size_t t = 0; allocated && t < n_threads; t++) {
+		allocated = fraction_row_alloc(&step.rows[t], scratch,
+		                               matrix->n_col);
+	}
+	worker_pool pool;
+	if (!allocated || !pool_init(&pool, n_threads)) {
+		arena_rewind(scratch, position);
+		return false;
+	}
+	pthread_mutex_t table_lock;
+	if (pool.n_threads > 1) {
+		pthread_mutex_init(&table_lock, NULL);
+		matrix->wide.lock = &table_lock;
+	}
+	for (size_t t = 0; t < pool.n_threads; t++) {
+		fraction_from_int(0, &step.factors[t]);
+	}
+	const bool blocked = block_size > 1 && !reduce;
+	if (blocked) {
+		step.tile_width = TILE_BYTES / (block_size * sizeof(fraction));
+		if (step.tile_width == 0) {
+			step.tile_width = 1;
+		}
+	}
+
+	if (STATS_ENABLED) {
+		stats_begin_steps(n_lines);
+	}
+	*echelon = (struct echelon){0, false};
+	const size_t width = blocked ? block_size : 1;
+	size_t column = 0;
+	while (column < n_lines) {
+		const size_t end = column + width < n_lines ? column + width
+		                                            : n_lines;
+		step.block_line = echelon->rank;
+		step.block_start = column;
+		step.block_end = blocked ? end : 0;
+		for (; column < end; column++) {
+			/* The pivot is in position (rank, column) */
+			const size_t i = echelon->rank;
+			step.line = i;
+			step.pivot = column;
+			/* Make the line of the best value of the column the
+			 * pivot line */
+			pool_run(&pool, search_pivot_task, &step);
+			const size_t line_pivot =
+			    best_candidate(&step, pool.n_threads);
+			if (line_pivot == n_lines) {
+				/* The column has no pivot, and ends the
+				 * block */
+				column++;
+				break;
+			}
+			if (line_pivot > i) {
+				matrix_swap_lines(matrix, i, line_pivot);
+				echelon->odd_swaps = !echelon->odd_swaps;
+				STATS_ADD(row_swaps, 1);
+			}
+			fraction *pivot_line = matrix_line(matrix, i);
+
+			fraction inverse_of_pivot = {0, 0, 1};
+			tiered_invert(&matrix->wide, &pivot_line[column],
+			              &inverse_of_pivot);
+			step.inverse_of_pivot = &inverse_of_pivot;
+			step.narrow_pivot =
+			    !blocked && fraction_row_load(&step.pivot_row,
+			                                  pivot_line, column,
+			                                  matrix->n_col);
+			pool_run(&pool,
+			         blocked ? factor_block_task : eliminate_task,
+			         &step);
+			tiered_release(&matrix->wide, &inverse_of_pivot);
+			echelon->rank++;
+			if (STATS_ENABLED && !blocked) {
+				record_growth(matrix, n_lines, column);
+			}
+		}
+		step.block_pivots = echelon->rank - step.block_line;
+		if (blocked && step.block_pivots > 0) {
+			/* The lines of the block are the pivot lines of the
+			 * others */
+			for (size_t j = step.block_line + 1; j < echelon->rank;
+			     j++) {
+				update_block_line(&step, j);
+			}
+			pool_run(&pool, update_block_task, &step);
+			if (STATS_ENABLED) {
+				record_growth(matrix, n_lines, column - 1);
+			}
+		}
+	}
+
+	for (size_t t = 0; t < pool.n_threads; t++) {
+		tiered_release(&matrix->wide, &step.factors[t]);
+	}
+	if (pool.n_threads > 1) {
+		matrix->wide.lock = NULL;
+		pthread_mutex_destroy(&table_lock);
+	}
+	pool_free(&pool);
+	arena_rewind(scratch, position);
+	return true;
+}
+
+/**
+ * @brief Computes a row-echelon form of the matrix.
+ *
+ * Uses Gauss' method (row operations) to find a row-echelon form of the
+ * matrix: at each step, only the lines below the pivot are eliminated, from
+ * the pivot's column on. The matrix is modified in place. The elements that
+ * overflow are promoted to wider representations.
+ *
+ * @see eliminate_columns()
+ *
+ * @param[in, out] matrix The matrix to manipulate.
+ * @param[in] pivoting How the pivots are chosen.
+ * @param[in] block_size The number of pivots eliminated together, 0 or 1
+ * for one at a time.
+ * @param[in] n_threads The number of threads to use.
+ * @param[in, out] scratch The arena to allocate the state of the threads
+ * from, with the room given by triangularise_arena_size().
+ * @param[out] echelon Where to store the rank and the parity of the
+ * elimination.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+triangularise(matrix *const matrix, const enum solver_pivoting pivoting,
+              const size_t block_size, const size_t n_threads,
+              arena *const scratch, struct echelon *const echelon)
+{
+	return eliminate_columns(matrix, pivoting, block_size, n_threads,
+	                         scratch, false, echelon);
+}
+
+/**
+ * @brief Computes the diagonal form of the matrix with the Gauss-Jordan
+ * method.
+ *
+ * At each step, the lines above the pivot are eliminated along with those
+ * below, which takes about half as many operations again as triangularise()
+ * followed by diagonalise(). It is kept to compare both.
+ *
+ * @see eliminate_columns()
+ *
+ * @param[in, out] matrix The matrix to manipulate.
+ * @param[in] pivoting How the pivots are chosen.
+ * @param[in] n_threads The number of threads to use.
+ * @param[in, out] scratch The arena to allocate the state of the threads
+ * from, with the room given by triangularise_arena_size().
+ * @param[out] echelon Where to store the rank and the parity of the
+ * elimination.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+gauss_jordan(matrix *const matrix, const enum solver_pivoting pivoting,
+             const size_t n_threads, arena *const scratch,
+             struct echelon *const echelon)
+{
+	return eliminate_columns(matrix, pivoting, 1, n_threads, scratch,
+	                         true, echelon);
+}
+
+/**
+ * @brief Adds two sizes, saturating at SIZE_MAX.
+ *
+ * @param[in] a One of the sizes.
+ * @param[in] b The other size.
+ *
+ * @return The sum, or SIZE_MAX if it overflows.
+ */
+static size_t
+add_sizes(const size_t a, const size_t b)
+{
+	return a > SIZE_MAX - b ? SIZE_MAX : a + b;
+}
+
+/**
+ * @brief Gives the room triangularise() and gauss_jordan() need in an arena.
+ *
+ * @param[in] n_col The number of columns of the matrix.
+ * @param[in] n_threads The number of threads they use.
+ *
+ * @return The number of bytes, or SIZE_MAX if it overflows.
+ */
+size_t
+triangularise_arena_size(const size_t n_col, const size_t n_threads)
+{
+	size_t size = add_sizes(arena_size(n_threads, sizeof(fraction)),
+	                        arena_size(n_threads, sizeof(size_t)));
+	size = add_sizes(size, arena_size(n_threads, sizeof(fraction_row)));
+	const size_t row = fraction_row_arena_size(n_col);
+	for (size_t t = 0; t <= n_threads; t++) {
+		size = add_sizes(size, row);
+	}
+	return size;
+}
+
+/**
+ * @brief Reduces a matrix in upper-echelon form.
+ *
+ * Uses back-substitution to transform a matrix in row-echelon form to its
+ * diagonal form, from the last column of the unknowns to the first. Once the
+ * lines below a pivot are done, they are zero right of their own pivot but
+ * in the columns of the constants: eliminating the pivot's column from the
+ * lines above only updates these, in \f$O(n^2)\f$ operations per
+ * right-hand side. The diagonal is left as it is, and the solution is read
+ * off by dividing the constants by it.
+ *
+ * @param[in,out] matrix The matrix to reduce, from triangularise().
+ */
+void
+diagonalise(matrix *const matrix)
+{
+	const size_t n = matrix->n_lines;
+	wide_table *table = &matrix->wide;
+	fraction inverse_of_pivot = {0, 0, 1};
+	fraction factor = {0, 0, 1};
+	for (size_t j = n; j-- > 0;) {
+		const fraction *pivot_line = matrix_line(matrix, j);
+		if (tiered_is_zero(&pivot_line[j])) {
+			/* A singular system: the column cannot be eliminated */
+			continue;
+		}
+		tiered_invert(table, &pivot_line[j], &inverse_of_pivot);
+		for (size_t i = 0; i < j; i++) {
+			fraction *line = matrix_line(matrix, i);
+			if (tiered_is_zero(&line[j])) {
+				/* Nothing to eliminate */
+				continue;
+			}
+			tiered_multiply(table, &line[j], &inverse_of_pivot,
+			                &factor);
+			eliminate_line(table, line, pivot_line, &factor, n,
+			               matrix->n_col);
+			tiered_release(table, &line[j]);
+			line[j] = (fraction){0, 0, 1};
+		}
+	}
+	tiered_release(table, &inverse_of_pivot);
+	tiered_release(table, &factor);
+}
+
+/**
+ * @brief Performs the gaussian elimination method on the matrix.
+ *
+ * Uses the gaussian elimitation method on an augmented matrix to find the
+ * solution of its corresponding system of linear equations: a forward
+ * elimination to a row-echelon form, then a back-substitution on the
+ * constants. The matrix is modified in place.
+ *
+ * @param[in, out] matrix The matrix system to resolve.
+ * @param[in] pivoting How the pivots are chosen.
+ * @param[in] block_size The number of pivots eliminated together, 0 or 1
+ * for one at a time.
+ * @param[in] n_threads The number of threads to use.
+ * @param[in, out] scratch The arena to allocate the temporary memory from.
+ * @param[out] echelon Where to store the rank and the parity of the
+ * elimination. The back-substitution is only done if the matrix is regular,
+ * with a rank of its number of lines.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+gaussian_elimination(matrix *const matrix,
+                     const enum solver_pivoting pivoting,
+                     const size_t block_size, const size_t n_threads,
+                     arena *const scratch, struct echelon *const echelon)
+{
+	if (!triangularise(matrix, pivoting, block_size, n_threads, scratch,
+	                   echelon)) {
+		return false;
+	}
+	if (echelon->rank == matrix->n_lines) {
+		diagonalise(matrix);
+	}
+	return true;
+}
+
+/**
+ * @brief Computes the LU factorisation of a system, with partial pivoting.
+ *
+ * Only the lines below each pivot are eliminated. The matrix ends up with U
+ * on and above the diagonal and, below it, the factors each line was
+ * eliminated with, which make up L (its unit diagonal is implicit). The
+ * columns of the constants are eliminated along: they are then solved by
+ * back_substitute() alone. The pivots are chosen as by triangularise().
+ *
+ * A column without a pivot is skipped, as by triangularise(), so that the
+ * rank of a singular system is still found. The factors are then of no use
+ * to solve it.
+ *
+ * @param[in, out] matrix The augmented matrix of the system, with a column
+ * per right-hand side after the columns of the unknowns.
+ * @param[in] pivoting How the pivots are chosen.
+ * @param[out] permutation Where to store the line of the system at each line
+ * of the factors.
+ * @param[out] echelon Where to store the rank and the parity of the
+ * permutation.
+ *
+ * @return Whether the system is regular.
+ */
+bool
+factorise(matrix *const matrix, const enum solver_pivoting pivoting,
+          size_t *const permutation, struct echelon *const echelon)
+{
+	const size_t n = matrix->n_lines;
+	wide_table *table = &matrix->wide;
+	for (size_t i = 0; i < n; i++) {
+		permutation[i] = i;
+	}
+	if (STATS_ENABLED) {
+		stats_begin_steps(n);
+	}
+	*echelon = (struct echelon){0, false};
+	fraction inverse_of_pivot = {0, 0, 1};
+	fraction factor = {0, 0, 1};
+	for (size_t column = 0; column < n; column++) {
+		/* The pivot is in position (rank, column) */
+		const size_t i = echelon->rank;
+		const size_t line_pivot =
+		    find_pivot_in_lines(matrix, pivoting, column, i, n);
+		if (line_pivot == n) {
+			/* No pivot in this column */
+			continue;
+		}
+		if (line_pivot > i) {
+			matrix_swap_lines(matrix, i, line_pivot);
+			const size_t line = permutation[i];
+			permutation[i] = permutation[line_pivot];
+			permutation[line_pivot] = line;
+			echelon->odd_swaps = !echelon->odd_swaps;
+			STATS_ADD(row_swaps, 1);
+		}
+
+		const fraction *pivot_line = matrix_line(matrix, i);
+		tiered_invert(table, &pivot_line[column], &inverse_of_pivot);
+		for (size_t j = i + 1; j < n; j++) {
+			fraction *line = matrix_line(matrix, j);
+			if (tiered_is_zero(&line[column])) {
+				continue;
+			}
+			tiered_multiply(table, &line[column],
+			                &inverse_of_pivot, &factor);
+			eliminate_line(table, line, pivot_line, &factor,
+			               column + 1, matrix->n_col);
+			/* The eliminated element keeps the factor, for L */
+			tiered_release(table, &line[column]);
+			line[column] = factor;
+			factor = (fraction){0, 0, 1};
+		}
+		echelon->rank++;
+		if (STATS_ENABLED) {
+			record_growth(matrix, n, column);
+		}
+	}
+	tiered_release(table, &inverse_of_pivot);
+	return echelon->rank == n;
+}
+
+/**
+ * @brief Applies the L factor of a factorisation to the constants of a
+ * system.
+ *
+ * The constants must already be in the order of the lines of the factors.
+ * They are then as if they had been eliminated by factorise().
+ *
+ * @param[in, out] matrix The factorisation of the system, by factorise(),
+ * with new constants in the columns after the unknowns.
+ */
+void
+forward_substitute(matrix *const matrix)
+{
+	const size_t n = matrix->n_lines;
+	for (size_t i = 1; i < n; i++) {
+		fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; j < i; j++) {
+			if (tiered_is_zero(&line[j])) {
+				continue;
+			}
+			eliminate_line(&matrix->wide, line,
+			               matrix_line(matrix, j), &line[j], n,
+			               matrix->n_col);
+		}
+	}
+}
+
+/**
+ * @brief Solves a factorised system, by back-substitution on U.
+ *
+ * @param[in, out] matrix The factorisation of the system, whose constants
+ * were eliminated by factorise() or forward_substitute(). Its table stores
+ * the promoted values of the solution.
+ * @param[in, out] solution Where to store the solution of each right-hand
+ * side, one after the other. The previous values are released.
+ */
+void
+back_substitute(matrix *const matrix, fraction *const solution)
+{
+	const size_t n = matrix->n_lines;
+	const size_t n_rhs = matrix->n_col - n;
+	wide_table *table = &matrix->wide;
+	const fraction one = {0, 1, 1};
+	fraction inverse = {0, 0, 1};
+	for (size_t i = n; i-- > 0;) {
+		const fraction *line = matrix_line(matrix, i);
+		tiered_invert(table, &line[i], &inverse);
+		for (size_t r = 0; r < n_rhs; r++) {
+			fraction *values = solution + r * n;
+			tiered_multiply(table, &line[n + r], &one, &values[i]);
+			for (size_t j = i + 1; j < n; j++) {
+				tiered_submul(table, &values[i], &line[j],
+				              &values[j]);
+			}
+			tiered_multiply(table, &values[i], &inverse,
+			                &values[i]);
+		}
+	}
+	tiered_release(table, &inverse);
+}
+
+/**
+ * @brief Solves a factorised system for a single vector.
+ *
+ * The vector goes through the permutation, L and U in place, in
+ * \f$O(n^2)\f$ operations, without touching the constants of the matrix.
+ *
+ * @param[in, out] factors The factorisation of the system, by factorise().
+ * Its table stores the promoted values of the solution.
+ * @param[in] permutation The line of the system at each line of the
+ * factors.
+ * @param[in] vector The vector, in the order of the lines of the system.
+ * @param[in, out] solution Where to store the solution. The previous values
+ * are released.
+ */
+void
+solve_factored(matrix *const factors, const size_t *const permutation,
+               const fraction *const vector, fraction *const solution)
+{
+	const size_t n = factors->n_lines;
+	wide_table *table = &factors->wide;
+	const fraction one = {0, 1, 1};
+	for (size_t i = 0; i < n; i++) {
+		const fraction *line = matrix_line(factors, i);
+		tiered_multiply(table, &vector[permutation[i]], &one,
+		                &solution[i]);
+		for (size_t j = 0; j < i; j++) {
+			if (!tiered_is_zero(&line[j])) {
+				tiered_submul(table, &solution[i], &line[j],
+				              &solution[j]);
+			}
+		}
+	}
+	fraction inverse = {0, 0, 1};
+	for (size_t i = n; i-- > 0;) {
+		const fraction *line = matrix_line(factors, i);
+		for (size_t j = i + 1; j < n; j++) {
+			if (!tiered_is_zero(&line[j])) {
+				tiered_submul(table, &solution[i], &line[j],
+				              &solution[j]);
+			}
+		}
+		tiered_invert(table, &line[i], &inverse);
+		tiered_multiply(table, &solution[i], &inverse, &solution[i]);
+	}
+	tiered_release(table, &inverse);
+}
+
+/**
+ * @brief Corrects a solution of the factorised system into one of the
+ * system changed by rank-one updates.
+ *
+ * By the Sherman-Morrison formula, each update \f$A + uv^T\f$ turns the
+ * solution \f$x\f$ of \f$Ax = b\f$ into
+ * \f$x - A^{-1}u \frac{v^Tx}{1 + v^TA^{-1}u}\f$, in \f$O(n)\f$ operations
+ * once \f$A^{-1}u\f$ is known. The updates are applied in the order they
+ * were made, each one to the system changed by the previous ones.
+ *
+ * @param[in, out] table The storage of the promoted values of the updates
+ * and of the solution.
+ * @param[in] updates The updates.
+ * @param[in] count The number of updates to apply, from the first one.
+ * @param[in] n The number of unknowns.
+ * @param[in, out] values The solution to correct.
+ */
+void
+apply_rank_updates(wide_table *const table,
+                   const struct rank_updates *const updates,
+                   const size_t count, const size_t n, fraction *const values)
+{
+	fraction product = {0, 0, 1};
+	fraction factor = {0, 0, 1};
+	for (size_t t = 0; t < count; t++) {
+		const fraction *column = updates->columns + t * n;
+		const fraction *row = updates->rows + t * n;
+		/* Minus v^T x */
+		tiered_release(table, &product);
+		product = (fraction){0, 0, 1};
+		for (size_t j = 0; j < n; j++) {
+			if (!tiered_is_zero(&row[j])) {
+				tiered_submul(table, &product, &row[j],
+				              &values[j]);
+			}
+		}
+		if (tiered_is_zero(&product)) {
+			continue;
+		}
+		tiered_multiply(table, &product, &updates->pivots[t], &factor);
+		for (size_t i = 0; i < n; i++) {
+			tiered_submul(table, &values[i], &factor, &column[i]);
+		}
+	}
+	tiered_release(table, &product);
+	tiered_release(table, &factor);
+}
+
+/**
+ * @brief Records a rank-one update \f$uv^T\f$ of a factorised system.
+ *
+ * \f$A^{-1}u\f$ is solved with the factors and the previous updates, in
+ * \f$O(n^2)\f$ operations, and kept for apply_rank_updates(). The update is
+ * not recorded if it makes the system singular: the formula would divide by
+ * zero.
+ *
+ * @param[in, out] factors The factorisation of the system, by factorise().
+ * Its table stores the promoted values of the updates.
+ * @param[in] permutation The line of the system at each line of the
+ * factors.
+ * @param[in, out] updates The updates, with room for one more.
+ * @param[in] u The column of the update, in the order of the lines.
+ * @param[in] v The line of the update, in the order of the unknowns.
+ * @param[in, out] ratio Where to store \f$1 + v^TA^{-1}u\f$, the ratio of
+ * the determinants of the system after and before the update. The previous
+ * value is released.
+ *
+ * @return Whether the system is still regular, and the update recorded.
+ */
+bool
+add_rank_update(matrix *const factors, const size_t *const permutation,
+                struct rank_updates *const updates, const fraction *const u,
+                const fraction *const v, fraction *const ratio)
+{
+	const size_t n = factors->n_lines;
+	wide_table *table = &factors->wide;
+	fraction *column = updates->columns + updates->count * n;
+	fraction *row = updates->rows + updates->count * n;
+	/* The room of the update may hold stale values, of a table since
+	 * cleared: they are not released */
+	for (size_t i = 0; i < n; i++) {
+		column[i] = (fraction){0, 0, 1};
+		row[i] = (fraction){0, 0, 1};
+	}
+	updates->pivots[updates->count] = (fraction){0, 0, 1};
+	solve_factored(factors, permutation, u, column);
+	apply_rank_updates(table, updates, updates->count, n, column);
+	/* 1 - (-v^T A^-1 u) */
+	const fraction one = {0, 1, 1};
+	fraction product = {0, 0, 1};
+	for (size_t j = 0; j < n; j++) {
+		if (!tiered_is_zero(&v[j])) {
+			tiered_submul(table, &product, &v[j], &column[j]);
+		}
+	}
+	tiered_release(table, ratio);
+	fraction_from_int(1, ratio);
+	tiered_submul(table, ratio, &product, &one);
+	tiered_release(table, &product);
+	if (tiered_is_zero(ratio)) {
+		for (size_t i = 0; i < n; i++) {
+			tiered_release(table, &column[i]);
+		}
+		return false;
+	}
+	/* The pivot is stored as -1 / (1 + v^T A^-1 u): the correction is
+	 * then subtracted with the product apply_rank_updates() computes */
+	const fraction minus_one = {1, 1, 1};
+	fraction inverse = {0, 0, 1};
+	tiered_invert(table, ratio, &inverse);
+	tiered_multiply(table, &inverse, &minus_one,
+	                &updates->pivots[updates->count]);
+	tiered_release(table, &inverse);
+	for (size_t j = 0; j < n; j++) {
+		tiered_multiply(table, &v[j], &one, &row[j]);
+	}
+	updates->count++;
+	return true;
+}
+
+/**
+ * @brief Writes a little-endian 64-bit integer to a file.
+ *
+ * @param[in] stream The file to write to.
+ * @param[in] value The integer.
+ *
+ * @return Whether the integer could be written.
+ */
+static bool
+write_u64(FILE *const stream, const uint64_t value)
+{
+	unsigned char bytes[8];
+	for (unsigned b = 0; b < 8; b++) {
+		bytes[b] = (unsigned char)(value >> (8 * b));
+	}
+	return fwrite(bytes, 1, 8, stream) == 8;
+}
+
+/**
+ * @brief Saves the factorisation of a system to a file.
+ *
+ * The file starts with a header of @ref FACTORS_HEADER_SIZE bytes: the magic
+ * bytes `LQSF`, the version of the format on 2 bytes, 2 bytes of zeros and
+ * the number of unknowns on 8 bytes. The permutation follows, one 8-byte
+ * integer per line, then the elements of L and U line after line, written
+ * by tiered_write(). All the integers are little-endian.
+ *
+ * @param[in] stream The file to write to, opened in binary mode.
+ * @param[in] matrix The factorisation, by factorise(). The constants are not
+ * saved.
+ * @param[in] permutation The permutation of the lines of the factorisation.
+ *
+ * @return Whether the file could be written.
+ */
+bool
+write_factors(FILE *const stream, const matrix *const matrix,
+              const size_t *const permutation)
+{
+	const size_t n = matrix->n_lines;
+	const unsigned char header[8] = {'L', 'Q', 'S', 'F', FACTORS_VERSION,
+	                                 0, 0, 0};
+	bool written = fwrite(header, 1, 8, stream) == 8 &&
+	               write_u64(stream, n);
+	for (size_t i = 0; written && i < n; i++) {
+		written = write_u64(stream, permutation[i]);
+	}
+	for (size_t i = 0; written && i < n; i++) {
+		const fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; written && j < n; j++) {
+			written = tiered_write(stream, &matrix->wide, &line[j]);
+		}
+	}
+	return written && fflush(stream) == 0;
+}
+
+/**
+ * @brief Reads the header of a file written by write_factors().
+ *
+ * @param[in] stream The file to read from, opened in binary mode.
+ * @param[out] n Where to store the number of unknowns of the system.
+ * @param[out] error Where to describe why the header is not valid, or NULL.
+ *
+ * @return Whether the file starts with a valid header.
+ */
+bool
+read_factors_header(FILE *const stream, size_t *const n, char *const error)
+{
+	unsigned char header[FACTORS_HEADER_SIZE];
+	if (fread(header, 1, FACTORS_HEADER_SIZE, stream) !=
+	        FACTORS_HEADER_SIZE ||
+	    memcmp(header, "LQSF", 4) != 0) {
+		report_error(error, "the file does not hold factors");
+		return false;
+	}
+	const uint64_t size = binary_load_u64(header + 8);
+	if (header[4] != FACTORS_VERSION || header[5] != 0 || size == 0 ||
+	    size > INT32_MAX) {
+		report_error(error,
+		             "the factors are of an unknown version or size");
+		return false;
+	}
+	*n = (size_t)size;
+	return true;
+}
+
+/**
+ * @brief Reads the factorisation of a system, after its header.
+ *
+ * @param[in] stream The file to read from, positioned after the header.
+ * @param[in, out] matrix The matrix to store L and U in, in the columns of
+ * the unknowns, whose number of lines was given by the header.
+ * @param[out] permutation Where to store the permutation of the lines.
+ * @param[out] error Where to describe why the factors are not valid, or
+ * NULL.
+ *
+ * @return Whether valid factors could be read.
+ */
+bool
+read_factors(FILE *const stream, matrix *const matrix,
+             size_t *const permutation, char *const error)
+{
+	const size_t n = matrix->n_lines;
+	bool read = true;
+	for (size_t i = 0; read && i < n; i++) {
+		unsigned char bytes[8];
+		read = fread(bytes, 1, 8, stream) == 8;
+		const uint64_t line = binary_load_u64(bytes);
+		/* Each line of the system appears once */
+		read = read && line < n;
+		for (size_t j = 0; read && j < i; j++) {
+			read = permutation[j] != line;
+		}
+		permutation[i] = (size_t)line;
+	}
+	for (size_t i = 0; read && i < n; i++) {
+		fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; read && j < n; j++) {
+			read = tiered_read(stream, &matrix->wide, &line[j]);
+		}
+		/* A zero pivot would be divided by */
+		read = read && !tiered_is_zero(&line[i]);
+	}
+	if (!read) {
+		report_error(error, "the factors are not valid");
+	}
+	return read;
+}
+
+/**
+ * @brief Reads the lines of a system after the first, for
+ * pipelined_elimination().
+ *
+ * Each line is published as soon as it is stored in the matrix.
+ *
+ * @param[in, out] argument The @ref pipeline.
+ *
+ * @return NULL.
+ */
+static void *
+read_lines_task(void *const argument)
+{
+	struct pipeline *pipeline = argument;
+	matrix *matrix = pipeline->matrix;
+	for (size_t i = 1; i < matrix->n_lines; i++) {
+		bool read = read_system_line(pipeline->reader, matrix->n_col);
+		if (read) {
+			store_line(matrix, i, pipeline->reader->values);
+		}
+
+		pthread_mutex_lock(&pipeline->lock);
+		if (read) {
+			pipeline->n_read = i + 1;
+		} else {
+			pipeline->failed = true;
+		}
+		const bool stop = !read || pipeline->stopping;
+		pthread_cond_signal(&pipeline->line_read);
+		pthread_mutex_unlock(&pipeline->lock);
+		if (stop) {
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Waits until a line of the matrix is read.
+ *
+ * @param[in, out] pipeline The state of the elimination.
+ * @param[in] line The index of the line to wait for.
+ *
+ * @return Whether the line was read, or reading failed before.
+ */
+static bool
+wait_for_line(struct pipeline *const pipeline, const size_t line)
+{
+	pthread_mutex_lock(&pipeline->lock);
+	while (pipeline->n_read <= line && !pipeline->failed) {
+		pthread_cond_wait(&pipeline->line_read, &pipeline->lock);
+	}
+	const bool read = pipeline->n_read > line;
+	pthread_mutex_unlock(&pipeline->lock);
+	return read;
+}
+
+/**
+ * @brief Finds the column of the pivot of a line, for
+ * pipelined_elimination().
+ *
+ * @param[in] matrix The matrix the line belongs to.
+ * @param[in] line The line, eliminated against the previous pivots.
+ * @param[in] is_pivot Whether each column already holds a pivot.
+ *
+ * @return The column of the non-zero element of greatest magnitude, out of
+ * the columns without a pivot, or the number of lines of the matrix if they
+ * are all zero.
+ */
+static size_t
+find_pivot_column(const matrix *const matrix, const fraction *const line,
+                  const bool *const is_pivot)
+{
+	const size_t n = matrix->n_lines;
+	size_t column = n;
+	for (size_t j = 0; j < n; j++) {
+		if (is_pivot[j] || tiered_is_zero(&line[j])) {
+			continue;
+		}
+		if (column == n ||
+		    tiered_compare_magnitude(&matrix->wide, &line[j],
+		                             &line[column]) == 1) {
+			column = j;
+		}
+	}
+	return column;
+}
+
+/**
+ * @brief Reads a system and eliminates it at the same time.
+ *
+ * The lines after the first are read by another thread. Meanwhile, each line
+ * read is eliminated against the pivots of the previous lines, and its own
+ * pivot is then eliminated from them: this is Gauss-Jordan elimination, one
+ * line at a time. As the later lines are not known, the pivot of a line is
+ * chosen in its columns instead, and the lines are put back in the order of
+ * their pivots' columns at the end.
+ *
+ * The matrix ends up in the same form as with gaussian_elimination().
+ *
+ * @param[in, out] matrix The matrix to fill and reduce, whose first line is
+ * already read.
+ * @param[in, out] reader The reader of the file, positioned after the first
+ * line.
+ * @param[in, out] scratch The arena to allocate the temporary memory from,
+ * with the room given by pipelined_elimination_arena_size(). It is released
+ * on return.
+ * @param[out] error Where to describe why the system could not be
+ * eliminated, or NULL.
+ *
+ * @return Whether the system could be read and is regular.
+ */
+bool
+pipelined_elimination(matrix *const matrix, line_reader *const reader,
+                      arena *const scratch, char *const error)
+{
+	const size_t n_lines = matrix->n_lines;
+	const size_t position = arena_position(scratch);
+	size_t *pivot_columns = arena_alloc(scratch, n_lines, sizeof(size_t));
+	bool *is_pivot = arena_alloc(scratch, n_lines, sizeof(bool));
+	fraction *inverses = arena_alloc(scratch, n_lines, sizeof(fraction));
+	if (pivot_columns == NULL || is_pivot == NULL || inverses == NULL) {
+		report_error(error, "the memory was not allocated");
+		arena_rewind(scratch, position);
+		return false;
+	}
+	for (size_t i = 0; i < n_lines; i++) {
+		is_pivot[i] = false;
+	}
+
+	struct pipeline pipeline = {0};
+	pipeline.matrix = matrix;
+	pipeline.reader = reader;
+	pipeline.n_read = 1;
+	pthread_mutex_init(&pipeline.lock, NULL);
+	pthread_cond_init(&pipeline.line_read, NULL);
+	pthread_t reading_thread;
+	if (pthread_create(&reading_thread, NULL, read_lines_task,
+	                   &pipeline) != 0) {
+		report_error(error, "the reading thread was not started");
+		pthread_cond_destroy(&pipeline.line_read);
+		pthread_mutex_destroy(&pipeline.lock);
+		arena_rewind(scratch, position);
+		return false;
+	}
+
+	if (STATS_ENABLED) {
+		stats_begin_steps(n_lines);
+	}
+	fraction factor = {0, 0, 1};
+	size_t k = 0;
+	for (; k < n_lines && wait_for_line(&pipeline, k); k++) {
+		fraction *line = matrix_line(matrix, k);
+		for (size_t i = 0; i < k; i++) {
+			const size_t column = pivot_columns[i];
+			if (tiered_is_zero(&line[column])) {
+				continue;
+			}
+			tiered_multiply(&matrix->wide, &line[column],
+			                &inverses[i], &factor);
+			eliminate_line(&matrix->wide, line,
+			               matrix_line(matrix, i), &factor, 0,
+			               matrix->n_col);
+		}
+
+		const size_t column = find_pivot_column(matrix, line, is_pivot);
+		if (column == n_lines) {
+			report_error(error, "the system is singular");
+			break;
+		}
+		pivot_columns[k] = column;
+		is_pivot[column] = true;
+		inverses[k] = (fraction){0, 0, 1};
+		tiered_invert(&matrix->wide, &line[column], &inverses[k]);
+
+		for (size_t i = 0; i < k; i++) {
+			fraction *other = matrix_line(matrix, i);
+			if (tiered_is_zero(&other[column])) {
+				continue;
+			}
+			tiered_multiply(&matrix->wide, &other[column],
+			                &inverses[k], &factor);
+			eliminate_line(&matrix->wide, other, line, &factor, 0,
+			               matrix->n_col);
+		}
+		if (STATS_ENABLED) {
+			/* The lines after this one are not read yet */
+			record_growth(matrix, k + 1, k);
+		}
+	}
+	const bool solved = k == n_lines;
+
+	pthread_mutex_lock(&pipeline.lock);
+	pipeline.stopping = true;
+	pthread_mutex_unlock(&pipeline.lock);
+	pthread_join(reading_thread, NULL);
+	pthread_cond_destroy(&pipeline.line_read);
+	pthread_mutex_destroy(&pipeline.lock);
+	if (k < n_lines && pipeline.n_read <= k) {
+		/* The reader stopped on the line waited for */
+		report_error(error, "%s", reader->error);
+	}
+
+	if (solved) {
+		/* Move the pivots to the diagonal */
+		for (size_t i = 0; i < n_lines; i++) {
+			while (pivot_columns[i] != i) {
+				const size_t j = pivot_columns[i];
+				matrix_swap_lines(matrix, i, j);
+				STATS_ADD(row_swaps, 1);
+				pivot_columns[i] = pivot_columns[j];
+				pivot_columns[j] = j;
+			}
+		}
+	}
+	for (size_t i = 0; i < k; i++) {
+		tiered_release(&matrix->wide, &inverses[i]);
+	}
+	tiered_release(&matrix->wide, &factor);
+	arena_rewind(scratch, position);
+	return solved;
+}
+
+/**
+ * @brief Gives the room pipelined_elimination() needs in an arena.
+ *
+ * @param[in] n The number of unknowns of the system.
+ *
+ * @return The number of bytes.
+ */
+size_t
+pipelined_elimination_arena_size(const size_t n)
+{
+	return arena_size(n, sizeof(size_t)) + arena_size(n, sizeof(bool)) +
+	       arena_size(n, sizeof(fraction));
+}
+
+/**
+ * @brief Tells whether a system is sparse enough to be solved as such.
+ *
+ * @param[in] matrix The augmented matrix of the system, whose elements are
+ * not promoted.
+ *
+ * @return Whether at most @ref SPARSE_DENSITY_PERCENT percent of the
+ * coefficients of the unknowns are not zero.
+ */
+bool
+is_sparse(const matrix *const matrix)
+{
+	const size_t n = matrix->n_lines;
+	size_t n_nonzero = 0;
+	for (size_t i = 0; i < n; i++) {
+		const fraction *line = matrix_line(matrix, i);
+		for (size_t j = 0; j < n; j++) {
+			n_nonzero += !tiered_is_zero(&line[j]);
+		}
+	}
+	/* Computed in floating point, n * n * 100 may overflow */
+	return (double)n_nonzero * 100 <=
+	       (double)n * (double)n * SPARSE_DENSITY_PERCENT;
+}
+
+/**
+ * @brief Gives the memory needed to solve a system, to size its arena.
+ *
+ * It covers the matrix, the permutation of its factorisation, the solution,
+ * and the temporary memory of the engine. The promoted values are not
+ * included, their number not being known in advance.
+ *
+ * @param[in] engine The engine that solves the system.
+ * @param[in] n The number of unknowns of the system.
+ * @param[in] n_rhs The number of right-hand sides of the system.
+ * @param[in] n_threads The number of threads of the fraction engine.
+ *
+ * @return The number of bytes, or SIZE_MAX if it overflows.
+ */
+size_t
+solve_arena_size(const enum solver_engine engine, const size_t n,
+                 const size_t n_rhs, const size_t n_threads)
+{
+	if (n_rhs >= SIZE_MAX - n || n >= SIZE_MAX / (n + n_rhs)) {
+		return SIZE_MAX;
+	}
+	const size_t n_elements = n * (n + n_rhs);
+	const size_t n_values = n * n_rhs;
+	/* The lines of the matrix, and the permutation */
+	size_t size = add_sizes(arena_size(n, sizeof(size_t)),
+	                        arena_size(n, sizeof(size_t)));
+	size = add_sizes(size, arena_size(n_values, sizeof(fraction)));
+	size = add_sizes(size, arena_size(n_values, sizeof(double)));
+	switch (engine) {
+	case ENGINE_FRACTION:
+		size = add_sizes(size,
+		                 arena_size(n_elements, sizeof(fraction)));
+		size = add_sizes(size, triangularise_arena_size(n + n_rhs,
+		                                                n_threads));
+		size = add_sizes(size, pipelined_elimination_arena_size(n));
+		break;
+	case ENGINE_BAREISS:
+		/* The matrix of fractions it falls back to, and its lines */
+		size = add_sizes(size,
+		                 arena_size(n_elements, sizeof(fraction)));
+		size = add_sizes(size, arena_size(n, sizeof(size_t)));
+		size = add_sizes(size, triangularise_arena_size(n + n_rhs,
+		                                                n_threads));
+		size = add_sizes(size,
+		                 arena_size(n_elements, sizeof(int64_t)));
+		break;
+	case ENGINE_FLOAT:
+		size = add_sizes(size, float_solve_arena_size(n));
+		/* Fall through */
+	case ENGINE_MODULAR:
+		size = add_sizes(size,
+		                 arena_size(n_elements, sizeof(int64_t)));
+		break;
+	}
+	return size;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file solver.h
+ * @brief Definitions for solver.c and lineqsolve.c, private to the library
+ * and to its command-line interface.
+ * @see solver.c
+ * @see lineqsolve.c
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "arena.h"
+#include "binary.h"
+#include "fractions.h"
+#include "lineqsolve.h"
+#include "matrix.h"
+#include "pool.h"
+#include "reader.h"
+#include "report.h"
+#include "sparse.h"
+#include "stats.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief What an elimination tells of the matrix, besides its row-echelon
+ * form.
+ */
+struct echelon {
+	/** The number of pivots found, which is the rank of the matrix of the
+	 * unknowns */
+	size_t rank;
+	/** Whether the lines were swapped an odd number of times, which flips
+	 * the sign of the determinant */
+	bool odd_swaps;
+};
+
+/**
+ * @brief The rank-one updates \f$uv^T\f$ made to a factorised system since
+ * its factorisation.
+ *
+ * Their values are in the table of the factors.
+ */
+struct rank_updates {
+	/** The number of updates made */
+	size_t count;
+	/** The number of updates kept before the system is factorised again,
+	 * 0 if the system is not updated */
+	size_t limit;
+	/** \f$A^{-1}u\f$ of each update, for the system before it, \f$n\f$
+	 * values each */
+	fraction *columns;
+	/** \f$v\f$ of each update, \f$n\f$ values each */
+	fraction *rows;
+	/** \f$-1/(1 + v^TA^{-1}u)\f$ of each update */
+	fraction *pivots;
+};
+
+/**
+ * @brief A solver, with its engine and the memory of its systems.
+ *
+ * The memory of a system comes from the arena, which is reset for the next
+ * one and only grows when a bigger system is loaded.
+ */
+struct solver {
+	/** The engine that solves the systems */
+	enum solver_engine engine;
+	/** The number of threads of the fraction engine */
+	size_t n_threads;
+	/** The maximum number of refinement steps of the floating-point
+	 * engine */
+	size_t refinement_steps;
+	/** Whether the fraction engine always uses the sparse elimination */
+	bool force_sparse;
+	/** Whether the fraction engine eliminates the dense systems with the
+	 * Gauss-Jordan method, rather than with a back-substitution */
+	bool gauss_jordan;
+	/** How the fraction engine chooses the pivots of the dense systems */
+	enum solver_pivoting pivoting;
+	/** The number of pivots the fraction engine eliminates together, 0
+	 * for one at a time */
+	size_t block_size;
+	/** The number of right-hand sides of the systems loaded */
+	size_t n_rhs;
+	/** Whether the fraction engine keeps the LU factorisation of the
+	 * systems */
+	bool keep_factors;
+	/** The number of unknowns of the loaded system, 0 if none is */
+	size_t n;
+	/** Whether the loaded system was solved */
+	bool solved;
+	/** The outcome of the solve, once the system is solved */
+	enum solver_status status;
+	/** Whether the matrix holds the LU factorisation of the system */
+	bool factored;
+	/** Whether the loaded system was eliminated by the dense fraction
+	 * engine, whether it is regular or not */
+	bool eliminated;
+	/** What the elimination found, once the system is eliminated */
+	struct echelon echelon;
+	/** Whether the determinant of the system was computed */
+	bool determinant_known;
+	/** The determinant of the matrix of the unknowns, once computed. Its
+	 * promoted value is in the table of the matrix */
+	fraction determinant;
+	/** The coefficients of the system as it was last changed, line after
+	 * line, or NULL if it is not updated */
+	int64_t *system;
+	/** The updates of the system since it was factorised */
+	struct rank_updates updates;
+	/** The inverse of the matrix of the unknowns, line after line,
+	 * once solver_invert() computed it, or NULL. Its promoted values are
+	 * in the table of the matrix */
+	fraction *inverse;
+	/** The memory of the loaded system */
+	arena arena;
+	/** The system, for the fraction engine */
+	matrix matrix;
+	/** The system, for the other engines */
+	integer_matrix integer_matrix;
+	/** The system, when the fraction engine solves it as a sparse one */
+	sparse_matrix sparse;
+	/** The storage of the promoted values of the modular engine */
+	wide_table table;
+	/** The line of the system at each line of the factorisation */
+	size_t *permutation;
+	/** The exact solution of each right-hand side, one after the other,
+	 * for the exact engines */
+	fraction *solution;
+	/** The storage of the promoted values of the solution, or NULL */
+	const wide_table *solution_table;
+	/** The approximate solution, in the same order */
+	double *approximations;
+	/** The number of primes the modular engine solved the system modulo,
+	 * 0 until it does */
+	size_t n_primes;
+	/** The largest residual of the solution of the floating-point engine,
+	 * once it is solved */
+	double residual;
+	/** Why the system could not be loaded, solved or saved, given by
+	 * solver_last_error() */
+	char error[ERROR_SIZE];
+};
+
+enum solver_status solver_prepare(solver *const, const size_t);
+void solver_store_line(solver *const, const size_t, const int64_t *const);
+enum solver_status solver_read_diagonal(solver *const);
+enum solver_status solver_eliminate(solver *const);
+enum solver_status solver_substitute(solver *const);
+enum solver_status solver_compute_determinant(solver *const);
+bool solver_uses_sparse(const solver *const);
+
+bool check_system_line(line_reader *const, const size_t);
+bool read_system_line(line_reader *const, const size_t);
+bool read_triplets(line_reader *const, const size_t, sparse_matrix *const,
+                   integer_matrix *const);
+void store_line(matrix *const, const size_t, const int64_t *const);
+void store_integer_line(integer_matrix *const, const size_t,
+                        const int64_t *const);
+bool load_binary_system(matrix *const, const binary_matrix *const,
+                        char *const);
+bool load_binary_integer_system(integer_matrix *const,
+                                const binary_matrix *const, char *const);
+size_t find_pivot_in_lines(const matrix *const, const enum solver_pivoting,
+                           const size_t, const size_t, const size_t);
+void eliminate_line(wide_table *const, fraction *const, const fraction *const,
+                    const fraction *const, const size_t, const size_t);
+bool triangularise(matrix *const, const enum solver_pivoting, const size_t,
+                   const size_t, arena *const, struct echelon *const);
+bool gauss_jordan(matrix *const, const enum solver_pivoting, const size_t,
+                  arena *const, struct echelon *const);
+size_t triangularise_arena_size(const size_t, const size_t);
+void diagonalise(matrix *const);
+bool gaussian_elimination(matrix *const, const enum solver_pivoting,
+                          const size_t, const size_t, arena *const,
+                          struct echelon *const);
+bool pipelined_elimination(matrix *const, line_reader *const, arena *const,
+                           char *const);
+size_t pipelined_elimination_arena_size(const size_t);
+bool factorise(matrix *const, const enum solver_pivoting, size_t *const,
+               struct echelon *const);
+void forward_substitute(matrix *const);
+void back_substitute(matrix *const, fraction *const);
+void solve_factored(matrix *const, const size_t *const,
+                    const fraction *const, fraction *const);
+void apply_rank_updates(wide_table *const, const struct rank_updates *const,
+                        const size_t, const size_t, fraction *const);
+bool add_rank_update(matrix *const, const size_t *const,
+                     struct rank_updates *const, const fraction *const,
+                     const fraction *const, fraction *const);
+bool write_factors(FILE *const, const matrix *const, const size_t *const);
+bool read_factors_header(FILE *const, size_t *const, char *const);
+bool read_factors(FILE *const, matrix *const, size_t *const, char *const);
+bool is_sparse(const matrix *const);
+size_t solve_arena_size(const enum solver_engine, const size_t,
+                        const size_t, const size_t);
+
+#endif /* SOLVER_H */
@@ -0,0 +1,542 @@
+/**
+ * @file sparse.c
+ * @brief Storage and elimination of sparse matrices.
+ *
+ * The systems built from networks have a handful of non-zero coefficients
+ * per line. Storing only those, each line as a list sorted by column, makes
+ * a line operation cost the number of non-zero elements of the two lines
+ * instead of the number of columns, and the lines without an element in the
+ * pivot's column are not touched at all.
+ *
+ * Eliminating a column can turn zeros into non-zero elements: this is the
+ * fill-in, which makes the lines grow. The pivots are chosen to limit it with
+ * Markowitz' criterion: among the remaining elements, the one minimising
+ * \f$(r - 1)(c - 1)\f$, where \f$r\f$ and \f$c\f$ are the numbers of non-zero
+ * elements of its line and its column. The arithmetic being exact, any
+ * non-zero element is a stable pivot, so no threshold on the values is
+ * needed.
+ *
+ * The matrix is reduced to a triangular form, in the order of the pivots,
+ * and the solution is then found by back-substitution.
+ *
+ * @see https://en.wikipedia.org/wiki/Sparse_matrix
+ * @see https://doi.org/10.1287/mnsc.3.3.255
+ */
+
+#include "sparse.h"
+
+#include "report.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/** @brief The number of elements a line can hold before growing it. */
+#define INITIAL_LINE_CAPACITY 4
+
+/**
+ * @brief Makes sure a line can hold a number of elements.
+ *
+ * @param[in, out] line The line, reallocated if it is too small.
+ * @param[in] count The number of elements needed.
+ *
+ * @return Whether the memory could be allocated. If not, the line is left
+ * unchanged.
+ */
+static bool
+reserve_entries(sparse_line *const line, const size_t count)
+{
+	if (count <= line->capacity) {
+		return true;
+	}
+	size_t capacity = line->capacity < INITIAL_LINE_CAPACITY
+	                      ? INITIAL_LINE_CAPACITY
+	                      : line->capacity;
+	while (capacity < count) {
+		if (capacity > SIZE_MAX / 2 / sizeof(sparse_entry)) {
+			return false;
+		}
+		capacity *= 2;
+	}
+	sparse_entry *entries =
+	    realloc(line->entries, capacity * sizeof(sparse_entry));
+	if (entries == NULL) {
+		return false;
+	}
+	line->entries = entries;
+	line->capacity = capacity;
+	return true;
+}
+
+/**
+ * @brief Appends an element to a line, whatever its column.
+ *
+ * @param[in, out] line The line to extend.
+ * @param[in] column The column of the element.
+ * @param[in] value The value of the element.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+append_entry(sparse_line *const line, const size_t column,
+             const fraction *const value)
+{
+	if (!reserve_entries(line, line->length + 1)) {
+		return false;
+	}
+	line->entries[line->length].column = column;
+	line->entries[line->length].value = *value;
+	line->length++;
+	return true;
+}
+
+/**
+ * @brief Allocates a sparse matrix, with all its elements set to zero.
+ *
+ * @param[out] m The matrix to initialise.
+ * @param[in] n_lines The number of lines of the matrix.
+ * @param[in] n_col The number of columns of the matrix.
+ *
+ * @return Whether the memory could be allocated. If not, the matrix is left
+ * empty.
+ */
+bool
+sparse_init(sparse_matrix *const m, const size_t n_lines, const size_t n_col)
+{
+	m->n_lines = n_lines;
+	m->n_col = n_col;
+	m->fill_in = 0;
+	wide_table_init(&m->wide);
+	m->lines = calloc(n_lines, sizeof(sparse_line));
+	if (m->lines == NULL) {
+		m->n_lines = 0;
+		return n_lines == 0;
+	}
+	return true;
+}
+
+/**
+ * @brief Releases the memory held by a sparse matrix.
+ *
+ * @param[in, out] m The matrix to free.
+ */
+void
+sparse_free(sparse_matrix *const m)
+{
+	for (size_t i = 0; i < m->n_lines; i++) {
+		free(m->lines[i].entries);
+	}
+	free(m->lines);
+	wide_table_free(&m->wide);
+	m->lines = NULL;
+	m->n_lines = 0;
+	m->n_col = 0;
+}
+
+/**
+ * @brief Adds a coefficient to a sparse matrix being built.
+ *
+ * The coefficients can be added in any order, and several of them can be
+ * added to the same element: sparse_finish() must then be called before the
+ * matrix is used.
+ *
+ * @param[in, out] m The matrix to fill.
+ * @param[in] line The line of the coefficient.
+ * @param[in] column The column of the coefficient.
+ * @param[in] value The coefficient. Zeros are ignored.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+sparse_append(sparse_matrix *const m, const size_t line, const size_t column,
+              const int32_t value)
+{
+	if (value == 0) {
+		return true;
+	}
+	fraction coefficient;
+	fraction_from_int(value, &coefficient);
+	return append_entry(&m->lines[line], column, &coefficient);
+}
+
+/**
+ * @brief Orders two elements by column, for `qsort()`.
+ *
+ * @param[in] a The first @ref sparse_entry.
+ * @param[in] b The second @ref sparse_entry.
+ *
+ * @return A negative, zero or positive number if the first element comes
+ * before, with or after the second one.
+ */
+static int
+compare_entries(const void *const a, const void *const b)
+{
+	const size_t column_a = ((const sparse_entry *)a)->column;
+	const size_t column_b = ((const sparse_entry *)b)->column;
+	return (column_a > column_b) - (column_a < column_b);
+}
+
+/**
+ * @brief Sorts the elements added with sparse_append().
+ *
+ * The coefficients added to the same element are summed, and the elements
+ * that end up zero are dropped.
+ *
+ * @param[in, out] m The matrix to finish.
+ */
+void
+sparse_finish(sparse_matrix *const m)
+{
+	fraction minus_one;
+	fraction_from_int(-1, &minus_one);
+	for (size_t i = 0; i < m->n_lines; i++) {
+		sparse_line *line = &m->lines[i];
+		qsort(line->entries, line->length, sizeof(sparse_entry),
+		      compare_entries);
+		size_t kept = 0;
+		for (size_t k = 0; k < line->length; k++) {
+			sparse_entry *entry = &line->entries[k];
+			if (kept > 0 &&
+			    line->entries[kept - 1].column == entry->column) {
+				tiered_submul(&m->wide,
+				              &line->entries[kept - 1].value,
+				              &minus_one, &entry->value);
+				continue;
+			}
+			if (kept > 0 &&
+			    tiered_is_zero(&line->entries[kept - 1].value)) {
+				/* The previous element summed to zero */
+				kept--;
+			}
+			line->entries[kept++] = *entry;
+		}
+		if (kept > 0 &&
+		    tiered_is_zero(&line->entries[kept - 1].value)) {
+			kept--;
+		}
+		line->length = kept;
+	}
+}
+
+/**
+ * @brief Converts a matrix to a sparse matrix.
+ *
+ * @param[out] sparse The sparse matrix to initialise.
+ * @param[in] m The matrix to convert, whose elements are not promoted.
+ *
+ * @return Whether the memory could be allocated. If not, the sparse matrix
+ * is left empty.
+ */
+bool
+sparse_from_matrix(sparse_matrix *const sparse, const matrix *const m)
+{
+	if (!sparse_init(sparse, m->n_lines, m->n_col)) {
+		return false;
+	}
+	for (size_t i = 0; i < m->n_lines; i++) {
+		const fraction *line = matrix_line(m, i);
+		for (size_t j = 0; j < m->n_col; j++) {
+			if (tiered_is_zero(&line[j])) {
+				continue;
+			}
+			if (!append_entry(&sparse->lines[i], j, &line[j])) {
+				sparse_free(sparse);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Counts the non-zero elements of a sparse matrix.
+ *
+ * @param[in] m The matrix.
+ *
+ * @return The number of elements stored.
+ */
+size_t
+sparse_count(const sparse_matrix *const m)
+{
+	size_t count = 0;
+	for (size_t i = 0; i < m->n_lines; i++) {
+		count += m->lines[i].length;
+	}
+	return count;
+}
+
+/**
+ * @brief Finds the element of a line in a column.
+ *
+ * @param[in] line The line to search.
+ * @param[in] column The column of the element.
+ *
+ * @return The element, or NULL if it is zero.
+ */
+static sparse_entry *
+find_entry(const sparse_line *const line, const size_t column)
+{
+	size_t low = 0;
+	size_t high = line->length;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (line->entries[middle].column < column) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (low < line->length && line->entries[low].column == column) {
+		return &line->entries[low];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Chooses the next pivot with Markowitz' criterion.
+ *
+ * @param[in] m The matrix being eliminated, whose last column holds the
+ * constants.
+ * @param[in] active Whether each line is still to be used as a pivot.
+ * @param[in] column_counts The number of elements of each column in the
+ * active lines.
+ * @param[out] pivot_line Where to store the line of the pivot.
+ * @param[out] pivot_column Where to store the column of the pivot.
+ *
+ * @return Whether a pivot was found. If not, the system is singular.
+ */
+static bool
+find_markowitz_pivot(const sparse_matrix *const m, const bool *const active,
+                     const size_t *const column_counts,
+                     size_t *const pivot_line, size_t *const pivot_column)
+{
+	const size_t constants = m->n_col - 1;
+	size_t best_cost = SIZE_MAX;
+	for (size_t i = 0; i < m->n_lines; i++) {
+		if (!active[i]) {
+			continue;
+		}
+		const sparse_line *line = &m->lines[i];
+		size_t n_coefficients = line->length;
+		if (n_coefficients > 0 &&
+		    line->entries[n_coefficients - 1].column == constants) {
+			n_coefficients--;
+		}
+		if (n_coefficients == 0) {
+			/* This equation has no unknown left */
+			return false;
+		}
+		for (size_t k = 0; k < n_coefficients; k++) {
+			const size_t column = line->entries[k].column;
+			const size_t cost =
+			    (n_coefficients - 1) * (column_counts[column] - 1);
+			if (cost < best_cost) {
+				best_cost = cost;
+				*pivot_line = i;
+				*pivot_column = column;
+				if (cost == 0) {
+					/* No fill-in at all */
+					return true;
+				}
+			}
+		}
+	}
+	return best_cost != SIZE_MAX;
+}
+
+/**
+ * @brief Subtracts a multiple of the pivot's line from a line.
+ *
+ * Performs `line` -= `factor` \f$\times\f$ `pivot`, by merging the two
+ * sorted lines into the scratch line, which is then swapped with `line`. The
+ * element in the pivot's column becomes zero and is dropped.
+ *
+ * @param[in, out] m The matrix being eliminated.
+ * @param[in, out] line The line to update.
+ * @param[in] pivot The line of the pivot.
+ * @param[in] pivot_column The column of the pivot.
+ * @param[in] factor The multiple of the pivot's line to subtract.
+ * @param[in, out] scratch A line to merge into, whose memory is reused.
+ * @param[in, out] column_counts The number of elements of each column in the
+ * active lines, updated.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+eliminate_sparse_line(sparse_matrix *const m, sparse_line *const line,
+                      const sparse_line *const pivot,
+                      const size_t pivot_column, const fraction *const factor,
+                      sparse_line *const scratch, size_t *const column_counts)
+{
+	if (line->length > SIZE_MAX - pivot->length ||
+	    !reserve_entries(scratch, line->length + pivot->length)) {
+		return false;
+	}
+	size_t a = 0;
+	size_t b = 0;
+	size_t length = 0;
+	while (a < line->length || b < pivot->length) {
+		const size_t column_a =
+		    a < line->length ? line->entries[a].column : SIZE_MAX;
+		const size_t column_b =
+		    b < pivot->length ? pivot->entries[b].column : SIZE_MAX;
+		sparse_entry *result = &scratch->entries[length];
+		if (column_a < column_b) {
+			*result = line->entries[a++];
+			length++;
+			continue;
+		}
+		if (column_a == column_b && column_a == pivot_column) {
+			/* Eliminated exactly, whatever the arithmetic says */
+			tiered_release(&m->wide, &line->entries[a].value);
+			column_counts[pivot_column]--;
+			a++;
+			b++;
+			continue;
+		}
+		result->column = column_b;
+		if (column_a == column_b) {
+			result->value = line->entries[a++].value;
+		} else {
+			result->value = (fraction){0, 0, 1};
+		}
+		tiered_submul(&m->wide, &result->value, factor,
+		              &pivot->entries[b++].value);
+		const bool existed = column_a == column_b;
+		if (tiered_is_zero(&result->value)) {
+			if (existed) {
+				column_counts[result->column]--;
+			}
+			continue;
+		}
+		if (!existed) {
+			column_counts[result->column]++;
+			m->fill_in++;
+		}
+		length++;
+	}
+
+	sparse_line merged = *scratch;
+	merged.length = length;
+	*scratch = *line;
+	scratch->length = 0;
+	*line = merged;
+	return true;
+}
+
+/**
+ * @brief Solves a sparse system.
+ *
+ * The matrix is reduced in place, choosing the pivots with Markowitz'
+ * criterion, and the solution is found by back-substitution.
+ *
+ * @param[in, out] m The augmented matrix of the system, with one more column
+ * than lines.
+ * @param[out] solution Where to store the value of each unknown. The values
+ * are in the table of the matrix, and must be released with it.
+ * @param[out] error Where to describe why the system could not be solved,
+ * or NULL.
+ *
+ * @return Whether the system could be solved. If the memory could not be
+ * allocated, the table of the matrix is marked as failed and the error is
+ * left as it is.
+ */
+bool
+sparse_solve(sparse_matrix *const m, fraction *const solution,
+             char *const error)
+{
+	const size_t n = m->n_lines;
+	size_t *column_counts = calloc(n + 1, sizeof(size_t));
+	size_t *pivot_lines = malloc(n * sizeof(size_t));
+	size_t *pivot_columns = malloc(n * sizeof(size_t));
+	bool *active = malloc(n * sizeof(bool));
+	sparse_line scratch = {0};
+	bool solved = column_counts != NULL && pivot_lines != NULL &&
+	              pivot_columns != NULL && active != NULL;
+	if (!solved) {
+		m->wide.failed = true;
+	}
+	for (size_t i = 0; solved && i < n; i++) {
+		active[i] = true;
+		for (size_t k = 0; k < m->lines[i].length; k++) {
+			column_counts[m->lines[i].entries[k].column]++;
+		}
+	}
+
+	fraction inverse = {0, 0, 1};
+	fraction factor = {0, 0, 1};
+	for (size_t step = 0; solved && step < n; step++) {
+		size_t line = n;
+		size_t column = n;
+		if (!find_markowitz_pivot(m, active, column_counts, &line,
+		                          &column)) {
+			report_error(error, "the system is singular");
+			solved = false;
+			break;
+		}
+		active[line] = false;
+		pivot_lines[step] = line;
+		pivot_columns[step] = column;
+		const sparse_line *pivot = &m->lines[line];
+		for (size_t k = 0; k < pivot->length; k++) {
+			column_counts[pivot->entries[k].column]--;
+		}
+		tiered_invert(&m->wide, &find_entry(pivot, column)->value,
+		              &inverse);
+
+		for (size_t i = 0; i < n; i++) {
+			if (!active[i]) {
+				continue;
+			}
+			const sparse_entry *entry =
+			    find_entry(&m->lines[i], column);
+			if (entry == NULL) {
+				/* Nothing to eliminate */
+				continue;
+			}
+			tiered_multiply(&m->wide, &entry->value, &inverse,
+			                &factor);
+			if (!eliminate_sparse_line(m, &m->lines[i], pivot,
+			                           column, &factor, &scratch,
+			                           column_counts)) {
+				m->wide.failed = true;
+				solved = false;
+				break;
+			}
+		}
+	}
+
+	/* Each pivot's line only holds unknowns eliminated after it */
+	fraction minus_one;
+	fraction_from_int(-1, &minus_one);
+	for (size_t step = n; solved && step-- > 0;) {
+		const sparse_line *line = &m->lines[pivot_lines[step]];
+		const size_t column = pivot_columns[step];
+		fraction value = {0, 0, 1};
+		const fraction *pivot = NULL;
+		for (size_t k = 0; k < line->length; k++) {
+			const sparse_entry *entry = &line->entries[k];
+			if (entry->column == n) {
+				tiered_submul(&m->wide, &value, &minus_one,
+				              &entry->value);
+			} else if (entry->column == column) {
+				pivot = &entry->value;
+			} else {
+				tiered_submul(&m->wide, &value, &entry->value,
+				              &solution[entry->column]);
+			}
+		}
+		tiered_invert(&m->wide, pivot, &inverse);
+		solution[column] = (fraction){0, 0, 1};
+		tiered_multiply(&m->wide, &value, &inverse, &solution[column]);
+		tiered_release(&m->wide, &value);
+	}
+
+	tiered_release(&m->wide, &inverse);
+	tiered_release(&m->wide, &factor);
+	free(scratch.entries);
+	free(column_counts);
+	free(pivot_lines);
+	free(pivot_columns);
+	free(active);
+	return solved && !m->wide.failed;
+}
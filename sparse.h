@@ -0,0 +1,86 @@
+/**
+ * @file sparse.h
+ * @brief Definitions for sparse.c
+ * @see sparse.c
+ */
+
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "fractions.h"
+#include "matrix.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief A non-zero element of a sparse matrix.
+ */
+struct sparse_entry {
+	/** The column of the element */
+	size_t column;
+	/** The value of the element, possibly promoted */
+	fraction value;
+};
+
+/**
+ * @brief Definition of a type from the sparse_entry structure.
+ * @see struct sparse_entry
+ */
+typedef struct sparse_entry sparse_entry;
+
+/**
+ * @brief A line of a sparse matrix: its non-zero elements, by column.
+ */
+struct sparse_line {
+	/** The elements, sorted by column */
+	sparse_entry *entries;
+	/** The number of elements */
+	size_t length;
+	/** The number of elements the line can hold */
+	size_t capacity;
+};
+
+/**
+ * @brief Definition of a type from the sparse_line structure.
+ * @see struct sparse_line
+ */
+typedef struct sparse_line sparse_line;
+
+/**
+ * @brief A matrix of fractions storing only its non-zero elements.
+ *
+ * Each line holds its own elements, so that the lines can grow with the
+ * fill-in of the elimination. As in a @ref matrix, the values that do not
+ * fit in a fraction are in the matrix's @ref wide_table.
+ */
+struct sparse_matrix {
+	/** The lines of the matrix */
+	sparse_line *lines;
+	/** The number of lines of the matrix */
+	size_t n_lines;
+	/** The number of columns of the matrix */
+	size_t n_col;
+	/** The number of elements created by the elimination */
+	size_t fill_in;
+	/** The values of the elements that do not fit in a fraction */
+	wide_table wide;
+};
+
+/**
+ * @brief Definition of a type from the sparse_matrix structure.
+ * @see struct sparse_matrix
+ */
+typedef struct sparse_matrix sparse_matrix;
+
+bool sparse_init(sparse_matrix *const, const size_t, const size_t);
+void sparse_free(sparse_matrix *const);
+bool sparse_append(sparse_matrix *const, const size_t, const size_t,
+                   const int32_t);
+void sparse_finish(sparse_matrix *const);
+bool sparse_from_matrix(sparse_matrix *const, const matrix *const);
+size_t sparse_count(const sparse_matrix *const);
+bool sparse_solve(sparse_matrix *const, fraction *const, char *const);
+
+#endif /* SPARSE_H */
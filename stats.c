@@ -0,0 +1,150 @@
+/**
+ * @file stats.c
+ * @brief Counters and timers of the solves, reported with `--stats`.
+ *
+ * The counters are updated in the hot paths of the fractions and of the
+ * elimination, by several threads at once: they are atomic, and only
+ * compiled in when `LINEQSOLVE_STATS` is defined. The growth of the
+ * coefficients takes a pass over the matrix at each step, so it is only
+ * recorded once stats_start() is called. Its steps are recorded under a
+ * lock, as the solves of a server may run at once.
+ *
+ * @see stats.h
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct solve_stats solve_stats = {0};
+
+/** @brief The lock of the steps of the statistics. */
+static pthread_mutex_t steps_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Starts recording the growth of the coefficients, and resets the
+ * statistics.
+ *
+ * @return Whether the statistics are compiled in.
+ */
+bool
+stats_start(void)
+{
+	stats_stop();
+	solve_stats.enabled = STATS_COMPILED;
+	return STATS_COMPILED;
+}
+
+/**
+ * @brief Stops recording, resets the statistics and releases their memory.
+ */
+void
+stats_stop(void)
+{
+	pthread_mutex_lock(&steps_lock);
+	free(solve_stats.steps);
+	solve_stats = (struct solve_stats){0};
+	pthread_mutex_unlock(&steps_lock);
+}
+
+/**
+ * @brief Prepares the recording of the steps of an elimination, dropping
+ * the steps of the previous one.
+ *
+ * @param[in] n_steps The number of steps of the elimination.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+stats_begin_steps(const size_t n_steps)
+{
+	bool allocated = true;
+	pthread_mutex_lock(&steps_lock);
+	solve_stats.n_steps = 0;
+	if (n_steps > solve_stats.capacity) {
+		struct stats_step *steps = realloc(
+		    solve_stats.steps, n_steps * sizeof(struct stats_step));
+		if (steps != NULL) {
+			solve_stats.steps = steps;
+			solve_stats.capacity = n_steps;
+		}
+		allocated = steps != NULL;
+	}
+	pthread_mutex_unlock(&steps_lock);
+	return allocated;
+}
+
+/**
+ * @brief Records the growth of the coefficients at a step of an
+ * elimination.
+ *
+ * @param[in] step The index of the step.
+ * @param[in] numerator_bits The greatest number of bits of a numerator.
+ * @param[in] denominator_bits The greatest number of bits of a denominator.
+ */
+void
+stats_record_step(const size_t step, const uint32_t numerator_bits,
+                  const uint32_t denominator_bits)
+{
+	pthread_mutex_lock(&steps_lock);
+	if (step < solve_stats.capacity) {
+		solve_stats.steps[step].numerator_bits = numerator_bits;
+		solve_stats.steps[step].denominator_bits = denominator_bits;
+		if (step >= solve_stats.n_steps) {
+			solve_stats.n_steps = step + 1;
+		}
+	}
+	pthread_mutex_unlock(&steps_lock);
+}
+
+/**
+ * @brief Gives the current instant, to time the phases.
+ *
+ * @return The number of seconds since an arbitrary instant.
+ */
+double
+stats_clock(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Prints the statistics as a JSON object, on a single line.
+ *
+ * @param[in] stream The stream to print to.
+ */
+void
+stats_fprint_json(FILE *const stream)
+{
+	static const char *const phase_names[N_PHASES] = {
+	    "read", "eliminate", "substitute", "print"};
+	const struct solve_stats *s = &solve_stats;
+	fprintf(stream,
+	        "{\"gcd_calls\": %" PRIu64 ", \"gcd_iterations\": %" PRIu64
+	        ", \"simplify_calls\": %" PRIu64 ", \"simplify_hits\": %" PRIu64
+	        ", \"subtract_near_overflows\": %" PRIu64
+	        ", \"subtract_overflows\": %" PRIu64
+	        ", \"row_swaps\": %" PRIu64 ", \"phases_s\": {",
+	        s->gcd_calls, s->gcd_iterations, s->simplify_calls,
+	        s->simplify_hits, s->subtract_near_overflows,
+	        s->subtract_overflows, s->row_swaps);
+	for (size_t p = 0; p < N_PHASES; p++) {
+		fprintf(stream, p == 0 ? "\"%s\": %.6f" : ", \"%s\": %.6f",
+		        phase_names[p], (double)s->phase_ns[p] / 1e9);
+	}
+	fprintf(stream, "}, \"steps\": [");
+	for (size_t i = 0; i < s->n_steps; i++) {
+		fprintf(stream, i == 0 ? "[%" PRIu32 ", %" PRIu32 "]"
+		                       : ", [%" PRIu32 ", %" PRIu32 "]",
+		        s->steps[i].numerator_bits,
+		        s->steps[i].denominator_bits);
+	}
+	fprintf(stream, "]}\n");
+}
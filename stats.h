@@ -0,0 +1,117 @@
+/**
+ * @file stats.h
+ * @brief Definitions for stats.c
+ *
+ * The counters are only compiled in when `LINEQSOLVE_STATS` is defined:
+ * otherwise, the macros below expand to nothing and the hot paths are left
+ * untouched.
+ *
+ * @see stats.c
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The phases of a solve that are timed.
+ */
+enum stats_phase {
+	/** Reading and storing the system */
+	PHASE_READ,
+	/** Eliminating the system */
+	PHASE_ELIMINATE,
+	/** Reading the solution off the eliminated system */
+	PHASE_SUBSTITUTE,
+	/** Printing the solution */
+	PHASE_PRINT,
+	/** The number of phases */
+	N_PHASES,
+};
+
+/**
+ * @brief The growth of the coefficients at a step of an elimination.
+ */
+struct stats_step {
+	/** The greatest number of bits of a numerator of the matrix */
+	uint32_t numerator_bits;
+	/** The greatest number of bits of a denominator of the matrix */
+	uint32_t denominator_bits;
+};
+
+/**
+ * @brief What was counted and timed during the solves.
+ *
+ * The statistics are those of the whole process. The counters and the
+ * timers are updated atomically, by the threads of a solve and by the solves
+ * run at once, as those of the workers of a server: they add up. The steps
+ * of eliminations run at once are mixed.
+ */
+struct solve_stats {
+	/** Whether the growth of the coefficients is recorded */
+	bool enabled;
+	/** The number of GCDs computed */
+	uint64_t gcd_calls;
+	/** The number of iterations of their loops */
+	uint64_t gcd_iterations;
+	/** The number of calls to simplify_fraction() */
+	uint64_t simplify_calls;
+	/** The number of them that actually reduced the fraction */
+	uint64_t simplify_hits;
+	/** The number of differences whose terms exceeded 32 bits before
+	 * being reduced */
+	uint64_t subtract_near_overflows;
+	/** The number of differences that did not fit in a fraction */
+	uint64_t subtract_overflows;
+	/** The number of lines swapped to bring a pivot in place */
+	uint64_t row_swaps;
+	/** The nanoseconds spent in each phase */
+	uint64_t phase_ns[N_PHASES];
+	/** The growth of the coefficients, at each step of the last
+	 * elimination */
+	struct stats_step *steps;
+	/** The number of steps recorded */
+	size_t n_steps;
+	/** The number of steps that can be recorded */
+	size_t capacity;
+};
+
+/** @brief The statistics of the program. */
+extern struct solve_stats solve_stats;
+
+bool stats_start(void);
+void stats_stop(void);
+bool stats_begin_steps(const size_t);
+void stats_record_step(const size_t, const uint32_t, const uint32_t);
+double stats_clock(void);
+void stats_fprint_json(FILE *const);
+
+#ifdef LINEQSOLVE_STATS
+/** @brief Whether the counters are compiled in. */
+#define STATS_COMPILED true
+/** @brief Whether the growth of the coefficients is recorded. */
+#define STATS_ENABLED (solve_stats.enabled)
+/** @brief Adds an amount to a counter. */
+#define STATS_ADD(counter, amount)                                          \
+	__atomic_fetch_add(&solve_stats.counter, (amount), __ATOMIC_RELAXED)
+/** @brief Adds the time since an instant given by stats_clock() to a
+ * phase, atomically. */
+#define STATS_TIME(phase, start)                                            \
+	__atomic_fetch_add(&solve_stats.phase_ns[(phase)],                  \
+	                   (uint64_t)((stats_clock() - (start)) * 1e9),      \
+	                   __ATOMIC_RELAXED)
+/** @brief Gives the current instant, for STATS_TIME(). */
+#define STATS_NOW() stats_clock()
+#else
+#define STATS_COMPILED false
+#define STATS_ENABLED false
+#define STATS_ADD(counter, amount) ((void)(amount))
+#define STATS_TIME(phase, start) ((void)(start))
+#define STATS_NOW() 0.0
+#endif
+
+#endif /* STATS_H */
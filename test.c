@@ -1,23 +1,78 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "binary.h"
+#include "floating.h"
 #include "fractions.h"
+#include "kernels.h"
+#include "lineqsolve.h"
+#include "matrix.h"
+#include "modular.h"
+#include "pool.h"
+#include "reader.h"
+#include "server.h"
+#include "sparse.h"
+#include "stats.h"
+#include "tiered.h"
+#include "writer.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
 
 void test_subtraction(void);
+void test_submul(void);
 void test_simplification(void);
 void test_multiplication(void);
 void test_comparison(void);
 void test_conversion(void);
+void test_quotient(void);
+void test_matrix(void);
+void test_big_integers(void);
+void test_promotion(void);
+void test_modular(void);
+void test_floating(void);
+void test_pool(void);
+void test_kernels(void);
+void test_reader(void);
+void test_binary(void);
+void test_arena(void);
+void test_sparse(void);
+void test_library(void);
+void test_server(void);
+void test_stats(void);
+void test_writer(void);
 
 int
 main(void)
 {
 	test_comparison();
 	test_subtraction();
+	test_submul();
 	test_simplification();
 	test_multiplication();
 	test_conversion();
+	test_quotient();
+	test_matrix();
+	test_big_integers();
+	test_promotion();
+	test_modular();
+	test_floating();
+	test_pool();
+	test_kernels();
+	test_reader();
+	test_binary();
+	test_arena();
+	test_sparse();
+	test_library();
+	test_server();
+	test_stats();
+	test_writer();
 	printf("All good.\n");
 	return EXIT_SUCCESS;
 }
@@ -81,6 +136,55 @@ test_subtraction(void)
 	}
 }
 
+void
+test_submul(void)
+{
+	{
+		/* Standard case */
+		fraction minuend = {0, 1, 2};
+		fraction factor = {0, 2, 3};
+		fraction term = {1, 3, 4};
+		fraction result = {0};
+		submul_fractions(&minuend, &factor, &term, &result);
+		fraction theorical = {0, 1, 1};
+		assert(compare_fractions(&result, &theorical) == 0);
+		assert(result.denominator == 1);
+	}
+	{
+		/* Elimination of the value */
+		fraction minuend = {1, 7, 9};
+		fraction factor = {1, 7, 3};
+		fraction term = {0, 1, 3};
+		fraction result = {0};
+		submul_fractions(&minuend, &factor, &term, &result);
+		fraction theorical = {0, 0, 1};
+		assert(compare_fractions(&result, &theorical) == 0);
+		assert(!result.negative && result.denominator == 1);
+	}
+	{
+		/* In place, with a null factor */
+		fraction minuend = {1, 5, 8};
+		fraction factor = {0, 0, 1};
+		fraction term = {0, 3, 4};
+		submul_fractions(&minuend, &factor, &term, &minuend);
+		fraction theorical = {1, 5, 8};
+		assert(compare_fractions(&minuend, &theorical) == 0);
+	}
+	{
+		/* Same result as the separate operations */
+		fraction minuend = {0, 65521, 65519};
+		fraction factor = {1, 4093, 65537};
+		fraction term = {0, 2, 4093};
+		fraction result = {0};
+		submul_fractions(&minuend, &factor, &term, &result);
+		fraction product = {0};
+		fraction theorical = {0};
+		multiply_fractions(&factor, &term, &product);
+		subtract_fractions(&minuend, &product, &theorical);
+		assert(compare_fractions(&result, &theorical) == 0);
+	}
+}
+
 void
 test_simplification(void)
 {
@@ -105,6 +209,25 @@ test_simplification(void)
 		fraction theorical = {0, 0, 1};
 		assert(compare_fractions(&frac1, &theorical) == 0);
 	}
+	{
+		/* Common factors of two */
+		fraction frac1 = {0, 3145728, 2359296};
+		assert(simplify_fraction(&frac1));
+		assert(frac1.numerator == 4 && frac1.denominator == 3);
+	}
+	{
+		/* Very different magnitudes */
+		fraction frac1 = {0, 600000, 6};
+		assert(simplify_fraction(&frac1));
+		assert(frac1.numerator == 100000 && frac1.denominator == 1);
+	}
+	{
+		/* Already reduced */
+		fraction frac1 = {1, 4294967291, 65536};
+		assert(!simplify_fraction(&frac1));
+		assert(frac1.numerator == 4294967291 &&
+		       frac1.denominator == 65536);
+	}
 }
 
 void
@@ -264,3 +387,1272 @@ test_conversion(void)
 		assert(compare_fractions(&result, &theorical) == 0);
 	}
 }
+
+void
+test_quotient(void)
+{
+	{
+		/* Already reduced */
+		fraction result = {0};
+		assert(fraction_from_quotient(3, 7, &result));
+		fraction theorical = {0, 3, 7};
+		assert(compare_fractions(&result, &theorical) == 0);
+	}
+	{
+		/* Negative denominator */
+		fraction result = {0};
+		assert(fraction_from_quotient(12, -8, &result));
+		fraction theorical = {1, 3, 2};
+		assert(compare_fractions(&result, &theorical) == 0);
+	}
+	{
+		/* Zero */
+		fraction result = {0};
+		assert(fraction_from_quotient(0, -5, &result));
+		fraction theorical = {0, 0, 1};
+		assert(compare_fractions(&result, &theorical) == 0);
+		assert(result.denominator == 1);
+	}
+	{
+		/* Terms too big for 32 bits, but not once reduced */
+		fraction result = {0};
+		assert(fraction_from_quotient(-6000000000, -4000000000,
+		                              &result));
+		fraction theorical = {0, 3, 2};
+		assert(compare_fractions(&result, &theorical) == 0);
+	}
+	{
+		/* Too big even when reduced */
+		fraction result = {0};
+		assert(!fraction_from_quotient(INT64_MIN, 3, &result));
+	}
+	{
+		/* Division by zero */
+		fraction result = {0};
+		assert(!fraction_from_quotient(1, 0, &result));
+	}
+}
+
+void
+test_matrix(void)
+{
+	{
+		/* Elements are initialised to zero */
+		matrix m = {0};
+		assert(matrix_init(&m, 3, 4));
+		fraction zero = {0, 0, 1};
+		for (size_t i = 0; i < m.n_lines; i++) {
+			for (size_t j = 0; j < m.n_col; j++) {
+				assert(compare_fractions(&matrix_line(&m, i)[j],
+				                         &zero) == 0);
+			}
+		}
+		matrix_free(&m);
+	}
+	{
+		/* Swapping lines does not move the elements */
+		matrix m = {0};
+		assert(matrix_init(&m, 2, 2));
+		fraction *first = matrix_line(&m, 0);
+		fraction_from_int(5, &first[1]);
+		matrix_swap_lines(&m, 0, 1);
+		assert(matrix_line(&m, 1) == first);
+		assert(matrix_line(&m, 1)[1].numerator == 5);
+		assert(matrix_line(&m, 0)[1].numerator == 0);
+		matrix_free(&m);
+	}
+	{
+		/* Too big to be allocated */
+		integer_matrix m = {0};
+		assert(!integer_matrix_init(&m, SIZE_MAX / 2, 3));
+	}
+	{
+		/* Reshaping reuses the memory, and resets the matrix */
+		integer_matrix m = {0};
+		assert(integer_matrix_reshape(&m, 3, 4));
+		integer_matrix_line(&m, 2)[3] = 7;
+		integer_matrix_swap_lines(&m, 0, 2);
+		int64_t *data = m.data;
+		assert(integer_matrix_reshape(&m, 2, 3));
+		assert(m.data == data && m.n_lines == 2 && m.n_col == 3);
+		for (size_t i = 0; i < 2; i++) {
+			assert(integer_matrix_line(&m, i) == data + i * 3);
+			for (size_t j = 0; j < 3; j++) {
+				assert(integer_matrix_line(&m, i)[j] == 0);
+			}
+		}
+		assert(integer_matrix_reshape(&m, 5, 6));
+		assert(m.capacity >= 30 && m.line_capacity >= 5);
+		assert(!integer_matrix_reshape(&m, SIZE_MAX / 2, 3));
+		assert(m.n_lines == 5);
+		integer_matrix_free(&m);
+	}
+}
+
+void
+test_big_integers(void)
+{
+	big_integer a;
+	big_integer b;
+	big_integer c;
+	big_integer quotient;
+	big_integer remainder;
+	big_integer_init(&a);
+	big_integer_init(&b);
+	big_integer_init(&c);
+	big_integer_init(&quotient);
+	big_integer_init(&remainder);
+	{
+		/* (a * b + c) / b, with a 2-limb divisor */
+		uint64_t value = 0;
+		big_integer_set_u64(&a, 18446744073709551557u);
+		big_integer_set_u64(&b, 12345678910111213u);
+		big_integer_set_u64(&c, 1234567);
+		big_integer_multiply(&quotient, &a, &b);
+		big_integer_add(&quotient, &quotient, &c);
+		big_integer_divide(&quotient, &remainder, &quotient, &b);
+		assert(big_integer_compare(&quotient, &a) == 0);
+		assert(big_integer_to_u64(&remainder, &value) &&
+		       value == 1234567);
+	}
+	{
+		/* GCD of a * c and b * c */
+		big_integer_set_u64(&a, 4294967291);
+		big_integer_multiply(&a, &a, &a);
+		big_integer_set_u64(&b, 65521);
+		big_integer_multiply(&b, &b, &a);
+		big_integer_set_u64(&c, 4294967279);
+		big_integer_multiply(&c, &c, &a);
+		big_integer_gcd(&remainder, &b, &c);
+		assert(big_integer_compare(&remainder, &a) == 0);
+	}
+	{
+		/* Subtraction back to a small number */
+		uint64_t value = 0;
+		big_integer_set_u64(&b, 7);
+		big_integer_add(&c, &a, &b);
+		big_integer_subtract(&c, &c, &a);
+		assert(big_integer_to_u64(&c, &value) && value == 7);
+	}
+	big_integer_free(&a);
+	big_integer_free(&b);
+	big_integer_free(&c);
+	big_integer_free(&quotient);
+	big_integer_free(&remainder);
+}
+
+void
+test_promotion(void)
+{
+	wide_table table;
+	wide_table_init(&table);
+	{
+		/* Promotion to 64 bits and back */
+		fraction value = {0, 4294967295, 1};
+		fraction minus_one = {1, 1, 1};
+		fraction one = {0, 1, 1};
+		tiered_submul(&table, &value, &minus_one, &one);
+		assert(fraction_is_wide(&value));
+		assert(table.promotions_to_64 == 1);
+		assert(tiered_to_double(&table, &value) == 4294967296.0);
+		tiered_submul(&table, &value, &one, &one);
+		assert(!fraction_is_wide(&value));
+		assert(value.numerator == 4294967295 && value.denominator == 1);
+		assert(table.n_free == 1);
+	}
+	{
+		/* Promotion to arbitrary precision and back */
+		fraction value = {1, 4294967291, 4294967279};
+		fraction square = {0, 0, 1};
+		fraction power = {0, 0, 1};
+		fraction inverse = {0, 0, 1};
+		fraction product = {0, 0, 1};
+		tiered_multiply(&table, &value, &value, &square);
+		tiered_multiply(&table, &square, &square, &power);
+		assert(table.promotions_to_big == 1);
+		assert(tiered_compare(&table, &power, &square) == 1);
+		/* The magnitudes, whatever the signs */
+		fraction minus_two = {1, 2, 1};
+		assert(tiered_compare(&table, &minus_two, &power) == -1);
+		assert(tiered_compare_magnitude(&table, &minus_two, &power) ==
+		       1);
+		assert(tiered_compare_magnitude(&table, &value, &value) == 0);
+		tiered_invert(&table, &power, &inverse);
+		tiered_multiply(&table, &power, &inverse, &product);
+		fraction one = {0, 1, 1};
+		assert(!fraction_is_wide(&product));
+		assert(compare_fractions(&product, &one) == 0);
+		tiered_release(&table, &square);
+		tiered_release(&table, &power);
+		tiered_release(&table, &inverse);
+	}
+	wide_table_free(&table);
+}
+
+void
+test_modular(void)
+{
+	assert(is_word_prime(2147483647));
+	assert(is_word_prime(61));
+	assert(!is_word_prime(2147483647u - 2));
+	/* A strong pseudoprime to the bases 2, 3, 5 and 7 */
+	assert(!is_word_prime(3215031751u));
+	assert(inverse_mod(3, 7) == 5);
+	assert(inverse_mod(1000, 2147483647) * 1000ull % 2147483647 == 1);
+
+	{
+		/* -3/7 modulo 1000003 */
+		big_integer modulus, residue;
+		big_integer_init(&modulus);
+		big_integer_init(&residue);
+		big_integer_set_u64(&modulus, 1000003);
+		big_integer_set_u64(&residue, 1000003 - 3ull *
+		                                  inverse_mod(7, 1000003) %
+		                                  1000003);
+		big_fraction result;
+		big_fraction_init(&result);
+		bool found = false;
+		assert(rational_reconstruction(&result, &residue, &modulus,
+		                               &found));
+		assert(found);
+		bool negative = false;
+		uint64_t numerator = 0;
+		uint64_t denominator = 0;
+		assert(big_fraction_to_u64(&result, &negative, &numerator,
+		                           &denominator));
+		assert(negative && numerator == 3 && denominator == 7);
+		big_fraction_free(&result);
+		big_integer_free(&modulus);
+		big_integer_free(&residue);
+	}
+	{
+		/* x + y = 3, x - 2y = 1 gives x = 7/3, y = 2/3 */
+		integer_matrix system;
+		assert(integer_matrix_init(&system, 2, 3));
+		const int64_t values[] = {1, 1, 3, 1, -2, 1};
+		for (size_t i = 0; i < 6; i++) {
+			integer_matrix_line(&system, i / 3)[i % 3] = values[i];
+		}
+		wide_table table;
+		wide_table_init(&table);
+		fraction solution[2] = {{0, 0, 1}, {0, 0, 1}};
+		size_t n_primes = 0;
+		assert(modular_solve(&system, &table, solution, &n_primes,
+		                     NULL));
+		assert(n_primes > 0);
+		assert(!solution[0].negative && solution[0].numerator == 7 &&
+		       solution[0].denominator == 3);
+		assert(solution[1].numerator == 2 &&
+		       solution[1].denominator == 3);
+		solution[1].numerator = 1;
+		assert(!verify_solution(&system, &table, solution));
+		wide_table_free(&table);
+		integer_matrix_free(&system);
+	}
+}
+
+void
+test_floating(void)
+{
+	/* Large enough to span several panels and tiles */
+	const size_t n = 300;
+	integer_matrix system;
+	assert(integer_matrix_init(&system, n, n + 1));
+	uint32_t state = 12345;
+	for (size_t i = 0; i < n; i++) {
+		int64_t *line = integer_matrix_line(&system, i);
+		line[n] = 0;
+		for (size_t j = 0; j < n; j++) {
+			state = state * 1103515245 + 12345;
+			line[j] = (int64_t)(state >> 16) % 201 - 100;
+			/* The solution is 1, 2, ..., n */
+			line[n] += line[j] * (int64_t)(j + 1);
+		}
+	}
+	double *solution = malloc(n * sizeof(double));
+	assert(solution != NULL);
+	arena scratch;
+	assert(arena_init(&scratch, float_solve_arena_size(n)));
+	double residual = 1;
+	assert(float_solve(&system, 3, &scratch, solution, &residual, NULL));
+	assert(residual < 1e-6);
+	/* Everything is given back on return */
+	assert(scratch.used == 0 && scratch.peak <= scratch.capacity);
+	for (size_t j = 0; j < n; j++) {
+		double error = solution[j] - (double)(j + 1);
+		assert(error < 1e-9 && error > -1e-9);
+	}
+
+	/* An unknown that appears nowhere makes the system singular */
+	for (size_t i = 0; i < n; i++) {
+		integer_matrix_line(&system, i)[100] = 0;
+	}
+	char error[ERROR_SIZE] = "";
+	assert(!float_solve(&system, 0, &scratch, solution, &residual, error));
+	assert(strcmp(error, "the system is singular") == 0);
+
+	/* An arena too small is reported, not fatal */
+	arena small;
+	assert(arena_init(&small, 4096));
+	assert(!float_solve(&system, 0, &small, solution, &residual, NULL));
+	assert(small.used == 0);
+	arena_free(&small);
+	arena_free(&scratch);
+	free(solution);
+	integer_matrix_free(&system);
+}
+
+/**
+ * @brief Marks the share of an array of a thread of a pool.
+ */
+static void
+mark_task(void *const argument, const size_t thread, const size_t n_threads)
+{
+	size_t *marks = argument;
+	for (size_t i = thread; i < 100; i += n_threads) {
+		marks[i] += thread + 1;
+	}
+}
+
+void
+test_pool(void)
+{
+	worker_pool pool;
+	assert(pool_init(&pool, 3));
+	assert(pool.n_threads >= 1 && pool.n_threads <= 3);
+	size_t marks[100] = {0};
+	/* The same threads run both tasks */
+	pool_run(&pool, mark_task, marks);
+	pool_run(&pool, mark_task, marks);
+	for (size_t i = 0; i < 100; i++) {
+		assert(marks[i] == 2 * (i % pool.n_threads + 1));
+	}
+	pool_free(&pool);
+}
+
+/**
+ * @brief Fills a line of fractions for test_kernels().
+ *
+ * Most elements are small whole numbers, some are large enough to overflow
+ * and the others are reduced fractions.
+ */
+static void
+fill_row(fraction_row *const row, uint32_t *const state)
+{
+	for (size_t j = 0; j < row->length; j++) {
+		*state = *state * 1103515245 + 12345;
+		fraction f = {(*state >> 8) & 1, (*state >> 16) % 100, 1};
+		if ((*state >> 9) % 16 == 0) {
+			f.numerator = 0xFFFFFF00u + (*state >> 16) % 256;
+		} else if ((*state >> 9) % 16 == 1) {
+			f.denominator = (*state >> 24) % 7 + 2;
+			simplify_fraction(&f);
+		}
+		fraction_row_set(row, j, &f);
+	}
+}
+
+void
+test_kernels(void)
+{
+	const size_t length = 203;
+	arena rows;
+	assert(arena_init(&rows, 3 * fraction_row_arena_size(length)));
+	fraction_row pivot;
+	fraction_row reference;
+	fraction_row row;
+	assert(fraction_row_alloc(&pivot, &rows, length));
+	assert(fraction_row_alloc(&reference, &rows, length));
+	assert(fraction_row_alloc(&row, &rows, length));
+	const fraction factors[] = {{0, 3, 1}, {1, 17, 1}, {0, 2, 5}};
+
+	for (enum kernel_isa isa = KERNEL_SCALAR; isa <= KERNEL_AVX2; isa++) {
+		if (!kernel_select(isa)) {
+			continue;
+		}
+		for (size_t k = 0; k < 3 * 20; k++) {
+			uint32_t state = (uint32_t)k;
+			fill_row(&pivot, &state);
+			fill_row(&row, &state);
+			const size_t first = k % 5;
+
+			/* The reference goes through the fraction API */
+			size_t expected = length;
+			for (size_t j = 0; j < length; j++) {
+				fraction a = {0};
+				fraction b = {0};
+				fraction_row_get(&row, j, &a);
+				fraction_row_get(&pivot, j, &b);
+				if (j >= first && expected == length &&
+				    !submul_fractions(&a, &factors[k % 3], &b,
+				                      &a)) {
+					expected = j;
+				}
+				fraction_row_set(&reference, j, &a);
+			}
+			assert(row_submul(&row, &factors[k % 3], &pivot, first,
+			                  length) == expected);
+			for (size_t j = first; j < expected; j++) {
+				fraction a = {0};
+				fraction b = {0};
+				fraction_row_get(&row, j, &a);
+				fraction_row_get(&reference, j, &b);
+				assert(a.negative == b.negative &&
+				       a.numerator == b.numerator &&
+				       a.denominator == b.denominator);
+			}
+		}
+	}
+	assert(kernel_select(kernel_best_isa()));
+
+	/* A promoted value cannot be copied to a line of fractions */
+	fraction line[3] = {{0, 1, 1}, {1, 2, 3}, {0, 7, 0}};
+	assert(fraction_row_load(&row, line, 0, 2));
+	assert(!fraction_row_load(&row, line, 0, 3));
+	line[0].numerator = 5;
+	fraction_row_store(&row, line, 0, 2);
+	assert(line[0].numerator == 1 && line[1].negative &&
+	       line[1].denominator == 3);
+	arena_free(&rows);
+}
+
+void
+test_reader(void)
+{
+	FILE *file = tmpfile();
+	assert(file != NULL);
+	/* A line far longer than the buffer of the reader */
+	const size_t length = 20000;
+	for (size_t j = 0; j < length; j++) {
+		fprintf(file, "%s%zu", j == 0 ? "" : " ", j * 1000003);
+	}
+	fprintf(file, "\n-9223372036854775808 +7\t-0\r\n\n12 a\n");
+	rewind(file);
+
+	line_reader reader;
+	assert(reader_init(&reader, file));
+	assert(reader_next_line(&reader) == READ_LINE);
+	assert(reader.n_values == length);
+	for (size_t j = 0; j < length; j++) {
+		assert(reader.values[j] == (int64_t)(j * 1000003));
+	}
+	assert(reader_next_line(&reader) == READ_LINE);
+	assert(reader.n_values == 3);
+	assert(reader.values[0] == INT64_MIN);
+	assert(reader.values[1] == 7 && reader.values[2] == 0);
+	assert(reader_next_line(&reader) == READ_LINE);
+	assert(reader.n_values == 0);
+	assert(reader_next_line(&reader) == READ_ERROR);
+	reader_free(&reader);
+
+	rewind(file);
+	fprintf(file, "9223372036854775808\n");
+	rewind(file);
+	assert(reader_init(&reader, file));
+	assert(reader_next_line(&reader) == READ_ERROR);
+	reader_free(&reader);
+	fclose(file);
+}
+
+void
+test_binary(void)
+{
+	const int64_t lines[2][3] = {{1, -2, INT32_MAX}, {INT32_MIN, 0, 7}};
+	unsigned char contents[BINARY_HEADER_SIZE + 6 * 8];
+	binary_matrix binary;
+	for (unsigned width = 4; width <= 8; width += 4) {
+		FILE *file = tmpfile();
+		assert(file != NULL);
+		binary_writer writer;
+		assert(binary_writer_start(&writer, file, width, true));
+		assert(binary_writer_line(&writer, lines[0], 3));
+		assert(binary_writer_line(&writer, lines[1], 3));
+		/* Lines of another length are refused */
+		assert(!binary_writer_line(&writer, lines[1], 2));
+		assert(binary_writer_finish(&writer));
+
+		const size_t size = BINARY_HEADER_SIZE + 6 * width;
+		rewind(file);
+		assert(fread(contents, 1, sizeof(contents), file) == size);
+		fclose(file);
+		assert(binary_parse(&binary, contents, size) == BINARY_MATRIX);
+		assert(binary.n_lines == 2 && binary.n_col == 3);
+		for (size_t i = 0; i < 2; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				assert(binary_element(&binary, i, j) ==
+				       lines[i][j]);
+			}
+		}
+
+		/* Corruption and truncation are detected */
+		contents[size - 1] ^= 1;
+		assert(binary_parse(&binary, contents, size) == BINARY_INVALID);
+		assert(binary_parse(&binary, contents, size - 1) ==
+		       BINARY_INVALID);
+	}
+	assert(binary_parse(&binary, "1 2 3\n", 6) == BINARY_NOT_BINARY);
+}
+
+void
+test_arena(void)
+{
+	arena a;
+	assert(arena_init(&a, 3 * ARENA_ALIGNMENT));
+	char *first = arena_alloc(&a, 10, 1);
+	assert(first != NULL && (uintptr_t)first % ARENA_ALIGNMENT == 0);
+	/* The allocations are rounded up to the alignment */
+	int64_t *second = arena_alloc(&a, 2, sizeof(int64_t));
+	assert((char *)second == first + ARENA_ALIGNMENT);
+	assert(arena_position(&a) == 2 * ARENA_ALIGNMENT);
+
+	const size_t position = arena_position(&a);
+	assert(arena_alloc(&a, ARENA_ALIGNMENT, 1) != NULL);
+	/* The arena is exhausted */
+	assert(arena_alloc(&a, 1, 1) == NULL);
+	assert(arena_alloc(&a, SIZE_MAX / 2, 4) == NULL);
+	arena_rewind(&a, position);
+	assert(arena_alloc(&a, 1, 1) != NULL);
+	assert(a.peak == 3 * ARENA_ALIGNMENT);
+
+	/* Growing drops the contents, resetting keeps the memory */
+	arena_reset(&a);
+	assert(arena_alloc(&a, 1, 1) == first);
+	arena_reset(&a);
+	assert(arena_reserve(&a, 2 * ARENA_ALIGNMENT));
+	assert(a.capacity == 3 * ARENA_ALIGNMENT);
+	assert(arena_reserve(&a, 8 * ARENA_ALIGNMENT));
+	assert(a.capacity == 8 * ARENA_ALIGNMENT && a.used == 0);
+	assert(arena_size(3, 8) == ARENA_ALIGNMENT);
+	assert(arena_size(SIZE_MAX, 2) == SIZE_MAX);
+
+	/* A matrix allocated from the arena does not free its memory */
+	matrix m;
+	assert(matrix_init_in(&m, &a, 2, 3));
+	assert(matrix_line(&m, 1)[2].denominator == 1);
+	assert(!matrix_reshape(&m, 3, 4));
+	matrix_free(&m);
+	integer_matrix im;
+	assert(!integer_matrix_init_in(&im, &a, 100, 100));
+	arena_free(&a);
+}
+
+void
+test_sparse(void)
+{
+	/* An arrow: eliminating the dense line or column first would fill
+	 * the whole matrix, Markowitz' criterion leaves them for last */
+	const size_t n = 6;
+	sparse_matrix m;
+	assert(sparse_init(&m, n, n + 1));
+	for (size_t i = 0; i < n; i++) {
+		/* The solution is 1, 2, ..., n */
+		int32_t constant = 0;
+		for (size_t j = 0; j < n; j++) {
+			const int32_t value =
+			    i == j ? 4 : (i == 0 || j == 0 ? 1 : 0);
+			assert(sparse_append(&m, i, j, value));
+			constant += value * (int32_t)(j + 1);
+		}
+		assert(sparse_append(&m, i, n, constant));
+	}
+	/* Added twice, the coefficients are summed */
+	assert(sparse_append(&m, 1, 2, 3));
+	assert(sparse_append(&m, 1, 2, -3));
+	sparse_finish(&m);
+	assert(sparse_count(&m) == 3 * n - 2 + n);
+	assert(m.lines[1].length == 3 && m.lines[1].entries[1].column == 1);
+
+	fraction solution[6];
+	assert(sparse_solve(&m, solution, NULL));
+	assert(m.fill_in == 0);
+	for (size_t j = 0; j < n; j++) {
+		assert(!fraction_is_wide(&solution[j]));
+		assert(solution[j].numerator == j + 1 &&
+		       solution[j].denominator == 1 && !solution[j].negative);
+	}
+	sparse_free(&m);
+
+	/* From a dense matrix, with a zero line: the system is singular */
+	matrix dense;
+	assert(matrix_init(&dense, 2, 3));
+	fraction_from_int(1, &matrix_line(&dense, 0)[0]);
+	fraction_from_int(1, &matrix_line(&dense, 1)[2]);
+	assert(sparse_from_matrix(&m, &dense));
+	assert(sparse_count(&m) == 2);
+	assert(!sparse_solve(&m, solution, NULL));
+	sparse_free(&m);
+	matrix_free(&dense);
+}
+
+void
+test_library(void)
+{
+	/* 2x = 1, 3y = 2 */
+	const int64_t system[] = {2, 0, 1, 0, 3, 2};
+	const enum solver_engine engines[] = {ENGINE_FRACTION, ENGINE_BAREISS,
+	                                      ENGINE_MODULAR, ENGINE_FLOAT};
+	for (size_t e = 0; e < 4; e++) {
+		solver *s = solver_create(engines[e], 2);
+		assert(s != NULL);
+		assert(solver_solve(s) == SOLVER_ERROR_NO_SYSTEM);
+		assert(solver_load(s, 2, system) == SOLVER_OK);
+		assert(solver_size(s) == 2);
+		assert(solver_solve(s) == SOLVER_OK);
+		const double *x = solver_approximations(s);
+		assert(x[0] > 0.4999 && x[0] < 0.5001);
+		assert(x[1] > 0.6666 && x[1] < 0.6667);
+		int64_t numerator = 0;
+		int64_t denominator = 0;
+		assert(solver_exact_value(s, 1, &numerator, &denominator) ==
+		       (engines[e] != ENGINE_FLOAT));
+		assert(engines[e] == ENGINE_FLOAT ||
+		       (numerator == 2 && denominator == 3));
+
+		/* The same system, from text */
+		assert(solver_load_text(s, "2 0 1\n0 3 2\n", 12) == SOLVER_OK);
+		assert(solver_solve(s) == SOLVER_OK);
+		assert(solver_approximations(s)[0] > 0.4999);
+		solver_destroy(s);
+	}
+
+	/* The fraction-free elimination keeps the solutions beyond 32 bits */
+	const int64_t large[] = {70000, 1, 1, -1, 70000, 0};
+	solver *s = solver_create(ENGINE_BAREISS, 1);
+	assert(solver_load(s, 2, large) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	int64_t numerator = 0;
+	int64_t denominator = 0;
+	assert(solver_exact_value(s, 1, &numerator, &denominator));
+	assert(numerator == 1 && denominator == 4900000001);
+	solver_destroy(s);
+
+	/* Its minors of 3 lines do not fit in 64 bits: the fractions finish
+	 * the elimination */
+	const int64_t minors[] = {1000000007, -999999937,  123456789,
+	                          123456859,  -987654321,  1000000021,
+	                          555555555,  567901255,   314159265,
+	                          271828182,  -1000000009, -414012562};
+	s = solver_create(ENGINE_BAREISS, 1);
+	assert(solver_load(s, 3, minors) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	for (size_t i = 0; i < 3; i++) {
+		assert(solver_exact_value(s, i, &numerator, &denominator));
+		assert(numerator == 1 && denominator == 1);
+	}
+	solver_destroy(s);
+	/* Solved by the fraction engine, only its determinant overflows */
+	s = solver_create(ENGINE_FRACTION, 1);
+	assert(solver_load(s, 3, minors) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_determinant(s, &numerator, &denominator) ==
+	       SOLVER_ERROR_OVERFLOW);
+	solver_destroy(s);
+
+	/* The sparse elimination gives the same solution */
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_sparse(s, true);
+	assert(solver_load(s, 2, system) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_exact_value(s, 0, &numerator, &denominator));
+	assert(numerator == 1 && denominator == 2);
+	solver_destroy(s);
+
+	/* The back-substitution, by blocks or not, and the Gauss-Jordan
+	 * elimination agree, with every pivoting */
+	const int64_t full[] = {1, 2, 3, 14, 2, 1, 1, 7, 3, 2, -1, 4};
+	const char *const pivotings[] = {"greatest", "smallest", "sparsest",
+	                                 "first"};
+	for (int run = 0; run < 12; run++) {
+		enum solver_pivoting pivoting = PIVOTING_GREATEST;
+		assert(solver_parse_pivoting(pivotings[run / 3], &pivoting));
+		s = solver_create(ENGINE_FRACTION, 2);
+		solver_set_gauss_jordan(s, run % 3 == 1);
+		solver_set_block_size(s, run % 3 == 2 ? 2 : 0);
+		solver_set_pivoting(s, pivoting);
+		assert(solver_load(s, 3, full) == SOLVER_OK);
+		assert(solver_solve(s) == SOLVER_OK);
+		for (size_t i = 0; i < 3; i++) {
+			assert(solver_exact_value(s, i, &numerator,
+			                          &denominator));
+			assert(numerator == (int64_t)i + 1 && denominator == 1);
+		}
+		/* The determinant does not depend on the line swaps */
+		size_t rank = 0;
+		assert(solver_rank(s, &rank) == SOLVER_OK && rank == 3);
+		assert(solver_determinant(s, &numerator, &denominator) ==
+		       SOLVER_OK);
+		assert(numerator == 10 && denominator == 1);
+		/* Only the factorisation gives the inverse */
+		assert(solver_invert(s) == SOLVER_ERROR_UNSUPPORTED);
+		solver_destroy(s);
+	}
+	enum solver_pivoting pivoting = PIVOTING_GREATEST;
+	assert(!solver_parse_pivoting("largest", &pivoting));
+
+	/* From the binary format */
+	FILE *file = tmpfile();
+	assert(file != NULL);
+	binary_writer writer;
+	assert(binary_writer_start(&writer, file, 4, true));
+	assert(binary_writer_line(&writer, system, 3));
+	assert(binary_writer_line(&writer, system + 3, 3));
+	assert(binary_writer_finish(&writer));
+	unsigned char contents[BINARY_HEADER_SIZE + 6 * 4];
+	rewind(file);
+	assert(fread(contents, 1, sizeof(contents), file) == sizeof(contents));
+	fclose(file);
+	s = solver_create(ENGINE_MODULAR, 1);
+	assert(solver_load_binary(s, contents, sizeof(contents)) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_exact_value(s, 0, &numerator, &denominator));
+	assert(numerator == 1 && denominator == 2);
+
+	/* Invalid inputs, and a singular system */
+	const int64_t too_large[] = {1, INT64_C(1) << 40};
+	assert(solver_load(s, 1, too_large) == SOLVER_ERROR_INPUT);
+	assert(solver_solve(s) == SOLVER_ERROR_NO_SYSTEM);
+	assert(solver_load_text(s, "1 2 3\n4 5\n", 10) == SOLVER_ERROR_INPUT);
+	assert(strstr(solver_last_error(s), "line 2") != NULL);
+	assert(solver_load_binary(s, "1 2\n", 4) == SOLVER_ERROR_INPUT);
+	const int64_t singular[] = {1, 1, 2, 2, 2, 4};
+	assert(solver_load(s, 2, singular) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_ERROR_UNSOLVED);
+	assert(strcmp(solver_last_error(s), "the system is singular") == 0);
+	assert(solver_approximations(s) == NULL);
+	size_t rank = 0;
+	assert(solver_rank(s, &rank) == SOLVER_ERROR_UNSUPPORTED);
+	solver_destroy(s);
+
+	/* The fraction engine finds the rank of a singular system, however it
+	 * eliminates it, instead of inverting a zero pivot */
+	const int64_t dependent[] = {1, 2, 3, 6, 2, 4, 6, 12, 1, 0, 1, 2};
+	for (int run = 0; run < 3; run++) {
+		s = solver_create(ENGINE_FRACTION, 1);
+		solver_set_gauss_jordan(s, run == 1);
+		solver_set_factors(s, run == 2);
+		assert(solver_load(s, 3, dependent) == SOLVER_OK);
+		assert(solver_rank(s, &rank) == SOLVER_OK && rank == 2);
+		assert(solver_solve(s) == SOLVER_ERROR_UNSOLVED);
+		assert(solver_approximations(s) == NULL);
+		assert(solver_determinant(s, &numerator, &denominator) ==
+		       SOLVER_OK);
+		assert(numerator == 0 && denominator == 1);
+		assert(solver_invert(s) == SOLVER_ERROR_UNSOLVED);
+		solver_destroy(s);
+	}
+
+	/* Two right-hand sides, factorised once then solved again */
+	const int64_t sides[] = {2, 0, 1, 4, 0, 3, 2, 3};
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_rhs(s, 2);
+	solver_set_factors(s, true);
+	assert(solver_load(s, 2, sides) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_exact_value(s, 2, &numerator, &denominator));
+	assert(numerator == 2 && denominator == 1);
+	const int64_t constants[] = {-1, 6, 5, -4};
+	assert(solver_solve_rhs(s, constants) == SOLVER_OK);
+	assert(solver_exact_value(s, 3, &numerator, &denominator));
+	assert(numerator == -4 && denominator == 3);
+	file = tmpfile();
+	assert(file != NULL);
+	assert(solver_save_factors(s, file) == SOLVER_OK);
+	solver_destroy(s);
+
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_rhs(s, 2);
+	rewind(file);
+	assert(solver_load_factors(s, file) == SOLVER_OK);
+	fclose(file);
+	assert(solver_size(s) == 2);
+	assert(solver_approximations(s) == NULL);
+	assert(solver_solve_rhs(s, constants) == SOLVER_OK);
+	assert(solver_exact_value(s, 0, &numerator, &denominator));
+	assert(numerator == -1 && denominator == 2);
+	assert(solver_approximations(s)[2] == 3.0);
+	assert(solver_determinant(s, &numerator, &denominator) == SOLVER_OK);
+	assert(numerator == 6 && denominator == 1);
+	solver_destroy(s);
+
+	/* The inverse, two columns at a time, from the factorisation saved
+	 * and loaded back: the line swaps are found from its permutation */
+	const int64_t wide[] = {1, 2, 3, 14, 0, 2, 1, 1, 7, 0,
+	                        3, 2, -1, 4, 0};
+	const int64_t inverse[] = {-3, 10, 4, 5, -1, 10, 1, 2, -1, 1,
+	                           1, 2, 1, 10, 2, 5, -3, 10};
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_rhs(s, 2);
+	solver_set_factors(s, true);
+	assert(solver_load(s, 3, wide) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	file = tmpfile();
+	assert(file != NULL);
+	assert(solver_save_factors(s, file) == SOLVER_OK);
+	solver_destroy(s);
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_rhs(s, 2);
+	rewind(file);
+	assert(solver_load_factors(s, file) == SOLVER_OK);
+	fclose(file);
+	assert(solver_determinant(s, &numerator, &denominator) == SOLVER_OK);
+	assert(numerator == 10 && denominator == 1);
+	assert(solver_invert(s) == SOLVER_OK);
+	for (size_t i = 0; i < 9; i++) {
+		assert(solver_inverse_value(s, i / 3, i % 3, &numerator,
+		                            &denominator));
+		assert(numerator == inverse[2 * i] &&
+		       denominator == inverse[2 * i + 1]);
+	}
+	assert(!solver_inverse_value(s, 3, 0, &numerator, &denominator));
+	solver_destroy(s);
+
+	/* Changes of the system, as updates of its factorisation until the
+	 * limit, then factorised again */
+	s = solver_create(ENGINE_FRACTION, 1);
+	solver_set_factors(s, true);
+	assert(solver_load(s, 3, full) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_update_coefficient(s, 0, 0, 2) ==
+	       SOLVER_ERROR_UNSUPPORTED);
+	solver_set_updates(s, 2);
+	assert(solver_load(s, 3, full) == SOLVER_OK);
+	assert(solver_solve(s) == SOLVER_OK);
+	assert(solver_update_coefficient(s, 0, 0, 2) == SOLVER_OK);
+	assert(solver_update_count(s) == 1);
+	assert(solver_exact_value(s, 2, &numerator, &denominator));
+	assert(numerator == 20 && denominator == 7);
+	assert(solver_determinant(s, &numerator, &denominator) == SOLVER_OK);
+	assert(numerator == 7 && denominator == 1);
+	assert(solver_save_factors(s, stdout) == SOLVER_ERROR_UNSUPPORTED);
+	/* A constant is not an update */
+	assert(solver_update_coefficient(s, 2, 3, 5) == SOLVER_OK);
+	assert(solver_update_count(s) == 1);
+	assert(solver_exact_value(s, 0, &numerator, &denominator));
+	assert(numerator == 9 && denominator == 7);
+	const int64_t changed_line[] = {1, 1, 1, 6};
+	assert(solver_update_line(s, 1, changed_line) == SOLVER_OK);
+	assert(solver_update_count(s) == 2);
+	assert(solver_exact_value(s, 1, &numerator, &denominator));
+	assert(numerator == 5 && denominator == 1);
+	assert(solver_determinant(s, &numerator, &denominator) == SOLVER_OK);
+	assert(numerator == -1 && denominator == 1);
+	const int64_t changed_column[] = {1, 1, 1};
+	assert(solver_update_column(s, 2, changed_column) == SOLVER_OK);
+	assert(solver_update_count(s) == 0);
+	assert(solver_exact_value(s, 1, &numerator, &denominator));
+	assert(numerator == 17 && denominator == 1);
+	/* A change that makes the system singular, then one that undoes it */
+	assert(solver_update_column(s, 0, changed_column) ==
+	       SOLVER_ERROR_UNSOLVED);
+	assert(solver_rank(s, &rank) == SOLVER_OK && rank == 2);
+	const int64_t first_column[] = {2, 1, 3};
+	assert(solver_update_column(s, 0, first_column) == SOLVER_OK);
+	assert(solver_exact_value(s, 2, &numerator, &denominator));
+	assert(numerator == -2 && denominator == 1);
+	assert(solver_update_coefficient(s, 3, 0, 1) == SOLVER_ERROR_INPUT);
+	solver_destroy(s);
+
+	/* Only the fraction engine solves several sides */
+	s = solver_create(ENGINE_MODULAR, 1);
+	solver_set_rhs(s, 2);
+	assert(solver_load(s, 2, sides) == SOLVER_ERROR_INPUT);
+	assert(solver_save_factors(s, stdout) == SOLVER_ERROR_NO_SYSTEM);
+	solver_destroy(s);
+}
+
+/**
+ * @brief Writes bytes to a socket, however many calls it takes.
+ */
+static void
+write_fully(const int fd, const void *const bytes, const size_t count)
+{
+	size_t done = 0;
+	while (done < count) {
+		const ssize_t n =
+		    write(fd, (const char *)bytes + done, count - done);
+		assert(n > 0);
+		done += (size_t)n;
+	}
+}
+
+/**
+ * @brief Reads bytes from a socket, however many calls it takes.
+ */
+static void
+read_fully(const int fd, void *const bytes, const size_t count)
+{
+	size_t done = 0;
+	while (done < count) {
+		const ssize_t n = read(fd, (char *)bytes + done, count - done);
+		assert(n > 0);
+		done += (size_t)n;
+	}
+}
+
+/**
+ * @brief Sends a request to a server, as its client.
+ */
+static void
+send_request(const int fd, const enum frame_kind kind,
+             const void *const payload, const size_t length)
+{
+	unsigned char header[FRAME_HEADER_SIZE] = {
+	    'L', 'Q', 'S', 'Q', SERVER_VERSION, 0, (unsigned char)kind, 0};
+	for (size_t b = 0; b < 8; b++) {
+		header[8 + b] = (unsigned char)((uint64_t)length >> (8 * b));
+	}
+	write_fully(fd, header, sizeof(header));
+	write_fully(fd, payload, length);
+}
+
+/**
+ * @brief Receives a response of a server, as its client.
+ *
+ * @return The status of the response, whose payload is stored as a string.
+ */
+static enum solver_status
+receive_response(const int fd, char *const payload, const size_t size)
+{
+	unsigned char header[FRAME_HEADER_SIZE];
+	read_fully(fd, header, sizeof(header));
+	assert(memcmp(header, "LQSA", 4) == 0);
+	assert(header[4] == SERVER_VERSION && header[5] == 0 && header[7] == 0);
+	uint64_t length = 0;
+	for (size_t b = 8; b-- > 0;) {
+		length = length << 8 | header[8 + b];
+	}
+	assert(length < size);
+	read_fully(fd, payload, (size_t)length);
+	payload[length] = '\0';
+	return (enum solver_status)header[6];
+}
+
+/**
+ * @brief A connection served by test_server(), from a thread of its own.
+ */
+struct test_connection {
+	/** The server */
+	server *srv;
+	/** The server's end of the socket */
+	int fd;
+	/** What server_serve() returned */
+	bool served;
+};
+
+/**
+ * @brief Serves a @ref test_connection.
+ */
+static void *
+serve_connection(void *const argument)
+{
+	struct test_connection *connection = argument;
+	connection->served =
+	    server_serve(connection->srv, connection->fd, connection->fd);
+	return NULL;
+}
+
+/**
+ * @brief The requests a client of test_server() sends, from a thread of its
+ * own.
+ */
+struct test_client {
+	/** The client's end of the socket */
+	int fd;
+	/** The number of requests */
+	size_t count;
+	/** The greatest number of unknowns of a system */
+	size_t max_unknowns;
+};
+
+/**
+ * @brief Sends the requests of a @ref test_client, then closes its side of
+ * the socket.
+ *
+ * The system of the request `r` is diagonal, with `1 + r % max_unknowns`
+ * unknowns whose values are all `r + 1`.
+ */
+static void *
+send_systems(void *const argument)
+{
+	const struct test_client *client = argument;
+	static char text[65536];
+	for (size_t r = 0; r < client->count; r++) {
+		const size_t n = 1 + r % client->max_unknowns;
+		size_t length = 0;
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				text[length++] = i == j ? '1' : '0';
+				text[length++] = ' ';
+			}
+			length += (size_t)sprintf(text + length, "%zu\n", r + 1);
+		}
+		send_request(client->fd, FRAME_TEXT, text, length);
+	}
+	shutdown(client->fd, SHUT_WR);
+	return NULL;
+}
+
+/**
+ * @brief Receives the responses to the requests of a @ref test_client, and
+ * checks that they come in order.
+ */
+static void
+receive_systems(const struct test_client *const client)
+{
+	static char payload[65536];
+	for (size_t r = 0; r < client->count; r++) {
+		assert(receive_response(client->fd, payload,
+		                        sizeof(payload)) == SOLVER_OK);
+		char expected[64];
+		sprintf(expected, "\n1,1,%zu,1,", r + 1);
+		assert(strstr(payload, expected) != NULL);
+	}
+}
+
+void
+test_server(void)
+{
+	solver *model = solver_create(ENGINE_FRACTION, 1);
+	assert(model != NULL);
+	server srv;
+	int fds[2];
+	pthread_t serving;
+	pthread_t sending;
+	struct test_connection connection = {&srv, -1, false};
+	static char payload[65536];
+
+	/* A request in text and one in binary */
+	assert(server_init(&srv, model, 2, FORMAT_CSV, 1 << 20));
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	connection.fd = fds[1];
+	assert(pthread_create(&serving, NULL, serve_connection,
+	                      &connection) == 0);
+	send_request(fds[0], FRAME_TEXT, "1 1 3\n1 -2 1\n", 13);
+	FILE *file = tmpfile();
+	assert(file != NULL);
+	binary_writer writer;
+	const int64_t system[] = {2, 0, 1, 0, 4, 1};
+	assert(binary_writer_start(&writer, file, 4, true));
+	assert(binary_writer_line(&writer, system, 3));
+	assert(binary_writer_line(&writer, system + 3, 3));
+	assert(binary_writer_finish(&writer));
+	unsigned char contents[BINARY_HEADER_SIZE + 6 * 4];
+	rewind(file);
+	assert(fread(contents, 1, sizeof(contents), file) == sizeof(contents));
+	fclose(file);
+	send_request(fds[0], FRAME_BINARY, contents, sizeof(contents));
+	shutdown(fds[0], SHUT_WR);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_OK);
+	assert(strstr(payload, "\n1,1,7,3,") != NULL &&
+	       strstr(payload, "\n1,2,2,3,") != NULL);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_OK);
+	assert(strstr(payload, "\n1,1,1,2,") != NULL &&
+	       strstr(payload, "\n1,2,1,4,") != NULL);
+	pthread_join(serving, NULL);
+	assert(connection.served);
+	close(fds[0]);
+	close(fds[1]);
+
+	/* Systems of different sizes, solved side by side, are answered in
+	 * order */
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	connection.fd = fds[1];
+	struct test_client client = {fds[0], 40, 23};
+	assert(pthread_create(&serving, NULL, serve_connection,
+	                      &connection) == 0);
+	assert(pthread_create(&sending, NULL, send_systems, &client) == 0);
+	receive_systems(&client);
+	pthread_join(sending, NULL);
+	pthread_join(serving, NULL);
+	assert(connection.served);
+	close(fds[0]);
+	close(fds[1]);
+	server_free(&srv);
+
+	/* While the client reads nothing, the server stops reading once its
+	 * slots are full, and resumes when the responses are read */
+	assert(server_init(&srv, model, 1, FORMAT_CSV, 1 << 20));
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	const int small = 4096;
+	assert(setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &small,
+	                  sizeof(small)) == 0);
+	connection.fd = fds[1];
+	client = (struct test_client){fds[0], 64, 40};
+	assert(pthread_create(&serving, NULL, serve_connection,
+	                      &connection) == 0);
+	assert(pthread_create(&sending, NULL, send_systems, &client) == 0);
+	const struct timespec pause = {0, 200000000};
+	nanosleep(&pause, NULL);
+	pthread_mutex_lock(&srv.lock);
+	assert(srv.n_read - srv.n_sent <= srv.depth);
+	assert(srv.n_read < client.count);
+	pthread_mutex_unlock(&srv.lock);
+	receive_systems(&client);
+	pthread_join(sending, NULL);
+	pthread_join(serving, NULL);
+	assert(connection.served);
+	close(fds[0]);
+	close(fds[1]);
+	server_free(&srv);
+
+	/* A payload too large is skipped, a header that is not valid ends the
+	 * connection, and both are answered in their turn */
+	assert(server_init(&srv, model, 2, FORMAT_CSV, 64));
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	connection.fd = fds[1];
+	assert(pthread_create(&serving, NULL, serve_connection,
+	                      &connection) == 0);
+	static char large[100];
+	for (size_t i = 0; i < sizeof(large); i += 4) {
+		memcpy(large + i, "1 2\n", 4);
+	}
+	send_request(fds[0], FRAME_TEXT, "1 3\n", 4);
+	send_request(fds[0], FRAME_TEXT, large, sizeof(large));
+	send_request(fds[0], FRAME_TEXT, "1 5\n", 4);
+	write_fully(fds[0], "LQSX\1\0\0\0\4\0\0\0\0\0\0\0" "1 6\n", 20);
+	shutdown(fds[0], SHUT_WR);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_OK);
+	assert(strstr(payload, "\n1,1,3,1,") != NULL);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_ERROR_INPUT);
+	assert(strstr(payload, "the request 2 has 100 bytes") != NULL);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_OK);
+	assert(strstr(payload, "\n1,1,5,1,") != NULL);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_ERROR_INPUT);
+	assert(strstr(payload, "the request 4 is not a valid frame") != NULL);
+	pthread_join(serving, NULL);
+	assert(!connection.served);
+	close(fds[0]);
+	close(fds[1]);
+
+	/* A truncated payload is answered too */
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+	connection.fd = fds[1];
+	assert(pthread_create(&serving, NULL, serve_connection,
+	                      &connection) == 0);
+	write_fully(fds[0], "LQSQ\1\0\0\0\50\0\0\0\0\0\0\0" "1 6\n", 20);
+	shutdown(fds[0], SHUT_WR);
+	assert(receive_response(fds[0], payload, sizeof(payload)) ==
+	       SOLVER_ERROR_INPUT);
+	assert(strstr(payload, "the request 1 is truncated") != NULL);
+	pthread_join(serving, NULL);
+	assert(!connection.served);
+	close(fds[0]);
+	close(fds[1]);
+	server_free(&srv);
+	solver_destroy(model);
+}
+
+void
+test_stats(void)
+{
+	assert(stats_start() == STATS_COMPILED);
+	fraction frac = {0, 4, 2};
+	assert(simplify_fraction(&frac));
+	fraction other = {0, 2, 3};
+	assert(!simplify_fraction(&other));
+	if (STATS_COMPILED) {
+		assert(solve_stats.simplify_calls == 2);
+		assert(solve_stats.simplify_hits == 1);
+		assert(solve_stats.gcd_calls == 2);
+	}
+
+	/* The steps are recorded up to the size given */
+	assert(stats_begin_steps(2));
+	stats_record_step(1, 40, 30);
+	stats_record_step(2, 50, 40);
+	assert(solve_stats.n_steps == 2);
+	assert(solve_stats.steps[1].numerator_bits == 40);
+	stats_stop();
+	assert(solve_stats.gcd_calls == 0 && solve_stats.steps == NULL);
+}
+
+/**
+ * @brief Reads back the contents of a file, from its start.
+ */
+static size_t
+read_contents(FILE *const file, char *const contents, const size_t size)
+{
+	rewind(file);
+	return fread(contents, 1, size, file);
+}
+
+void
+test_writer(void)
+{
+	wide_table table;
+	wide_table_init(&table);
+	/* A fraction of each tier */
+	fraction values[3] = {{1, 3, 4}, {0, 4294967295, 1}, {1, 0, 1}};
+	const fraction minus_one = {1, 1, 1};
+	const fraction one = {0, 1, 1};
+	tiered_submul(&table, &values[1], &minus_one, &one);
+	const fraction big = {1, 4294967291, 4294967279};
+	fraction square = {0, 0, 1};
+	tiered_multiply(&table, &big, &big, &square);
+	tiered_multiply(&table, &square, &square, &values[2]);
+	assert(table.promotions_to_big == 1);
+
+	/* The text and the binary forms are those of the tiered values */
+	FILE *expected = tmpfile();
+	FILE *file = tmpfile();
+	assert(expected != NULL && file != NULL);
+	writer w;
+	assert(writer_init(&w, file));
+	for (size_t i = 0; i < 3; i++) {
+		tiered_fprint(expected, &table, &values[i]);
+		assert(tiered_write(expected, &table, &values[i]));
+		writer_fraction(&w, &table, &values[i]);
+		writer_binary_fraction(&w, &table, &values[i]);
+	}
+	assert(writer_flush(&w));
+	static char contents[2][256];
+	const size_t length = read_contents(expected, contents[0], 256);
+	assert(read_contents(file, contents[1], 256) == length);
+	assert(memcmp(contents[0], contents[1], length) == 0);
+
+	/* The integers, past the size of the buffer */
+	rewind(file);
+	for (size_t i = 0; i < 10000; i++) {
+		writer_signed(&w, INT64_MIN);
+		writer_unsigned(&w, UINT64_MAX);
+		writer_numerator(&w, &table, &values[0]);
+		writer_char(&w, '/');
+		writer_denominator(&w, &table, &values[0]);
+		writer_char(&w, '\n');
+	}
+	assert(writer_flush(&w));
+	rewind(file);
+	char line[64];
+	for (size_t i = 0; i < 10000; i++) {
+		assert(fgets(line, sizeof(line), file) != NULL);
+		assert(strcmp(line, "-9223372036854775808"
+		                    "18446744073709551615-3/4\n") == 0);
+	}
+	writer_free(&w);
+
+	/* In memory, the buffer grows to keep everything */
+	assert(writer_init_memory(&w));
+	for (size_t i = 0; i < 10000; i++) {
+		writer_signed(&w, INT64_MIN);
+		writer_char(&w, '\n');
+	}
+	assert(writer_flush(&w));
+	assert(w.length == 10000 * 21);
+	assert(memcmp(w.buffer + 9999 * 21, "-9223372036854775808\n", 21) == 0);
+	writer_clear(&w);
+	writer_string(&w, "reused");
+	assert(w.length == 6 && memcmp(w.buffer, "reused", 6) == 0);
+	writer_free(&w);
+	fclose(expected);
+	fclose(file);
+	tiered_release(&table, &values[1]);
+	tiered_release(&table, &values[2]);
+	tiered_release(&table, &square);
+	wide_table_free(&table);
+}
@@ -0,0 +1,1001 @@
+/**
+ * @file tiered.c
+ * @brief Overflow-free arithmetic on fractions, by promotion.
+ *
+ * The values of the matrix are kept as @ref fraction structures as long as
+ * they fit, which is the fast path. When an operation overflows, its result
+ * is promoted to a @ref wide_fraction (64-bit terms, computed with 128-bit
+ * intermediates), and when that overflows too, to a @ref big_fraction. The
+ * promoted values live in a @ref wide_table, and are demoted back to a
+ * @ref fraction as soon as they fit in it again.
+ *
+ * When the table is shared between threads, its lock is only held while
+ * entries are read or written: the arbitrary-precision computations are done
+ * on shallow copies of the entries, outside of it.
+ *
+ * The memory of the promoted values is allocated as they appear. When it
+ * cannot be, the table is marked as failed and the operation is dropped: the
+ * caller checks the mark once its computation is done.
+ *
+ * @see tiered.h
+ */
+
+#include "tiered.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+/**
+ * @brief An unsigned integer type wide enough to hold the product of two
+ * `uint64_t`.
+ */
+__extension__ typedef unsigned __int128 u128;
+
+/* -- Helper functions -- */
+
+/**
+ * @brief Takes the lock of a table, if it is shared between threads.
+ *
+ * @param[in, out] table The table to lock.
+ */
+static inline void
+lock_table(wide_table *const table)
+{
+	if (table->lock != NULL) {
+		pthread_mutex_lock(table->lock);
+	}
+}
+
+/**
+ * @brief Releases the lock of a table, if it is shared between threads.
+ *
+ * @param[in, out] table The table to unlock.
+ */
+static inline void
+unlock_table(wide_table *const table)
+{
+	if (table->lock != NULL) {
+		pthread_mutex_unlock(table->lock);
+	}
+}
+
+/**
+ * @brief Frees the slot of a promoted value, the table being locked.
+ *
+ * @see tiered_release
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] f The value to release.
+ */
+static void
+release(wide_table *const table, fraction *const f)
+{
+	if (!fraction_is_wide(f)) {
+		return;
+	}
+	table->entries[f->numerator].tier = TIER_32;
+	table->free_slots[table->n_free++] = f->numerator;
+	f->negative = false;
+	f->numerator = 0;
+	f->denominator = 1;
+}
+
+/**
+ * @brief Gives the representation of a value.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The value to inspect.
+ *
+ * @return The tier of the value.
+ */
+static enum fraction_tier
+tier_of(const wide_table *const table, const fraction *const f)
+{
+	if (!fraction_is_wide(f)) {
+		return TIER_32;
+	}
+	return table->entries[f->numerator].tier;
+}
+
+/**
+ * @brief Gives a value of tier TIER_32 or TIER_64 as a wide fraction.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The value to convert.
+ *
+ * @return The value, with 64-bit terms.
+ */
+static wide_fraction
+widen(const wide_table *const table, const fraction *const f)
+{
+	if (fraction_is_wide(f)) {
+		return table->entries[f->numerator].wide;
+	}
+	wide_fraction result = {f->negative, f->numerator, f->denominator};
+	return result;
+}
+
+/**
+ * @brief Gives a value of any tier as a big fraction.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The value to convert.
+ * @param[out] scratch A big fraction to convert the value into, if it is not
+ * already of tier TIER_BIG.
+ *
+ * @return A pointer to the value, or NULL if the memory of the conversion
+ * could not be allocated. It is only valid until the table is modified.
+ */
+static const big_fraction *
+big_view(const wide_table *const table, const fraction *const f,
+         big_fraction *const scratch)
+{
+	if (tier_of(table, f) == TIER_BIG) {
+		return &table->entries[f->numerator].big;
+	}
+	wide_fraction value = widen(table, f);
+	if (!big_fraction_set(scratch, value.negative, value.numerator,
+	                      value.denominator)) {
+		return NULL;
+	}
+	return scratch;
+}
+
+/**
+ * @brief Reserves a slot in the table.
+ *
+ * @param[in, out] table The table to reserve a slot in.
+ * @param[out] slot Where to store the index of the slot.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+allocate_slot(wide_table *const table, uint32_t *const slot)
+{
+	if (table->n_free > 0) {
+		*slot = table->free_slots[--table->n_free];
+		return true;
+	}
+	if (table->count == table->capacity) {
+		size_t capacity = table->capacity == 0 ? 64 : table->capacity * 2;
+		struct wide_entry *entries =
+		    realloc(table->entries, capacity * sizeof(*entries));
+		if (entries != NULL) {
+			table->entries = entries;
+		}
+		uint32_t *free_slots =
+		    realloc(table->free_slots, capacity * sizeof(uint32_t));
+		if (free_slots != NULL) {
+			table->free_slots = free_slots;
+		}
+		if (entries == NULL || free_slots == NULL ||
+		    capacity > UINT32_MAX) {
+			return false;
+		}
+		for (size_t i = table->capacity; i < capacity; i++) {
+			table->entries[i].tier = TIER_32;
+			big_fraction_init(&table->entries[i].big);
+		}
+		table->capacity = capacity;
+	}
+	*slot = (uint32_t)table->count++;
+	return true;
+}
+
+/**
+ * @brief Gives the slot where a value will be promoted.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] target The value being promoted. It is made to point to
+ * the slot.
+ *
+ * @return The slot of the value, with its previous tier still set, or NULL
+ * if the memory could not be allocated. The table is then marked as failed,
+ * and the value is left unchanged.
+ */
+static struct wide_entry *
+promotion_slot(wide_table *const table, fraction *const target)
+{
+	if (!fraction_is_wide(target)) {
+		uint32_t slot = 0;
+		if (!allocate_slot(table, &slot)) {
+			table->failed = true;
+			return NULL;
+		}
+		table->entries[slot].tier = TIER_32;
+		target->negative = false;
+		target->numerator = slot;
+		target->denominator = 0;
+	}
+	return &table->entries[target->numerator];
+}
+
+/**
+ * @brief Stores a value given with 64-bit terms.
+ *
+ * The value is stored directly in the fraction if it fits. If it does not,
+ * and its slot cannot be allocated, the table is marked as failed and the
+ * target is left unchanged.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] target Where to store the value.
+ * @param[in] value The (reduced) value to store.
+ */
+static void
+store_wide(wide_table *const table, fraction *const target,
+           const wide_fraction *const value)
+{
+	if (value->numerator <= UINT32_MAX && value->denominator <= UINT32_MAX) {
+		release(table, target);
+		target->negative = value->negative;
+		target->numerator = (uint32_t)value->numerator;
+		target->denominator = (uint32_t)value->denominator;
+		return;
+	}
+	struct wide_entry *entry = promotion_slot(table, target);
+	if (entry == NULL) {
+		return;
+	}
+	if (entry->tier == TIER_32) {
+		table->promotions_to_64++;
+	}
+	entry->tier = TIER_64;
+	entry->wide = *value;
+}
+
+/**
+ * @brief Stores a value given with arbitrary precision.
+ *
+ * The value is stored in the lowest tier it fits in, like store_wide().
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] target Where to store the value.
+ * @param[in, out] value The (reduced) value to store. Its content is moved
+ * to the table, and it is left with an unspecified value.
+ */
+static void
+store_big(wide_table *const table, fraction *const target,
+          big_fraction *const value)
+{
+	wide_fraction narrower = {0};
+	if (big_fraction_to_u64(value, &narrower.negative, &narrower.numerator,
+	                        &narrower.denominator)) {
+		store_wide(table, target, &narrower);
+		return;
+	}
+	struct wide_entry *entry = promotion_slot(table, target);
+	if (entry == NULL) {
+		return;
+	}
+	if (entry->tier != TIER_BIG) {
+		table->promotions_to_big++;
+	}
+	entry->tier = TIER_BIG;
+	big_fraction temp = entry->big;
+	entry->big = *value;
+	*value = temp;
+}
+
+/**
+ * @brief Multiplies two wide fractions together.
+ *
+ * The terms are cross-reduced before the multiplication, so that the result
+ * is already reduced.
+ *
+ * @param[in] a The product's first term.
+ * @param[in] b The product's second term.
+ * @param[out] result Where to store the product.
+ *
+ * @return Whether the product fits in 64-bit terms.
+ */
+static bool
+wide_multiply(const wide_fraction *const a, const wide_fraction *const b,
+              wide_fraction *const result)
+{
+	if (a->numerator == 0 || b->numerator == 0) {
+		wide_fraction zero = {false, 0, 1};
+		*result = zero;
+		return true;
+	}
+	uint64_t divisor1 = gcd_u64(a->numerator, b->denominator);
+	uint64_t divisor2 = gcd_u64(b->numerator, a->denominator);
+	u128 numerator =
+	    (u128)(a->numerator / divisor1) * (b->numerator / divisor2);
+	u128 denominator =
+	    (u128)(a->denominator / divisor2) * (b->denominator / divisor1);
+	if (numerator > UINT64_MAX || denominator > UINT64_MAX) {
+		return false;
+	}
+	result->negative = a->negative != b->negative;
+	result->numerator = (uint64_t)numerator;
+	result->denominator = (uint64_t)denominator;
+	return true;
+}
+
+/**
+ * @brief Subtracts the product of two wide fractions from a third one.
+ *
+ * @param[in] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ * @param[out] result Where to store the result.
+ *
+ * @return Whether the result fits in 64-bit terms.
+ */
+static bool
+wide_submul(const wide_fraction *const minuend,
+            const wide_fraction *const factor, const wide_fraction *const term,
+            wide_fraction *const result)
+{
+	wide_fraction product = {0};
+	if (!wide_multiply(factor, term, &product)) {
+		return false;
+	}
+	/* Use the LCM of the denominators, like subtract_fractions() */
+	uint64_t divisor = gcd_u64(minuend->denominator, product.denominator);
+	u128 left = (u128)minuend->numerator * (product.denominator / divisor);
+	u128 right = (u128)product.numerator * (minuend->denominator / divisor);
+	u128 denominator =
+	    (u128)minuend->denominator * (product.denominator / divisor);
+	if (denominator > UINT64_MAX) {
+		return false;
+	}
+	u128 magnitude = 0;
+	bool negative = minuend->negative;
+	if (minuend->negative != product.negative) {
+		if (__builtin_add_overflow(left, right, &magnitude)) {
+			return false;
+		}
+	} else if (left >= right) {
+		magnitude = left - right;
+	} else {
+		magnitude = right - left;
+		negative = !negative;
+	}
+
+	uint64_t reduced_den = (uint64_t)denominator;
+	divisor = gcd_u64(reduced_den, (uint64_t)(magnitude % reduced_den));
+	magnitude /= divisor;
+	reduced_den /= divisor;
+	if (magnitude > UINT64_MAX) {
+		return false;
+	}
+	result->negative = negative && magnitude != 0;
+	result->numerator = (uint64_t)magnitude;
+	result->denominator = magnitude == 0 ? 1 : reduced_den;
+	return true;
+}
+
+/**
+ * @brief Compares two wide fractions.
+ *
+ * @see compare_fractions
+ *
+ * @param[in] a The first fraction to compare.
+ * @param[in] b The second fraction to compare.
+ *
+ * @return -1, 0, or 1 if `a` is respectively less, equal or greater than `b`.
+ */
+static int
+wide_compare(const wide_fraction *const a, const wide_fraction *const b)
+{
+	if (a->negative != b->negative) {
+		return a->negative ? -1 : 1;
+	}
+	u128 left = (u128)a->numerator * b->denominator;
+	u128 right = (u128)b->numerator * a->denominator;
+	int order = (left < right) ? -1 : (left > right);
+	return a->negative ? -order : order;
+}
+
+/**
+ * @brief Compares two approximations.
+ *
+ * This is the fallback of the comparisons of big fractions, when the memory
+ * of their cross-products cannot be allocated.
+ *
+ * @param[in] a The first approximation to compare.
+ * @param[in] b The second approximation to compare.
+ *
+ * @return -1, 0, or 1 if `a` is respectively less, equal or greater than `b`.
+ */
+static int
+approximate_compare(const double a, const double b)
+{
+	return (a < b) ? -1 : (a > b);
+}
+
+/* -- Table functions -- */
+
+/**
+ * @brief Initialises an empty table.
+ *
+ * @param[out] table The table to initialise.
+ */
+void
+wide_table_init(wide_table *const table)
+{
+	table->entries = NULL;
+	table->count = 0;
+	table->capacity = 0;
+	table->free_slots = NULL;
+	table->n_free = 0;
+	table->promotions_to_64 = 0;
+	table->promotions_to_big = 0;
+	table->failed = false;
+	table->lock = NULL;
+}
+
+/**
+ * @brief Releases the memory held by a table.
+ *
+ * @param[in, out] table The table to free.
+ */
+void
+wide_table_free(wide_table *const table)
+{
+	for (size_t i = 0; i < table->capacity; i++) {
+		big_fraction_free(&table->entries[i].big);
+	}
+	free(table->entries);
+	free(table->free_slots);
+	wide_table_init(table);
+}
+
+/**
+ * @brief Drops all the values of a table, keeping its memory.
+ *
+ * Its mark of failure is cleared.
+ *
+ * The fractions that referred to the table must not be used anymore.
+ *
+ * @param[in, out] table The table to clear.
+ */
+void
+wide_table_clear(wide_table *const table)
+{
+	for (size_t i = 0; i < table->count; i++) {
+		table->entries[i].tier = TIER_32;
+	}
+	table->count = 0;
+	table->n_free = 0;
+	table->promotions_to_64 = 0;
+	table->promotions_to_big = 0;
+	table->failed = false;
+}
+
+/* -- Arithmetic functions -- */
+
+/**
+ * @brief Frees the slot of a promoted value.
+ *
+ * The value is set to zero. Nothing is done if it was not promoted.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] f The value to release.
+ */
+void
+tiered_release(wide_table *const table, fraction *const f)
+{
+	if (!fraction_is_wide(f)) {
+		return;
+	}
+	lock_table(table);
+	release(table, f);
+	unlock_table(table);
+}
+
+/**
+ * @brief Sets a fraction to a value given with arbitrary precision.
+ *
+ * The value is stored in the lowest tier it fits in.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] target Where to store the value. Its previous value is
+ * released.
+ * @param[in, out] value The (reduced) value to store. Its content is moved
+ * to the table, and it is left with an unspecified value that must still be
+ * freed.
+ *
+ * @return Whether the memory could be allocated. If not, the table is marked
+ * as failed.
+ */
+bool
+tiered_set_big(wide_table *const table, fraction *const target,
+               big_fraction *const value)
+{
+	lock_table(table);
+	store_big(table, target, value);
+	const bool failed = table->failed;
+	unlock_table(table);
+	return !failed;
+}
+
+/**
+ * @brief Subtracts the product of two fractions from a third one, in place,
+ * with promotions.
+ *
+ * This is the slow path of tiered_submul(), for operands already promoted or
+ * whose result overflows a @ref fraction.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ */
+void
+tiered_submul_slow(wide_table *const table, fraction *const minuend,
+                   const fraction *const factor, const fraction *const term)
+{
+	if (tiered_is_zero(factor) || tiered_is_zero(term)) {
+		return;
+	}
+	lock_table(table);
+	if (tier_of(table, minuend) != TIER_BIG &&
+	    tier_of(table, factor) != TIER_BIG &&
+	    tier_of(table, term) != TIER_BIG) {
+		wide_fraction a = widen(table, minuend);
+		wide_fraction f = widen(table, factor);
+		wide_fraction b = widen(table, term);
+		wide_fraction result = {0};
+		if (wide_submul(&a, &f, &b, &result)) {
+			store_wide(table, minuend, &result);
+			unlock_table(table);
+			return;
+		}
+	}
+
+	big_fraction scratch_a;
+	big_fraction scratch_f;
+	big_fraction scratch_b;
+	big_fraction result;
+	big_fraction_init(&scratch_a);
+	big_fraction_init(&scratch_f);
+	big_fraction_init(&scratch_b);
+	big_fraction_init(&result);
+	/*
+	 * The views are copied, so that the table can be unlocked during the
+	 * computation: only the entries may move, not their limbs.
+	 */
+	const big_fraction *big_a = big_view(table, minuend, &scratch_a);
+	const big_fraction *big_f = big_view(table, factor, &scratch_f);
+	const big_fraction *big_b = big_view(table, term, &scratch_b);
+	if (big_a != NULL && big_f != NULL && big_b != NULL) {
+		const big_fraction view_a = *big_a;
+		const big_fraction view_f = *big_f;
+		const big_fraction view_b = *big_b;
+		unlock_table(table);
+		bool computed =
+		    big_fraction_submul(&result, &view_a, &view_f, &view_b);
+		lock_table(table);
+		if (computed) {
+			store_big(table, minuend, &result);
+		} else {
+			table->failed = true;
+		}
+	} else {
+		table->failed = true;
+	}
+	unlock_table(table);
+	big_fraction_free(&scratch_a);
+	big_fraction_free(&scratch_f);
+	big_fraction_free(&scratch_b);
+	big_fraction_free(&result);
+}
+
+/**
+ * @brief Multiplies two fractions together, with promotions.
+ *
+ * @see multiply_fractions
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in] a The product's first term.
+ * @param[in] b The product's second term.
+ * @param[in, out] result Where to store the product. Its previous value is
+ * released.
+ */
+void
+tiered_multiply(wide_table *const table, const fraction *const a,
+                const fraction *const b, fraction *const result)
+{
+	fraction narrow = {0};
+	if (!fraction_is_wide(a) && !fraction_is_wide(b) &&
+	    multiply_fractions(a, b, &narrow)) {
+		tiered_release(table, result);
+		*result = narrow;
+		return;
+	}
+	lock_table(table);
+	if (tier_of(table, a) != TIER_BIG && tier_of(table, b) != TIER_BIG) {
+		wide_fraction wide_a = widen(table, a);
+		wide_fraction wide_b = widen(table, b);
+		wide_fraction product = {0};
+		if (wide_multiply(&wide_a, &wide_b, &product)) {
+			store_wide(table, result, &product);
+			unlock_table(table);
+			return;
+		}
+	}
+	big_fraction scratch_a;
+	big_fraction scratch_b;
+	big_fraction product;
+	big_fraction_init(&scratch_a);
+	big_fraction_init(&scratch_b);
+	big_fraction_init(&product);
+	const big_fraction *big_a = big_view(table, a, &scratch_a);
+	const big_fraction *big_b = big_view(table, b, &scratch_b);
+	if (big_a != NULL && big_b != NULL) {
+		const big_fraction view_a = *big_a;
+		const big_fraction view_b = *big_b;
+		unlock_table(table);
+		bool computed =
+		    big_fraction_multiply(&product, &view_a, &view_b);
+		lock_table(table);
+		if (computed) {
+			store_big(table, result, &product);
+		} else {
+			table->failed = true;
+		}
+	} else {
+		table->failed = true;
+	}
+	unlock_table(table);
+	big_fraction_free(&scratch_a);
+	big_fraction_free(&scratch_b);
+	big_fraction_free(&product);
+}
+
+/**
+ * @brief Gives the invert of a fraction, with promotions.
+ *
+ * @warning If the input fraction is null, no action is performed.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in] input The fraction to invert.
+ * @param[in, out] result Where to store the inverted fraction. Its previous
+ * value is released.
+ */
+void
+tiered_invert(wide_table *const table, const fraction *const input,
+              fraction *const result)
+{
+	if (tiered_is_zero(input)) {
+		return;
+	}
+	lock_table(table);
+	switch (tier_of(table, input)) {
+	case TIER_32: {
+		fraction inverse = {0};
+		invert_fraction(input, &inverse);
+		release(table, result);
+		*result = inverse;
+		break;
+	}
+	case TIER_64: {
+		wide_fraction value = widen(table, input);
+		wide_fraction inverse = {value.negative, value.denominator,
+		                         value.numerator};
+		store_wide(table, result, &inverse);
+		break;
+	}
+	case TIER_BIG: {
+		big_fraction inverse;
+		big_fraction_init(&inverse);
+		if (big_fraction_invert(&inverse,
+		                        &table->entries[input->numerator].big)) {
+			store_big(table, result, &inverse);
+		} else {
+			table->failed = true;
+		}
+		big_fraction_free(&inverse);
+		break;
+	}
+	}
+	unlock_table(table);
+}
+
+/**
+ * @brief Compares two fractions, whatever their tier.
+ *
+ * The approximations of the fractions are compared if the memory of an
+ * exact comparison cannot be allocated.
+ *
+ * @see compare_fractions
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] a The first fraction to compare.
+ * @param[in] b The second fraction to compare.
+ *
+ * @return -1, 0, or 1 if `a` is respectively less, equal or greater than `b`.
+ */
+int
+tiered_compare(const wide_table *const table, const fraction *const a,
+               const fraction *const b)
+{
+	if (!fraction_is_wide(a) && !fraction_is_wide(b)) {
+		return compare_fractions(a, b);
+	}
+	if (tier_of(table, a) != TIER_BIG && tier_of(table, b) != TIER_BIG) {
+		wide_fraction wide_a = widen(table, a);
+		wide_fraction wide_b = widen(table, b);
+		return wide_compare(&wide_a, &wide_b);
+	}
+	big_fraction scratch_a;
+	big_fraction scratch_b;
+	big_fraction_init(&scratch_a);
+	big_fraction_init(&scratch_b);
+	const big_fraction *big_a = big_view(table, a, &scratch_a);
+	const big_fraction *big_b = big_view(table, b, &scratch_b);
+	int order = big_a != NULL && big_b != NULL
+	                ? big_fraction_compare(big_a, big_b)
+	                : approximate_compare(tiered_to_double(table, a),
+	                                      tiered_to_double(table, b));
+	big_fraction_free(&scratch_a);
+	big_fraction_free(&scratch_b);
+	return order;
+}
+
+/**
+ * @brief Compares the magnitudes of two fractions, whatever their tier.
+ *
+ * The approximations of the magnitudes are compared if the memory of an
+ * exact comparison cannot be allocated.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] a The first fraction to compare.
+ * @param[in] b The second fraction to compare.
+ *
+ * @return -1, 0, or 1 if the absolute value of `a` is respectively less,
+ * equal or greater than that of `b`.
+ */
+int
+tiered_compare_magnitude(const wide_table *const table,
+                         const fraction *const a, const fraction *const b)
+{
+	if (tier_of(table, a) != TIER_BIG && tier_of(table, b) != TIER_BIG) {
+		wide_fraction wide_a = widen(table, a);
+		wide_fraction wide_b = widen(table, b);
+		wide_a.negative = false;
+		wide_b.negative = false;
+		return wide_compare(&wide_a, &wide_b);
+	}
+	big_fraction scratch_a;
+	big_fraction scratch_b;
+	big_fraction_init(&scratch_a);
+	big_fraction_init(&scratch_b);
+	const big_fraction *big_a = big_view(table, a, &scratch_a);
+	const big_fraction *big_b = big_view(table, b, &scratch_b);
+	big_integer left;
+	big_integer right;
+	big_integer_init(&left);
+	big_integer_init(&right);
+	int order = 0;
+	if (big_a != NULL && big_b != NULL &&
+	    big_integer_multiply(&left, &big_a->numerator,
+	                         &big_b->denominator) &&
+	    big_integer_multiply(&right, &big_b->numerator,
+	                         &big_a->denominator)) {
+		order = big_integer_compare(&left, &right);
+	} else {
+		double x = tiered_to_double(table, a);
+		double y = tiered_to_double(table, b);
+		order = approximate_compare(x < 0 ? -x : x, y < 0 ? -y : y);
+	}
+	big_integer_free(&left);
+	big_integer_free(&right);
+	big_fraction_free(&scratch_a);
+	big_fraction_free(&scratch_b);
+	return order;
+}
+
+/**
+ * @brief Gives an approximation of a fraction, whatever its tier.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction to approximate.
+ *
+ * @return The value of the fraction, as a floating-point number.
+ */
+double
+tiered_to_double(const wide_table *const table, const fraction *const f)
+{
+	switch (tier_of(table, f)) {
+	case TIER_BIG:
+		return big_fraction_to_double(&table->entries[f->numerator].big);
+	default: {
+		wide_fraction value = widen(table, f);
+		return (value.negative ? -1.0 : 1.0) * value.numerator /
+		       value.denominator;
+	}
+	}
+}
+
+/**
+ * @brief Gives the number of bits of the terms of a fraction, whatever its
+ * tier.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ * @param[out] numerator_bits Where to store the number of bits of the
+ * numerator.
+ * @param[out] denominator_bits Where to store the number of bits of the
+ * denominator.
+ */
+void
+tiered_bits(const wide_table *const table, const fraction *const f,
+            size_t *const numerator_bits, size_t *const denominator_bits)
+{
+	switch (tier_of(table, f)) {
+	case TIER_BIG: {
+		const big_fraction *big = &table->entries[f->numerator].big;
+		*numerator_bits = big_integer_bits(&big->numerator);
+		*denominator_bits = big_integer_bits(&big->denominator);
+		break;
+	}
+	default: {
+		wide_fraction value = widen(table, f);
+		*numerator_bits = value.numerator == 0
+		                      ? 0
+		                      : 64 - (size_t)__builtin_clzll(
+		                                 value.numerator);
+		*denominator_bits =
+		    64 - (size_t)__builtin_clzll(value.denominator);
+	}
+	}
+}
+
+/**
+ * @brief Writes a big integer to a file, as its number of limbs followed by
+ * the limbs, all as little-endian 32-bit integers.
+ *
+ * @param[in] stream The file to write to.
+ * @param[in] n The integer to write.
+ *
+ * @return Whether the integer could be written.
+ */
+static bool
+write_integer(FILE *const stream, const big_integer *const n)
+{
+	unsigned char bytes[4];
+	for (size_t i = 0; i <= n->length; i++) {
+		const uint32_t limb = i == 0 ? (uint32_t)n->length
+		                             : n->limbs[i - 1];
+		for (unsigned b = 0; b < 4; b++) {
+			bytes[b] = (unsigned char)(limb >> (8 * b));
+		}
+		if (fwrite(bytes, 1, 4, stream) != 4) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Reads a big integer written by write_integer().
+ *
+ * @param[in] stream The file to read from.
+ * @param[out] n The integer to overwrite.
+ *
+ * @return Whether an integer could be read.
+ */
+static bool
+read_integer(FILE *const stream, big_integer *const n)
+{
+	unsigned char bytes[4];
+	if (fread(bytes, 1, 4, stream) != 4) {
+		return false;
+	}
+	const uint32_t length = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+	                        (uint32_t)bytes[2] << 16 |
+	                        (uint32_t)bytes[3] << 24;
+	/* Far more than any value of an elimination, a corrupted file */
+	if (length > (UINT32_C(1) << 24)) {
+		return false;
+	}
+	uint32_t *limbs =
+	    malloc((length == 0 ? 1 : length) * sizeof(uint32_t));
+	if (limbs == NULL) {
+		return false;
+	}
+	bool read = true;
+	for (uint32_t i = 0; read && i < length; i++) {
+		read = fread(bytes, 1, 4, stream) == 4;
+		limbs[i] = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+		           (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+	}
+	read = read && big_integer_set_limbs(n, limbs, length);
+	free(limbs);
+	return read;
+}
+
+/**
+ * @brief Writes a fraction to a binary file, whatever its tier.
+ *
+ * The sign is written as a byte, followed by the numerator and the
+ * denominator, whatever their size.
+ *
+ * @see tiered_read
+ *
+ * @param[in] stream The file to write to.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction to write.
+ *
+ * @return Whether the fraction could be written, and the memory of its
+ * conversion allocated.
+ */
+bool
+tiered_write(FILE *const stream, const wide_table *const table,
+             const fraction *const f)
+{
+	big_fraction scratch;
+	big_fraction_init(&scratch);
+	const big_fraction *value = big_view(table, f, &scratch);
+	if (value == NULL) {
+		big_fraction_free(&scratch);
+		return false;
+	}
+	const unsigned char sign = value->negative;
+	const bool written = fwrite(&sign, 1, 1, stream) == 1 &&
+	                     write_integer(stream, &value->numerator) &&
+	                     write_integer(stream, &value->denominator);
+	big_fraction_free(&scratch);
+	return written;
+}
+
+/**
+ * @brief Reads a fraction written by tiered_write().
+ *
+ * The fraction is reduced, and stored in the lowest tier it fits in.
+ *
+ * @param[in] stream The file to read from.
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] f Where to store the fraction. Its previous value is
+ * released.
+ *
+ * @return Whether a valid fraction could be read and stored.
+ */
+bool
+tiered_read(FILE *const stream, wide_table *const table, fraction *const f)
+{
+	big_fraction value;
+	big_fraction_init(&value);
+	unsigned char sign = 0;
+	bool read = fread(&sign, 1, 1, stream) == 1 && sign <= 1 &&
+	            read_integer(stream, &value.numerator) &&
+	            read_integer(stream, &value.denominator) &&
+	            value.denominator.length > 0;
+	if (read) {
+		value.negative = sign;
+		read = big_fraction_simplify(&value) &&
+		       tiered_set_big(table, f, &value);
+	}
+	big_fraction_free(&value);
+	return read;
+}
+
+/**
+ * @brief Prints a fraction, whatever its tier.
+ *
+ * The format is the sign, the numerator and the denominator, as in
+ * `-3/4`.
+ *
+ * @param[in] stream The stream to print to.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction to print.
+ *
+ * @return Whether the memory of an arbitrary-precision value could be
+ * allocated, as for big_fraction_fprint().
+ */
+bool
+tiered_fprint(FILE *const stream, const wide_table *const table,
+              const fraction *const f)
+{
+	if (tier_of(table, f) == TIER_BIG) {
+		return big_fraction_fprint(stream,
+		                           &table->entries[f->numerator].big);
+	}
+	wide_fraction value = widen(table, f);
+	fprintf(stream, "%c%" PRIu64 "/%" PRIu64, value.negative ? '-' : '+',
+	        value.numerator, value.denominator);
+	return true;
+}
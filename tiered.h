@@ -0,0 +1,181 @@
+/**
+ * @file tiered.h
+ * @brief Definitions for tiered.c
+ * @see tiered.c
+ */
+
+#ifndef TIERED_H
+#define TIERED_H
+
+#include "bigfrac.h"
+#include "fractions.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The representations a value can be stored in, from the fastest to
+ * the most precise.
+ */
+enum fraction_tier {
+	/** A @ref fraction, stored directly in the matrix */
+	TIER_32,
+	/** A @ref wide_fraction, stored in a @ref wide_table */
+	TIER_64,
+	/** A @ref big_fraction, stored in a @ref wide_table */
+	TIER_BIG,
+};
+
+/**
+ * @brief A fraction with 64-bit terms.
+ *
+ * @see struct fraction
+ */
+struct wide_fraction {
+	/** Whether the fraction is negative */
+	bool negative;
+	/** The numerator of the fraction */
+	uint64_t numerator;
+	/** The denominator of the fraction */
+	uint64_t denominator;
+};
+
+/**
+ * @brief Definition of a type from the wide_fraction structure.
+ * @see struct wide_fraction
+ */
+typedef struct wide_fraction wide_fraction;
+
+/**
+ * @brief A value promoted out of its @ref fraction.
+ */
+struct wide_entry {
+	/** The representation in use, TIER_32 if the entry is free */
+	enum fraction_tier tier;
+	/** The value, if the tier is TIER_64 */
+	wide_fraction wide;
+	/** The value, if the tier is TIER_BIG */
+	big_fraction big;
+};
+
+/**
+ * @brief The storage of the values that do not fit in a @ref fraction.
+ *
+ * A promoted @ref fraction has a denominator of 0, and its numerator is the
+ * index of its value in the table. The slots freed when a value fits in
+ * 32 bits again are reused.
+ *
+ * When the memory of a value cannot be allocated, the operation that produced
+ * it is dropped and the table is marked as failed: the values computed with
+ * it are then unspecified, but can still be released.
+ *
+ * A table can be shared between threads by giving it a lock. Its functions
+ * can then be called concurrently, as long as no two threads modify the same
+ * value and no value read by a thread is modified by another.
+ */
+struct wide_table {
+	/** The promoted values */
+	struct wide_entry *entries;
+	/** The number of slots in use or freed */
+	size_t count;
+	/** The number of slots allocated */
+	size_t capacity;
+	/** The indices of the freed slots */
+	uint32_t *free_slots;
+	/** The number of freed slots */
+	size_t n_free;
+	/** The number of values promoted to 64-bit terms */
+	size_t promotions_to_64;
+	/** The number of values promoted to arbitrary precision */
+	size_t promotions_to_big;
+	/** Whether the memory of a value could not be allocated */
+	bool failed;
+	/** The lock of the table if it is shared between threads, or NULL */
+	pthread_mutex_t *lock;
+};
+
+/**
+ * @brief Definition of a type from the wide_table structure.
+ * @see struct wide_table
+ */
+typedef struct wide_table wide_table;
+
+void wide_table_init(wide_table *const);
+void wide_table_free(wide_table *const);
+void wide_table_clear(wide_table *const);
+
+void tiered_release(wide_table *const, fraction *const);
+bool tiered_set_big(wide_table *const, fraction *const, big_fraction *const);
+void tiered_submul_slow(wide_table *const, fraction *const,
+                        const fraction *const, const fraction *const);
+void tiered_multiply(wide_table *const, const fraction *const,
+                     const fraction *const, fraction *const);
+void tiered_invert(wide_table *const, const fraction *const,
+                   fraction *const);
+int tiered_compare(const wide_table *const, const fraction *const,
+                   const fraction *const);
+int tiered_compare_magnitude(const wide_table *const, const fraction *const,
+                             const fraction *const);
+double tiered_to_double(const wide_table *const, const fraction *const);
+void tiered_bits(const wide_table *const, const fraction *const,
+                 size_t *const, size_t *const);
+bool tiered_write(FILE *const, const wide_table *const, const fraction *const);
+bool tiered_read(FILE *const, wide_table *const, fraction *const);
+bool tiered_fprint(FILE *const, const wide_table *const,
+                   const fraction *const);
+
+/**
+ * @brief Tells whether a fraction's value is stored in a @ref wide_table.
+ *
+ * @param[in] f The fraction to check.
+ *
+ * @return Whether the fraction was promoted.
+ */
+static inline bool
+fraction_is_wide(const fraction *const f)
+{
+	return f->denominator == 0;
+}
+
+/**
+ * @brief Tells whether a (possibly promoted) fraction is zero.
+ *
+ * Promoted values are never zero, since zero fits in a @ref fraction.
+ *
+ * @param[in] f The fraction to check.
+ *
+ * @return Whether the fraction is zero.
+ */
+static inline bool
+tiered_is_zero(const fraction *const f)
+{
+	return f->numerator == 0 && f->denominator != 0;
+}
+
+/**
+ * @brief Subtracts the product of two fractions from a third one, in place.
+ *
+ * Performs `minuend` -= `factor` \f$\times\f$ `term`. The 32-bit path is
+ * tried first, and the operands are only promoted if it overflows.
+ *
+ * @param[in, out] table The storage of the promoted values.
+ * @param[in, out] minuend The fraction being subtracted from.
+ * @param[in] factor The first term of the product being subtracted.
+ * @param[in] term The second term of the product being subtracted.
+ */
+static inline void
+tiered_submul(wide_table *const table, fraction *const minuend,
+              const fraction *const factor, const fraction *const term)
+{
+	if (!fraction_is_wide(minuend) && !fraction_is_wide(factor) &&
+	    !fraction_is_wide(term) &&
+	    submul_fractions(minuend, factor, term, minuend)) {
+		return;
+	}
+	tiered_submul_slow(table, minuend, factor, term);
+}
+
+#endif /* TIERED_H */
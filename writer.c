@@ -0,0 +1,451 @@
+/**
+ * @file writer.c
+ * @brief Buffered writing of the results, in text or binary.
+ *
+ * Everything is gathered in a large buffer, written to the file in blocks:
+ * a matrix or a solution of thousands of values then takes a few calls to
+ * `fwrite()` instead of a `printf()` per value. The integers are formatted
+ * by hand, without parsing a format on each call.
+ *
+ * @see writer.h
+ */
+
+#include "writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief The number of bytes gathered before they are written. */
+#define WRITE_BUFFER_SIZE 65536
+
+/**
+ * @brief Starts writing to a file.
+ *
+ * @param[out] w The writer.
+ * @param[in] file The file to write to.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+writer_init(writer *const w, FILE *const file)
+{
+	w->file = file;
+	w->buffer = malloc(WRITE_BUFFER_SIZE);
+	w->length = 0;
+	w->capacity = WRITE_BUFFER_SIZE;
+	w->failed = false;
+	return w->buffer != NULL;
+}
+
+/**
+ * @brief Starts writing to memory.
+ *
+ * The buffer grows as needed, and holds everything written until the writer
+ * is cleared.
+ *
+ * @param[out] w The writer.
+ *
+ * @return Whether the memory could be allocated.
+ */
+bool
+writer_init_memory(writer *const w)
+{
+	return writer_init(w, NULL);
+}
+
+/**
+ * @brief Drops what is buffered, to write again from the start of the
+ * buffer.
+ *
+ * @param[in, out] w The writer.
+ */
+void
+writer_clear(writer *const w)
+{
+	w->length = 0;
+	w->failed = false;
+}
+
+/**
+ * @brief Writes what is buffered to the file, and flushes the file.
+ *
+ * A writer to memory keeps what is buffered.
+ *
+ * @param[in, out] w The writer.
+ *
+ * @return Whether everything written so far reached the file.
+ */
+bool
+writer_flush(writer *const w)
+{
+	if (w->file == NULL) {
+		return !w->failed;
+	}
+	if (w->length > 0 &&
+	    fwrite(w->buffer, 1, w->length, w->file) != w->length) {
+		w->failed = true;
+	}
+	w->length = 0;
+	if (fflush(w->file) != 0) {
+		w->failed = true;
+	}
+	return !w->failed;
+}
+
+/**
+ * @brief Releases the memory of a writer, without flushing it.
+ *
+ * @param[in, out] w The writer.
+ */
+void
+writer_free(writer *const w)
+{
+	free(w->buffer);
+	w->buffer = NULL;
+	w->length = 0;
+}
+
+/**
+ * @brief Makes room in the buffer of a writer to memory.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] size The number of bytes the buffer must hold.
+ *
+ * @return Whether the memory could be allocated.
+ */
+static bool
+grow_buffer(writer *const w, const size_t size)
+{
+	size_t capacity = w->capacity;
+	while (capacity < size) {
+		capacity *= 2;
+	}
+	char *buffer = realloc(w->buffer, capacity);
+	if (buffer == NULL) {
+		return false;
+	}
+	w->buffer = buffer;
+	w->capacity = capacity;
+	return true;
+}
+
+/**
+ * @brief Writes bytes.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] bytes The bytes to write.
+ * @param[in] count The number of bytes.
+ */
+void
+writer_bytes(writer *const w, const void *const bytes, const size_t count)
+{
+	if (w->length + count > w->capacity && w->file == NULL) {
+		if (!grow_buffer(w, w->length + count)) {
+			w->failed = true;
+			return;
+		}
+	} else if (w->length + count > w->capacity) {
+		if (w->length > 0 &&
+		    fwrite(w->buffer, 1, w->length, w->file) != w->length) {
+			w->failed = true;
+		}
+		w->length = 0;
+		if (count > w->capacity) {
+			/* Too big to be buffered */
+			if (fwrite(bytes, 1, count, w->file) != count) {
+				w->failed = true;
+			}
+			return;
+		}
+	}
+	memcpy(w->buffer + w->length, bytes, count);
+	w->length += count;
+}
+
+/**
+ * @brief Writes a string, without its terminating null byte.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] string The string.
+ */
+void
+writer_string(writer *const w, const char *const string)
+{
+	writer_bytes(w, string, strlen(string));
+}
+
+/**
+ * @brief Writes a single character.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] c The character.
+ */
+void
+writer_char(writer *const w, const char c)
+{
+	if (w->length == w->capacity) {
+		writer_bytes(w, &c, 1);
+	} else {
+		w->buffer[w->length++] = c;
+	}
+}
+
+/**
+ * @brief Writes an unsigned integer in decimal.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] n The integer.
+ */
+void
+writer_unsigned(writer *const w, uint64_t n)
+{
+	/* 2^64 has 20 digits */
+	char digits[20];
+	size_t first = sizeof(digits);
+	do {
+		digits[--first] = (char)('0' + n % 10);
+		n /= 10;
+	} while (n != 0);
+	writer_bytes(w, digits + first, sizeof(digits) - first);
+}
+
+/**
+ * @brief Writes a signed integer in decimal, with its sign, as in `+3` or
+ * `-3`.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] n The integer.
+ */
+void
+writer_signed(writer *const w, const int64_t n)
+{
+	writer_char(w, n < 0 ? '-' : '+');
+	writer_unsigned(w, n < 0 ? -(uint64_t)n : (uint64_t)n);
+}
+
+/**
+ * @brief Writes a floating-point number.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] format The `printf()` format of the number, as `"%g"`.
+ * @param[in] x The number.
+ */
+void
+writer_double(writer *const w, const char *const format, const double x)
+{
+	/* Enough for any double, in the formats used */
+	char text[64];
+	const int length = snprintf(text, sizeof(text), format, x);
+	if (length > 0) {
+		writer_bytes(w, text,
+		             (size_t)length < sizeof(text) ? (size_t)length
+		                                           : sizeof(text) - 1);
+	}
+}
+
+/**
+ * @brief Writes a big integer in decimal.
+ *
+ * The writer fails if the memory of the conversion cannot be allocated.
+ *
+ * @see big_integer_fprint
+ *
+ * @param[in, out] w The writer.
+ * @param[in] n The integer.
+ */
+void
+writer_big_integer(writer *const w, const big_integer *const n)
+{
+	if (n->length <= 2) {
+		uint64_t small = 0;
+		big_integer_to_u64(n, &small);
+		writer_unsigned(w, small);
+		return;
+	}
+	uint32_t *chunks = NULL;
+	size_t n_chunks = 0;
+	if (!big_integer_decimal_chunks(n, &chunks, &n_chunks)) {
+		w->failed = true;
+		return;
+	}
+	writer_unsigned(w, chunks[n_chunks - 1]);
+	for (size_t i = n_chunks - 1; i-- > 0;) {
+		char digits[9];
+		uint32_t chunk = chunks[i];
+		for (size_t d = sizeof(digits); d-- > 0;) {
+			digits[d] = (char)('0' + chunk % 10);
+			chunk /= 10;
+		}
+		writer_bytes(w, digits, sizeof(digits));
+	}
+	free(chunks);
+}
+
+/**
+ * @brief Gives the value of a fraction that is not of arbitrary precision.
+ *
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ * @param[out] value Where to store its value.
+ *
+ * @return Whether the fraction is not of arbitrary precision.
+ */
+static bool
+small_value(const wide_table *const table, const fraction *const f,
+            wide_fraction *const value)
+{
+	if (!fraction_is_wide(f)) {
+		*value = (wide_fraction){f->negative, f->numerator,
+		                         f->denominator};
+		return true;
+	}
+	const struct wide_entry *entry = &table->entries[f->numerator];
+	if (entry->tier == TIER_BIG) {
+		return false;
+	}
+	*value = entry->wide;
+	return true;
+}
+
+/**
+ * @brief Writes a fraction, whatever its tier.
+ *
+ * The format is the one of tiered_fprint(), as in `-3/4`.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ */
+void
+writer_fraction(writer *const w, const wide_table *const table,
+                const fraction *const f)
+{
+	wide_fraction value;
+	if (small_value(table, f, &value)) {
+		writer_char(w, value.negative ? '-' : '+');
+		writer_unsigned(w, value.numerator);
+		writer_char(w, '/');
+		writer_unsigned(w, value.denominator);
+		return;
+	}
+	const big_fraction *big = &table->entries[f->numerator].big;
+	writer_char(w, big->negative ? '-' : '+');
+	writer_big_integer(w, &big->numerator);
+	writer_char(w, '/');
+	writer_big_integer(w, &big->denominator);
+}
+
+/**
+ * @brief Writes the numerator of a fraction, preceded by a minus sign if the
+ * fraction is negative.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ */
+void
+writer_numerator(writer *const w, const wide_table *const table,
+                 const fraction *const f)
+{
+	wide_fraction value;
+	if (small_value(table, f, &value)) {
+		if (value.negative && value.numerator != 0) {
+			writer_char(w, '-');
+		}
+		writer_unsigned(w, value.numerator);
+		return;
+	}
+	const big_fraction *big = &table->entries[f->numerator].big;
+	if (big->negative) {
+		writer_char(w, '-');
+	}
+	writer_big_integer(w, &big->numerator);
+}
+
+/**
+ * @brief Writes the denominator of a fraction.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ */
+void
+writer_denominator(writer *const w, const wide_table *const table,
+                   const fraction *const f)
+{
+	wide_fraction value;
+	if (small_value(table, f, &value)) {
+		writer_unsigned(w, value.denominator);
+	} else {
+		const big_fraction *big = &table->entries[f->numerator].big;
+		writer_big_integer(w, &big->denominator);
+	}
+}
+
+/**
+ * @brief Writes an unsigned integer in binary, in little-endian order.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] n The integer.
+ * @param[in] size The number of bytes to write it on, at most 8.
+ */
+void
+writer_le(writer *const w, const uint64_t n, const size_t size)
+{
+	unsigned char bytes[8];
+	for (size_t b = 0; b < size; b++) {
+		bytes[b] = (unsigned char)(n >> (8 * b));
+	}
+	writer_bytes(w, bytes, size);
+}
+
+/**
+ * @brief Writes a 64-bit term in binary, as a number of 32-bit limbs
+ * followed by the limbs.
+ *
+ * @param[in, out] w The writer.
+ * @param[in] n The term.
+ */
+static void
+writer_binary_term(writer *const w, const uint64_t n)
+{
+	const uint32_t length = n == 0 ? 0 : n >> 32 == 0 ? 1 : 2;
+	writer_le(w, length, 4);
+	for (uint32_t i = 0; i < length; i++) {
+		writer_le(w, (uint32_t)(n >> (32 * i)), 4);
+	}
+}
+
+/**
+ * @brief Writes a fraction in binary, whatever its tier.
+ *
+ * The encoding is the one of tiered_write(): the sign as a byte, then the
+ * numerator and the denominator, each as a number of 32-bit limbs followed
+ * by the limbs, all in little-endian order. The values are read back with
+ * tiered_read().
+ *
+ * @param[in, out] w The writer.
+ * @param[in] table The storage of the promoted values.
+ * @param[in] f The fraction.
+ */
+void
+writer_binary_fraction(writer *const w, const wide_table *const table,
+                       const fraction *const f)
+{
+	wide_fraction value;
+	if (small_value(table, f, &value)) {
+		writer_char(w, value.negative);
+		writer_binary_term(w, value.numerator);
+		writer_binary_term(w, value.denominator);
+		return;
+	}
+	const big_fraction *big = &table->entries[f->numerator].big;
+	writer_char(w, big->negative);
+	const big_integer *terms[2] = {&big->numerator, &big->denominator};
+	for (size_t t = 0; t < 2; t++) {
+		writer_le(w, terms[t]->length, 4);
+		for (size_t i = 0; i < terms[t]->length; i++) {
+			writer_le(w, terms[t]->limbs[i], 4);
+		}
+	}
+}
@@ -0,0 +1,65 @@
+/**
+ * @file writer.h
+ * @brief Definitions for writer.c
+ * @see writer.c
+ */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "bigfrac.h"
+#include "tiered.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief A buffered writer of text and binary values.
+ *
+ * What is written is kept in a large buffer, written to the file when it is
+ * full or flushed. Without a file, the buffer grows to keep everything.
+ */
+struct writer {
+	/** The file to write to, or NULL if everything is kept in memory */
+	FILE *file;
+	/** The bytes not yet written to the file */
+	char *buffer;
+	/** The number of bytes in the buffer */
+	size_t length;
+	/** The number of bytes the buffer can hold */
+	size_t capacity;
+	/** Whether writing to the file failed */
+	bool failed;
+};
+
+/**
+ * @brief Definition of a type from the writer structure.
+ * @see struct writer
+ */
+typedef struct writer writer;
+
+bool writer_init(writer *const, FILE *const);
+bool writer_init_memory(writer *const);
+void writer_clear(writer *const);
+bool writer_flush(writer *const);
+void writer_free(writer *const);
+void writer_bytes(writer *const, const void *const, const size_t);
+void writer_string(writer *const, const char *const);
+void writer_char(writer *const, const char);
+void writer_unsigned(writer *const, uint64_t);
+void writer_signed(writer *const, const int64_t);
+void writer_double(writer *const, const char *const, const double);
+void writer_big_integer(writer *const, const big_integer *const);
+void writer_fraction(writer *const, const wide_table *const,
+                     const fraction *const);
+void writer_numerator(writer *const, const wide_table *const,
+                      const fraction *const);
+void writer_denominator(writer *const, const wide_table *const,
+                        const fraction *const);
+void writer_le(writer *const, const uint64_t, const size_t);
+void writer_binary_fraction(writer *const, const wide_table *const,
+                            const fraction *const);
+
+#endif /* WRITER_H */